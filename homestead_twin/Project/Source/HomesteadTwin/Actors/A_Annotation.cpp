@@ -1,9 +1,11 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "A_Annotation.h"
-#include "Components/WidgetComponent.h"
+#include "../Subsystems/US_WorldWidgetPool.h"
+#include "Blueprint/UserWidget.h"
 #include "Components/BillboardComponent.h"
 #include "Components/SceneComponent.h"
+#include "Engine/World.h"
 
 AA_Annotation::AA_Annotation()
 {
@@ -17,9 +19,12 @@ AA_Annotation::AA_Annotation()
 	MarkerBillboard = CreateDefaultSubobject<UBillboardComponent>(TEXT("MarkerBillboard"));
 	MarkerBillboard->SetupAttachment(RootComponent);
 
-	// Create widget component for text display
-	TextWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("TextWidget"));
-	TextWidget->SetupAttachment(RootComponent);
+	// Text display is pooled by UUS_WorldWidgetPool
+	TextWidgetClass = TSoftClassPtr<UUserWidget>(FSoftObjectPath(TEXT("/Game/UI/Widgets/WID_AnnotationDisplay.WID_AnnotationDisplay_C")));
+	TextWidgetOffset = FVector(0.0f, 0.0f, 30.0f);
+	WidgetPool = nullptr;
+	WidgetSourceId = INDEX_NONE;
+	bMarkerActive = true;
 
 	// Initialize default values
 	AnnotationId = FGuid();
@@ -33,7 +38,19 @@ void AA_Annotation::BeginPlay()
 {
 	Super::BeginPlay();
 
-	UpdateWidgetDisplay();
+	UWorld* World = GetWorld();
+	WidgetPool = World ? World->GetSubsystem<UUS_WorldWidgetPool>() : nullptr;
+	if (bMarkerActive)
+	{
+		RegisterTextSource();
+	}
+}
+
+void AA_Annotation::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterTextSource();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AA_Annotation::Tick(float DeltaTime)
@@ -52,6 +69,28 @@ void AA_Annotation::InitializeAnnotation(FGuid InAnnotationId, const FString& In
 	UpdateWidgetDisplay();
 }
 
+void AA_Annotation::SetMarkerActive(bool bActive)
+{
+	if (bActive == bMarkerActive)
+	{
+		return;
+	}
+
+	bMarkerActive = bActive;
+	SetActorHiddenInGame(!bActive);
+	SetActorTickEnabled(bActive);
+
+	// Parked markers must not compete for pooled widgets
+	if (bActive)
+	{
+		RegisterTextSource();
+	}
+	else
+	{
+		UnregisterTextSource();
+	}
+}
+
 void AA_Annotation::UpdateAnnotationText(const FString& NewText)
 {
 	AnnotationText = NewText;
@@ -60,6 +99,35 @@ void AA_Annotation::UpdateAnnotationText(const FString& NewText)
 
 void AA_Annotation::UpdateWidgetDisplay()
 {
-	// TODO: Update widget to display current annotation data
-	// This would typically involve updating a UMG widget with the annotation text
+	if (!WidgetPool || WidgetSourceId == INDEX_NONE)
+	{
+		return;
+	}
+
+	FWorldWidgetContent Content;
+	Content.Label = FText::FromName(AnnotationCategory);
+	Content.Value = FText::FromString(AnnotationText);
+	Content.Color = MarkerColor;
+	WidgetPool->SetWidgetSourceContent(WidgetSourceId, Content);
+}
+
+void AA_Annotation::RegisterTextSource()
+{
+	if (!WidgetPool || WidgetSourceId != INDEX_NONE)
+	{
+		return;
+	}
+
+	// The billboard already marks the annotation, so no impostor
+	WidgetSourceId = WidgetPool->RegisterWidgetSource(RootSceneComponent, TextWidgetOffset, TextWidgetClass.LoadSynchronous(), 1.0f, false);
+	UpdateWidgetDisplay();
+}
+
+void AA_Annotation::UnregisterTextSource()
+{
+	if (WidgetPool && WidgetSourceId != INDEX_NONE)
+	{
+		WidgetPool->UnregisterWidgetSource(WidgetSourceId);
+	}
+	WidgetSourceId = INDEX_NONE;
 }
@@ -6,8 +6,9 @@
 #include "GameFramework/Actor.h"
 #include "A_Annotation.generated.h"
 
-class UWidgetComponent;
 class UBillboardComponent;
+class UUserWidget;
+class UUS_WorldWidgetPool;
 
 /**
  * AA_Annotation
@@ -22,9 +23,12 @@ class UBillboardComponent;
  *
  * Implementation Notes:
  * - Use billboard sprite or simple mesh for marker
- * - Widget component for text display
- * - Managed by US_AnnotationManager subsystem
- * - Visibility can be toggled based on phase or category
+ * - Text is displayed through UUS_WorldWidgetPool (no widget component per annotation);
+ *   the billboard remains the marker for annotations without a pooled widget
+ * - Placed and recycled by UUS_AnnotationMarkerPool, which keeps a bounded set of markers bound
+ *   (via InitializeAnnotation) to the annotations nearest the viewer that pass its phase and
+ *   category filter; annotations themselves live in US_AnnotationManager
+ * - An inactive marker is hidden, does not tick and holds no widget pool source
  */
 UCLASS()
 class HOMESTEADTWIN_API AA_Annotation : public AActor
@@ -36,6 +40,7 @@ public:
 
 	// Begin AActor Interface
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 	// End AActor Interface
 
@@ -43,6 +48,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
 	void InitializeAnnotation(FGuid InAnnotationId, const FString& InText, FName InCategory);
 
+	/** Show (and register the text source) or hide a marker; pooled markers are hidden while unassigned */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	void SetMarkerActive(bool bActive);
+
+	/** Check if the marker is shown */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Annotation")
+	bool IsMarkerActive() const { return bMarkerActive; }
+
 	/** Update annotation text */
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
 	void UpdateAnnotationText(const FString& NewText);
@@ -67,6 +80,10 @@ protected:
 	/** Update widget to display current annotation data */
 	void UpdateWidgetDisplay();
 
+	/** Register or remove the text source on the world widget pool */
+	void RegisterTextSource();
+	void UnregisterTextSource();
+
 protected:
 	/** Root scene component */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Homestead Twin|Components")
@@ -76,9 +93,13 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Homestead Twin|Components")
 	UBillboardComponent* MarkerBillboard;
 
-	/** Widget component for text display */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Homestead Twin|Components")
-	UWidgetComponent* TextWidget;
+	/** Widget class shown when the pool assigns this annotation a widget */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Appearance")
+	TSoftClassPtr<UUserWidget> TextWidgetClass;
+
+	/** Text position relative to the marker */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Appearance")
+	FVector TextWidgetOffset;
 
 	/** Annotation ID (matches US_AnnotationManager data) */
 	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|Data")
@@ -99,4 +120,15 @@ protected:
 	/** Text scale factor */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Appearance")
 	float TextScale;
+
+private:
+	/** Widget pool the text source is registered with */
+	UPROPERTY(Transient)
+	UUS_WorldWidgetPool* WidgetPool;
+
+	/** Source id on WidgetPool (INDEX_NONE = not registered) */
+	int32 WidgetSourceId;
+
+	/** Shown and holding a text source (false while parked in UUS_AnnotationMarkerPool) */
+	bool bMarkerActive;
 };
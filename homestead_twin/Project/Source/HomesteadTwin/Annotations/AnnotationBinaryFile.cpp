@@ -0,0 +1,317 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "AnnotationBinaryFile.h"
+#include "../Subsystems/US_AnnotationManager.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+
+/** On-disk record; layout is part of the file format */
+struct FAnnotationBinaryFile::FRecord
+{
+	FGuid Id;
+	double Position[3];
+	uint32 CategoryName;
+	int32 Phase;
+	int64 CreatedTicks;
+	int64 ModifiedTicks;
+
+	/** Text bytes in the string heap */
+	uint32 TextOffset;
+	uint32 TextBytes;
+
+	uint32 LinkedObjectName;
+	uint32 Reserved;
+};
+
+namespace AnnotationBinary
+{
+	constexpr uint32 FileMagic = 0x424E4148; // "HANB"
+	constexpr uint32 FileVersion = 1;
+
+	const TCHAR* const TempSuffix = TEXT(".tmp");
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 NumRecords;
+		uint32 NumNames;
+		uint64 RecordsOffset;
+
+		/** Name table: NumNames x (heap offset, byte count) */
+		uint64 NamesOffset;
+		uint64 HeapOffset;
+		uint64 HeapBytes;
+	};
+
+	struct FNameEntry
+	{
+		uint32 Offset;
+		uint32 Bytes;
+	};
+
+	static_assert(sizeof(FHeader) == 48, "Annotation snapshot header layout changed; bump FileVersion");
+	static_assert(sizeof(FNameEntry) == 8, "Annotation snapshot name entry layout changed; bump FileVersion");
+
+	/** Append Text as UTF-8 to Heap; returns false if the heap would outgrow 32-bit offsets */
+	bool AppendString(const FString& Text, TArray64<uint8>& Heap, uint32& OutOffset, uint32& OutBytes)
+	{
+		const FTCHARToUTF8 Utf8(*Text, Text.Len());
+		if (Heap.Num() + Utf8.Length() > MAX_uint32)
+		{
+			return false;
+		}
+
+		OutOffset = uint32(Heap.Num());
+		OutBytes = uint32(Utf8.Length());
+		Heap.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+		return true;
+	}
+
+	FString DecodeString(const uint8* Heap, uint64 HeapBytes, uint64 Offset, uint64 Bytes)
+	{
+		if (Bytes == 0 || Offset + Bytes > HeapBytes)
+		{
+			return FString();
+		}
+
+		const FUTF8ToTCHAR Text(reinterpret_cast<const UTF8CHAR*>(Heap + Offset), int32(Bytes));
+		return FString(Text.Length(), Text.Get());
+	}
+}
+
+using namespace AnnotationBinary;
+
+bool FAnnotationBinaryFile::Write(TConstArrayView<FAnnotation> Annotations, const FString& Path, FString& OutError)
+{
+	// Records are sorted by id so lookups can binary search the mapped file
+	TArray<const FAnnotation*> Sorted;
+	Sorted.Reserve(Annotations.Num());
+	for (const FAnnotation& Annotation : Annotations)
+	{
+		Sorted.Add(&Annotation);
+	}
+	Sorted.Sort([](const FAnnotation& A, const FAnnotation& B) { return A.AnnotationId < B.AnnotationId; });
+
+	TArray64<uint8> Heap;
+	TArray<FNameEntry> NameEntries;
+	TMap<FName, uint32> NameIndices;
+	NameIndices.Add(NAME_None, 0);
+	NameEntries.Add({ 0, 0 });
+
+	bool bHeapOverflow = false;
+	auto GetNameIndex = [&](FName Name)
+	{
+		if (const uint32* Index = NameIndices.Find(Name))
+		{
+			return *Index;
+		}
+
+		FNameEntry Entry;
+		bHeapOverflow |= !AppendString(Name.ToString(), Heap, Entry.Offset, Entry.Bytes);
+		NameEntries.Add(Entry);
+		return NameIndices.Add(Name, uint32(NameEntries.Num() - 1));
+	};
+
+	TArray<FRecord> Records;
+	Records.Reserve(Sorted.Num());
+	for (const FAnnotation* Annotation : Sorted)
+	{
+		FRecord& Record = Records.AddZeroed_GetRef();
+		Record.Id = Annotation->AnnotationId;
+		Record.Position[0] = Annotation->WorldPosition.X;
+		Record.Position[1] = Annotation->WorldPosition.Y;
+		Record.Position[2] = Annotation->WorldPosition.Z;
+		Record.CategoryName = GetNameIndex(Annotation->Category);
+		Record.Phase = Annotation->AssociatedPhase;
+		Record.CreatedTicks = Annotation->CreatedTimestamp.GetTicks();
+		Record.ModifiedTicks = Annotation->ModifiedTimestamp.GetTicks();
+		Record.LinkedObjectName = GetNameIndex(Annotation->LinkedObjectId);
+		bHeapOverflow |= !AppendString(Annotation->Text, Heap, Record.TextOffset, Record.TextBytes);
+	}
+
+	if (bHeapOverflow)
+	{
+		OutError = TEXT("annotation text exceeds the 4 GB string heap");
+		return false;
+	}
+
+	FHeader Header;
+	Header.Magic = FileMagic;
+	Header.Version = FileVersion;
+	Header.NumRecords = uint32(Records.Num());
+	Header.NumNames = uint32(NameEntries.Num());
+	Header.RecordsOffset = sizeof(FHeader);
+	Header.NamesOffset = Header.RecordsOffset + uint64(Records.Num()) * sizeof(FRecord);
+	Header.HeapOffset = Header.NamesOffset + uint64(NameEntries.Num()) * sizeof(FNameEntry);
+	Header.HeapBytes = uint64(Heap.Num());
+
+	IFileManager& FileManager = IFileManager::Get();
+	const FString TempPath = Path + TempSuffix;
+
+	TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*TempPath));
+	if (!File)
+	{
+		OutError = FString::Printf(TEXT("could not create %s"), *TempPath);
+		return false;
+	}
+
+	// Synced before the rename: callers delete the journal and older generations once this returns
+	const bool bWritten = File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header))
+		&& File->Write(reinterpret_cast<const uint8*>(Records.GetData()), Records.Num() * sizeof(FRecord))
+		&& File->Write(reinterpret_cast<const uint8*>(NameEntries.GetData()), NameEntries.Num() * sizeof(FNameEntry))
+		&& File->Write(Heap.GetData(), Heap.Num())
+		&& File->Flush(true);
+	File.Reset();
+
+	if (!bWritten)
+	{
+		FileManager.Delete(*TempPath, false, false, true);
+		OutError = FString::Printf(TEXT("could not write %s"), *TempPath);
+		return false;
+	}
+
+	if (!FileManager.Move(*Path, *TempPath, true, true))
+	{
+		OutError = FString::Printf(TEXT("could not replace %s"), *Path);
+		return false;
+	}
+	return true;
+}
+
+TSharedPtr<FAnnotationBinaryFile> FAnnotationBinaryFile::Open(const FString& Path, FString& OutError)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FOpenMappedResult Result = PlatformFile.OpenMappedEx(*Path);
+	if (Result.HasError())
+	{
+		OutError = FString::Printf(TEXT("cannot map %s"), *Path);
+		return nullptr;
+	}
+
+	TSharedPtr<FAnnotationBinaryFile> File = MakeShareable(new FAnnotationBinaryFile());
+	File->Path = Path;
+	File->MappedFile = Result.StealValue();
+
+	const int64 Size = File->MappedFile->GetFileSize();
+	if (Size >= int64(sizeof(FHeader)))
+	{
+		File->MappedRegion.Reset(File->MappedFile->MapRegion(0, Size));
+	}
+	if (!File->MappedRegion)
+	{
+		OutError = FString::Printf(TEXT("%s is truncated"), *Path);
+		return nullptr;
+	}
+
+	const uint8* Data = File->MappedRegion->GetMappedPtr();
+	FHeader Header;
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+
+	if (Header.Magic != FileMagic || Header.Version != FileVersion)
+	{
+		OutError = FString::Printf(TEXT("%s is not an annotation snapshot (or has an unsupported version)"), *Path);
+		return nullptr;
+	}
+
+	// Bounds only: checksumming would touch every page and defeat mapping
+	const uint64 FileSize = uint64(Size);
+	const bool bValid = Header.NumRecords <= uint32(MAX_int32)
+		&& Header.NumNames > 0
+		&& Header.RecordsOffset % alignof(FRecord) == 0
+		&& Header.RecordsOffset + uint64(Header.NumRecords) * sizeof(FRecord) <= FileSize
+		&& Header.NamesOffset % alignof(FNameEntry) == 0
+		&& Header.NamesOffset + uint64(Header.NumNames) * sizeof(FNameEntry) <= FileSize
+		&& Header.HeapOffset <= FileSize
+		&& Header.HeapBytes <= FileSize - Header.HeapOffset;
+	if (!bValid)
+	{
+		OutError = FString::Printf(TEXT("%s has a corrupt header"), *Path);
+		return nullptr;
+	}
+
+	File->Records = reinterpret_cast<const FRecord*>(Data + Header.RecordsOffset);
+	File->NumRecords = int32(Header.NumRecords);
+	File->StringHeap = Data + Header.HeapOffset;
+	File->StringHeapBytes = Header.HeapBytes;
+
+	const FNameEntry* NameEntries = reinterpret_cast<const FNameEntry*>(Data + Header.NamesOffset);
+	File->Names.Reserve(Header.NumNames);
+	File->Names.Add(NAME_None);
+	for (uint32 Index = 1; Index < Header.NumNames; ++Index)
+	{
+		const FString Name = DecodeString(File->StringHeap, File->StringHeapBytes, NameEntries[Index].Offset, NameEntries[Index].Bytes);
+		File->Names.Add(Name.IsEmpty() ? FName() : FName(*Name));
+	}
+
+	return File;
+}
+
+FAnnotationBinaryFile::FAnnotationBinaryFile()
+	: Records(nullptr)
+	, NumRecords(0)
+	, StringHeap(nullptr)
+	, StringHeapBytes(0)
+{
+}
+
+FAnnotationBinaryFile::~FAnnotationBinaryFile()
+{
+	// The region must be unmapped before its file handle closes
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+int32 FAnnotationBinaryFile::FindRecord(const FGuid& AnnotationId) const
+{
+	const int32 Index = Algo::LowerBoundBy(MakeArrayView(Records, NumRecords), AnnotationId, &FRecord::Id);
+	return Index < NumRecords && Records[Index].Id == AnnotationId ? Index : INDEX_NONE;
+}
+
+const FAnnotationBinaryFile::FRecord& FAnnotationBinaryFile::GetRecord(int32 Index) const
+{
+	static_assert(sizeof(FRecord) == 80, "Annotation snapshot record layout changed; bump FileVersion");
+	check(Index >= 0 && Index < NumRecords);
+	return Records[Index];
+}
+
+FName FAnnotationBinaryFile::GetName(uint32 NameIndex) const
+{
+	return Names.IsValidIndex(int32(NameIndex)) ? Names[int32(NameIndex)] : FName();
+}
+
+const FGuid& FAnnotationBinaryFile::GetId(int32 Index) const
+{
+	return GetRecord(Index).Id;
+}
+
+FVector FAnnotationBinaryFile::GetPosition(int32 Index) const
+{
+	const FRecord& Record = GetRecord(Index);
+	return FVector(Record.Position[0], Record.Position[1], Record.Position[2]);
+}
+
+FName FAnnotationBinaryFile::GetCategory(int32 Index) const
+{
+	return GetName(GetRecord(Index).CategoryName);
+}
+
+int32 FAnnotationBinaryFile::GetPhase(int32 Index) const
+{
+	return GetRecord(Index).Phase;
+}
+
+void FAnnotationBinaryFile::Decode(int32 Index, FAnnotation& OutAnnotation) const
+{
+	const FRecord& Record = GetRecord(Index);
+	OutAnnotation.AnnotationId = Record.Id;
+	OutAnnotation.WorldPosition = FVector(Record.Position[0], Record.Position[1], Record.Position[2]);
+	OutAnnotation.Text = DecodeString(StringHeap, StringHeapBytes, Record.TextOffset, Record.TextBytes);
+	OutAnnotation.Category = GetName(Record.CategoryName);
+	OutAnnotation.CreatedTimestamp = FDateTime(Record.CreatedTicks);
+	OutAnnotation.ModifiedTimestamp = FDateTime(Record.ModifiedTicks);
+	OutAnnotation.AssociatedPhase = Record.Phase;
+	OutAnnotation.LinkedObjectId = GetName(Record.LinkedObjectName);
+}
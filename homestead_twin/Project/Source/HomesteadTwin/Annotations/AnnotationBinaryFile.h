@@ -0,0 +1,78 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FAnnotation;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * FAnnotationBinaryFile
+ *
+ * Memory-mapped binary snapshot of the annotation database.
+ *
+ * Responsibilities:
+ * - Write annotations as a versioned binary file (temp file + rename, like FAnnotationJson)
+ * - Map a snapshot and serve individual records without loading the rest
+ *
+ * Implementation Notes:
+ * - File = header + fixed-size records sorted by id + name table + string heap. A record holds
+ *   id, position, phase, timestamps and name table indices (category, linked object) inline;
+ *   text lives in the UTF-8 string heap
+ * - Opening resolves only the name table (one FName per distinct category or linked object);
+ *   records are read in place, so startup cost does not grow with annotation text
+ * - Id lookup is a binary search over the sorted records
+ * - Little-endian, native layout; version bumps on any layout change
+ * - Read-only once opened and safe to read from any thread
+ */
+class HOMESTEADTWIN_API FAnnotationBinaryFile
+{
+public:
+	/** Write annotations to Path via a temp file, synced to disk before the rename */
+	static bool Write(TConstArrayView<FAnnotation> Annotations, const FString& Path, FString& OutError);
+
+	/** Map the snapshot at Path (nullptr, with OutError, if it cannot be mapped or is not a valid snapshot) */
+	static TSharedPtr<FAnnotationBinaryFile> Open(const FString& Path, FString& OutError);
+
+	~FAnnotationBinaryFile();
+
+	const FString& GetPath() const { return Path; }
+
+	/** Number of records */
+	int32 Num() const { return NumRecords; }
+
+	/** Index of the record with AnnotationId (INDEX_NONE if absent) */
+	int32 FindRecord(const FGuid& AnnotationId) const;
+
+	/** Fixed fields of record Index, read in place */
+	const FGuid& GetId(int32 Index) const;
+	FVector GetPosition(int32 Index) const;
+	FName GetCategory(int32 Index) const;
+	int32 GetPhase(int32 Index) const;
+
+	/** Decode record Index into a full annotation (reads its text from the string heap) */
+	void Decode(int32 Index, FAnnotation& OutAnnotation) const;
+
+private:
+	struct FRecord;
+
+	FAnnotationBinaryFile();
+
+	const FRecord& GetRecord(int32 Index) const;
+	FName GetName(uint32 NameIndex) const;
+
+	FString Path;
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** Views into the mapped region */
+	const FRecord* Records;
+	int32 NumRecords;
+	const uint8* StringHeap;
+	uint64 StringHeapBytes;
+
+	/** Name table, resolved on open (index 0 = NAME_None) */
+	TArray<FName> Names;
+};
@@ -0,0 +1,272 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "AnnotationJournal.h"
+#include "../HomesteadTwin.h"
+#include "../Subsystems/US_AnnotationManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace AnnotationJournal
+{
+	constexpr uint32 FileMagic = 0x4A4E4148; // "HANJ"
+	constexpr uint32 FileVersion = 1;
+	constexpr uint32 RecordMagic = 0x31434552; // "REC1"
+
+	/** File header: magic + version */
+	constexpr int64 FileHeaderBytes = 8;
+
+	/** Record header: magic + payload size + payload CRC */
+	constexpr int64 RecordHeaderBytes = 12;
+
+	uint32 ReadUInt32(const uint8* Data)
+	{
+		uint32 Value;
+		FMemory::Memcpy(&Value, Data, sizeof(Value));
+		return Value;
+	}
+
+	/** Start a record in OutBytes; returns its offset for FinishRecord */
+	int32 BeginRecord(TArray<uint8>& OutBytes)
+	{
+		const int32 HeaderOffset = OutBytes.Num();
+		OutBytes.AddZeroed(RecordHeaderBytes);
+		return HeaderOffset;
+	}
+
+	/** Fill in the header of the record started at HeaderOffset */
+	void FinishRecord(TArray<uint8>& OutBytes, int32 HeaderOffset)
+	{
+		const uint8* Payload = OutBytes.GetData() + HeaderOffset + RecordHeaderBytes;
+		const uint32 PayloadSize = uint32(OutBytes.Num() - HeaderOffset - RecordHeaderBytes);
+		const uint32 PayloadCrc = FCrc::MemCrc32(Payload, PayloadSize);
+
+		uint8* Header = OutBytes.GetData() + HeaderOffset;
+		FMemory::Memcpy(Header, &RecordMagic, 4);
+		FMemory::Memcpy(Header + 4, &PayloadSize, 4);
+		FMemory::Memcpy(Header + 8, &PayloadCrc, 4);
+	}
+}
+
+using namespace AnnotationJournal;
+
+void FAnnotationJournal::EncodeUpsert(EOp Op, const FAnnotation& Annotation, TArray<uint8>& OutBytes)
+{
+	check(Op != EOp::Delete);
+
+	const int32 HeaderOffset = BeginRecord(OutBytes);
+
+	FMemoryWriter Writer(OutBytes);
+	Writer.Seek(OutBytes.Num());
+
+	uint8 OpByte = uint8(Op);
+	FGuid AnnotationId = Annotation.AnnotationId;
+	FVector Position = Annotation.WorldPosition;
+	FString Text = Annotation.Text;
+	FString Category = Annotation.Category.ToString();
+	int64 CreatedTicks = Annotation.CreatedTimestamp.GetTicks();
+	int64 ModifiedTicks = Annotation.ModifiedTimestamp.GetTicks();
+	int32 Phase = Annotation.AssociatedPhase;
+	FString LinkedObject = Annotation.LinkedObjectId.ToString();
+
+	Writer << OpByte;
+	Writer << AnnotationId;
+	Writer << Position;
+	Writer << Text;
+	Writer << Category;
+	Writer << CreatedTicks;
+	Writer << ModifiedTicks;
+	Writer << Phase;
+	Writer << LinkedObject;
+
+	FinishRecord(OutBytes, HeaderOffset);
+}
+
+void FAnnotationJournal::EncodeDelete(const FGuid& AnnotationId, TArray<uint8>& OutBytes)
+{
+	const int32 HeaderOffset = BeginRecord(OutBytes);
+
+	FMemoryWriter Writer(OutBytes);
+	Writer.Seek(OutBytes.Num());
+
+	uint8 OpByte = uint8(EOp::Delete);
+	FGuid Id = AnnotationId;
+	Writer << OpByte;
+	Writer << Id;
+
+	FinishRecord(OutBytes, HeaderOffset);
+}
+
+int32 FAnnotationJournal::Replay(TFunctionRef<void(FAnnotation&&)> OnUpsert, TFunctionRef<void(const FGuid&)> OnDelete, bool& bOutTorn)
+{
+	check(!File);
+
+	bOutTorn = false;
+	ValidBytes = INDEX_NONE;
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+	{
+		return 0;
+	}
+
+	if (Bytes.Num() < FileHeaderBytes || ReadUInt32(Bytes.GetData()) != FileMagic || ReadUInt32(Bytes.GetData() + 4) != FileVersion)
+	{
+		bOutTorn = Bytes.Num() > 0;
+		ValidBytes = bOutTorn ? 0 : INDEX_NONE;
+		return 0;
+	}
+
+	int32 Applied = 0;
+	int64 Offset = FileHeaderBytes;
+	while (Offset < Bytes.Num())
+	{
+		const uint8* Header = Bytes.GetData() + Offset;
+		if (Bytes.Num() - Offset < RecordHeaderBytes || ReadUInt32(Header) != RecordMagic)
+		{
+			bOutTorn = true;
+			break;
+		}
+
+		const uint32 PayloadSize = ReadUInt32(Header + 4);
+		const uint8* Payload = Header + RecordHeaderBytes;
+		if (PayloadSize > Bytes.Num() - Offset - RecordHeaderBytes || FCrc::MemCrc32(Payload, PayloadSize) != ReadUInt32(Header + 8))
+		{
+			bOutTorn = true;
+			break;
+		}
+
+		FMemoryReaderView Reader(MakeArrayView(Payload, int32(PayloadSize)));
+
+		uint8 OpByte = 0;
+		FGuid AnnotationId;
+		Reader << OpByte;
+		Reader << AnnotationId;
+
+		if (EOp(OpByte) == EOp::Delete)
+		{
+			OnDelete(AnnotationId);
+		}
+		else
+		{
+			FAnnotation Annotation(ForceInit);
+			Annotation.AnnotationId = AnnotationId;
+
+			FString Category;
+			FString LinkedObject;
+			int64 CreatedTicks = 0;
+			int64 ModifiedTicks = 0;
+			Reader << Annotation.WorldPosition;
+			Reader << Annotation.Text;
+			Reader << Category;
+			Reader << CreatedTicks;
+			Reader << ModifiedTicks;
+			Reader << Annotation.AssociatedPhase;
+			Reader << LinkedObject;
+
+			if (Reader.IsError())
+			{
+				bOutTorn = true;
+				break;
+			}
+
+			Annotation.Category = FName(*Category);
+			Annotation.CreatedTimestamp = FDateTime(CreatedTicks);
+			Annotation.ModifiedTimestamp = FDateTime(ModifiedTicks);
+			Annotation.LinkedObjectId = FName(*LinkedObject);
+
+			// Create and update both carry the whole annotation
+			OnUpsert(MoveTemp(Annotation));
+		}
+
+		++Applied;
+		Offset += RecordHeaderBytes + PayloadSize;
+	}
+
+	if (bOutTorn)
+	{
+		ValidBytes = Offset;
+	}
+	return Applied;
+}
+
+FAnnotationJournal::FAnnotationJournal(const FString& InPath)
+	: Path(InPath)
+	, File(nullptr)
+	, ValidBytes(INDEX_NONE)
+{
+}
+
+FAnnotationJournal::~FAnnotationJournal()
+{
+	Close();
+}
+
+bool FAnnotationJournal::Open()
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+	// A header that did not survive is rewritten along with the rest of the file
+	const int64 KeepBytes = ValidBytes >= FileHeaderBytes ? ValidBytes : 0;
+	const bool bNewFile = ValidBytes != INDEX_NONE ? KeepBytes == 0 : PlatformFile.FileSize(*Path) <= 0;
+	File = PlatformFile.OpenWrite(*Path, true);
+	if (!File)
+	{
+		return false;
+	}
+
+	// Cut off the torn tail Replay stopped at, so new records follow the last valid one
+	if (ValidBytes != INDEX_NONE)
+	{
+		if (!File->Truncate(KeepBytes) || !File->Seek(KeepBytes))
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: could not truncate %s to %lld bytes"), *Path, KeepBytes);
+			delete File;
+			File = nullptr;
+			return false;
+		}
+		ValidBytes = INDEX_NONE;
+	}
+
+	if (bNewFile)
+	{
+		uint8 Header[FileHeaderBytes];
+		FMemory::Memcpy(Header, &FileMagic, 4);
+		FMemory::Memcpy(Header + 4, &FileVersion, 4);
+		File->Write(Header, FileHeaderBytes);
+	}
+	return true;
+}
+
+bool FAnnotationJournal::Append(TConstArrayView<uint8> Records)
+{
+	if (!File && !Open())
+	{
+		return false;
+	}
+
+	// Handing the bytes to the OS is enough to survive a process crash
+	return File->Write(Records.GetData(), Records.Num()) && File->Flush();
+}
+
+void FAnnotationJournal::Close()
+{
+	if (File)
+	{
+		File->Flush(true);
+		delete File;
+		File = nullptr;
+	}
+}
+
+void FAnnotationJournal::Delete()
+{
+	Close();
+	ValidBytes = INDEX_NONE;
+	IFileManager::Get().Delete(*Path, false, false, true);
+}
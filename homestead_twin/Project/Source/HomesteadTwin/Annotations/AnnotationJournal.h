@@ -0,0 +1,80 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FAnnotation;
+class IFileHandle;
+
+/**
+ * FAnnotationJournal
+ *
+ * Append-only log of annotation changes, written between snapshots.
+ *
+ * Responsibilities:
+ * - Encode create, update and delete operations as small checksummed records
+ * - Append them to the journal file
+ * - Replay the journal onto a loaded snapshot after a restart or crash
+ *
+ * Implementation Notes:
+ * - File = header (magic + version) + records; a record is magic + payload size + payload CRC
+ *   followed by the payload (op, annotation id and, for create and update, the whole annotation)
+ * - Create and update records carry the full annotation, so replay is idempotent: replaying
+ *   records a snapshot already holds gives the same state. That makes "write snapshot, then
+ *   delete journal" safe to interrupt at any point
+ * - Replay stops at the first truncated or corrupt record, which discards only a torn tail; it
+ *   remembers where the valid records end, and the next Open truncates the file there so new
+ *   records never land behind unreadable bytes (a journal that is only replayed is left as is)
+ * - Encoding is static and runs on the game thread; Append and Delete run on the annotation
+ *   manager's persistence pipe
+ */
+class HOMESTEADTWIN_API FAnnotationJournal
+{
+public:
+	enum class EOp : uint8
+	{
+		Create,
+		Update,
+		Delete
+	};
+
+	/** Append a create or update record for Annotation to OutBytes */
+	static void EncodeUpsert(EOp Op, const FAnnotation& Annotation, TArray<uint8>& OutBytes);
+
+	/** Append a delete record for AnnotationId to OutBytes */
+	static void EncodeDelete(const FGuid& AnnotationId, TArray<uint8>& OutBytes);
+
+	explicit FAnnotationJournal(const FString& InPath);
+	~FAnnotationJournal();
+
+	FAnnotationJournal(const FAnnotationJournal&) = delete;
+	FAnnotationJournal& operator=(const FAnnotationJournal&) = delete;
+
+	/**
+	 * Visit the records in the (closed) file in order: OnUpsert for create and update (with the
+	 * whole annotation), OnDelete for delete. Returns the number of records visited; bOutTorn is
+	 * set if reading stopped at a truncated or corrupt record, which the next Append cuts off.
+	 */
+	int32 Replay(TFunctionRef<void(FAnnotation&&)> OnUpsert, TFunctionRef<void(const FGuid&)> OnDelete, bool& bOutTorn);
+
+	/** Append encoded records (opens the file on first use) and flush them to the OS */
+	bool Append(TConstArrayView<uint8> Records);
+
+	/** Close the file */
+	void Close();
+
+	/** Close and delete the file (once a snapshot holds every record) */
+	void Delete();
+
+	const FString& GetPath() const { return Path; }
+
+private:
+	bool Open();
+
+	FString Path;
+	IFileHandle* File;
+
+	/** Length of the valid prefix found by the last torn Replay, or INDEX_NONE */
+	int64 ValidBytes;
+};
@@ -0,0 +1,332 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "AnnotationJson.h"
+#include "../Subsystems/US_AnnotationManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonWriter.h"
+
+namespace AnnotationJson
+{
+	/** Newest format this code reads and the one it writes */
+	constexpr int32 FormatVersion = 1;
+
+	const TCHAR* const TempSuffix = TEXT(".tmp");
+
+	const TCHAR* const VersionField = TEXT("version");
+	const TCHAR* const AnnotationsField = TEXT("annotations");
+	const TCHAR* const IdField = TEXT("id");
+	const TCHAR* const PositionField = TEXT("position");
+	const TCHAR* const TextField = TEXT("text");
+	const TCHAR* const CategoryField = TEXT("category");
+	const TCHAR* const CreatedField = TEXT("created");
+	const TCHAR* const ModifiedField = TEXT("modified");
+	const TCHAR* const PhaseField = TEXT("phase");
+	const TCHAR* const LinkedObjectField = TEXT("linkedObject");
+
+	typedef TJsonReader<UTF8CHAR> FReader;
+	typedef TJsonWriter<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>> FWriter;
+
+	/** Skip the container just opened by Notation (no-op for scalars) */
+	bool SkipValue(FReader& Reader, EJsonNotation Notation)
+	{
+		if (Notation == EJsonNotation::ObjectStart)
+		{
+			return Reader.SkipObject();
+		}
+		if (Notation == EJsonNotation::ArrayStart)
+		{
+			return Reader.SkipArray();
+		}
+		return true;
+	}
+
+	/** Read the fields of one annotation object (after its ObjectStart) */
+	bool ReadAnnotation(FReader& Reader, FAnnotation& OutAnnotation)
+	{
+		EJsonNotation Notation;
+		while (Reader.ReadNext(Notation))
+		{
+			if (Notation == EJsonNotation::ObjectEnd)
+			{
+				return true;
+			}
+
+			const FString& Field = Reader.GetIdentifier();
+			if (Notation == EJsonNotation::String)
+			{
+				const FString& Value = Reader.GetValueAsString();
+				if (Field == IdField)
+				{
+					FGuid::Parse(Value, OutAnnotation.AnnotationId);
+				}
+				else if (Field == TextField)
+				{
+					OutAnnotation.Text = Value;
+				}
+				else if (Field == CategoryField)
+				{
+					OutAnnotation.Category = FName(Value);
+				}
+				else if (Field == CreatedField)
+				{
+					FDateTime::ParseIso8601(*Value, OutAnnotation.CreatedTimestamp);
+				}
+				else if (Field == ModifiedField)
+				{
+					FDateTime::ParseIso8601(*Value, OutAnnotation.ModifiedTimestamp);
+				}
+				else if (Field == LinkedObjectField)
+				{
+					OutAnnotation.LinkedObjectId = FName(Value);
+				}
+			}
+			else if (Notation == EJsonNotation::Number && Field == PhaseField)
+			{
+				OutAnnotation.AssociatedPhase = int32(Reader.GetValueAsNumber());
+			}
+			else if (Notation == EJsonNotation::ArrayStart && Field == PositionField)
+			{
+				int32 Axis = 0;
+				while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ArrayEnd)
+				{
+					if (Notation == EJsonNotation::Number && Axis < 3)
+					{
+						OutAnnotation.WorldPosition[Axis] = Reader.GetValueAsNumber();
+					}
+					++Axis;
+				}
+				if (Notation != EJsonNotation::ArrayEnd)
+				{
+					return false;
+				}
+			}
+			else if (!SkipValue(Reader, Notation))
+			{
+				return false;
+			}
+		}
+		return false;
+	}
+
+	/** Read the annotations array (after its ArrayStart) */
+	bool ReadAnnotationArray(FReader& Reader, TArray<FAnnotation>& OutAnnotations)
+	{
+		EJsonNotation Notation;
+		while (Reader.ReadNext(Notation))
+		{
+			if (Notation == EJsonNotation::ArrayEnd)
+			{
+				return true;
+			}
+
+			if (Notation != EJsonNotation::ObjectStart)
+			{
+				if (!SkipValue(Reader, Notation))
+				{
+					return false;
+				}
+				continue;
+			}
+
+			// Zeroed construction: no GUID generation or clock reads per loaded annotation
+			FAnnotation& Annotation = OutAnnotations.Emplace_GetRef(ForceInit);
+			if (!ReadAnnotation(Reader, Annotation))
+			{
+				return false;
+			}
+
+			if (!Annotation.AnnotationId.IsValid())
+			{
+				Annotation.AnnotationId = FGuid::NewGuid();
+			}
+		}
+		return false;
+	}
+}
+
+using namespace AnnotationJson;
+
+void FAnnotationJson::Write(TConstArrayView<FAnnotation> Annotations, FArchive& Ar)
+{
+	TSharedRef<FWriter> Writer = TJsonWriterFactory<UTF8CHAR, TCondensedJsonPrintPolicy<UTF8CHAR>>::Create(&Ar);
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(VersionField, FormatVersion);
+	Writer->WriteArrayStart(AnnotationsField);
+
+	for (const FAnnotation& Annotation : Annotations)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(IdField, Annotation.AnnotationId.ToString(EGuidFormats::DigitsWithHyphens));
+
+		Writer->WriteArrayStart(PositionField);
+		Writer->WriteValue(Annotation.WorldPosition.X);
+		Writer->WriteValue(Annotation.WorldPosition.Y);
+		Writer->WriteValue(Annotation.WorldPosition.Z);
+		Writer->WriteArrayEnd();
+
+		Writer->WriteValue(TextField, Annotation.Text);
+		if (Annotation.Category != NAME_None)
+		{
+			Writer->WriteValue(CategoryField, Annotation.Category.ToString());
+		}
+		Writer->WriteValue(CreatedField, Annotation.CreatedTimestamp.ToIso8601());
+		Writer->WriteValue(ModifiedField, Annotation.ModifiedTimestamp.ToIso8601());
+		Writer->WriteValue(PhaseField, Annotation.AssociatedPhase);
+		if (Annotation.LinkedObjectId != NAME_None)
+		{
+			Writer->WriteValue(LinkedObjectField, Annotation.LinkedObjectId.ToString());
+		}
+		Writer->WriteObjectEnd();
+	}
+
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+}
+
+bool FAnnotationJson::Read(FUtf8StringView Json, TArray<FAnnotation>& OutAnnotations, FString& OutError)
+{
+	OutAnnotations.Reset();
+
+	TSharedRef<FReader> Reader = TJsonReaderFactory<UTF8CHAR>::CreateFromView(Json);
+
+	EJsonNotation Notation;
+	if (!Reader->ReadNext(Notation) || Notation != EJsonNotation::ObjectStart)
+	{
+		OutError = TEXT("expected a JSON object");
+		return false;
+	}
+
+	while (Reader->ReadNext(Notation))
+	{
+		if (Notation == EJsonNotation::ObjectEnd)
+		{
+			return true;
+		}
+
+		const FString& Field = Reader->GetIdentifier();
+		if (Notation == EJsonNotation::Number && Field == VersionField)
+		{
+			const int32 Version = int32(Reader->GetValueAsNumber());
+			if (Version > FormatVersion)
+			{
+				OutError = FString::Printf(TEXT("unsupported version %d"), Version);
+				return false;
+			}
+		}
+		else if (Notation == EJsonNotation::ArrayStart && Field == AnnotationsField)
+		{
+			if (!ReadAnnotationArray(*Reader, OutAnnotations))
+			{
+				break;
+			}
+		}
+		else if (!SkipValue(*Reader, Notation))
+		{
+			break;
+		}
+	}
+
+	OutError = Reader->GetErrorMessage().IsEmpty() ? TEXT("unexpected end of file") : Reader->GetErrorMessage();
+	return false;
+}
+
+bool FAnnotationJson::SaveFile(TConstArrayView<FAnnotation> Annotations, const FString& Path, FString& OutError)
+{
+	IFileManager& FileManager = IFileManager::Get();
+	const FString TempPath = Path + TempSuffix;
+
+	TUniquePtr<FArchive> File(FileManager.CreateFileWriter(*TempPath, FILEWRITE_EvenIfReadOnly));
+	if (!File)
+	{
+		OutError = FString::Printf(TEXT("could not create %s"), *TempPath);
+		return false;
+	}
+
+	Write(Annotations, *File);
+	File->Flush();
+	bool bWritten = File->Close();
+	File.Reset();
+
+	// The archive cannot sync, so a write handle on the finished file forces it to disk before
+	// the rename; the previous save must not be replaced by data still in the OS cache
+	if (bWritten)
+	{
+		TUniquePtr<IFileHandle> SyncHandle(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*TempPath, true));
+		bWritten = SyncHandle && SyncHandle->Flush(true);
+	}
+
+	if (!bWritten)
+	{
+		FileManager.Delete(*TempPath, false, false, true);
+		OutError = FString::Printf(TEXT("could not write %s"), *TempPath);
+		return false;
+	}
+
+	// The complete temp file replaces the previous save in one step
+	if (!FileManager.Move(*Path, *TempPath, true, true))
+	{
+		OutError = FString::Printf(TEXT("could not replace %s"), *Path);
+		return false;
+	}
+	return true;
+}
+
+bool FAnnotationJson::LoadFile(const FString& Path, TArray<FAnnotation>& OutAnnotations, FString& OutError)
+{
+	OutAnnotations.Reset();
+	OutError.Reset();
+
+	auto ReadFile = [&OutAnnotations, &OutError](const FString& ReadPath)
+	{
+		TArray<uint8> Bytes;
+		if (!FFileHelper::LoadFileToArray(Bytes, *ReadPath))
+		{
+			OutError = FString::Printf(TEXT("could not read %s"), *ReadPath);
+			return false;
+		}
+
+		if (!Read(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Bytes.GetData()), Bytes.Num()), OutAnnotations, OutError))
+		{
+			OutAnnotations.Reset();
+			OutError = FString::Printf(TEXT("%s: %s"), *ReadPath, *OutError);
+			return false;
+		}
+		return true;
+	};
+
+	IFileManager& FileManager = IFileManager::Get();
+	if (FileManager.FileExists(*Path))
+	{
+		return ReadFile(Path);
+	}
+
+	// A crash between syncing the temp file and the move leaves a complete temp file with no
+	// save beside it, but so does a crash part way through the very first save. Only a temp
+	// file that parses in full is taken, and it is moved into place so it is not read again.
+	const FString TempPath = Path + TempSuffix;
+	if (!FileManager.FileExists(*TempPath))
+	{
+		return false;
+	}
+
+	if (!ReadFile(TempPath))
+	{
+		// Never a finished save: treat it as no file at all; the next save overwrites it
+		OutError.Reset();
+		return false;
+	}
+
+	if (!FileManager.Move(*Path, *TempPath, true, true))
+	{
+		OutAnnotations.Reset();
+		OutError = FString::Printf(TEXT("could not replace %s"), *Path);
+		return false;
+	}
+	return true;
+}
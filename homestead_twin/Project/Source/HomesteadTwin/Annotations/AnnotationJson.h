@@ -0,0 +1,47 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FAnnotation;
+
+/**
+ * FAnnotationJson
+ *
+ * Streaming JSON persistence for annotations.
+ *
+ * Responsibilities:
+ * - Write annotations straight to a file archive, token by token
+ * - Read them back with a pull parser, filling FAnnotation fields as tokens arrive
+ * - Replace the saved file atomically, so a crash mid-save never leaves a truncated file
+ *
+ * Implementation Notes:
+ * - No FJsonObject DOM is built in either direction; memory beyond the annotations themselves
+ *   is the raw file bytes on load and the writer's buffer on save
+ * - Format: { "version": 1, "annotations": [ { "id", "position": [x, y, z], "text", "category",
+ *   "created", "modified", "phase", "linkedObject" } ] }, timestamps as ISO 8601
+ * - Saves go to <Path>.tmp and are moved over <Path>; if a crash leaves only the temp file,
+ *   LoadFile takes it when it parses in full (moving it over <Path>) and ignores it otherwise
+ * - Unknown fields are skipped, so newer files stay readable
+ * - Stateless and thread-safe; the annotation manager calls it from a background pipe
+ */
+class HOMESTEADTWIN_API FAnnotationJson
+{
+public:
+	/** Write annotations as JSON to Ar */
+	static void Write(TConstArrayView<FAnnotation> Annotations, FArchive& Ar);
+
+	/** Parse annotations from JSON. Returns false (with OutError) on malformed input. */
+	static bool Read(FUtf8StringView Json, TArray<FAnnotation>& OutAnnotations, FString& OutError);
+
+	/** Write annotations to Path via a temp file, synced to disk before the rename */
+	static bool SaveFile(TConstArrayView<FAnnotation> Annotations, const FString& Path, FString& OutError);
+
+	/**
+	 * Read annotations from Path, or from a leftover temp file that parses in full (which is
+	 * then moved to Path). Returns false with an empty OutError if neither exists, or if the
+	 * temp file is incomplete.
+	 */
+	static bool LoadFile(const FString& Path, TArray<FAnnotation>& OutAnnotations, FString& OutError);
+};
@@ -0,0 +1,79 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * TAnnotationKeyIndex
+ *
+ * Secondary index from an annotation attribute (category, phase) to the ids that carry it.
+ *
+ * Implementation Notes:
+ * - Maintained incrementally by UUS_AnnotationManager on create, change and delete
+ * - A key's id set is dropped with its last id, so the index only holds values in use
+ * - Game thread only
+ */
+template <typename KeyType>
+class TAnnotationKeyIndex
+{
+public:
+	void Reset()
+	{
+		IdsByKey.Reset();
+	}
+
+	void Add(const KeyType& Key, const FGuid& Id)
+	{
+		IdsByKey.FindOrAdd(Key).Add(Id);
+	}
+
+	void Remove(const KeyType& Key, const FGuid& Id)
+	{
+		if (TSet<FGuid>* Ids = IdsByKey.Find(Key))
+		{
+			Ids->Remove(Id);
+			if (Ids->Num() == 0)
+			{
+				IdsByKey.Remove(Key);
+			}
+		}
+	}
+
+	/** Move an id from one key to another */
+	void Move(const KeyType& OldKey, const KeyType& NewKey, const FGuid& Id)
+	{
+		if (OldKey != NewKey)
+		{
+			Remove(OldKey, Id);
+			Add(NewKey, Id);
+		}
+	}
+
+	/** Ids carrying Key (nullptr if none) */
+	const TSet<FGuid>* Find(const KeyType& Key) const
+	{
+		return IdsByKey.Find(Key);
+	}
+
+	/** Number of ids carrying Key */
+	int32 Num(const KeyType& Key) const
+	{
+		const TSet<FGuid>* Ids = IdsByKey.Find(Key);
+		return Ids ? Ids->Num() : 0;
+	}
+
+	/** Approximate heap memory held by the index (bytes) */
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Bytes = IdsByKey.GetAllocatedSize();
+		for (const TPair<KeyType, TSet<FGuid>>& Pair : IdsByKey)
+		{
+			Bytes += Pair.Value.GetAllocatedSize();
+		}
+		return Bytes;
+	}
+
+private:
+	TMap<KeyType, TSet<FGuid>> IdsByKey;
+};
@@ -0,0 +1,223 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "AnnotationSpatialIndex.h"
+#include "ConvexVolume.h"
+
+namespace AnnotationSpatialIndex
+{
+	/** Smallest allowed cell edge (cm) */
+	constexpr double MinCellSize = 1.0;
+
+	/** k-nearest candidates kept without a heap allocation */
+	constexpr int32 InlineNearestCount = 32;
+
+	/** k-nearest switches to scanning every occupied cell once a shell would probe more cells than this many times the occupied count */
+	constexpr int64 ShellProbeFactor = 4;
+}
+
+using namespace AnnotationSpatialIndex;
+
+FAnnotationSpatialIndex::FAnnotationSpatialIndex(double InCellSize)
+{
+	Reset(InCellSize);
+}
+
+void FAnnotationSpatialIndex::Reset(double InCellSize)
+{
+	CellSize = FMath::Max(MinCellSize, InCellSize);
+	InvCellSize = 1.0 / CellSize;
+	Cells.Reset();
+	EntryCells.Reset();
+	MinOccupiedCell = FIntVector(MAX_int32);
+	MaxOccupiedCell = FIntVector(MIN_int32);
+}
+
+FIntVector FAnnotationSpatialIndex::GetCell(const FVector& Position) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Position.X * InvCellSize),
+		FMath::FloorToInt32(Position.Y * InvCellSize),
+		FMath::FloorToInt32(Position.Z * InvCellSize));
+}
+
+void FAnnotationSpatialIndex::Add(const FGuid& Id, const FVector& Position)
+{
+	const FIntVector Cell = GetCell(Position);
+
+	if (FIntVector* ExistingCell = EntryCells.Find(Id))
+	{
+		TArray<FEntry>& Entries = Cells.FindChecked(*ExistingCell);
+		const int32 Index = Entries.IndexOfByPredicate([&Id](const FEntry& Entry) { return Entry.Id == Id; });
+
+		// Moves within a cell only update the stored position
+		if (*ExistingCell == Cell)
+		{
+			Entries[Index].Position = Position;
+			return;
+		}
+
+		Entries.RemoveAtSwap(Index, EAllowShrinking::No);
+		if (Entries.Num() == 0)
+		{
+			Cells.Remove(*ExistingCell);
+		}
+		*ExistingCell = Cell;
+	}
+	else
+	{
+		EntryCells.Add(Id, Cell);
+	}
+
+	Cells.FindOrAdd(Cell).Add(FEntry{ Id, Position });
+	MinOccupiedCell = FIntVector(FMath::Min(MinOccupiedCell.X, Cell.X), FMath::Min(MinOccupiedCell.Y, Cell.Y), FMath::Min(MinOccupiedCell.Z, Cell.Z));
+	MaxOccupiedCell = FIntVector(FMath::Max(MaxOccupiedCell.X, Cell.X), FMath::Max(MaxOccupiedCell.Y, Cell.Y), FMath::Max(MaxOccupiedCell.Z, Cell.Z));
+}
+
+void FAnnotationSpatialIndex::Remove(const FGuid& Id)
+{
+	FIntVector Cell;
+	if (!EntryCells.RemoveAndCopyValue(Id, Cell))
+	{
+		return;
+	}
+
+	TArray<FEntry>& Entries = Cells.FindChecked(Cell);
+	Entries.RemoveAtSwap(Entries.IndexOfByPredicate([&Id](const FEntry& Entry) { return Entry.Id == Id; }), EAllowShrinking::No);
+	if (Entries.Num() == 0)
+	{
+		Cells.Remove(Cell);
+	}
+}
+
+int32 FAnnotationSpatialIndex::NumCandidatesInRadius(const FVector& Center, double Radius) const
+{
+	int32 Candidates = 0;
+	ForEachCellInBox(FBox(Center - FVector(Radius), Center + FVector(Radius)), [&Candidates](const TArray<FEntry>& Entries)
+	{
+		Candidates += Entries.Num();
+	});
+	return Candidates;
+}
+
+void FAnnotationSpatialIndex::FindNearest(const FVector& Center, int32 Count, double MaxDistance, TArray<FGuid>& OutIds) const
+{
+	OutIds.Reset();
+	if (Count <= 0 || EntryCells.Num() == 0)
+	{
+		return;
+	}
+
+	const double MaxDistanceSq = MaxDistance > 0.0 ? MaxDistance * MaxDistance : TNumericLimits<double>::Max();
+	const FIntVector CenterCell = GetCell(Center);
+
+	// Max-heap on distance of the best Count entries so far
+	typedef TPair<double, FGuid> FCandidate;
+	TArray<FCandidate, TInlineAllocator<InlineNearestCount>> Best;
+	Best.Reserve(FMath::Min(Count, EntryCells.Num()));
+	const auto FartherFirst = [](const FCandidate& A, const FCandidate& B) { return A.Key > B.Key; };
+
+	const auto Consider = [&](const TArray<FEntry>& Entries)
+	{
+		for (const FEntry& Entry : Entries)
+		{
+			const double DistanceSq = FVector::DistSquared(Center, Entry.Position);
+			if (DistanceSq > MaxDistanceSq)
+			{
+				continue;
+			}
+
+			if (Best.Num() < Count)
+			{
+				Best.HeapPush(FCandidate(DistanceSq, Entry.Id), FartherFirst);
+			}
+			else if (DistanceSq < Best.HeapTop().Key)
+			{
+				Best.HeapPopDiscard(FartherFirst, EAllowShrinking::No);
+				Best.HeapPush(FCandidate(DistanceSq, Entry.Id), FartherFirst);
+			}
+		}
+	};
+
+	// No shell beyond the occupied bounds (or MaxDistance) can hold anything
+	int32 MaxRing = 0;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		MaxRing = FMath::Max(MaxRing, FMath::Max(FMath::Abs(MinOccupiedCell[Axis] - CenterCell[Axis]), FMath::Abs(MaxOccupiedCell[Axis] - CenterCell[Axis])));
+	}
+	if (MaxDistance > 0.0)
+	{
+		MaxRing = FMath::Min(MaxRing, FMath::CeilToInt32(MaxDistance * InvCellSize) + 1);
+	}
+
+	for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+	{
+		const int64 Side = 2 * int64(Ring) + 1;
+		const int64 ShellCells = Ring == 0 ? 1 : Side * Side * Side - (Side - 2) * (Side - 2) * (Side - 2);
+
+		// Far-flung sparse data: finish with one pass over the occupied cells outside the visited block
+		if (ShellCells > ShellProbeFactor * Cells.Num())
+		{
+			for (const TPair<FIntVector, TArray<FEntry>>& Pair : Cells)
+			{
+				const FIntVector Offset = Pair.Key - CenterCell;
+				if (FMath::Max3(FMath::Abs(Offset.X), FMath::Abs(Offset.Y), FMath::Abs(Offset.Z)) >= Ring)
+				{
+					Consider(Pair.Value);
+				}
+			}
+			break;
+		}
+
+		for (int32 DZ = -Ring; DZ <= Ring; ++DZ)
+		{
+			for (int32 DY = -Ring; DY <= Ring; ++DY)
+			{
+				// Interior rows only touch the two faces of the shell
+				const bool bFullRow = FMath::Abs(DZ) == Ring || FMath::Abs(DY) == Ring;
+				const int32 Step = bFullRow || Ring == 0 ? 1 : 2 * Ring;
+				for (int32 DX = -Ring; DX <= Ring; DX += Step)
+				{
+					if (const TArray<FEntry>* Entries = Cells.Find(CenterCell + FIntVector(DX, DY, DZ)))
+					{
+						Consider(*Entries);
+					}
+				}
+			}
+		}
+
+		// Every unvisited cell is at least Ring cells from Center
+		if (Best.Num() == Count && Best.HeapTop().Key <= FMath::Square(Ring * CellSize))
+		{
+			break;
+		}
+	}
+
+	Best.Sort([](const FCandidate& A, const FCandidate& B) { return A.Key < B.Key; });
+	OutIds.Reserve(Best.Num());
+	for (const FCandidate& Candidate : Best)
+	{
+		OutIds.Add(Candidate.Value);
+	}
+}
+
+bool FAnnotationSpatialIndex::IntersectCell(const FConvexVolume& Frustum, const FIntVector& Cell, bool& bOutFullyInside) const
+{
+	const FVector Extent(CellSize * 0.5);
+	const FVector Origin = FVector(Cell) * CellSize + Extent;
+	return Frustum.IntersectBox(Origin, Extent, bOutFullyInside);
+}
+
+bool FAnnotationSpatialIndex::IntersectPoint(const FConvexVolume& Frustum, const FVector& Position)
+{
+	return Frustum.IntersectSphere(Position, 0.0f);
+}
+
+SIZE_T FAnnotationSpatialIndex::GetAllocatedSize() const
+{
+	SIZE_T Bytes = Cells.GetAllocatedSize() + EntryCells.GetAllocatedSize();
+	for (const TPair<FIntVector, TArray<FEntry>>& Pair : Cells)
+	{
+		Bytes += Pair.Value.GetAllocatedSize();
+	}
+	return Bytes;
+}
@@ -0,0 +1,197 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FConvexVolume;
+
+/**
+ * FAnnotationSpatialIndex
+ *
+ * Hashed uniform grid over annotation positions.
+ *
+ * Responsibilities:
+ * - Track the position of every annotation incrementally (add, move, remove)
+ * - Answer radius, box, frustum and k-nearest queries without scanning every annotation
+ *
+ * Implementation Notes:
+ * - Only occupied cells exist (TMap keyed by cell coordinate), so the world can be any size
+ * - Cells store id and position inline; queries read cell arrays only and never touch the
+ *   annotations themselves
+ * - Range queries walk the cells overlapping the query bounds, or every occupied cell when that
+ *   is fewer, so cost is about O(cells touched + results)
+ * - k-nearest searches shells of cells outward from the query cell and stops once no unvisited
+ *   cell can hold a closer entry
+ * - Game thread only
+ */
+class HOMESTEADTWIN_API FAnnotationSpatialIndex
+{
+public:
+	explicit FAnnotationSpatialIndex(double InCellSize = 1000.0);
+
+	/** Drop all entries and change the cell size */
+	void Reset(double InCellSize);
+
+	/** Add an entry, or move it if the id is already indexed */
+	void Add(const FGuid& Id, const FVector& Position);
+
+	/** Remove an entry (no-op if unknown) */
+	void Remove(const FGuid& Id);
+
+	/** Number of indexed entries */
+	int32 Num() const { return EntryCells.Num(); }
+
+	/** Visit entries within Radius of Center. Func(const FGuid& Id, const FVector& Position) */
+	template <typename FuncType>
+	void ForEachInRadius(const FVector& Center, double Radius, FuncType&& Func) const
+	{
+		const double RadiusSq = Radius * Radius;
+		ForEachCellInBox(FBox(Center - FVector(Radius), Center + FVector(Radius)), [&](const TArray<FEntry>& Entries)
+		{
+			for (const FEntry& Entry : Entries)
+			{
+				if (FVector::DistSquared(Center, Entry.Position) <= RadiusSq)
+				{
+					Func(Entry.Id, Entry.Position);
+				}
+			}
+		});
+	}
+
+	/** Visit entries inside Box. Func(const FGuid& Id, const FVector& Position) */
+	template <typename FuncType>
+	void ForEachInBox(const FBox& Box, FuncType&& Func) const
+	{
+		ForEachCellInBox(Box, [&](const TArray<FEntry>& Entries)
+		{
+			for (const FEntry& Entry : Entries)
+			{
+				if (Box.IsInsideOrOn(Entry.Position))
+				{
+					Func(Entry.Id, Entry.Position);
+				}
+			}
+		});
+	}
+
+	/**
+	 * Visit entries inside Frustum, searching only cells that overlap Bounds (a box enclosing the
+	 * part of the frustum of interest). Func(const FGuid& Id, const FVector& Position)
+	 */
+	template <typename FuncType>
+	void ForEachInFrustum(const FConvexVolume& Frustum, const FBox& Bounds, FuncType&& Func) const
+	{
+		ForEachCellInBox(Bounds, [&](const FIntVector& Cell, const TArray<FEntry>& Entries)
+		{
+			bool bFullyInside = false;
+			if (!IntersectCell(Frustum, Cell, bFullyInside))
+			{
+				return;
+			}
+
+			for (const FEntry& Entry : Entries)
+			{
+				if ((bFullyInside || IntersectPoint(Frustum, Entry.Position)) && Bounds.IsInsideOrOn(Entry.Position))
+				{
+					Func(Entry.Id, Entry.Position);
+				}
+			}
+		});
+	}
+
+	/** Entries in the cells a radius query would search (an upper bound on its result count) */
+	int32 NumCandidatesInRadius(const FVector& Center, double Radius) const;
+
+	/**
+	 * Ids of the Count entries nearest Center, nearest first.
+	 * MaxDistance > 0 ignores entries farther than it.
+	 */
+	void FindNearest(const FVector& Center, int32 Count, double MaxDistance, TArray<FGuid>& OutIds) const;
+
+	/** Approximate heap memory held by the index (bytes) */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FEntry
+	{
+		FGuid Id;
+		FVector Position;
+	};
+
+	FIntVector GetCell(const FVector& Position) const;
+
+	/** Frustum tests, kept out of line so this header does not need ConvexVolume.h */
+	bool IntersectCell(const FConvexVolume& Frustum, const FIntVector& Cell, bool& bOutFullyInside) const;
+	static bool IntersectPoint(const FConvexVolume& Frustum, const FVector& Position);
+
+	/** Visit occupied cells overlapping Box. Func(const TArray<FEntry>&) or Func(const FIntVector&, const TArray<FEntry>&) */
+	template <typename FuncType>
+	void ForEachCellInBox(const FBox& Box, FuncType&& Func) const
+	{
+		if (Cells.Num() == 0 || !Box.IsValid)
+		{
+			return;
+		}
+
+		const FIntVector MinCell = GetCell(Box.Min);
+		const FIntVector MaxCell = GetCell(Box.Max);
+		const int64 BoxCells = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1) * int64(MaxCell.Z - MinCell.Z + 1);
+
+		// Large boxes over sparse data: filter the occupied cells instead of probing empty ones
+		if (BoxCells > Cells.Num())
+		{
+			for (const TPair<FIntVector, TArray<FEntry>>& Pair : Cells)
+			{
+				const FIntVector& Cell = Pair.Key;
+				if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X && Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y && Cell.Z >= MinCell.Z && Cell.Z <= MaxCell.Z)
+				{
+					InvokeCell(Func, Cell, Pair.Value);
+				}
+			}
+			return;
+		}
+
+		for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+				{
+					const FIntVector Cell(X, Y, Z);
+					if (const TArray<FEntry>* Entries = Cells.Find(Cell))
+					{
+						InvokeCell(Func, Cell, *Entries);
+					}
+				}
+			}
+		}
+	}
+
+	template <typename FuncType>
+	static void InvokeCell(FuncType& Func, const FIntVector& Cell, const TArray<FEntry>& Entries)
+	{
+		if constexpr (std::is_invocable_v<FuncType&, const FIntVector&, const TArray<FEntry>&>)
+		{
+			Func(Cell, Entries);
+		}
+		else
+		{
+			Func(Entries);
+		}
+	}
+
+	/** Edge length of a cell (cm) */
+	double CellSize;
+	double InvCellSize;
+
+	/** Occupied cells; a cell is removed when its last entry leaves */
+	TMap<FIntVector, TArray<FEntry>> Cells;
+
+	/** Id -> cell holding its entry */
+	TMap<FGuid, FIntVector> EntryCells;
+
+	/** Bounds of every cell ever occupied (limits the k-nearest shell search) */
+	FIntVector MinOccupiedCell;
+	FIntVector MaxOccupiedCell;
+};
@@ -1,6 +1,8 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "U_InteractableComponent.h"
+#include "U_TelemetryComponent.h"
+#include "GameFramework/Actor.h"
 
 UU_InteractableComponent::UU_InteractableComponent()
 {
@@ -26,6 +28,17 @@ void UU_InteractableComponent::TickComponent(float DeltaTime, ELevelTick TickTyp
 void UU_InteractableComponent::OnFocusGained()
 {
 	bIsFocused = true;
+
+	// Telemetry graphs are drawn only while focused; refresh them now rather than on the next sample
+	if (AActor* Owner = GetOwner())
+	{
+		TInlineComponentArray<UU_TelemetryComponent*> TelemetryComponents(Owner);
+		for (UU_TelemetryComponent* TelemetryComponent : TelemetryComponents)
+		{
+			TelemetryComponent->RefreshTelemetryData();
+		}
+	}
+
 	OnFocusGainedEvent();
 }
 
@@ -1,89 +1,290 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "U_TelemetryComponent.h"
+#include "U_InteractableComponent.h"
+#include "Components/PrimitiveComponent.h"
 #include "Components/WidgetComponent.h"
+#include "Blueprint/UserWidget.h"
+#include "GameFramework/Actor.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
 
 UU_TelemetryComponent::UU_TelemetryComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
+	// Updates are pushed by UUS_TelemetryManager
+	PrimaryComponentTick.bCanEverTick = false;
 
 	// Initialize default values
 	DisplayMode = ETelemetryDisplayMode::FloatingText;
 	UpdateRate = 1.0f;
 	CurrentValue = 0.0f;
-	UpdateTimer = 0.0f;
 
 	// Threshold defaults
 	GreenThreshold = 80.0f;
 	YellowThreshold = 60.0f;
 	RedThreshold = 30.0f;
 	bLowerIsBetter = false;
+	ThresholdHysteresis = 0.0f;
+	CustomDataIndex = 0;
 
-	// Create widget component
-	FloatingTextWidget = nullptr;
+	FloatingTextOffset = FVector(0.0f, 0.0f, 100.0f);
+	FloatingTextRelevance = 1.0f;
+
+	GraphWindowSeconds = 300.0f;
+	GraphPointCount = 128;
+
+	TelemetryManager = nullptr;
+	SubscriptionId = INDEX_NONE;
+	bAlarmThresholdsRegistered = false;
+	RegisteredStaleTimeout = 0.0f;
+	Interactable = nullptr;
+	WidgetPool = nullptr;
+	WidgetSourceId = INDEX_NONE;
 }
 
 void UU_TelemetryComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	ResolveTelemetryHandles();
 	RefreshTelemetryData();
 }
 
-void UU_TelemetryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UU_TelemetryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	UnsubscribeFromTelemetry();
+	UnregisterKeySettings();
+	UnbindOverlayPrimitives();
+	UnregisterFloatingText();
 
-	UpdateTimer += DeltaTime;
-	if (UpdateTimer >= UpdateRate)
-	{
-		UpdateTimer = 0.0f;
-		RefreshTelemetryData();
-	}
+	Super::EndPlay(EndPlayReason);
 }
 
 FString UU_TelemetryComponent::GetTelemetryValueString() const
 {
-	return FString::Printf(TEXT("%.2f"), CurrentValue);
+	// Formatted from the stored value only when a display asks, so enums and status text show as such
+	bool bSuccess = false;
+	const FString Text = TelemetryManager ? TelemetryManager->GetTelemetryStringByHandle(PrimaryHandle, bSuccess) : FString();
+	return bSuccess ? Text : FString::Printf(TEXT("%.2f"), CurrentValue);
 }
 
 bool UU_TelemetryComponent::IsTelemetryStale() const
 {
-	// Check if data is older than 2x the update rate
-	FTimespan TimeSinceUpdate = FDateTime::UtcNow() - LastUpdateTimestamp;
-	return TimeSinceUpdate.GetTotalSeconds() > (UpdateRate * 2.0);
+	// Tracked by the manager's deadline index; no clock read here
+	return !TelemetryManager || TelemetryManager->IsTelemetryStale(PrimaryHandle);
 }
 
 void UU_TelemetryComponent::RefreshTelemetryData()
 {
-	// TODO: Fetch data from US_TelemetryManager
-	// For now, just update timestamp
-	LastUpdateTimestamp = FDateTime::UtcNow();
+	if (!TelemetryManager || AdditionalHandles.Num() != AdditionalTelemetryKeys.Num())
+	{
+		ResolveTelemetryHandles();
+	}
+
+	if (!TelemetryManager)
+	{
+		return;
+	}
+
+	bool bSuccess = false;
+	const float PrimaryValue = TelemetryManager->GetTelemetryValueByHandle(PrimaryHandle, bSuccess);
+	if (bSuccess)
+	{
+		CurrentValue = PrimaryValue;
+		LastUpdateTimestamp = TelemetryManager->GetTelemetryTimestampByHandle(PrimaryHandle);
+	}
+
+	for (int32 Index = 0; Index < AdditionalHandles.Num(); ++Index)
+	{
+		const float Value = TelemetryManager->GetTelemetryValueByHandle(AdditionalHandles[Index], bSuccess);
+		if (bSuccess)
+		{
+			AdditionalValues[Index] = Value;
+		}
+	}
 
 	UpdateTelemetryDisplay();
 	OnTelemetryUpdated(CurrentValue);
 }
 
-void UU_TelemetryComponent::UpdateTelemetryDisplay()
+void UU_TelemetryComponent::ResolveTelemetryHandles()
 {
-	// TODO: Update visual display based on display mode
-	FLinearColor DisplayColor = GetColorForValue(CurrentValue);
+	UnsubscribeFromTelemetry();
+	UnregisterKeySettings();
+	UnbindOverlayPrimitives();
+	UnregisterFloatingText();
+
+	UWorld* World = GetWorld();
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	TelemetryManager = GameInstance ? GameInstance->GetSubsystem<UUS_TelemetryManager>() : nullptr;
+
+	AdditionalHandles.Reset(AdditionalTelemetryKeys.Num());
+	AdditionalValues.SetNumZeroed(AdditionalTelemetryKeys.Num());
+
+	if (!TelemetryManager)
+	{
+		PrimaryHandle = FTelemetryHandle();
+		return;
+	}
 
-	// Apply color to widget or material based on display mode
+	PrimaryHandle = TelemetryManager->RegisterTelemetryKey(TelemetryKey);
+	if (PrimaryHandle.IsValid() && DisplayMode != ETelemetryDisplayMode::None)
+	{
+		// Leaving Green = warning, leaving Yellow = critical
+		TelemetryManager->RegisterAlarmThresholds(PrimaryHandle, GreenThreshold, YellowThreshold, ThresholdHysteresis, bLowerIsBetter);
+		bAlarmThresholdsRegistered = true;
+	}
+
+	if (PrimaryHandle.IsValid() && UpdateRate > 0.0f)
+	{
+		// Data older than twice the expected interval is stale
+		RegisteredStaleTimeout = UpdateRate * 2.0f;
+		TelemetryManager->RegisterStaleTimeout(PrimaryHandle, RegisteredStaleTimeout);
+	}
+
+	for (const FName& Key : AdditionalTelemetryKeys)
+	{
+		AdditionalHandles.Add(TelemetryManager->RegisterTelemetryKey(Key));
+	}
+
+	TArray<FTelemetryHandle, TInlineAllocator<8>> Handles;
+	Handles.Add(PrimaryHandle);
+	Handles.Append(AdditionalHandles);
+	SubscriptionId = TelemetryManager->SubscribeToTelemetry(Handles,
+		FOnTelemetrySubscriptionUpdated::CreateUObject(this, &UU_TelemetryComponent::RefreshTelemetryData));
+
+	if (DisplayMode == ETelemetryDisplayMode::ColorOverlay)
+	{
+		BindOverlayPrimitives();
+	}
+	else if (DisplayMode == ETelemetryDisplayMode::FloatingText)
+	{
+		RegisterFloatingText();
+	}
+	else if (DisplayMode == ETelemetryDisplayMode::Graph)
+	{
+		AActor* Owner = GetOwner();
+		Interactable = Owner ? Owner->FindComponentByClass<UU_InteractableComponent>() : nullptr;
+	}
+}
+
+void UU_TelemetryComponent::UnsubscribeFromTelemetry()
+{
+	if (TelemetryManager && SubscriptionId != INDEX_NONE)
+	{
+		TelemetryManager->UnsubscribeFromTelemetry(SubscriptionId);
+	}
+	SubscriptionId = INDEX_NONE;
 }
 
-FLinearColor UU_TelemetryComponent::GetColorForValue(float Value) const
+void UU_TelemetryComponent::UnregisterKeySettings()
 {
-	if (bLowerIsBetter)
+	if (TelemetryManager && bAlarmThresholdsRegistered)
 	{
-		if (Value <= GreenThreshold) return FLinearColor::Green;
-		if (Value <= YellowThreshold) return FLinearColor::Yellow;
-		return FLinearColor::Red;
+		TelemetryManager->UnregisterAlarmThresholds(PrimaryHandle);
 	}
-	else
+	if (TelemetryManager && RegisteredStaleTimeout > 0.0f)
+	{
+		TelemetryManager->UnregisterStaleTimeout(PrimaryHandle, RegisteredStaleTimeout);
+	}
+	bAlarmThresholdsRegistered = false;
+	RegisteredStaleTimeout = 0.0f;
+}
+
+void UU_TelemetryComponent::BindOverlayPrimitives()
+{
+	AActor* Owner = GetOwner();
+	if (!TelemetryManager || !PrimaryHandle.IsValid() || !Owner)
+	{
+		return;
+	}
+
+	// Intensity spans the threshold range, whichever direction is better
+	const float IntensityMin = FMath::Min(RedThreshold, GreenThreshold);
+	const float IntensityMax = FMath::Max(RedThreshold, GreenThreshold);
+
+	TInlineComponentArray<UPrimitiveComponent*> Primitives(Owner);
+	for (UPrimitiveComponent* Primitive : Primitives)
+	{
+		if (Primitive->IsA<UWidgetComponent>())
+		{
+			continue;
+		}
+
+		const int32 BindingId = TelemetryManager->BindTelemetryToPrimitive(PrimaryHandle, Primitive, CustomDataIndex, IntensityMin, IntensityMax);
+		if (BindingId != INDEX_NONE)
+		{
+			OverlayBindingIds.Add(BindingId);
+		}
+	}
+}
+
+void UU_TelemetryComponent::UnbindOverlayPrimitives()
+{
+	if (TelemetryManager)
+	{
+		for (const int32 BindingId : OverlayBindingIds)
+		{
+			TelemetryManager->UnbindTelemetryFromPrimitive(BindingId);
+		}
+	}
+	OverlayBindingIds.Reset();
+}
+
+void UU_TelemetryComponent::RegisterFloatingText()
+{
+	AActor* Owner = GetOwner();
+	UWorld* World = GetWorld();
+	WidgetPool = World ? World->GetSubsystem<UUS_WorldWidgetPool>() : nullptr;
+	if (!WidgetPool || !Owner)
+	{
+		return;
+	}
+
+	WidgetSourceId = WidgetPool->RegisterWidgetSource(Owner->GetRootComponent(), FloatingTextOffset, nullptr, FloatingTextRelevance, true);
+}
+
+void UU_TelemetryComponent::UnregisterFloatingText()
+{
+	if (WidgetPool && WidgetSourceId != INDEX_NONE)
+	{
+		WidgetPool->UnregisterWidgetSource(WidgetSourceId);
+	}
+	WidgetSourceId = INDEX_NONE;
+}
+
+void UU_TelemetryComponent::UpdateTelemetryDisplay()
+{
+	// Color overlay is written by the telemetry manager's primitive bindings; floating text
+	// content is handed to the widget pool, which shows it if this source holds a widget
+	if (DisplayMode == ETelemetryDisplayMode::FloatingText && WidgetPool && WidgetSourceId != INDEX_NONE)
+	{
+		FWorldWidgetContent Content;
+		Content.Label = FText::FromName(TelemetryKey);
+		Content.Value = FText::FromString(GetTelemetryValueString());
+		Content.Color = GetAlarmColor();
+		Content.bStale = IsTelemetryStale();
+		WidgetPool->SetWidgetSourceContent(WidgetSourceId, Content);
+	}
+
+	// Graph buckets are queried only for the focused object
+	if (DisplayMode == ETelemetryDisplayMode::Graph && Interactable && Interactable->IsFocused())
+	{
+		TelemetryManager->GetTelemetryGraph(TelemetryKey, GraphWindowSeconds, GraphPointCount, GraphPoints);
+		OnTelemetryGraphUpdated();
+	}
+}
+
+FLinearColor UU_TelemetryComponent::GetAlarmColor() const
+{
+	const ETelemetryAlarmState State = TelemetryManager
+		? TelemetryManager->GetAlarmState(PrimaryHandle)
+		: ETelemetryAlarmState::Normal;
+
+	switch (State)
 	{
-		if (Value >= GreenThreshold) return FLinearColor::Green;
-		if (Value >= YellowThreshold) return FLinearColor::Yellow;
-		return FLinearColor::Red;
+	case ETelemetryAlarmState::Warning:  return FLinearColor::Yellow;
+	case ETelemetryAlarmState::Critical: return FLinearColor::Red;
+	default:                             return FLinearColor::Green;
 	}
 }
@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "../Subsystems/US_TelemetryManager.h"
+#include "../Subsystems/US_WorldWidgetPool.h"
 #include "U_TelemetryComponent.generated.h"
 
-class UWidgetComponent;
+class UU_InteractableComponent;
 
 /**
  * ETelemetryDisplayMode
@@ -30,14 +32,28 @@ enum class ETelemetryDisplayMode : uint8
  * Responsibilities:
  * - Fetch telemetry data from US_TelemetryManager
  * - Display data visually (text, color, graph)
- * - Update at configurable intervals
+ * - Refresh only when the telemetry manager reports new data for its keys
  * - Support multiple telemetry keys per object
  *
  * Implementation Notes:
  * - Attach to AA_HomesteadObject (e.g., rack, PV array, battery)
- * - Data fetched from US_TelemetryManager by key
+ * - Keys resolved to FTelemetryHandles once in BeginPlay, then read by handle
+ * - Never ticks: subscribes to its handles and is refreshed from the manager's per-frame drain
  * - Display mode can be text overlay, color change, or graph widget
- * - Gracefully handle missing/stale data (offline mode)
+ * - Graph mode fills GraphPoints from the manager's rollup pyramid on each refresh while the
+ *   owner's UU_InteractableComponent is focused, then fires OnTelemetryGraphUpdated for the
+ *   Blueprint graph widget to draw; unfocused objects query nothing. APC_Desktop and APC_VR do
+ *   not call OnFocusGained / OnFocusLost yet, so the graph stays empty until they do
+ * - Floating text registers the owner with UUS_WorldWidgetPool instead of owning a widget
+ *   component; the pool shows a widget only for the nearest sources within its budget
+ * - Green/Yellow thresholds are registered with the manager's alarm engine, which
+ *   evaluates every key in one vectorized pass; the color follows the alarm state. Components
+ *   sharing a key share its thresholds: the first registrant's apply and conflicts are logged
+ * - Color overlay binds the owner's primitives to the manager's binding table, which writes
+ *   alarm color and intensity as Custom Primitive Data (no per-actor material instances);
+ *   overlay materials read CustomPrimitiveData[CustomDataIndex..CustomDataIndex + 3]
+ * - Gracefully handle missing/stale data (offline mode); staleness is tracked by the manager,
+ *   which refreshes the component when its key goes stale or fresh
  */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class HOMESTEADTWIN_API UU_TelemetryComponent : public UActorComponent
@@ -49,13 +65,17 @@ public:
 
 	// Begin UActorComponent Interface
 	virtual void BeginPlay() override;
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	// End UActorComponent Interface
 
 	/** Get current telemetry value for primary key */
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
 	float GetTelemetryValue() const { return CurrentValue; }
 
+	/** Get current value of an additional telemetry key (index into AdditionalTelemetryKeys) */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
+	float GetAdditionalTelemetryValue(int32 Index) const { return AdditionalValues.IsValidIndex(Index) ? AdditionalValues[Index] : 0.0f; }
+
 	/** Get current telemetry value as string */
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
 	FString GetTelemetryValueString() const;
@@ -77,11 +97,36 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Homestead Twin|Telemetry")
 	void OnTelemetryUpdated(float NewValue);
 
+	/** Called when GraphPoints was refreshed (Graph mode, owner focused) */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Homestead Twin|Telemetry")
+	void OnTelemetryGraphUpdated();
+
 	/** Update telemetry display based on current value */
 	void UpdateTelemetryDisplay();
 
-	/** Get color based on value and thresholds */
-	FLinearColor GetColorForValue(float Value) const;
+	/** Get color for the primary key's alarm state (evaluated by the telemetry manager) */
+	FLinearColor GetAlarmColor() const;
+
+	/** Resolve telemetry keys into handles on the telemetry manager and subscribe to them */
+	void ResolveTelemetryHandles();
+
+	/** Drop the current subscription, if any */
+	void UnsubscribeFromTelemetry();
+
+	/** Release the primary key's alarm thresholds and stale timeout, if registered */
+	void UnregisterKeySettings();
+
+	/** Bind the owner's primitives to the primary key for color overlay */
+	void BindOverlayPrimitives();
+
+	/** Remove the overlay bindings, if any */
+	void UnbindOverlayPrimitives();
+
+	/** Register the owner as a floating text source with the world widget pool */
+	void RegisterFloatingText();
+
+	/** Remove the floating text source, if any */
+	void UnregisterFloatingText();
 
 protected:
 	/** Primary telemetry key to display */
@@ -96,7 +141,7 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry")
 	ETelemetryDisplayMode DisplayMode;
 
-	/** Update rate (seconds) */
+	/** Expected update interval (seconds); the manager flags the key stale after twice this without data (0 = learn). Components sharing a key use the shortest */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry")
 	float UpdateRate;
 
@@ -104,13 +149,21 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|Telemetry")
 	float CurrentValue;
 
+	/** Current values of AdditionalTelemetryKeys (same order) */
+	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|Telemetry")
+	TArray<float> AdditionalValues;
+
 	/** Timestamp of last update */
 	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|Telemetry")
 	FDateTime LastUpdateTimestamp;
 
-	/** Widget component for floating text display */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Homestead Twin|Components")
-	UWidgetComponent* FloatingTextWidget;
+	/** Floating text position relative to the owner's root */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry")
+	FVector FloatingTextOffset;
+
+	/** Floating text priority against other sources (> 1 wins over closer objects) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "0.01"))
+	float FloatingTextRelevance;
 
 	/** Threshold for green color (normal) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Thresholds")
@@ -128,7 +181,57 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Thresholds")
 	bool bLowerIsBetter;
 
+	/** How far the value must move back past a threshold before the color recovers */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Thresholds", meta = (ClampMin = "0"))
+	float ThresholdHysteresis;
+
+	/** Time span of the graph in Graph mode (seconds) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "1"))
+	float GraphWindowSeconds;
+
+	/** Points the graph is drawn with in Graph mode (about one per horizontal pixel of the widget) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "1"))
+	int32 GraphPointCount;
+
+	/** Min/max/mean of the primary key over GraphWindowSeconds (Graph mode, refreshed while focused) */
+	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|Telemetry")
+	TArray<FTelemetryGraphPoint> GraphPoints;
+
+	/** First Custom Primitive Data index written in color overlay mode (R, G, B, Intensity) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "0"))
+	int32 CustomDataIndex;
+
 private:
-	/** Timer for update rate */
-	float UpdateTimer;
+	/** Telemetry manager the handles were resolved against */
+	UPROPERTY(Transient)
+	UUS_TelemetryManager* TelemetryManager;
+
+	/** Handle for TelemetryKey */
+	FTelemetryHandle PrimaryHandle;
+
+	/** Handles for AdditionalTelemetryKeys (same order) */
+	TArray<FTelemetryHandle> AdditionalHandles;
+
+	/** Subscription id on TelemetryManager (INDEX_NONE = not subscribed) */
+	int32 SubscriptionId;
+
+	/** Holds a threshold registration for PrimaryHandle on TelemetryManager */
+	bool bAlarmThresholdsRegistered;
+
+	/** Stale timeout registered for PrimaryHandle on TelemetryManager (0 = none) */
+	float RegisteredStaleTimeout;
+
+	/** Primitive binding ids on TelemetryManager (color overlay mode) */
+	TArray<int32> OverlayBindingIds;
+
+	/** Owner's interactable, whose focus gates the graph (Graph mode) */
+	UPROPERTY(Transient)
+	UU_InteractableComponent* Interactable;
+
+	/** Widget pool the floating text source is registered with */
+	UPROPERTY(Transient)
+	UUS_WorldWidgetPool* WidgetPool;
+
+	/** Source id on WidgetPool (INDEX_NONE = not registered) */
+	int32 WidgetSourceId;
 };
@@ -2,6 +2,7 @@
 
 #include "PC_Desktop.h"
 #include "Pawn_Desktop.h"
+#include "../HomesteadTwin.h"
 #include "DrawDebugHelpers.h"
 #include "Components/InputComponent.h"
 
@@ -59,6 +60,8 @@ void APC_Desktop::ToggleFreeFlyMode()
 
 AActor* APC_Desktop::PerformInteractionRaycast(float MaxDistance)
 {
+	HOMESTEAD_SCOPE(InteractionRaycast);
+
 	if (!PlayerCameraManager)
 	{
 		return nullptr;
@@ -1,6 +1,7 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "PC_VR.h"
+#include "../HomesteadTwin.h"
 #include "DrawDebugHelpers.h"
 #include "Components/InputComponent.h"
 
@@ -47,6 +48,8 @@ void APC_VR::ToggleLocomotionMode()
 
 AActor* APC_VR::PerformLaserPointerRaycast(bool bUseRightHand, float MaxDistance)
 {
+	HOMESTEAD_SCOPE(LaserPointerRaycast);
+
 	// TODO: Get motion controller position and perform raycast from it
 	// For now, return nullptr
 	return nullptr;
@@ -24,7 +24,9 @@ public class HomesteadTwin : ModuleRules
 		{
 			"Json",
 			"JsonUtilities",
-			"HTTP"
+			"HTTP",
+			"Sockets",
+			"Networking"
 		});
 
 		// Uncomment if you are using online features
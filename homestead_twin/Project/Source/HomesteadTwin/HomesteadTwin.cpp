@@ -5,6 +5,10 @@
 
 #define LOCTEXT_NAMESPACE "FHomesteadTwinModule"
 
+DEFINE_LOG_CATEGORY(LogHomesteadTwin);
+CSV_DEFINE_CATEGORY_MODULE(HOMESTEADTWIN_API, HomesteadTwin, true);
+UE_TRACE_CHANNEL_DEFINE(HomesteadTwinChannel);
+
 void FHomesteadTwinModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uproject file
@@ -4,6 +4,62 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogHomesteadTwin, Log, All);
+
+/**
+ * Profiling
+ *
+ * HomesteadTwin timers and counters appear in three places:
+ * - "stat HomesteadTwin" (stat group STATGROUP_HomesteadTwin)
+ * - CSV profiles ("csvprofile start"), category HomesteadTwin
+ * - Unreal Insights, on the HomesteadTwin trace channel (-trace=default,HomesteadTwin)
+ *
+ * Wrap hot paths in HOMESTEAD_SCOPE(Name). Declare counters once per .cpp with
+ * HOMESTEAD_DECLARE_COUNTER / HOMESTEAD_DECLARE_MEMORY_COUNTER and publish them with
+ * HOMESTEAD_SET_COUNTER / HOMESTEAD_SET_MEMORY_COUNTER when they change.
+ */
+DECLARE_STATS_GROUP(TEXT("HomesteadTwin"), STATGROUP_HomesteadTwin, STATCAT_Advanced);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(HOMESTEADTWIN_API, HomesteadTwin);
+UE_TRACE_CHANNEL_EXTERN(HomesteadTwinChannel, HOMESTEADTWIN_API);
+
+/** Time the enclosing scope as stat, CSV timing and trace event "HomesteadTwin::<Name>" */
+#define HOMESTEAD_SCOPE(Name) \
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT(#Name), STAT_HomesteadTwin_##Name, STATGROUP_HomesteadTwin); \
+	CSV_SCOPED_TIMING_STAT(HomesteadTwin, Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("HomesteadTwin::" #Name, HomesteadTwinChannel)
+
+/** Declare an entity count (file scope) */
+#define HOMESTEAD_DECLARE_COUNTER(Name) \
+	DECLARE_DWORD_ACCUMULATOR_STAT(TEXT(#Name), STAT_HomesteadTwin_##Name, STATGROUP_HomesteadTwin); \
+	TRACE_DECLARE_INT_COUNTER(HomesteadTwin_##Name, TEXT("HomesteadTwin/" #Name))
+
+/** Declare a memory counter in bytes (file scope) */
+#define HOMESTEAD_DECLARE_MEMORY_COUNTER(Name) \
+	DECLARE_MEMORY_STAT(TEXT(#Name), STAT_HomesteadTwin_##Name, STATGROUP_HomesteadTwin); \
+	TRACE_DECLARE_MEMORY_COUNTER(HomesteadTwin_##Name, TEXT("HomesteadTwin/" #Name))
+
+/** Publish an entity count */
+#define HOMESTEAD_SET_COUNTER(Name, Value) \
+	do \
+	{ \
+		SET_DWORD_STAT(STAT_HomesteadTwin_##Name, (Value)); \
+		CSV_CUSTOM_STAT(HomesteadTwin, Name, int32(Value), ECsvCustomStatOp::Set); \
+		TRACE_COUNTER_SET(HomesteadTwin_##Name, int64(Value)); \
+	} while (0)
+
+/** Publish a memory counter in bytes (the CSV column is in MB) */
+#define HOMESTEAD_SET_MEMORY_COUNTER(Name, Bytes) \
+	do \
+	{ \
+		SET_MEMORY_STAT(STAT_HomesteadTwin_##Name, (Bytes)); \
+		CSV_CUSTOM_STAT(HomesteadTwin, Name, float(double(Bytes) / (1024.0 * 1024.0)), ECsvCustomStatOp::Set); \
+		TRACE_COUNTER_SET(HomesteadTwin_##Name, int64(Bytes)); \
+	} while (0)
 
 /**
  * FHomesteadTwinModule
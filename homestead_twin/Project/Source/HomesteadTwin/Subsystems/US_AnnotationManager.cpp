@@ -1,26 +1,125 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "US_AnnotationManager.h"
+#include "../Annotations/AnnotationBinaryFile.h"
+#include "../Annotations/AnnotationJson.h"
+#include "../HomesteadTwin.h"
+#include "ConvexVolume.h"
+#include "HAL/FileManager.h"
 #include "Misc/Paths.h"
 #include "HAL/PlatformFileManager.h"
 
+HOMESTEAD_DECLARE_COUNTER(Annotations);
+HOMESTEAD_DECLARE_MEMORY_COUNTER(AnnotationMemory);
+
+namespace AnnotationPersistence
+{
+	/** Binary snapshot of a generation: <save file base name>_<generation>.bin next to the JSON file */
+	FString GetSnapshotPath(const FString& SaveFilePath, int32 Generation)
+	{
+		return FPaths::GetPath(SaveFilePath) / FString::Printf(TEXT("%s_%08d.bin"), *FPaths::GetBaseFilename(SaveFilePath), Generation);
+	}
+
+	/** Snapshot generations on disk, ascending */
+	TArray<int32> FindSnapshotGenerations(const FString& SaveFilePath)
+	{
+		const FString Prefix = FPaths::GetBaseFilename(SaveFilePath) + TEXT("_");
+
+		TArray<FString> Files;
+		IFileManager::Get().FindFiles(Files, *(FPaths::GetPath(SaveFilePath) / Prefix + TEXT("*.bin")), true, false);
+
+		TArray<int32> Generations;
+		for (const FString& File : Files)
+		{
+			int32 Generation = INDEX_NONE;
+			if (LexTryParseString(Generation, *FPaths::GetBaseFilename(File).RightChop(Prefix.Len())) && Generation >= 0)
+			{
+				Generations.Add(Generation);
+			}
+		}
+
+		Generations.Sort();
+		return Generations;
+	}
+
+	/** Delete snapshot generations older than Generation, except the file at KeepPath (still mapped) */
+	void DeleteSnapshotsBefore(const FString& SaveFilePath, int32 Generation, const FString& KeepPath)
+	{
+		for (const int32 Older : FindSnapshotGenerations(SaveFilePath))
+		{
+			const FString Path = GetSnapshotPath(SaveFilePath, Older);
+			if (Older < Generation && Path != KeepPath)
+			{
+				IFileManager::Get().Delete(*Path, false, false, true);
+			}
+		}
+	}
+
+	/** Every annotation: the resident ones plus the stored records not removed (runs on the persistence pipe) */
+	TArray<FAnnotation> CollectAnnotations(TArray<FAnnotation>&& Resident, const FAnnotationBinaryFile* Stored, const TBitArray<>& StoredRemoved)
+	{
+		TArray<FAnnotation> Annotations = MoveTemp(Resident);
+		if (Stored)
+		{
+			Annotations.Reserve(Annotations.Num() + Stored->Num());
+			for (int32 RecordIndex = 0; RecordIndex < Stored->Num(); ++RecordIndex)
+			{
+				if (!StoredRemoved[RecordIndex])
+				{
+					Stored->Decode(RecordIndex, Annotations.Emplace_GetRef(ForceInit));
+				}
+			}
+		}
+		return Annotations;
+	}
+}
+
+using namespace AnnotationPersistence;
+
 UUS_AnnotationManager::UUS_AnnotationManager()
 {
 	SaveFilePath = FPaths::ProjectSavedDir() / TEXT("Annotations/annotations.json");
+	SpatialCellSize = 1000.0f; // 10 m, the default query radius
+	CompactJournalBytes = 4 * 1024 * 1024;
+	NumStoredRemoved = 0;
+	SnapshotGeneration = INDEX_NONE;
+	JournalBytes = 0;
+	bPersistenceReadOnly = false;
 }
 
 void UUS_AnnotationManager::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
+	PersistencePipe = MakeUnique<UE::Tasks::FPipe>(TEXT("AnnotationPersistence"));
+	Journal = MakeUnique<FAnnotationJournal>(FPaths::ChangeExtension(SaveFilePath, TEXT("journal")));
+
 	// Load annotations from file if exists
 	LoadAnnotations();
+
+	JournalTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UUS_AnnotationManager::TickJournal));
 }
 
 void UUS_AnnotationManager::Deinitialize()
 {
-	// Save annotations before shutdown
-	SaveAnnotations();
+	FTSTicker::GetCoreTicker().RemoveTicker(JournalTickerHandle);
+	JournalTickerHandle.Reset();
+
+	// Fold the journal into a snapshot so the next start reads one file; the process may exit
+	// right after, so wait for the writes
+	FlushJournal();
+	if (JournalBytes > 0)
+	{
+		SaveAnnotations();
+	}
+	WaitForPendingSaves();
+	Journal.Reset();
+	PersistencePipe.Reset();
+
+	DecodedStoredAnnotations.Reset();
+	PreviousDecodedStoredAnnotations.Reset();
+	StoredAnnotations.Reset();
 
 	Super::Deinitialize();
 }
@@ -36,6 +135,11 @@ FGuid UUS_AnnotationManager::CreateAnnotation(FVector WorldPosition, const FStri
 	NewAnnotation.ModifiedTimestamp = FDateTime::Now();
 
 	AnnotationDatabase.Add(NewAnnotation.AnnotationId, NewAnnotation);
+	SpatialIndex.Add(NewAnnotation.AnnotationId, NewAnnotation.WorldPosition);
+	CategoryIndex.Add(NewAnnotation.Category, NewAnnotation.AnnotationId);
+	PhaseIndex.Add(NewAnnotation.AssociatedPhase, NewAnnotation.AnnotationId);
+	UpdateAnnotationCounters();
+	FAnnotationJournal::EncodeUpsert(FAnnotationJournal::EOp::Create, NewAnnotation, PendingJournalRecords);
 
 	OnAnnotationCreated(NewAnnotation);
 
@@ -44,7 +148,7 @@ FGuid UUS_AnnotationManager::CreateAnnotation(FVector WorldPosition, const FStri
 
 bool UUS_AnnotationManager::UpdateAnnotation(FGuid AnnotationId, const FString& NewText, FName NewCategory)
 {
-	FAnnotation* Annotation = AnnotationDatabase.Find(AnnotationId);
+	FAnnotation* Annotation = FindMutableAnnotation(AnnotationId);
 	if (!Annotation)
 	{
 		return false;
@@ -53,9 +157,47 @@ bool UUS_AnnotationManager::UpdateAnnotation(FGuid AnnotationId, const FString&
 	Annotation->Text = NewText;
 	if (NewCategory != NAME_None)
 	{
+		CategoryIndex.Move(Annotation->Category, NewCategory, AnnotationId);
 		Annotation->Category = NewCategory;
 	}
 	Annotation->ModifiedTimestamp = FDateTime::Now();
+	FAnnotationJournal::EncodeUpsert(FAnnotationJournal::EOp::Update, *Annotation, PendingJournalRecords);
+
+	OnAnnotationUpdated(*Annotation);
+
+	return true;
+}
+
+bool UUS_AnnotationManager::SetAnnotationPosition(FGuid AnnotationId, FVector NewWorldPosition)
+{
+	FAnnotation* Annotation = FindMutableAnnotation(AnnotationId);
+	if (!Annotation)
+	{
+		return false;
+	}
+
+	Annotation->WorldPosition = NewWorldPosition;
+	Annotation->ModifiedTimestamp = FDateTime::Now();
+	SpatialIndex.Add(AnnotationId, NewWorldPosition);
+	FAnnotationJournal::EncodeUpsert(FAnnotationJournal::EOp::Update, *Annotation, PendingJournalRecords);
+
+	OnAnnotationUpdated(*Annotation);
+
+	return true;
+}
+
+bool UUS_AnnotationManager::SetAnnotationPhase(FGuid AnnotationId, int32 NewPhase)
+{
+	FAnnotation* Annotation = FindMutableAnnotation(AnnotationId);
+	if (!Annotation)
+	{
+		return false;
+	}
+
+	PhaseIndex.Move(Annotation->AssociatedPhase, NewPhase, AnnotationId);
+	Annotation->AssociatedPhase = NewPhase;
+	Annotation->ModifiedTimestamp = FDateTime::Now();
+	FAnnotationJournal::EncodeUpsert(FAnnotationJournal::EOp::Update, *Annotation, PendingJournalRecords);
 
 	OnAnnotationUpdated(*Annotation);
 
@@ -64,78 +206,741 @@ bool UUS_AnnotationManager::UpdateAnnotation(FGuid AnnotationId, const FString&
 
 bool UUS_AnnotationManager::DeleteAnnotation(FGuid AnnotationId)
 {
-	if (AnnotationDatabase.Remove(AnnotationId) > 0)
+	// A stored annotation moves to AnnotationDatabase (marking its record removed) first
+	FAnnotation Removed;
+	if (!FindMutableAnnotation(AnnotationId) || !AnnotationDatabase.RemoveAndCopyValue(AnnotationId, Removed))
 	{
-		OnAnnotationDeleted(AnnotationId);
-		return true;
+		return false;
 	}
-	return false;
+
+	SpatialIndex.Remove(AnnotationId);
+	CategoryIndex.Remove(Removed.Category, AnnotationId);
+	PhaseIndex.Remove(Removed.AssociatedPhase, AnnotationId);
+	UpdateAnnotationCounters();
+	FAnnotationJournal::EncodeDelete(AnnotationId, PendingJournalRecords);
+	OnAnnotationDeleted(AnnotationId);
+	return true;
 }
 
 FAnnotation UUS_AnnotationManager::GetAnnotation(FGuid AnnotationId) const
 {
-	const FAnnotation* Annotation = AnnotationDatabase.Find(AnnotationId);
+	const FAnnotation* Annotation = FindAnnotation(AnnotationId);
 	return Annotation ? *Annotation : FAnnotation();
 }
 
 TArray<FAnnotation> UUS_AnnotationManager::GetAllAnnotations() const
 {
 	TArray<FAnnotation> Annotations;
-	AnnotationDatabase.GenerateValueArray(Annotations);
+	Annotations.Reserve(GetNumAnnotations());
+	ForEachAnnotation([&Annotations](const FAnnotation& Annotation) { Annotations.Add(Annotation); });
 	return Annotations;
 }
 
 TArray<FAnnotation> UUS_AnnotationManager::GetAnnotationsByCategory(FName Category) const
 {
-	TArray<FAnnotation> FilteredAnnotations;
+	TArray<FAnnotation> Annotations;
+	Annotations.Reserve(CategoryIndex.Num(Category));
+	ForEachAnnotationInCategory(Category, [&Annotations](const FAnnotation& Annotation) { Annotations.Add(Annotation); });
+	return Annotations;
+}
+
+TArray<FAnnotation> UUS_AnnotationManager::GetAnnotationsByPhase(int32 Phase) const
+{
+	TArray<FAnnotation> Annotations;
+	Annotations.Reserve(PhaseIndex.Num(Phase));
+	ForEachAnnotationInPhase(Phase, [&Annotations](const FAnnotation& Annotation) { Annotations.Add(Annotation); });
+	return Annotations;
+}
+
+TArray<FAnnotation> UUS_AnnotationManager::GetAnnotationsNearPosition(FVector WorldPosition, float Radius) const
+{
+	TArray<FAnnotation> Annotations;
+	ForEachAnnotationNear(WorldPosition, Radius, [&Annotations](const FAnnotation& Annotation) { Annotations.Add(Annotation); });
+	return Annotations;
+}
+
+TArray<FAnnotation> UUS_AnnotationManager::GetNearestAnnotations(FVector WorldPosition, int32 Count, float MaxDistance) const
+{
+	TArray<FGuid> AnnotationIds;
+	FindNearestAnnotations(WorldPosition, Count, MaxDistance, AnnotationIds);
+
+	TArray<FAnnotation> Annotations;
+	Annotations.Reserve(AnnotationIds.Num());
+	FAnnotation Scratch(ForceInit);
+	for (const FGuid& AnnotationId : AnnotationIds)
+	{
+		Annotations.Add(ResolveAnnotation(AnnotationId, Scratch));
+	}
+	return Annotations;
+}
+
+TArray<FAnnotation> UUS_AnnotationManager::GetAnnotationsInBox(FBox Box) const
+{
+	TArray<FAnnotation> Annotations;
+	ForEachAnnotationInBox(Box, [&Annotations](const FAnnotation& Annotation) { Annotations.Add(Annotation); });
+	return Annotations;
+}
+
+TArray<FAnnotation> UUS_AnnotationManager::QueryAnnotations(const FAnnotationQuery& Query) const
+{
+	TArray<FAnnotation> Annotations;
+	ForEachAnnotationMatching(Query, [&Annotations](const FAnnotation& Annotation) { Annotations.Add(Annotation); });
+	return Annotations;
+}
+
+TArray<FAnnotation> UUS_AnnotationManager::GetAnnotationsInView(FVector ViewLocation, FRotator ViewRotation, float FieldOfView, float AspectRatio, float MaxDistance) const
+{
+	TArray<FAnnotation> Annotations;
+	ForEachAnnotationInView(ViewLocation, ViewRotation, FieldOfView, AspectRatio, MaxDistance, [&Annotations](const FAnnotation& Annotation) { Annotations.Add(Annotation); });
+	return Annotations;
+}
+
+const FAnnotation* UUS_AnnotationManager::FindAnnotation(const FGuid& AnnotationId) const
+{
+	if (const FAnnotation* Annotation = AnnotationDatabase.Find(AnnotationId))
+	{
+		return Annotation;
+	}
+
+	const int32 RecordIndex = FindStoredRecord(AnnotationId);
+	if (RecordIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	if (const TUniquePtr<FAnnotation>* Decoded = DecodedStoredAnnotations.Find(RecordIndex))
+	{
+		return Decoded->Get();
+	}
+
+	if (DecodedStoredAnnotations.Num() >= MaxDecodedStoredAnnotations)
+	{
+		PreviousDecodedStoredAnnotations = MoveTemp(DecodedStoredAnnotations);
+		DecodedStoredAnnotations.Reset();
+	}
+
+	TUniquePtr<FAnnotation> Decoded;
+	if (!PreviousDecodedStoredAnnotations.RemoveAndCopyValue(RecordIndex, Decoded))
+	{
+		Decoded = MakeUnique<FAnnotation>(ForceInit);
+		StoredAnnotations->Decode(RecordIndex, *Decoded);
+	}
+	return DecodedStoredAnnotations.Add(RecordIndex, MoveTemp(Decoded)).Get();
+}
+
+int32 UUS_AnnotationManager::GetNumAnnotations() const
+{
+	return AnnotationDatabase.Num() + (StoredAnnotations ? StoredAnnotations->Num() - NumStoredRemoved : 0);
+}
+
+void UUS_AnnotationManager::ForEachAnnotation(TFunctionRef<void(const FAnnotation&)> Visitor) const
+{
+	HOMESTEAD_SCOPE(AnnotationQueryAll);
+
 	for (const auto& Pair : AnnotationDatabase)
 	{
-		if (Pair.Value.Category == Category)
+		Visitor(Pair.Value);
+	}
+
+	if (StoredAnnotations)
+	{
+		FAnnotation Scratch(ForceInit);
+		for (int32 RecordIndex = 0; RecordIndex < StoredAnnotations->Num(); ++RecordIndex)
 		{
-			FilteredAnnotations.Add(Pair.Value);
+			if (!StoredRemoved[RecordIndex])
+			{
+				StoredAnnotations->Decode(RecordIndex, Scratch);
+				Visitor(Scratch);
+			}
 		}
 	}
-	return FilteredAnnotations;
 }
 
-TArray<FAnnotation> UUS_AnnotationManager::GetAnnotationsByPhase(int32 Phase) const
+void UUS_AnnotationManager::ForEachAnnotationInCategory(FName Category, TFunctionRef<void(const FAnnotation&)> Visitor) const
 {
-	TArray<FAnnotation> FilteredAnnotations;
-	for (const auto& Pair : AnnotationDatabase)
+	HOMESTEAD_SCOPE(AnnotationQueryCategory);
+
+	if (const TSet<FGuid>* AnnotationIds = CategoryIndex.Find(Category))
 	{
-		if (Pair.Value.AssociatedPhase == Phase)
+		FAnnotation Scratch(ForceInit);
+		for (const FGuid& AnnotationId : *AnnotationIds)
 		{
-			FilteredAnnotations.Add(Pair.Value);
+			Visitor(ResolveAnnotation(AnnotationId, Scratch));
 		}
 	}
-	return FilteredAnnotations;
 }
 
-TArray<FAnnotation> UUS_AnnotationManager::GetAnnotationsNearPosition(FVector WorldPosition, float Radius) const
+void UUS_AnnotationManager::ForEachAnnotationInPhase(int32 Phase, TFunctionRef<void(const FAnnotation&)> Visitor) const
 {
-	TArray<FAnnotation> NearbyAnnotations;
-	float RadiusSquared = Radius * Radius;
+	HOMESTEAD_SCOPE(AnnotationQueryPhase);
 
-	for (const auto& Pair : AnnotationDatabase)
+	if (const TSet<FGuid>* AnnotationIds = PhaseIndex.Find(Phase))
+	{
+		FAnnotation Scratch(ForceInit);
+		for (const FGuid& AnnotationId : *AnnotationIds)
+		{
+			Visitor(ResolveAnnotation(AnnotationId, Scratch));
+		}
+	}
+}
+
+void UUS_AnnotationManager::ForEachAnnotationNear(const FVector& WorldPosition, float Radius, TFunctionRef<void(const FAnnotation&)> Visitor) const
+{
+	HOMESTEAD_SCOPE(AnnotationQueryRadius);
+
+	FAnnotation Scratch(ForceInit);
+	SpatialIndex.ForEachInRadius(WorldPosition, Radius, [this, &Visitor, &Scratch](const FGuid& AnnotationId, const FVector& Position)
+	{
+		Visitor(ResolveAnnotation(AnnotationId, Scratch));
+	});
+}
+
+void UUS_AnnotationManager::ForEachAnnotationInBox(const FBox& Box, TFunctionRef<void(const FAnnotation&)> Visitor) const
+{
+	HOMESTEAD_SCOPE(AnnotationQueryBox);
+
+	FAnnotation Scratch(ForceInit);
+	SpatialIndex.ForEachInBox(Box, [this, &Visitor, &Scratch](const FGuid& AnnotationId, const FVector& Position)
+	{
+		Visitor(ResolveAnnotation(AnnotationId, Scratch));
+	});
+}
+
+void UUS_AnnotationManager::ForEachAnnotationInView(const FVector& ViewLocation, const FRotator& ViewRotation, float FieldOfView, float AspectRatio, float MaxDistance, TFunctionRef<void(const FAnnotation&)> Visitor) const
+{
+	HOMESTEAD_SCOPE(AnnotationQueryView);
+
+	const FRotationMatrix Axes(ViewRotation);
+	const FVector Forward = Axes.GetScaledAxis(EAxis::X);
+	const FVector Right = Axes.GetScaledAxis(EAxis::Y);
+	const FVector Up = Axes.GetScaledAxis(EAxis::Z);
+	const double TanX = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(FieldOfView, 1.0f, 179.0f) * 0.5));
+	const double TanY = TanX / FMath::Max(AspectRatio, UE_KINDA_SMALL_NUMBER);
+
+	// Side planes through the eye plus a far plane; normals point out of the volume
+	TArray<FPlane, TInlineAllocator<6>> Planes;
+	Planes.Add(FPlane(ViewLocation, (Right - Forward * TanX).GetSafeNormal()));
+	Planes.Add(FPlane(ViewLocation, (-Right - Forward * TanX).GetSafeNormal()));
+	Planes.Add(FPlane(ViewLocation, (Up - Forward * TanY).GetSafeNormal()));
+	Planes.Add(FPlane(ViewLocation, (-Up - Forward * TanY).GetSafeNormal()));
+	Planes.Add(FPlane(ViewLocation + Forward * MaxDistance, Forward));
+	const FConvexVolume Frustum(Planes);
+
+	// Only cells around the truncated pyramid are searched
+	FBox Bounds(ViewLocation, ViewLocation);
+	for (const double SignX : { -1.0, 1.0 })
 	{
-		float DistanceSquared = FVector::DistSquared(WorldPosition, Pair.Value.WorldPosition);
-		if (DistanceSquared <= RadiusSquared)
+		for (const double SignY : { -1.0, 1.0 })
 		{
-			NearbyAnnotations.Add(Pair.Value);
+			Bounds += ViewLocation + (Forward + Right * (SignX * TanX) + Up * (SignY * TanY)) * MaxDistance;
 		}
 	}
 
-	return NearbyAnnotations;
+	FAnnotation Scratch(ForceInit);
+	SpatialIndex.ForEachInFrustum(Frustum, Bounds, [this, &Visitor, &Scratch](const FGuid& AnnotationId, const FVector& Position)
+	{
+		Visitor(ResolveAnnotation(AnnotationId, Scratch));
+	});
+}
+
+void UUS_AnnotationManager::FindNearestAnnotations(const FVector& WorldPosition, int32 Count, float MaxDistance, TArray<FGuid>& OutAnnotationIds) const
+{
+	HOMESTEAD_SCOPE(AnnotationQueryNearest);
+
+	SpatialIndex.FindNearest(WorldPosition, Count, MaxDistance, OutAnnotationIds);
 }
 
 bool UUS_AnnotationManager::SaveAnnotations()
 {
-	// TODO: Implement JSON serialization
+	if (!PersistencePipe)
+	{
+		return false;
+	}
+
+	if (bPersistenceReadOnly)
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: not saving, no snapshot could be opened (persistence is read-only)"));
+		return false;
+	}
+
+	HOMESTEAD_SCOPE(AnnotationSaveSnapshot);
+
+	// Everything goes to the journal first, so a failed snapshot loses nothing
+	FlushJournal();
+
+	// Only resident annotations are copied here; the pipe decodes the rest from the mapped snapshot
+	TArray<FAnnotation> Resident;
+	AnnotationDatabase.GenerateValueArray(Resident);
+	JournalBytes = 0;
+	++SnapshotGeneration;
+
+	// Appends queued after this run after it on the pipe, so they land in the next journal
+	PersistencePipe->Launch(TEXT("SaveAnnotations"),
+		[Resident = MoveTemp(Resident), Stored = StoredAnnotations, Removed = StoredRemoved, BasePath = SaveFilePath, Generation = SnapshotGeneration, JournalFile = Journal.Get()]() mutable
+	{
+		HOMESTEAD_SCOPE(AnnotationSave);
+
+		const TArray<FAnnotation> Snapshot = CollectAnnotations(MoveTemp(Resident), Stored.Get(), Removed);
+		const FString Path = GetSnapshotPath(BasePath, Generation);
+
+		FString Error;
+		// Write returns once the snapshot is on disk, so its only backups can go
+		if (FAnnotationBinaryFile::Write(Snapshot, Path, Error))
+		{
+			JournalFile->Delete();
+
+			// The mapped generation stays until the next load unmaps it
+			DeleteSnapshotsBefore(BasePath, Generation, Stored ? Stored->GetPath() : FString());
+			UE_LOG(LogHomesteadTwin, Verbose, TEXT("Annotations: saved %d to %s"), Snapshot.Num(), *Path);
+		}
+		else
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: save failed (journal kept): %s"), *Error);
+		}
+	}, UE::Tasks::ETaskPriority::BackgroundNormal);
+
 	return true;
 }
 
 bool UUS_AnnotationManager::LoadAnnotations()
 {
-	// TODO: Implement JSON deserialization
+	if (!Journal)
+	{
+		return false;
+	}
+
+	HOMESTEAD_SCOPE(AnnotationLoad);
+
+	// Changes not yet written reach the journal first, so the reload includes them
+	FlushJournal();
+	WaitForPendingSaves();
+	Journal->Close();
+
+	// Map the newest snapshot that opens; an unreadable one is skipped (and deleted by the next save)
+	const TArray<int32> Generations = FindSnapshotGenerations(SaveFilePath);
+	TSharedPtr<const FAnnotationBinaryFile> Stored;
+	int32 StoredGeneration = INDEX_NONE;
+	for (int32 Position = Generations.Num() - 1; Position >= 0 && !Stored; --Position)
+	{
+		FString Error;
+		Stored = FAnnotationBinaryFile::Open(GetSnapshotPath(SaveFilePath, Generations[Position]), Error);
+		if (Stored)
+		{
+			StoredGeneration = Generations[Position];
+		}
+		else
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: skipping snapshot: %s"), *Error);
+		}
+	}
+
+	// Snapshots exist but none opened: a new snapshot would delete them, so write nothing this session
+	bPersistenceReadOnly = Generations.Num() > 0 && !Stored;
+	if (bPersistenceReadOnly)
+	{
+		UE_LOG(LogHomesteadTwin, Error, TEXT("Annotations: none of %d snapshot(s) could be opened; loading the journal alone and keeping persistence read-only"), Generations.Num());
+	}
+
+	// No binary snapshot yet: migrate a JSON save
+	TArray<FAnnotation> Loaded;
+	if (Generations.Num() == 0)
+	{
+		FString Error;
+		if (!FAnnotationJson::LoadFile(SaveFilePath, Loaded, Error) && !Error.IsEmpty())
+		{
+			// Leave the journal alone: replaying it without its snapshot would lose data
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: load failed: %s"), *Error);
+			return false;
+		}
+	}
+
+	DecodedStoredAnnotations.Reset();
+	PreviousDecodedStoredAnnotations.Reset();
+	StoredAnnotations = Stored;
+	StoredRemoved.Init(false, Stored ? Stored->Num() : 0);
+	NumStoredRemoved = 0;
+	SnapshotGeneration = Generations.Num() > 0 ? Generations.Last() : INDEX_NONE;
+
+	// Older generations are no longer mapped
+	if (!bPersistenceReadOnly)
+	{
+		DeleteSnapshotsBefore(SaveFilePath, StoredGeneration, FString());
+	}
+
+	AnnotationDatabase.Reset();
+	AnnotationDatabase.Reserve(Loaded.Num());
+	for (FAnnotation& Annotation : Loaded)
+	{
+		const FGuid AnnotationId = Annotation.AnnotationId;
+		AnnotationDatabase.Add(AnnotationId, MoveTemp(Annotation));
+	}
+
+	bool bTorn = false;
+	const int32 Replayed = Journal->Replay(
+		[this](FAnnotation&& Annotation) { PutResidentAnnotation(MoveTemp(Annotation)); },
+		[this](const FGuid& AnnotationId)
+		{
+			AnnotationDatabase.Remove(AnnotationId);
+			const int32 RecordIndex = FindStoredRecord(AnnotationId);
+			if (RecordIndex != INDEX_NONE)
+			{
+				RemoveStoredRecord(RecordIndex);
+			}
+		},
+		bTorn);
+	if (bTorn)
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: journal ends in a torn or corrupt record; replayed %d records before it"), Replayed);
+	}
+
+	RebuildIndexes();
+
+	UE_LOG(LogHomesteadTwin, Log, TEXT("Annotations: loaded %d (%d mapped from %s, %d journal records)"),
+		GetNumAnnotations(), Stored ? Stored->Num() : 0, Stored ? *Stored->GetPath() : *SaveFilePath, Replayed);
+
+	// Fold a leftover journal or a migrated JSON save into a fresh snapshot (the journal itself cuts a torn tail before its next append)
+	JournalBytes = 0;
+	if (!bPersistenceReadOnly && (Replayed > 0 || bTorn || Loaded.Num() > 0))
+	{
+		SaveAnnotations();
+	}
+
+	return true;
+}
+
+bool UUS_AnnotationManager::ExportAnnotationsJson(const FString& Path)
+{
+	if (!PersistencePipe)
+	{
+		return false;
+	}
+
+	TArray<FAnnotation> Resident;
+	AnnotationDatabase.GenerateValueArray(Resident);
+
+	PersistencePipe->Launch(TEXT("ExportAnnotations"),
+		[Resident = MoveTemp(Resident), Stored = StoredAnnotations, Removed = StoredRemoved, ExportPath = Path.IsEmpty() ? SaveFilePath : Path]() mutable
+	{
+		const TArray<FAnnotation> Annotations = CollectAnnotations(MoveTemp(Resident), Stored.Get(), Removed);
+
+		FString Error;
+		if (!FAnnotationJson::SaveFile(Annotations, ExportPath, Error))
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: export failed: %s"), *Error);
+		}
+	}, UE::Tasks::ETaskPriority::BackgroundNormal);
+
+	return true;
+}
+
+bool UUS_AnnotationManager::ImportAnnotationsJson(const FString& Path)
+{
+	const FString ImportPath = Path.IsEmpty() ? SaveFilePath : Path;
+
+	TArray<FAnnotation> Imported;
+	FString Error;
+	if (!FAnnotationJson::LoadFile(ImportPath, Imported, Error))
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: import failed: %s"), Error.IsEmpty() ? *FString::Printf(TEXT("%s not found"), *ImportPath) : *Error);
+		return false;
+	}
+
+	for (FAnnotation& Annotation : Imported)
+	{
+		const FGuid AnnotationId = Annotation.AnnotationId;
+		const bool bExisted = PutResidentAnnotation(MoveTemp(Annotation));
+		FAnnotationJournal::EncodeUpsert(bExisted ? FAnnotationJournal::EOp::Update : FAnnotationJournal::EOp::Create, AnnotationDatabase.FindChecked(AnnotationId), PendingJournalRecords);
+	}
+	RebuildIndexes();
+
+	UE_LOG(LogHomesteadTwin, Log, TEXT("Annotations: imported %d from %s"), Imported.Num(), *ImportPath);
 	return true;
 }
+
+void UUS_AnnotationManager::WaitForPendingSaves()
+{
+	if (PersistencePipe)
+	{
+		PersistencePipe->WaitUntilEmpty();
+	}
+}
+
+void UUS_AnnotationManager::FlushJournal()
+{
+	if (PendingJournalRecords.Num() == 0 || !PersistencePipe)
+	{
+		return;
+	}
+
+	// Read-only: edits stay in memory only (logged once by LoadAnnotations)
+	if (bPersistenceReadOnly)
+	{
+		PendingJournalRecords.Reset();
+		return;
+	}
+
+	JournalBytes += PendingJournalRecords.Num();
+
+	PersistencePipe->Launch(TEXT("AppendAnnotationJournal"), [Records = MoveTemp(PendingJournalRecords), JournalFile = Journal.Get()]()
+	{
+		HOMESTEAD_SCOPE(AnnotationJournalAppend);
+
+		if (!JournalFile->Append(Records))
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Annotations: append to %s failed"), *JournalFile->GetPath());
+		}
+	}, UE::Tasks::ETaskPriority::BackgroundNormal);
+
+	PendingJournalRecords.Reset();
+}
+
+bool UUS_AnnotationManager::TickJournal(float DeltaTime)
+{
+	FlushJournal();
+
+	if (CompactJournalBytes > 0 && JournalBytes >= CompactJournalBytes)
+	{
+		SaveAnnotations();
+	}
+	return true;
+}
+
+int32 UUS_AnnotationManager::FindStoredRecord(const FGuid& AnnotationId) const
+{
+	if (!StoredAnnotations)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 RecordIndex = StoredAnnotations->FindRecord(AnnotationId);
+	return RecordIndex != INDEX_NONE && !StoredRemoved[RecordIndex] ? RecordIndex : INDEX_NONE;
+}
+
+void UUS_AnnotationManager::RemoveStoredRecord(int32 RecordIndex)
+{
+	if (!StoredRemoved[RecordIndex])
+	{
+		StoredRemoved[RecordIndex] = true;
+		++NumStoredRemoved;
+		DecodedStoredAnnotations.Remove(RecordIndex);
+		PreviousDecodedStoredAnnotations.Remove(RecordIndex);
+	}
+}
+
+const FAnnotation& UUS_AnnotationManager::ResolveAnnotation(const FGuid& AnnotationId, FAnnotation& Scratch) const
+{
+	if (const FAnnotation* Annotation = AnnotationDatabase.Find(AnnotationId))
+	{
+		return *Annotation;
+	}
+
+	// Indexed ids that are not resident always have a live stored record
+	StoredAnnotations->Decode(FindStoredRecord(AnnotationId), Scratch);
+	return Scratch;
+}
+
+FVector UUS_AnnotationManager::GetAnnotationPosition(const FGuid& AnnotationId) const
+{
+	if (const FAnnotation* Annotation = AnnotationDatabase.Find(AnnotationId))
+	{
+		return Annotation->WorldPosition;
+	}
+	return StoredAnnotations->GetPosition(FindStoredRecord(AnnotationId));
+}
+
+FAnnotation* UUS_AnnotationManager::FindMutableAnnotation(const FGuid& AnnotationId)
+{
+	if (FAnnotation* Annotation = AnnotationDatabase.Find(AnnotationId))
+	{
+		return Annotation;
+	}
+
+	const int32 RecordIndex = FindStoredRecord(AnnotationId);
+	if (RecordIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	FAnnotation& Annotation = AnnotationDatabase.Add(AnnotationId, FAnnotation(ForceInit));
+	StoredAnnotations->Decode(RecordIndex, Annotation);
+	RemoveStoredRecord(RecordIndex);
+	return &Annotation;
+}
+
+bool UUS_AnnotationManager::PutResidentAnnotation(FAnnotation&& Annotation)
+{
+	const FGuid AnnotationId = Annotation.AnnotationId;
+
+	const int32 RecordIndex = FindStoredRecord(AnnotationId);
+	if (RecordIndex != INDEX_NONE)
+	{
+		RemoveStoredRecord(RecordIndex);
+	}
+
+	const bool bExisted = RecordIndex != INDEX_NONE || AnnotationDatabase.Contains(AnnotationId);
+	AnnotationDatabase.Add(AnnotationId, MoveTemp(Annotation));
+	return bExisted;
+}
+
+void UUS_AnnotationManager::UpdateAnnotationCounters() const
+{
+	SIZE_T Bytes = AnnotationDatabase.GetAllocatedSize() + SpatialIndex.GetAllocatedSize() + CategoryIndex.GetAllocatedSize() + PhaseIndex.GetAllocatedSize();
+	for (const auto& Pair : AnnotationDatabase)
+	{
+		Bytes += Pair.Value.Text.GetAllocatedSize();
+	}
+
+	// Mapped records are not counted: they are file-backed pages the OS can drop
+	Bytes += StoredRemoved.GetAllocatedSize() + DecodedStoredAnnotations.GetAllocatedSize() + DecodedStoredAnnotations.Num() * sizeof(FAnnotation);
+	Bytes += PreviousDecodedStoredAnnotations.GetAllocatedSize() + PreviousDecodedStoredAnnotations.Num() * sizeof(FAnnotation);
+
+	HOMESTEAD_SET_COUNTER(Annotations, GetNumAnnotations());
+	HOMESTEAD_SET_MEMORY_COUNTER(AnnotationMemory, Bytes);
+}
+
+void UUS_AnnotationManager::RebuildIndexes()
+{
+	SpatialIndex.Reset(SpatialCellSize);
+	CategoryIndex.Reset();
+	PhaseIndex.Reset();
+	for (const auto& Pair : AnnotationDatabase)
+	{
+		SpatialIndex.Add(Pair.Key, Pair.Value.WorldPosition);
+		CategoryIndex.Add(Pair.Value.Category, Pair.Key);
+		PhaseIndex.Add(Pair.Value.AssociatedPhase, Pair.Key);
+	}
+
+	// Stored records contribute their fixed fields only; text stays on disk
+	if (StoredAnnotations)
+	{
+		for (int32 RecordIndex = 0; RecordIndex < StoredAnnotations->Num(); ++RecordIndex)
+		{
+			if (!StoredRemoved[RecordIndex])
+			{
+				const FGuid& AnnotationId = StoredAnnotations->GetId(RecordIndex);
+				SpatialIndex.Add(AnnotationId, StoredAnnotations->GetPosition(RecordIndex));
+				CategoryIndex.Add(StoredAnnotations->GetCategory(RecordIndex), AnnotationId);
+				PhaseIndex.Add(StoredAnnotations->GetPhase(RecordIndex), AnnotationId);
+			}
+		}
+	}
+	UpdateAnnotationCounters();
+}
+
+void UUS_AnnotationManager::ForEachAnnotationMatching(const FAnnotationQuery& Query, TFunctionRef<void(const FAnnotation&)> Visitor) const
+{
+	HOMESTEAD_SCOPE(AnnotationQueryComposite);
+
+	if (!Query.bMatchCategory && !Query.bMatchPhase && !Query.bWithinRadius)
+	{
+		ForEachAnnotation(Visitor);
+		return;
+	}
+
+	FAnnotation Scratch(ForceInit);
+	ForEachAnnotationIdMatching(Query, [this, &Visitor, &Scratch](const FGuid& AnnotationId, const FVector& Position)
+	{
+		Visitor(ResolveAnnotation(AnnotationId, Scratch));
+	});
+}
+
+void UUS_AnnotationManager::ForEachAnnotationIdMatching(const FAnnotationQuery& Query, TFunctionRef<void(const FGuid&, const FVector&)> Visitor) const
+{
+	const TSet<FGuid>* CategoryIds = nullptr;
+	if (Query.bMatchCategory)
+	{
+		CategoryIds = CategoryIndex.Find(Query.Category);
+		if (!CategoryIds)
+		{
+			return;
+		}
+	}
+
+	const TSet<FGuid>* PhaseIds = nullptr;
+	if (Query.bMatchPhase)
+	{
+		PhaseIds = PhaseIndex.Find(Query.Phase);
+		if (!PhaseIds)
+		{
+			return;
+		}
+	}
+
+	// Drive the query from the smallest candidate set and test the other conditions per id
+	const TSet<FGuid>* Driver = nullptr;
+	if (CategoryIds && (!PhaseIds || CategoryIds->Num() <= PhaseIds->Num()))
+	{
+		Driver = CategoryIds;
+	}
+	else if (PhaseIds)
+	{
+		Driver = PhaseIds;
+	}
+
+	if (Query.bWithinRadius && (!Driver || SpatialIndex.NumCandidatesInRadius(Query.Center, Query.Radius) < Driver->Num()))
+	{
+		SpatialIndex.ForEachInRadius(Query.Center, Query.Radius, [&](const FGuid& AnnotationId, const FVector& Position)
+		{
+			if ((!CategoryIds || CategoryIds->Contains(AnnotationId)) && (!PhaseIds || PhaseIds->Contains(AnnotationId)))
+			{
+				Visitor(AnnotationId, Position);
+			}
+		});
+		return;
+	}
+
+	if (!Driver)
+	{
+		for (const auto& Pair : AnnotationDatabase)
+		{
+			Visitor(Pair.Key, Pair.Value.WorldPosition);
+		}
+		if (StoredAnnotations)
+		{
+			for (int32 RecordIndex = 0; RecordIndex < StoredAnnotations->Num(); ++RecordIndex)
+			{
+				if (!StoredRemoved[RecordIndex])
+				{
+					Visitor(StoredAnnotations->GetId(RecordIndex), StoredAnnotations->GetPosition(RecordIndex));
+				}
+			}
+		}
+		return;
+	}
+
+	const double RadiusSq = FMath::Square(double(Query.Radius));
+	for (const FGuid& AnnotationId : *Driver)
+	{
+		if ((CategoryIds && CategoryIds != Driver && !CategoryIds->Contains(AnnotationId))
+			|| (PhaseIds && PhaseIds != Driver && !PhaseIds->Contains(AnnotationId)))
+		{
+			continue;
+		}
+
+		const FVector Position = GetAnnotationPosition(AnnotationId);
+		if (!Query.bWithinRadius || FVector::DistSquared(Query.Center, Position) <= RadiusSq)
+		{
+			Visitor(AnnotationId, Position);
+		}
+	}
+}
+
+void UUS_AnnotationManager::ForEachAnnotationById(TConstArrayView<FGuid> AnnotationIds, TFunctionRef<void(const FAnnotation&)> Visitor) const
+{
+	FAnnotation Scratch(ForceInit);
+	for (const FGuid& AnnotationId : AnnotationIds)
+	{
+		if (const FAnnotation* Annotation = AnnotationDatabase.Find(AnnotationId))
+		{
+			Visitor(*Annotation);
+			continue;
+		}
+
+		const int32 RecordIndex = FindStoredRecord(AnnotationId);
+		if (RecordIndex != INDEX_NONE)
+		{
+			StoredAnnotations->Decode(RecordIndex, Scratch);
+			Visitor(Scratch);
+		}
+	}
+}
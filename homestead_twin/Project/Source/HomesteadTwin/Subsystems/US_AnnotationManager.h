@@ -3,9 +3,16 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Tasks/Pipe.h"
+#include "../Annotations/AnnotationJournal.h"
+#include "../Annotations/AnnotationKeyIndex.h"
+#include "../Annotations/AnnotationSpatialIndex.h"
 #include "US_AnnotationManager.generated.h"
 
+class FAnnotationBinaryFile;
+
 /**
  * FAnnotation
  *
@@ -58,6 +65,59 @@ struct FAnnotation
 		, AssociatedPhase(-1)
 		, LinkedObjectId(NAME_None)
 	{}
+
+	/** Zeroed id and timestamps (no GUID generation or clock reads), for bulk loading */
+	explicit FAnnotation(EForceInit)
+		: WorldPosition(FVector::ZeroVector)
+		, Category(NAME_None)
+		, AssociatedPhase(-1)
+		, LinkedObjectId(NAME_None)
+	{}
+};
+
+/**
+ * FAnnotationQuery
+ *
+ * Composite annotation filter; every enabled condition must match.
+ */
+USTRUCT(BlueprintType)
+struct FAnnotationQuery
+{
+	GENERATED_BODY()
+
+	/** Match only annotations of Category */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Annotation")
+	bool bMatchCategory;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Annotation", meta = (EditCondition = "bMatchCategory"))
+	FName Category;
+
+	/** Match only annotations associated with Phase */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Annotation")
+	bool bMatchPhase;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Annotation", meta = (EditCondition = "bMatchPhase"))
+	int32 Phase;
+
+	/** Match only annotations within Radius of Center */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Annotation")
+	bool bWithinRadius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Annotation", meta = (EditCondition = "bWithinRadius"))
+	FVector Center;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Annotation", meta = (EditCondition = "bWithinRadius"))
+	float Radius;
+
+	FAnnotationQuery()
+		: bMatchCategory(false)
+		, Category(NAME_None)
+		, bMatchPhase(false)
+		, Phase(-1)
+		, bWithinRadius(false)
+		, Center(FVector::ZeroVector)
+		, Radius(1000.0f)
+	{}
 };
 
 /**
@@ -67,13 +127,33 @@ struct FAnnotation
  *
  * Responsibilities:
  * - Create, read, update, delete annotations
- * - Persist annotations to JSON file
- * - Spawn/despawn annotation actors in world
+ * - Persist annotations (journal plus binary snapshots; JSON for interchange)
+ * - Serve the queries UUS_AnnotationMarkerPool uses to place annotation actors
  * - Query annotations by category, phase, or proximity
  *
  * Implementation Notes:
- * - Annotations saved to local JSON file (in Saved/Annotations/)
- * - Annotation actors spawned dynamically based on visibility rules
+ * - Positions are kept in a hashed uniform grid (FAnnotationSpatialIndex), updated on create,
+ *   move and delete, so proximity, box, view and nearest queries cost about O(results)
+ * - Category and phase have secondary indexes (id sets); composite queries start from the
+ *   smallest candidate set (category, phase or spatial cells) and test the rest per id
+ * - Every change is encoded as a journal record (FAnnotationJournal) and appended to
+ *   annotations.journal once per frame, so saving an edit costs O(edit), not O(annotations)
+ * - Compacted snapshots are binary (FAnnotationBinaryFile, annotations_<generation>.bin in
+ *   Saved/Annotations/): once the journal passes CompactJournalBytes, and on shutdown, a new
+ *   generation is written and the journal deleted
+ * - Loading maps the newest snapshot instead of deserializing it: annotations live in the
+ *   mapped records until created, changed or deleted, when they move into AnnotationDatabase
+ *   and their record is marked removed. Indexes are built from the records' fixed fields, and
+ *   text is decoded only for annotations a query returns. The journal replays over the top
+ * - If snapshots exist but none opens, persistence goes read-only for the session: the journal
+ *   is replayed on its own, and nothing is appended, snapshotted or deleted, so the unreadable
+ *   generations stay on disk for recovery
+ * - JSON (FAnnotationJson) is for interchange: export, import, and migrating a JSON save
+ *   from before the binary format
+ * - The game thread only encodes records and snapshots; file I/O runs in order on a
+ *   background pipe
+ * - Annotation actors are pooled per world by UUS_AnnotationMarkerPool, which picks what to
+ *   show with ForEachAnnotationIdMatching and decodes only the annotations it places
  * - Support filtering by phase (hide annotations for future phases)
  */
 UCLASS()
@@ -97,6 +177,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
 	bool UpdateAnnotation(FGuid AnnotationId, const FString& NewText, FName NewCategory = NAME_None);
 
+	/** Move an existing annotation */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	bool SetAnnotationPosition(FGuid AnnotationId, FVector NewWorldPosition);
+
+	/** Associate an existing annotation with a phase (-1 = none) */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	bool SetAnnotationPhase(FGuid AnnotationId, int32 NewPhase);
+
 	/** Delete an annotation */
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
 	bool DeleteAnnotation(FGuid AnnotationId);
@@ -121,14 +209,84 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
 	TArray<FAnnotation> GetAnnotationsNearPosition(FVector WorldPosition, float Radius = 1000.0f) const;
 
-	/** Save annotations to JSON file */
+	/** Get up to Count annotations nearest a world position, nearest first (MaxDistance <= 0 = unlimited) */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	TArray<FAnnotation> GetNearestAnnotations(FVector WorldPosition, int32 Count = 10, float MaxDistance = 0.0f) const;
+
+	/** Get annotations inside a world-space box */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	TArray<FAnnotation> GetAnnotationsInBox(FBox Box) const;
+
+	/** Get annotations matching every enabled condition of Query */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	TArray<FAnnotation> QueryAnnotations(const FAnnotationQuery& Query) const;
+
+	/**
+	 * Get annotations inside a view frustum.
+	 * FieldOfView is horizontal (degrees), AspectRatio is width / height.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	TArray<FAnnotation> GetAnnotationsInView(FVector ViewLocation, FRotator ViewRotation, float FieldOfView = 90.0f, float AspectRatio = 1.7778f, float MaxDistance = 5000.0f) const;
+
+	/**
+	 * Native queries: visit stored annotations in place, without copying or allocating.
+	 * The Blueprint getters above are thin wrappers that copy what these visit.
+	 * Visitors must not create, move or delete annotations.
+	 */
+
+	/**
+	 * Find an annotation by ID (nullptr if unknown). Valid until the next create, change or delete,
+	 * and for at least MaxDecodedStoredAnnotations further lookups of stored annotations
+	 */
+	const FAnnotation* FindAnnotation(const FGuid& AnnotationId) const;
+
+	/** Number of annotations, stored and resident */
+	int32 GetNumAnnotations() const;
+
+	void ForEachAnnotation(TFunctionRef<void(const FAnnotation&)> Visitor) const;
+	void ForEachAnnotationInCategory(FName Category, TFunctionRef<void(const FAnnotation&)> Visitor) const;
+	void ForEachAnnotationInPhase(int32 Phase, TFunctionRef<void(const FAnnotation&)> Visitor) const;
+	void ForEachAnnotationNear(const FVector& WorldPosition, float Radius, TFunctionRef<void(const FAnnotation&)> Visitor) const;
+	void ForEachAnnotationInBox(const FBox& Box, TFunctionRef<void(const FAnnotation&)> Visitor) const;
+	void ForEachAnnotationInView(const FVector& ViewLocation, const FRotator& ViewRotation, float FieldOfView, float AspectRatio, float MaxDistance, TFunctionRef<void(const FAnnotation&)> Visitor) const;
+	void ForEachAnnotationMatching(const FAnnotationQuery& Query, TFunctionRef<void(const FAnnotation&)> Visitor) const;
+
+	/** Ids and positions matching Query, without reading annotation text (for callers that pick before they display) */
+	void ForEachAnnotationIdMatching(const FAnnotationQuery& Query, TFunctionRef<void(const FGuid&, const FVector&)> Visitor) const;
+
+	/** Visit the annotations with the given ids (unknown ids are skipped); stored records are decoded, not cached */
+	void ForEachAnnotationById(TConstArrayView<FGuid> AnnotationIds, TFunctionRef<void(const FAnnotation&)> Visitor) const;
+
+	/** Ids of the Count annotations nearest WorldPosition, nearest first, into a caller-owned array */
+	void FindNearestAnnotations(const FVector& WorldPosition, int32 Count, float MaxDistance, TArray<FGuid>& OutAnnotationIds) const;
+
+	/**
+	 * Save a binary snapshot of the annotations and drop the journal it supersedes.
+	 * Returns once the annotations are snapshotted; the file is written on a background task
+	 * and replaced atomically.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
 	bool SaveAnnotations();
 
-	/** Load annotations from JSON file */
+	/** Map the newest snapshot and replay the journal, replacing the current annotations (waits for pending writes) */
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
 	bool LoadAnnotations();
 
+	/** Whether persistence is read-only because no snapshot on disk could be opened (see LoadAnnotations) */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Annotation")
+	bool IsPersistenceReadOnly() const { return bPersistenceReadOnly; }
+
+	/** Write every annotation to a JSON file (SaveFilePath if Path is empty), on a background task */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	bool ExportAnnotationsJson(const FString& Path);
+
+	/** Add annotations from a JSON file (SaveFilePath if Path is empty), replacing those with the same ID */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	bool ImportAnnotationsJson(const FString& Path);
+
+	/** Block until every queued journal append and snapshot has been written */
+	void WaitForPendingSaves();
+
 protected:
 	/** Called when an annotation is created */
 	UFUNCTION(BlueprintImplementableEvent, Category = "Homestead Twin|Annotation")
@@ -142,12 +300,100 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Homestead Twin|Annotation")
 	void OnAnnotationDeleted(FGuid AnnotationId);
 
+	/** Publish annotation count and memory to stats, CSV and trace */
+	void UpdateAnnotationCounters() const;
+
+	/** Rebuild the spatial and secondary indexes (after loading or changing SpatialCellSize) */
+	void RebuildIndexes();
+
+	/** Index of the stored record for AnnotationId (INDEX_NONE if absent or removed) */
+	int32 FindStoredRecord(const FGuid& AnnotationId) const;
+
+	/** Mark a stored record removed (its annotation was changed, replaced or deleted) */
+	void RemoveStoredRecord(int32 RecordIndex);
+
+	/** Annotation for an indexed ID: the resident one, or its stored record decoded into Scratch */
+	const FAnnotation& ResolveAnnotation(const FGuid& AnnotationId, FAnnotation& Scratch) const;
+
+	/** Position of an indexed ID, without decoding its stored record */
+	FVector GetAnnotationPosition(const FGuid& AnnotationId) const;
+
+	/** Resident annotation for AnnotationId, moving it out of the stored snapshot first (nullptr if unknown) */
+	FAnnotation* FindMutableAnnotation(const FGuid& AnnotationId);
+
+	/** Add or replace a resident annotation, superseding its stored record. Returns whether it existed. */
+	bool PutResidentAnnotation(FAnnotation&& Annotation);
+
+	/** Hand the records encoded since the last flush to the persistence pipe */
+	void FlushJournal();
+
+	/** Flush the journal each frame and compact it once it grows past CompactJournalBytes */
+	bool TickJournal(float DeltaTime);
+
 protected:
-	/** Annotation data storage */
-	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|Annotation")
+	/**
+	 * Resident annotations: created, changed or imported since the stored snapshot was mapped.
+	 * Not the full set (the rest stay in StoredAnnotations), so it is not exposed to Blueprint;
+	 * use GetAllAnnotations, GetAnnotation or the native queries
+	 */
 	TMap<FGuid, FAnnotation> AnnotationDatabase;
 
-	/** Path to JSON save file */
+	/** Path to the JSON interchange file; binary snapshots and the journal are kept next to it */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation")
 	FString SaveFilePath;
+
+	/** Journal size that triggers a snapshot (bytes, <= 0 = only on shutdown or request) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation")
+	int32 CompactJournalBytes;
+
+	/** Edge length of a spatial index cell (cm, applied on Initialize); about the typical query radius works best */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation", meta = (ClampMin = "1.0"))
+	float SpatialCellSize;
+
+	/** Annotation positions by grid cell */
+	FAnnotationSpatialIndex SpatialIndex;
+
+	/** Category -> annotation ids */
+	TAnnotationKeyIndex<FName> CategoryIndex;
+
+	/** Associated phase -> annotation ids */
+	TAnnotationKeyIndex<int32> PhaseIndex;
+
+	/** Mapped binary snapshot; annotations not in AnnotationDatabase are read from it */
+	TSharedPtr<const FAnnotationBinaryFile> StoredAnnotations;
+
+	/** One bit per stored record: set once its annotation moved to AnnotationDatabase or was deleted */
+	TBitArray<> StoredRemoved;
+	int32 NumStoredRemoved;
+
+	/** Decoded records kept per generation before the older one is dropped */
+	static constexpr int32 MaxDecodedStoredAnnotations = 1024;
+
+	/**
+	 * Stored records decoded by FindAnnotation, kept so the returned pointers stay valid. Two
+	 * generations bound the cache: when the current one is full the previous is dropped, and
+	 * hits in the previous one move (pointer unchanged) into the current one
+	 */
+	mutable TMap<int32, TUniquePtr<FAnnotation>> DecodedStoredAnnotations;
+	mutable TMap<int32, TUniquePtr<FAnnotation>> PreviousDecodedStoredAnnotations;
+
+	/** Newest snapshot generation on disk (INDEX_NONE = none) */
+	int32 SnapshotGeneration;
+
+	/** Journal records encoded this frame, not yet handed to the pipe */
+	TArray<uint8> PendingJournalRecords;
+
+	/** Journal bytes written since the last snapshot */
+	int64 JournalBytes;
+
+	/** Snapshots exist but none opened: nothing is written until a load succeeds */
+	bool bPersistenceReadOnly;
+
+	/** Journal file; only used on the persistence pipe once created */
+	TUniquePtr<FAnnotationJournal> Journal;
+
+	/** Serializes journal appends and snapshots */
+	TUniquePtr<UE::Tasks::FPipe> PersistencePipe;
+
+	FTSTicker::FDelegateHandle JournalTickerHandle;
 };
@@ -0,0 +1,270 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "US_AnnotationMarkerPool.h"
+#include "../Actors/A_Annotation.h"
+#include "../HomesteadTwin.h"
+#include "Algo/Sort.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+HOMESTEAD_DECLARE_COUNTER(AnnotationMarkers);
+
+UUS_AnnotationMarkerPool::UUS_AnnotationMarkerPool()
+{
+	MarkerBudget = 48;
+	MaxMarkerDistance = 5000.0f;
+	HysteresisFraction = 0.2f;
+	SelectionInterval = 0.25f;
+	MarkerClass = AA_Annotation::StaticClass();
+
+	SelectionCountdown = 0.0f;
+}
+
+void UUS_AnnotationMarkerPool::Deinitialize()
+{
+	for (AA_Annotation* Marker : Markers)
+	{
+		if (IsValid(Marker))
+		{
+			Marker->Destroy();
+		}
+	}
+
+	Markers.Reset();
+	Bindings.Reset();
+	FreeMarkers.Reset();
+	AnnotationMarkers.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UUS_AnnotationMarkerPool::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UUS_AnnotationMarkerPool::Tick(float DeltaTime)
+{
+	SelectionCountdown -= DeltaTime;
+	if (SelectionCountdown > 0.0f)
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	if (!PlayerController)
+	{
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	SelectionCountdown = SelectionInterval;
+	UpdateSelection(ViewLocation);
+}
+
+TStatId UUS_AnnotationMarkerPool::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUS_AnnotationMarkerPool, STATGROUP_HomesteadTwin);
+}
+
+void UUS_AnnotationMarkerPool::SetMarkerFilter(const FAnnotationQuery& Filter)
+{
+	MarkerFilter = Filter;
+	SelectionCountdown = 0.0f;
+}
+
+AA_Annotation* UUS_AnnotationMarkerPool::FindMarker(FGuid AnnotationId) const
+{
+	const int32* MarkerIndex = AnnotationMarkers.Find(AnnotationId);
+	AA_Annotation* Marker = MarkerIndex ? Markers[*MarkerIndex].Get() : nullptr;
+	return IsValid(Marker) ? Marker : nullptr;
+}
+
+void UUS_AnnotationMarkerPool::UpdateSelection(const FVector& ViewLocation)
+{
+	HOMESTEAD_SCOPE(AnnotationMarkerSelection);
+
+	UUS_AnnotationManager* AnnotationManager = GetAnnotationManager();
+	if (!AnnotationManager)
+	{
+		return;
+	}
+
+	RemoveDestroyedMarkers();
+
+	const double MaxMarkerDistanceSq = FMath::Square(double(MaxMarkerDistance));
+	const double HeldScoreScale = FMath::Square(1.0 - HysteresisFraction);
+
+	// Held markers may stay HysteresisFraction beyond MaxMarkerDistance
+	FAnnotationQuery Query = MarkerFilter;
+	Query.bWithinRadius = true;
+	Query.Center = ViewLocation;
+	Query.Radius = MaxMarkerDistance * (1.0f + HysteresisFraction);
+
+	// Score ids in range; lower is better. Nothing but ids and positions is read here
+	Candidates.Reset();
+	AnnotationManager->ForEachAnnotationIdMatching(Query, [this, &ViewLocation, MaxMarkerDistanceSq, HeldScoreScale](const FGuid& AnnotationId, const FVector& Position)
+	{
+		const double DistanceSq = FVector::DistSquared(ViewLocation, Position);
+		const bool bHeld = AnnotationMarkers.Contains(AnnotationId);
+		if (bHeld || DistanceSq <= MaxMarkerDistanceSq)
+		{
+			Candidates.Emplace(DistanceSq * (bHeld ? HeldScoreScale : 1.0), AnnotationId);
+		}
+	});
+
+	// Keep the best MarkerBudget candidates
+	if (Candidates.Num() > MarkerBudget)
+	{
+		Algo::SortBy(Candidates, &TPair<double, FGuid>::Key);
+		Candidates.SetNum(FMath::Max(MarkerBudget, 0), EAllowShrinking::No);
+	}
+
+	SelectedIds.Reset();
+	Selected.Init(false, Markers.Num());
+	for (const TPair<double, FGuid>& Candidate : Candidates)
+	{
+		SelectedIds.Add(Candidate.Value);
+		if (const int32* MarkerIndex = AnnotationMarkers.Find(Candidate.Value))
+		{
+			Selected[*MarkerIndex] = true;
+		}
+	}
+
+	// Release before assigning so parked markers can be reused this pass
+	for (int32 MarkerIndex = 0; MarkerIndex < Markers.Num(); ++MarkerIndex)
+	{
+		if (!Selected[MarkerIndex] && Bindings[MarkerIndex].AnnotationId.IsValid())
+		{
+			ReleaseMarker(MarkerIndex);
+		}
+	}
+
+	// Text is decoded for the selected annotations only
+	AnnotationManager->ForEachAnnotationById(SelectedIds, [this](const FAnnotation& Annotation)
+	{
+		const int32* MarkerIndex = AnnotationMarkers.Find(Annotation.AnnotationId);
+		if (!MarkerIndex)
+		{
+			AssignMarker(Annotation);
+			return;
+		}
+
+		// Rebind markers whose annotation was edited or moved since it was bound
+		const FMarkerBinding& Binding = Bindings[*MarkerIndex];
+		if (Binding.ModifiedTimestamp != Annotation.ModifiedTimestamp || !Markers[*MarkerIndex]->GetActorLocation().Equals(Annotation.WorldPosition))
+		{
+			BindMarker(*MarkerIndex, Annotation);
+		}
+	});
+
+	HOMESTEAD_SET_COUNTER(AnnotationMarkers, GetNumActiveMarkers());
+}
+
+bool UUS_AnnotationMarkerPool::AssignMarker(const FAnnotation& Annotation)
+{
+	int32 MarkerIndex = INDEX_NONE;
+	if (FreeMarkers.Num() > 0)
+	{
+		MarkerIndex = FreeMarkers.Pop(EAllowShrinking::No);
+	}
+	else if (Markers.Num() < MarkerBudget)
+	{
+		UWorld* World = GetWorld();
+		if (!World || !MarkerClass)
+		{
+			return false;
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.ObjectFlags = RF_Transient;
+		AA_Annotation* Marker = World->SpawnActor<AA_Annotation>(MarkerClass, FTransform(Annotation.WorldPosition), SpawnParams);
+		if (!Marker)
+		{
+			return false;
+		}
+
+		MarkerIndex = Markers.Add(Marker);
+		Bindings.AddDefaulted();
+	}
+	else
+	{
+		return false;
+	}
+
+	BindMarker(MarkerIndex, Annotation);
+	return true;
+}
+
+void UUS_AnnotationMarkerPool::BindMarker(int32 MarkerIndex, const FAnnotation& Annotation)
+{
+	AA_Annotation* Marker = Markers[MarkerIndex];
+	Marker->SetActorLocation(Annotation.WorldPosition);
+	Marker->InitializeAnnotation(Annotation.AnnotationId, Annotation.Text, Annotation.Category);
+	Marker->SetMarkerActive(true);
+
+	FMarkerBinding& Binding = Bindings[MarkerIndex];
+	Binding.AnnotationId = Annotation.AnnotationId;
+	Binding.ModifiedTimestamp = Annotation.ModifiedTimestamp;
+	AnnotationMarkers.Add(Annotation.AnnotationId, MarkerIndex);
+}
+
+void UUS_AnnotationMarkerPool::ReleaseMarker(int32 MarkerIndex)
+{
+	if (IsValid(Markers[MarkerIndex]))
+	{
+		Markers[MarkerIndex]->SetMarkerActive(false);
+	}
+
+	FMarkerBinding& Binding = Bindings[MarkerIndex];
+	AnnotationMarkers.Remove(Binding.AnnotationId);
+	Binding = FMarkerBinding();
+	FreeMarkers.Add(MarkerIndex);
+}
+
+void UUS_AnnotationMarkerPool::RemoveDestroyedMarkers()
+{
+	bool bRemoved = false;
+	for (int32 MarkerIndex = Markers.Num() - 1; MarkerIndex >= 0; --MarkerIndex)
+	{
+		if (!IsValid(Markers[MarkerIndex]))
+		{
+			Markers.RemoveAtSwap(MarkerIndex, EAllowShrinking::No);
+			Bindings.RemoveAtSwap(MarkerIndex, EAllowShrinking::No);
+			bRemoved = true;
+		}
+	}
+
+	if (!bRemoved)
+	{
+		return;
+	}
+
+	// Indices moved, so rebuild both lookups; annotations that lost their marker compete for a new one
+	FreeMarkers.Reset();
+	AnnotationMarkers.Reset();
+	for (int32 MarkerIndex = 0; MarkerIndex < Markers.Num(); ++MarkerIndex)
+	{
+		if (Bindings[MarkerIndex].AnnotationId.IsValid())
+		{
+			AnnotationMarkers.Add(Bindings[MarkerIndex].AnnotationId, MarkerIndex);
+		}
+		else
+		{
+			FreeMarkers.Add(MarkerIndex);
+		}
+	}
+}
+
+UUS_AnnotationManager* UUS_AnnotationMarkerPool::GetAnnotationManager() const
+{
+	UWorld* World = GetWorld();
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UUS_AnnotationManager>() : nullptr;
+}
@@ -0,0 +1,149 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "US_AnnotationManager.h"
+#include "US_AnnotationMarkerPool.generated.h"
+
+class AA_Annotation;
+
+/**
+ * UUS_AnnotationMarkerPool
+ *
+ * World Subsystem keeping a bounded pool of AA_Annotation markers bound to the annotations
+ * nearest the viewer, so thousands of annotations cost about as much as MarkerBudget markers.
+ *
+ * Responsibilities:
+ * - Pick the annotations that get a marker: nearest the viewer, within MaxMarkerDistance,
+ *   passing MarkerFilter (category and/or phase)
+ * - Bind markers to them with InitializeAnnotation, recycling markers of annotations that fell out
+ * - Rebind markers whose annotation moved or changed
+ *
+ * Implementation Notes:
+ * - Selection runs every SelectionInterval from UUS_AnnotationManager::ForEachAnnotationIdMatching
+ *   (spatial index plus category and phase indexes), so only ids and positions are read for
+ *   candidates; annotation text is decoded only for the selected ones
+ * - Score = distance^2, best MarkerBudget win. Hysteresis: an annotation holding a marker scores
+ *   as if HysteresisFraction closer and may stay HysteresisFraction beyond MaxMarkerDistance
+ * - Unassigned markers are parked (SetMarkerActive(false): hidden, not ticking, no widget
+ *   source) and reused; markers are spawned on demand up to MarkerBudget and never destroyed
+ *   by the pool before Deinitialize
+ * - A marker destroyed by something else (level streaming, gameplay code) is dropped at the
+ *   start of the next selection pass; until then FindMarker returns nullptr for it
+ * - Deleted annotations drop out of the query, so their markers are recycled on the next pass
+ */
+UCLASS()
+class HOMESTEADTWIN_API UUS_AnnotationMarkerPool : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UUS_AnnotationMarkerPool();
+
+	// Begin USubsystem Interface
+	virtual void Deinitialize() override;
+	// End USubsystem Interface
+
+	// Begin UWorldSubsystem Interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem Interface
+
+	// Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject Interface
+
+	/** Show markers only for annotations matching Filter's category and/or phase (its radius is ignored) */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	void SetMarkerFilter(const FAnnotationQuery& Filter);
+
+	/** Current category and phase filter */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Annotation")
+	FAnnotationQuery GetMarkerFilter() const { return MarkerFilter; }
+
+	/** Re-run selection on the next tick (e.g. after bulk edits) */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Annotation")
+	void RefreshMarkers() { SelectionCountdown = 0.0f; }
+
+	/** Marker currently bound to an annotation (nullptr if it has none) */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Annotation")
+	AA_Annotation* FindMarker(FGuid AnnotationId) const;
+
+	/** Number of markers currently bound to annotations */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Annotation")
+	int32 GetNumActiveMarkers() const { return Markers.Num() - FreeMarkers.Num(); }
+
+protected:
+	/** What a marker is bound to */
+	struct FMarkerBinding
+	{
+		FGuid AnnotationId;
+		FDateTime ModifiedTimestamp;
+	};
+
+	/** Select the annotations that get markers and bind them */
+	void UpdateSelection(const FVector& ViewLocation);
+
+	/** Give an annotation a marker (spawns one while under budget) */
+	bool AssignMarker(const FAnnotation& Annotation);
+
+	/** Point a marker at an annotation and show it */
+	void BindMarker(int32 MarkerIndex, const FAnnotation& Annotation);
+
+	/** Park a marker and return it to the pool */
+	void ReleaseMarker(int32 MarkerIndex);
+
+	/** Forget markers destroyed outside the pool */
+	void RemoveDestroyedMarkers();
+
+	UUS_AnnotationManager* GetAnnotationManager() const;
+
+protected:
+	/** Markers shared by all annotations (hard cap) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation", meta = (ClampMin = "0"))
+	int32 MarkerBudget;
+
+	/** Annotations farther than this never get a marker (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation", meta = (ClampMin = "0"))
+	float MaxMarkerDistance;
+
+	/** Advantage of an annotation that already holds a marker (fraction of its distance) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation", meta = (ClampMin = "0", ClampMax = "0.9"))
+	float HysteresisFraction;
+
+	/** Seconds between selection passes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation", meta = (ClampMin = "0"))
+	float SelectionInterval;
+
+	/** Marker actor class */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation")
+	TSubclassOf<AA_Annotation> MarkerClass;
+
+	/** Category and phase filter (radius fields unused) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Annotation")
+	FAnnotationQuery MarkerFilter;
+
+private:
+	/** Every pooled marker */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AA_Annotation>> Markers;
+
+	/** Binding per marker (invalid id = free) */
+	TArray<FMarkerBinding> Bindings;
+
+	/** Indices of parked markers */
+	TArray<int32> FreeMarkers;
+
+	/** Annotation id -> marker index */
+	TMap<FGuid, int32> AnnotationMarkers;
+
+	/** Seconds until the next selection pass */
+	float SelectionCountdown;
+
+	/** Selection scratch (score, annotation id) and selected ids, reused between passes */
+	TArray<TPair<double, FGuid>> Candidates;
+	TArray<FGuid> SelectedIds;
+	TBitArray<> Selected;
+};
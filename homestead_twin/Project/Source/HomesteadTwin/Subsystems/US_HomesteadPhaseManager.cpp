@@ -1,6 +1,7 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "US_HomesteadPhaseManager.h"
+#include "../HomesteadTwin.h"
 #include "EngineUtils.h"
 #include "GameFramework/Actor.h"
 
@@ -28,6 +29,8 @@ void UUS_HomesteadPhaseManager::SetCurrentPhase(EHomesteadPhase NewPhase)
 		return;
 	}
 
+	HOMESTEAD_SCOPE(PhaseSwitch);
+
 	EHomesteadPhase OldPhase = CurrentPhase;
 	CurrentPhase = NewPhase;
 
@@ -39,20 +42,19 @@ void UUS_HomesteadPhaseManager::SetCurrentPhase(EHomesteadPhase NewPhase)
 
 FPhaseDefinition UUS_HomesteadPhaseManager::GetPhaseDefinition(EHomesteadPhase Phase) const
 {
-	for (const FPhaseDefinition& PhaseDef : PhaseDefinitions)
-	{
-		if (PhaseDef.Phase == Phase)
-		{
-			return PhaseDef;
-		}
-	}
-	return FPhaseDefinition();
+	const FPhaseDefinition* PhaseDef = FindPhaseDefinition(Phase);
+	return PhaseDef ? *PhaseDef : FPhaseDefinition();
+}
+
+const FPhaseDefinition* UUS_HomesteadPhaseManager::FindPhaseDefinition(EHomesteadPhase Phase) const
+{
+	return PhaseDefinitions.FindByPredicate([Phase](const FPhaseDefinition& PhaseDef) { return PhaseDef.Phase == Phase; });
 }
 
 bool UUS_HomesteadPhaseManager::IsObjectVisibleInCurrentPhase(FName ObjectTag) const
 {
-	FPhaseDefinition CurrentPhaseDef = GetPhaseDefinition(CurrentPhase);
-	return CurrentPhaseDef.VisibleObjectTags.Contains(ObjectTag);
+	const FPhaseDefinition* CurrentPhaseDef = FindPhaseDefinition(CurrentPhase);
+	return CurrentPhaseDef && CurrentPhaseDef->VisibleObjectTags.Contains(ObjectTag);
 }
 
 void UUS_HomesteadPhaseManager::ApplyPhaseVisibility()
@@ -100,6 +100,12 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Phase")
 	TArray<FPhaseDefinition> GetAllPhaseDefinitions() const { return PhaseDefinitions; }
 
+	/** Find a phase definition (native, no copy; nullptr if undefined) */
+	const FPhaseDefinition* FindPhaseDefinition(EHomesteadPhase Phase) const;
+
+	/** View of all phase definitions (native, no copy) */
+	TConstArrayView<FPhaseDefinition> GetPhaseDefinitionsView() const { return PhaseDefinitions; }
+
 	/** Check if an object is visible in the current phase */
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Phase")
 	bool IsObjectVisibleInCurrentPhase(FName ObjectTag) const;
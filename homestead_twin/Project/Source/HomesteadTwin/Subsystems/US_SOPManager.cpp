@@ -1,7 +1,11 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "US_SOPManager.h"
+#include "../HomesteadTwin.h"
 #include "Misc/Paths.h"
+#include "String/Find.h"
+
+HOMESTEAD_DECLARE_COUNTER(SOPs);
 
 UUS_SOPManager::UUS_SOPManager()
 {
@@ -23,60 +27,96 @@ void UUS_SOPManager::LoadSOPData()
 {
 	// TODO: Load SOP data from data table
 	// If SOPDataTable is set, iterate through it and populate SOPDatabase
+
+	HOMESTEAD_SET_COUNTER(SOPs, SOPDatabase.Num());
 }
 
 FStandardOperatingProcedure UUS_SOPManager::GetSOPById(FName SOPId) const
 {
-	const FStandardOperatingProcedure* SOP = SOPDatabase.Find(SOPId);
+	const FStandardOperatingProcedure* SOP = FindSOP(SOPId);
 	return SOP ? *SOP : FStandardOperatingProcedure();
 }
 
 TArray<FStandardOperatingProcedure> UUS_SOPManager::GetSOPsForObject(FName ObjectId) const
 {
 	TArray<FStandardOperatingProcedure> SOPs;
-	for (const auto& Pair : SOPDatabase)
-	{
-		if (Pair.Value.LinkedObjectIds.Contains(ObjectId))
-		{
-			SOPs.Add(Pair.Value);
-		}
-	}
+	ForEachSOPForObject(ObjectId, [&SOPs](const FStandardOperatingProcedure& SOP) { SOPs.Add(SOP); });
 	return SOPs;
 }
 
 TArray<FStandardOperatingProcedure> UUS_SOPManager::GetSOPsByTag(FName Tag) const
 {
 	TArray<FStandardOperatingProcedure> SOPs;
-	for (const auto& Pair : SOPDatabase)
-	{
-		if (Pair.Value.Tags.Contains(Tag))
-		{
-			SOPs.Add(Pair.Value);
-		}
-	}
+	ForEachSOPWithTag(Tag, [&SOPs](const FStandardOperatingProcedure& SOP) { SOPs.Add(SOP); });
 	return SOPs;
 }
 
 TArray<FStandardOperatingProcedure> UUS_SOPManager::GetAllSOPs() const
 {
 	TArray<FStandardOperatingProcedure> SOPs;
-	SOPDatabase.GenerateValueArray(SOPs);
+	SOPs.Reserve(SOPDatabase.Num());
+	ForEachSOP([&SOPs](const FStandardOperatingProcedure& SOP) { SOPs.Add(SOP); });
 	return SOPs;
 }
 
 TArray<FStandardOperatingProcedure> UUS_SOPManager::SearchSOPs(const FString& SearchText) const
 {
 	TArray<FStandardOperatingProcedure> Results;
-	FString LowerSearchText = SearchText.ToLower();
+	ForEachSOPMatching(SearchText, [&Results](const FStandardOperatingProcedure& SOP) { Results.Add(SOP); });
+	return Results;
+}
+
+const FStandardOperatingProcedure* UUS_SOPManager::FindSOP(FName SOPId) const
+{
+	return SOPDatabase.Find(SOPId);
+}
 
+void UUS_SOPManager::ForEachSOP(TFunctionRef<void(const FStandardOperatingProcedure&)> Visitor) const
+{
 	for (const auto& Pair : SOPDatabase)
 	{
-		if (Pair.Value.Title.ToLower().Contains(LowerSearchText) ||
-			Pair.Value.Description.ToLower().Contains(LowerSearchText))
+		Visitor(Pair.Value);
+	}
+}
+
+void UUS_SOPManager::ForEachSOPForObject(FName ObjectId, TFunctionRef<void(const FStandardOperatingProcedure&)> Visitor) const
+{
+	HOMESTEAD_SCOPE(SOPQueryObject);
+
+	for (const auto& Pair : SOPDatabase)
+	{
+		if (Pair.Value.LinkedObjectIds.Contains(ObjectId))
 		{
-			Results.Add(Pair.Value);
+			Visitor(Pair.Value);
 		}
 	}
+}
 
-	return Results;
+void UUS_SOPManager::ForEachSOPWithTag(FName Tag, TFunctionRef<void(const FStandardOperatingProcedure&)> Visitor) const
+{
+	HOMESTEAD_SCOPE(SOPQueryTag);
+
+	for (const auto& Pair : SOPDatabase)
+	{
+		if (Pair.Value.Tags.Contains(Tag))
+		{
+			Visitor(Pair.Value);
+		}
+	}
+}
+
+void UUS_SOPManager::ForEachSOPMatching(FStringView SearchText, TFunctionRef<void(const FStandardOperatingProcedure&)> Visitor) const
+{
+	HOMESTEAD_SCOPE(SOPSearch);
+
+	// Case-insensitive compare in place; no lowercased copies per SOP
+	for (const auto& Pair : SOPDatabase)
+	{
+		if (SearchText.IsEmpty() ||
+			UE::String::FindFirst(Pair.Value.Title, SearchText, ESearchCase::IgnoreCase) != INDEX_NONE ||
+			UE::String::FindFirst(Pair.Value.Description, SearchText, ESearchCase::IgnoreCase) != INDEX_NONE)
+		{
+			Visitor(Pair.Value);
+		}
+	}
 }
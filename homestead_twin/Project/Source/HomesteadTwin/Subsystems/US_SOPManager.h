@@ -125,6 +125,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|SOP")
 	TArray<FStandardOperatingProcedure> SearchSOPs(const FString& SearchText) const;
 
+	/**
+	 * Native queries: visit stored SOPs in place, without copying or allocating.
+	 * The Blueprint getters above are thin wrappers that copy what these visit.
+	 */
+
+	/** Find an SOP by ID (nullptr if unknown; valid until SOP data is reloaded) */
+	const FStandardOperatingProcedure* FindSOP(FName SOPId) const;
+
+	void ForEachSOP(TFunctionRef<void(const FStandardOperatingProcedure&)> Visitor) const;
+	void ForEachSOPForObject(FName ObjectId, TFunctionRef<void(const FStandardOperatingProcedure&)> Visitor) const;
+	void ForEachSOPWithTag(FName Tag, TFunctionRef<void(const FStandardOperatingProcedure&)> Visitor) const;
+
+	/** Visit SOPs whose title or description contains SearchText (case-insensitive) */
+	void ForEachSOPMatching(FStringView SearchText, TFunctionRef<void(const FStandardOperatingProcedure&)> Visitor) const;
+
 protected:
 	/** SOP data storage */
 	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|SOP")
@@ -1,6 +1,7 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "US_ScenarioManager.h"
+#include "../HomesteadTwin.h"
 
 UUS_ScenarioManager::UUS_ScenarioManager()
 {
@@ -28,14 +29,16 @@ void UUS_ScenarioManager::Deinitialize()
 
 bool UUS_ScenarioManager::ActivateScenario(FName ScenarioId)
 {
+	HOMESTEAD_SCOPE(ScenarioActivate);
+
 	// Deactivate current scenario if any
 	if (bScenarioActive)
 	{
 		DeactivateScenario();
 	}
 
-	FScenarioDefinition ScenarioDef = GetScenarioDefinition(ScenarioId);
-	if (ScenarioDef.ScenarioId == NAME_None)
+	const FScenarioDefinition* ScenarioDef = FindScenarioDefinition(ScenarioId);
+	if (!ScenarioDef || ScenarioDef->ScenarioId == NAME_None)
 	{
 		return false;
 	}
@@ -43,8 +46,8 @@ bool UUS_ScenarioManager::ActivateScenario(FName ScenarioId)
 	ActiveScenarioId = ScenarioId;
 	bScenarioActive = true;
 
-	ApplyScenarioEffects(ScenarioDef);
-	OnScenarioActivated(ScenarioDef);
+	ApplyScenarioEffects(*ScenarioDef);
+	OnScenarioActivated(*ScenarioDef);
 
 	return true;
 }
@@ -56,6 +59,8 @@ void UUS_ScenarioManager::DeactivateScenario()
 		return;
 	}
 
+	HOMESTEAD_SCOPE(ScenarioDeactivate);
+
 	ResetScenarioEffects();
 
 	ActiveScenarioId = NAME_None;
@@ -76,14 +81,13 @@ FScenarioDefinition UUS_ScenarioManager::GetActiveScenario(bool& bIsActive) cons
 
 FScenarioDefinition UUS_ScenarioManager::GetScenarioDefinition(FName ScenarioId) const
 {
-	for (const FScenarioDefinition& Scenario : ScenarioDefinitions)
-	{
-		if (Scenario.ScenarioId == ScenarioId)
-		{
-			return Scenario;
-		}
-	}
-	return FScenarioDefinition();
+	const FScenarioDefinition* Scenario = FindScenarioDefinition(ScenarioId);
+	return Scenario ? *Scenario : FScenarioDefinition();
+}
+
+const FScenarioDefinition* UUS_ScenarioManager::FindScenarioDefinition(FName ScenarioId) const
+{
+	return ScenarioDefinitions.FindByPredicate([ScenarioId](const FScenarioDefinition& Scenario) { return Scenario.ScenarioId == ScenarioId; });
 }
 
 TArray<FScenarioDefinition> UUS_ScenarioManager::GetAllScenarios() const
@@ -94,14 +98,19 @@ TArray<FScenarioDefinition> UUS_ScenarioManager::GetAllScenarios() const
 TArray<FScenarioDefinition> UUS_ScenarioManager::GetScenariosByTag(FName Tag) const
 {
 	TArray<FScenarioDefinition> Results;
+	ForEachScenarioWithTag(Tag, [&Results](const FScenarioDefinition& Scenario) { Results.Add(Scenario); });
+	return Results;
+}
+
+void UUS_ScenarioManager::ForEachScenarioWithTag(FName Tag, TFunctionRef<void(const FScenarioDefinition&)> Visitor) const
+{
 	for (const FScenarioDefinition& Scenario : ScenarioDefinitions)
 	{
 		if (Scenario.Tags.Contains(Tag))
 		{
-			Results.Add(Scenario);
+			Visitor(Scenario);
 		}
 	}
-	return Results;
 }
 
 void UUS_ScenarioManager::ApplyScenarioEffects(const FScenarioDefinition& Scenario)
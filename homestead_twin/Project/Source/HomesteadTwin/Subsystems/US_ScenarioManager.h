@@ -102,6 +102,15 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Scenario")
 	TArray<FScenarioDefinition> GetScenariosByTag(FName Tag) const;
 
+	/** Find a scenario definition (native, no copy; nullptr if unknown) */
+	const FScenarioDefinition* FindScenarioDefinition(FName ScenarioId) const;
+
+	/** View of all scenario definitions (native, no copy) */
+	TConstArrayView<FScenarioDefinition> GetScenarioDefinitionsView() const { return ScenarioDefinitions; }
+
+	/** Visit scenarios with a tag (native, no copy) */
+	void ForEachScenarioWithTag(FName Tag, TFunctionRef<void(const FScenarioDefinition&)> Visitor) const;
+
 	/** Check if a scenario is currently active */
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Scenario")
 	bool IsScenarioActive() const { return bScenarioActive; }
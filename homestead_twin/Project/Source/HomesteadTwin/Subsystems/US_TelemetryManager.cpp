@@ -1,26 +1,121 @@
 // Copyright Fluxology. All Rights Reserved.
 
 #include "US_TelemetryManager.h"
-#include "TimerManager.h"
+#include "../HomesteadTwin.h"
+#include "../Telemetry/TelemetryMockSource.h"
+#include "../Telemetry/TelemetryMqttClient.h"
+#include "../Telemetry/TelemetryReplaySource.h"
+#include "../Telemetry/TelemetryRestPoller.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+
+HOMESTEAD_DECLARE_COUNTER(TelemetryKeys);
+HOMESTEAD_DECLARE_COUNTER(TelemetrySubscriptions);
+HOMESTEAD_DECLARE_COUNTER(TelemetrySamplesPerFrame);
+HOMESTEAD_DECLARE_MEMORY_COUNTER(TelemetryMemory);
 
 UUS_TelemetryManager::UUS_TelemetryManager()
 {
+	KeyRegistry = MakeShared<FTelemetryKeyRegistry>();
+	IngestQueue = MakeShared<FTelemetryIngestQueue>();
+	EndpointHealth = MakeShared<FTelemetryEndpointHealth>();
+
 	bTelemetryActive = false;
 	bMockDataMode = true; // Default to mock mode for testing
+	RetentionSamplesPerKey = 3600; // One hour at 1 Hz
+	bPersistTelemetry = true;
+	TelemetryLogRetentionHours = 24.0f * 7.0f;
+	RollupBucketsPerLevel = 512; // ~8.5 min at 1 s up to ~21 days at 1 h
+	MockUpdateInterval = 1.0f;
+	MockSeed = 12345;
+	MockKeyCount = 5;
+	MockTargetSamplesPerSecond = 0.0f;
+	MockTimeScale = 1.0f;
+	MockFaultsPerKeyPerDay = 0.5f;
+	CommittedSampleCount = 0;
+	bDrainedByOwner = false;
+	MaxConcurrentRestRequests = 4;
+	StaleUpdateMultiplier = 3.0f;
+	DefaultUpdateIntervalSeconds = 10.0f;
+	EndpointHealthRevision = 0;
+	NumEndpoints = 0;
+	NumFailingEndpoints = 0;
+	bTelemetryOffline = false;
 }
 
 void UUS_TelemetryManager::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	ResetTelemetryState();
+
+	if (bPersistTelemetry)
+	{
+		FTelemetrySegmentLog::FSettings LogSettings;
+		LogSettings.Directory = FPaths::ProjectSavedDir() / TEXT("Telemetry");
+		LogSettings.RetentionSeconds = TelemetryLogRetentionHours * 3600.0;
+
+		SegmentLog = MakeUnique<FTelemetrySegmentLog>(LogSettings, KeyRegistry.ToSharedRef());
+		WarmStartFromLog();
+		SegmentLog->StartThread();
+	}
+}
+
+void UUS_TelemetryManager::ResetTelemetryState()
+{
+	KeyRegistry->Reset();
+	TimeSeriesStore.Reset(RetentionSamplesPerKey);
+	RollupPyramid.Reset(RollupBucketsPerLevel);
+	RollingStats.Reset();
+	AlarmEngine.Reset();
+	PrimitiveBindings.Reset();
+	StalenessIndex.Reset(DefaultUpdateIntervalSeconds, StaleUpdateMultiplier, 1.0);
+	EnumLabelsBySlot.Reset();
+	AlarmThresholdRegistrations.Reset();
+	StaleTimeoutRegistrations.Reset();
+	CommittedSampleCount = 0;
+
+	ChangedSlots.Reset();
+	ChangedSlotFlags.Reset();
+
+	Subscriptions.Reset();
+	FreeSubscriptionIds.Reset();
+	SubscriptionsBySlot.Reset();
+	PendingSubscriptionIds.Reset();
+	PendingSubscriptionFlags.Reset();
 }
 
 void UUS_TelemetryManager::Deinitialize()
 {
 	StopTelemetry();
 
+	// Joins the log thread after it has written and synced everything drained above
+	SegmentLog.Reset();
+
 	Super::Deinitialize();
 }
 
+void UUS_TelemetryManager::Tick(float DeltaTime)
+{
+	const int64 PreviousSampleCount = CommittedSampleCount;
+	DrainIngestQueue();
+
+	HOMESTEAD_SET_COUNTER(TelemetryKeys, KeyRegistry->Num());
+	HOMESTEAD_SET_COUNTER(TelemetrySubscriptions, Subscriptions.Num() - FreeSubscriptionIds.Num());
+	HOMESTEAD_SET_COUNTER(TelemetrySamplesPerFrame, CommittedSampleCount - PreviousSampleCount);
+	HOMESTEAD_SET_MEMORY_COUNTER(TelemetryMemory, GetTelemetryAllocatedSize());
+}
+
+ETickableTickType UUS_TelemetryManager::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId UUS_TelemetryManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUS_TelemetryManager, STATGROUP_HomesteadTwin);
+}
+
 void UUS_TelemetryManager::StartTelemetry()
 {
 	if (bTelemetryActive)
@@ -30,22 +125,14 @@ void UUS_TelemetryManager::StartTelemetry()
 
 	bTelemetryActive = true;
 
-	// Start polling timer if not in mock mode
-	if (!bMockDataMode && GetWorld())
-	{
-		GetWorld()->GetTimerManager().SetTimer(
-			TelemetryPollTimerHandle,
-			this,
-			&UUS_TelemetryManager::PollTelemetryEndpoints,
-			5.0f, // Poll every 5 seconds
-			true
-		);
-	}
-	else if (bMockDataMode)
-	{
-		// Generate initial mock data
-		GenerateMockData();
-	}
+	// Sources register their endpoints while being created
+	EndpointHealth->Reset();
+	NumEndpoints = 0;
+	NumFailingEndpoints = 0;
+
+	IngestWorker = MakeUnique<FTelemetryIngestWorker>(KeyRegistry.ToSharedRef(), IngestQueue.ToSharedRef());
+	CreateTelemetrySources(*IngestWorker);
+	IngestWorker->StartThread();
 }
 
 void UUS_TelemetryManager::StopTelemetry()
@@ -57,30 +144,438 @@ void UUS_TelemetryManager::StopTelemetry()
 
 	bTelemetryActive = false;
 
-	// Clear polling timer
-	if (GetWorld() && TelemetryPollTimerHandle.IsValid())
-	{
-		GetWorld()->GetTimerManager().ClearTimer(TelemetryPollTimerHandle);
-	}
+	// Joins the ingest thread; anything it queued is still committed below
+	IngestWorker.Reset();
+	DrainIngestQueue();
+	ReplaySource.Reset();
 }
 
 float UUS_TelemetryManager::GetTelemetryValue(FName Key, bool& bSuccess) const
 {
-	const float* Value = TelemetryDataCache.Find(Key);
-	bSuccess = (Value != nullptr);
-	return bSuccess ? *Value : 0.0f;
+	return GetTelemetryValueByHandle(FTelemetryHandle(KeyRegistry->Find(Key)), bSuccess);
 }
 
 FString UUS_TelemetryManager::GetTelemetryString(FName Key, bool& bSuccess) const
 {
-	float Value = GetTelemetryValue(Key, bSuccess);
-	return bSuccess ? FString::Printf(TEXT("%.2f"), Value) : TEXT("N/A");
+	return GetTelemetryStringByHandle(FTelemetryHandle(KeyRegistry->Find(Key)), bSuccess);
+}
+
+bool UUS_TelemetryManager::GetTelemetryBool(FName Key, bool& bSuccess) const
+{
+	FTelemetryValue Value;
+	bSuccess = GetTypedTelemetryValue(FTelemetryHandle(KeyRegistry->Find(Key)), Value);
+	return bSuccess && Value.AsBoolean();
+}
+
+int64 UUS_TelemetryManager::GetTelemetryInteger(FName Key, bool& bSuccess) const
+{
+	FTelemetryValue Value;
+	bSuccess = GetTypedTelemetryValue(FTelemetryHandle(KeyRegistry->Find(Key)), Value);
+	return bSuccess ? Value.AsInteger() : 0;
+}
+
+SIZE_T UUS_TelemetryManager::GetTelemetryAllocatedSize() const
+{
+	return KeyRegistry->GetAllocatedSize()
+		+ TimeSeriesStore.GetAllocatedSize()
+		+ RollupPyramid.GetAllocatedSize()
+		+ AlarmEngine.GetAllocatedSize()
+		+ StalenessIndex.GetAllocatedSize()
+		+ SubscriptionsBySlot.GetAllocatedSize();
 }
 
 FDateTime UUS_TelemetryManager::GetTelemetryTimestamp(FName Key) const
 {
-	const FDateTime* Timestamp = TelemetryTimestamps.Find(Key);
-	return Timestamp ? *Timestamp : FDateTime::MinValue();
+	return GetTelemetryTimestampByHandle(FTelemetryHandle(KeyRegistry->Find(Key)));
+}
+
+FTelemetryHandle UUS_TelemetryManager::RegisterTelemetryKey(FName Key)
+{
+	if (Key == NAME_None)
+	{
+		return FTelemetryHandle();
+	}
+	const int32 Slot = KeyRegistry->FindOrAdd(Key);
+	TimeSeriesStore.EnsureSlots(Slot + 1);
+	RollupPyramid.EnsureSlots(Slot + 1);
+	AlarmEngine.EnsureSlots(Slot + 1);
+	StalenessIndex.EnsureSlots(Slot + 1);
+	return FTelemetryHandle(Slot);
+}
+
+float UUS_TelemetryManager::GetTelemetryValueByHandle(FTelemetryHandle Handle, bool& bSuccess) const
+{
+	float Value = 0.0f;
+	int64 TimestampTicks = 0;
+	bSuccess = TimeSeriesStore.GetLatest(Handle.Index, Value, TimestampTicks);
+	return bSuccess ? Value : 0.0f;
+}
+
+FString UUS_TelemetryManager::GetTelemetryStringByHandle(FTelemetryHandle Handle, bool& bSuccess) const
+{
+	FTelemetryValue Value;
+	bSuccess = GetTypedTelemetryValue(Handle, Value);
+	if (!bSuccess)
+	{
+		return TEXT("N/A");
+	}
+
+	const TArray<FString>* Labels = Value.GetType() == ETelemetryValueType::Enum ? EnumLabelsBySlot.Find(Handle.Index) : nullptr;
+	return Labels ? Value.ToString(*Labels) : Value.ToString();
+}
+
+bool UUS_TelemetryManager::GetTypedTelemetryValue(FTelemetryHandle Handle, FTelemetryValue& OutValue) const
+{
+	int64 TimestampTicks = 0;
+	return TimeSeriesStore.GetLatestValue(Handle.Index, OutValue, TimestampTicks);
+}
+
+void UUS_TelemetryManager::SetTelemetryEnumLabels(FName Key, const TArray<FString>& Labels)
+{
+	const int32 Slot = RegisterTelemetryKey(Key).Index;
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (Labels.Num() > 0)
+	{
+		EnumLabelsBySlot.Add(Slot, Labels);
+	}
+	else
+	{
+		EnumLabelsBySlot.Remove(Slot);
+	}
+}
+
+FTelemetryValue UUS_TelemetryManager::ResolveEnumLabel(int32 Slot, const FTelemetryValue& Value) const
+{
+	if (Value.GetType() != ETelemetryValueType::String || EnumLabelsBySlot.Num() == 0)
+	{
+		return Value;
+	}
+
+	const TArray<FString>* Labels = EnumLabelsBySlot.Find(Slot);
+	if (!Labels)
+	{
+		return Value;
+	}
+
+	// Compared against the value's own text; runs per sample, so no FString is built
+	int32 Ordinal = INDEX_NONE;
+	Value.VisitString([Labels, &Ordinal](FStringView Text)
+	{
+		Ordinal = Labels->IndexOfByPredicate([Text](const FString& Label) { return FStringView(Label).Equals(Text, ESearchCase::IgnoreCase); });
+	});
+	return Ordinal != INDEX_NONE ? FTelemetryValue::MakeEnum(Ordinal) : Value;
+}
+
+FDateTime UUS_TelemetryManager::GetTelemetryTimestampByHandle(FTelemetryHandle Handle) const
+{
+	float Value = 0.0f;
+	int64 TimestampTicks = 0;
+	return TimeSeriesStore.GetLatest(Handle.Index, Value, TimestampTicks)
+		? FDateTime(TimestampTicks)
+		: FDateTime::MinValue();
+}
+
+bool UUS_TelemetryManager::GetTelemetryGraph(FName Key, float WindowSeconds, int32 PixelWidth, TArray<FTelemetryGraphPoint>& OutPoints) const
+{
+	OutPoints.Reset();
+
+	const int32 Slot = KeyRegistry->Find(Key);
+	if (Slot == INDEX_NONE || PixelWidth <= 0)
+	{
+		return false;
+	}
+
+	const int64 EndTicks = FDateTime::UtcNow().GetTicks();
+	const int64 StartTicks = EndTicks - FTimespan::FromSeconds(WindowSeconds).GetTicks();
+
+	TArray<FTelemetryRollupPyramid::FBucket> Buckets;
+	RollupPyramid.QueryForWidth(Slot, StartTicks, EndTicks, PixelWidth, Buckets);
+
+	OutPoints.Reserve(Buckets.Num());
+	for (const FTelemetryRollupPyramid::FBucket& Bucket : Buckets)
+	{
+		FTelemetryGraphPoint& Point = OutPoints.AddDefaulted_GetRef();
+		Point.Timestamp = FDateTime(Bucket.StartTicks);
+		Point.Min = Bucket.Min;
+		Point.Max = Bucket.Max;
+		Point.Mean = Bucket.Mean;
+	}
+
+	return OutPoints.Num() > 0;
+}
+
+int32 UUS_TelemetryManager::RegisterTelemetryWindow(FTelemetryHandle Handle, float WindowSeconds, float EwmaTimeConstantSeconds)
+{
+	if (!Handle.IsValid() || Handle.Index >= TimeSeriesStore.NumSlots() || WindowSeconds <= 0.0f)
+	{
+		return INDEX_NONE;
+	}
+
+	const double TimeConstant = EwmaTimeConstantSeconds > 0.0f ? EwmaTimeConstantSeconds : WindowSeconds;
+	const int32 ExistingWindows = RollingStats.NumWindows();
+	const int32 WindowId = RollingStats.AddWindow(Handle.Index, WindowSeconds, TimeConstant);
+
+	// New windows start from the retained history so they are meaningful immediately
+	if (WindowId == ExistingWindows)
+	{
+		const int64 SinceTicks = FDateTime::UtcNow().GetTicks() - FTimespan::FromSeconds(WindowSeconds).GetTicks();
+		TimeSeriesStore.ForEachSampleSince(Handle.Index, SinceTicks, [this, WindowId](int64 TimestampTicks, float Value)
+		{
+			RollingStats.AddSampleToWindow(WindowId, TimestampTicks, Value);
+		});
+	}
+
+	return WindowId;
+}
+
+bool UUS_TelemetryManager::GetTelemetryWindowStats(int32 WindowId, FTelemetryWindowStats& OutStats) const
+{
+	FTelemetryRollingStats::FResult Result;
+	if (!RollingStats.GetResult(WindowId, Result))
+	{
+		OutStats = FTelemetryWindowStats();
+		return false;
+	}
+
+	OutStats.Count = Result.Count;
+	OutStats.Sum = float(Result.Sum);
+	OutStats.Mean = float(Result.Mean);
+	OutStats.Min = Result.Min;
+	OutStats.Max = Result.Max;
+	OutStats.Variance = float(Result.Variance);
+	OutStats.StandardDeviation = float(FMath::Sqrt(Result.Variance));
+	OutStats.Ewma = float(Result.Ewma);
+	OutStats.RatePerSecond = float(Result.SlopePerSecond);
+	return Result.Count > 0;
+}
+
+float UUS_TelemetryManager::GetTelemetryWindowMean(int32 WindowId, bool& bSuccess) const
+{
+	FTelemetryRollingStats::FResult Result;
+	bSuccess = RollingStats.GetResult(WindowId, Result) && Result.Count > 0;
+	return bSuccess ? float(Result.Mean) : 0.0f;
+}
+
+float UUS_TelemetryManager::GetTelemetryRateOfChange(int32 WindowId, bool& bSuccess) const
+{
+	FTelemetryRollingStats::FResult Result;
+	bSuccess = RollingStats.GetResult(WindowId, Result) && Result.Count >= 2;
+	return bSuccess ? float(Result.SlopePerSecond) : 0.0f;
+}
+
+int32 UUS_TelemetryManager::SubscribeToTelemetry(TConstArrayView<FTelemetryHandle> Handles, FOnTelemetrySubscriptionUpdated Callback)
+{
+	if (!Callback.IsBound())
+	{
+		return INDEX_NONE;
+	}
+
+	int32 SubscriptionId = INDEX_NONE;
+	if (FreeSubscriptionIds.Num() > 0)
+	{
+		SubscriptionId = FreeSubscriptionIds.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		SubscriptionId = Subscriptions.AddDefaulted();
+		PendingSubscriptionFlags.Add(false);
+	}
+
+	FTelemetrySubscription& Subscription = Subscriptions[SubscriptionId];
+	Subscription.Callback = MoveTemp(Callback);
+	Subscription.Slots.Reset(Handles.Num());
+
+	for (const FTelemetryHandle& Handle : Handles)
+	{
+		if (!Handle.IsValid() || Subscription.Slots.Contains(Handle.Index))
+		{
+			continue;
+		}
+
+		if (SubscriptionsBySlot.Num() <= Handle.Index)
+		{
+			SubscriptionsBySlot.SetNum(Handle.Index + 1);
+		}
+		SubscriptionsBySlot[Handle.Index].Add(SubscriptionId);
+		Subscription.Slots.Add(Handle.Index);
+	}
+
+	return SubscriptionId;
+}
+
+void UUS_TelemetryManager::UnsubscribeFromTelemetry(int32 SubscriptionId)
+{
+	if (!Subscriptions.IsValidIndex(SubscriptionId) || !Subscriptions[SubscriptionId].Callback.IsBound())
+	{
+		return;
+	}
+
+	FTelemetrySubscription& Subscription = Subscriptions[SubscriptionId];
+	for (const int32 Slot : Subscription.Slots)
+	{
+		SubscriptionsBySlot[Slot].RemoveSingleSwap(SubscriptionId, EAllowShrinking::No);
+	}
+
+	Subscription.Slots.Reset();
+	Subscription.Callback.Unbind();
+	FreeSubscriptionIds.Add(SubscriptionId);
+}
+
+bool UUS_TelemetryManager::GetTelemetryHistory(FName Key, float WindowSeconds, TArray<float>& OutValues, TArray<FDateTime>& OutTimestamps) const
+{
+	OutValues.Reset();
+	OutTimestamps.Reset();
+
+	const int32 Slot = KeyRegistry->Find(Key);
+	if (TimeSeriesStore.NumSamples(Slot) == 0)
+	{
+		return false;
+	}
+
+	const int64 SinceTicks = (FDateTime::UtcNow() - FTimespan::FromSeconds(WindowSeconds)).GetTicks();
+	TimeSeriesStore.ForEachSampleSince(Slot, SinceTicks, [&OutValues, &OutTimestamps](int64 TimestampTicks, float Value)
+	{
+		OutValues.Add(Value);
+		OutTimestamps.Add(FDateTime(TimestampTicks));
+	});
+
+	return true;
+}
+
+void UUS_TelemetryManager::SetAlarmThresholds(FTelemetryHandle Handle, float WarningThreshold, float CriticalThreshold, float Hysteresis, bool bLowerIsBetter)
+{
+	// The engine's "low is bad" is the inverse of "lower is better"
+	AlarmEngine.SetThresholds(Handle.Index, WarningThreshold, CriticalThreshold, Hysteresis, !bLowerIsBetter);
+	bAlarmThresholdsDirty = true;
+}
+
+void UUS_TelemetryManager::ClearAlarmThresholds(FTelemetryHandle Handle)
+{
+	AlarmEngine.ClearThresholds(Handle.Index);
+	bAlarmThresholdsDirty = true;
+}
+
+bool UUS_TelemetryManager::RegisterAlarmThresholds(FTelemetryHandle Handle, float WarningThreshold, float CriticalThreshold, float Hysteresis, bool bLowerIsBetter)
+{
+	if (!Handle.IsValid())
+	{
+		return false;
+	}
+
+	FAlarmThresholdRegistration* Registration = AlarmThresholdRegistrations.Find(Handle.Index);
+	if (!Registration)
+	{
+		AlarmThresholdRegistrations.Add(Handle.Index, { WarningThreshold, CriticalThreshold, Hysteresis, bLowerIsBetter, 1 });
+		SetAlarmThresholds(Handle, WarningThreshold, CriticalThreshold, Hysteresis, bLowerIsBetter);
+		return true;
+	}
+
+	++Registration->NumRegistrants;
+
+	// One set of thresholds per key: keep the armed ones rather than letting the last registrant win
+	const bool bSame = Registration->WarningThreshold == WarningThreshold && Registration->CriticalThreshold == CriticalThreshold
+		&& Registration->Hysteresis == Hysteresis && Registration->bLowerIsBetter == bLowerIsBetter;
+	if (!bSame)
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry key %s: conflicting alarm thresholds (warning %g, critical %g) ignored, keeping warning %g, critical %g"),
+			*KeyRegistry->GetKey(Handle.Index).ToString(), WarningThreshold, CriticalThreshold, Registration->WarningThreshold, Registration->CriticalThreshold);
+	}
+	return bSame;
+}
+
+void UUS_TelemetryManager::UnregisterAlarmThresholds(FTelemetryHandle Handle)
+{
+	FAlarmThresholdRegistration* Registration = AlarmThresholdRegistrations.Find(Handle.Index);
+	if (Registration && --Registration->NumRegistrants <= 0)
+	{
+		AlarmThresholdRegistrations.Remove(Handle.Index);
+		ClearAlarmThresholds(Handle);
+	}
+}
+
+int32 UUS_TelemetryManager::BindTelemetryToPrimitive(FTelemetryHandle Handle, UPrimitiveComponent* Primitive, int32 CustomDataIndex, float IntensityMin, float IntensityMax)
+{
+	if (!Handle.IsValid() || Handle.Index >= TimeSeriesStore.NumSlots() || !Primitive)
+	{
+		return INDEX_NONE;
+	}
+
+	FTelemetryPrimitiveBindings::FBindingSettings Settings;
+	Settings.Primitive = Primitive;
+	Settings.DataIndex = CustomDataIndex;
+	Settings.IntensityMin = IntensityMin;
+	Settings.IntensityMax = IntensityMax;
+	return PrimitiveBindings.Add(Handle.Index, Settings);
+}
+
+void UUS_TelemetryManager::UnbindTelemetryFromPrimitive(int32 BindingId)
+{
+	PrimitiveBindings.Remove(BindingId);
+}
+
+void UUS_TelemetryManager::EvaluateAlarms()
+{
+	bAlarmThresholdsDirty = false;
+
+	AlarmEngineTransitions.Reset();
+	AlarmEngine.Evaluate(AlarmEngineTransitions);
+
+	AlarmTransitions.Reset(AlarmEngineTransitions.Num());
+	for (const FTelemetryAlarmEngine::FTransition& EngineTransition : AlarmEngineTransitions)
+	{
+		FTelemetryAlarmTransition& Transition = AlarmTransitions.AddDefaulted_GetRef();
+		Transition.Handle = FTelemetryHandle(EngineTransition.Slot);
+		Transition.Key = KeyRegistry->GetKey(EngineTransition.Slot);
+		Transition.PreviousState = ETelemetryAlarmState(EngineTransition.OldState);
+		Transition.NewState = ETelemetryAlarmState(EngineTransition.NewState);
+
+		// Threshold changes can recolor keys that received no data this frame
+		PrimitiveBindings.MarkSlotDirty(EngineTransition.Slot);
+	}
+
+	if (AlarmTransitions.Num() > 0)
+	{
+		OnAlarmTransitions.Broadcast(AlarmTransitions);
+	}
+}
+
+void UUS_TelemetryManager::SetReplaySpeed(float Speed)
+{
+	if (ReplaySource)
+	{
+		ReplaySource->SetSpeed(Speed);
+	}
+}
+
+void UUS_TelemetryManager::SetReplayPaused(bool bPaused)
+{
+	if (ReplaySource)
+	{
+		ReplaySource->SetPaused(bPaused);
+	}
+}
+
+void UUS_TelemetryManager::SeekReplay(FDateTime Time)
+{
+	if (ReplaySource)
+	{
+		ReplaySource->SeekTo(Time.GetTicks());
+	}
+}
+
+FDateTime UUS_TelemetryManager::GetReplayPosition() const
+{
+	return ReplaySource ? FDateTime(ReplaySource->GetPlayheadTicks()) : FDateTime::MinValue();
+}
+
+void UUS_TelemetryManager::GetReplayRange(FDateTime& OutStart, FDateTime& OutEnd) const
+{
+	OutStart = ReplaySource ? FDateTime(ReplaySource->GetStartTicks()) : FDateTime::MinValue();
+	OutEnd = ReplaySource ? FDateTime(ReplaySource->GetEndTicks()) : FDateTime::MinValue();
 }
 
 void UUS_TelemetryManager::SetMockDataMode(bool bEnabled)
@@ -95,37 +590,422 @@ void UUS_TelemetryManager::SetMockDataMode(bool bEnabled)
 	}
 }
 
-void UUS_TelemetryManager::PollTelemetryEndpoints()
+void UUS_TelemetryManager::CreateTelemetrySources(FTelemetryIngestWorker& Worker)
 {
-	// TODO: Implement HTTP requests to configured endpoints
-	// For now, just use mock data
+	FTelemetryMockSource::FSettings MockSettings;
+	MockSettings.Seed = MockSeed;
+	MockSettings.TimeScale = MockTimeScale;
+	MockSettings.FaultsPerKeyPerDay = MockFaultsPerKeyPerDay;
+
 	if (bMockDataMode)
 	{
-		GenerateMockData();
+		MockSettings.NumKeys = MockKeyCount;
+		MockSettings.TargetSamplesPerSecond = MockTargetSamplesPerSecond > 0.0f
+			? MockTargetSamplesPerSecond
+			: MockKeyCount / FMath::Max(0.01f, MockUpdateInterval);
+
+		Worker.AddSource(MakeShared<FTelemetryMockSource>(MockSettings));
+		return;
+	}
+
+	// All REST endpoints share one poller so requests can be batched per host
+	TSharedRef<FTelemetryRestPoller> RestPoller = MakeShared<FTelemetryRestPoller>(KeyRegistry.ToSharedRef(), IngestQueue.ToSharedRef(), MaxConcurrentRestRequests);
+	RestPoller->SetEndpointHealth(EndpointHealth.ToSharedRef());
+
+	// The worker outlives the poller's requests: Stop cancels them before the thread exits
+	FTelemetryIngestWorker* WorkerToWake = &Worker;
+	RestPoller->SetWakeCallback([WorkerToWake]() { WorkerToWake->Wake(); });
+
+	for (const FTelemetryEndpoint& Endpoint : TelemetryEndpoints)
+	{
+		if (!Endpoint.bEnabled)
+		{
+			continue;
+		}
+
+		switch (Endpoint.SourceType)
+		{
+		case ETelemetrySourceType::Mock:
+			// Endpoint mocks keep the five homestead keys at the endpoint's poll interval
+			MockSettings.TargetSamplesPerSecond = MockSettings.NumKeys / FMath::Max(0.01f, Endpoint.PollInterval);
+			Worker.AddSource(MakeShared<FTelemetryMockSource>(MockSettings));
+			break;
+
+		case ETelemetrySourceType::MQTT:
+		{
+			FTelemetryMqttClient::FSettings Settings;
+			if (!FTelemetryMqttClient::ParseBrokerUrl(Endpoint.EndpointURL, Settings))
+			{
+				UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry endpoint %s: invalid MQTT URL '%s'"), *Endpoint.EndpointId.ToString(), *Endpoint.EndpointURL);
+				break;
+			}
+
+			Settings.QoS = uint8(FMath::Clamp(Endpoint.MqttQoS, 0, 1));
+			Settings.bUseMqtt5 = Endpoint.bUseMqtt5;
+			for (const TPair<FString, FName>& Mapping : Endpoint.KeyMappings)
+			{
+				Settings.TopicMappings.Emplace(Mapping.Key, Mapping.Value);
+			}
+
+			Settings.EndpointId = Endpoint.EndpointId;
+
+			TSharedRef<FTelemetryMqttClient> MqttClient = MakeShared<FTelemetryMqttClient>(Settings);
+			MqttClient->SetEndpointHealth(EndpointHealth.ToSharedRef());
+			Worker.AddSource(MqttClient);
+			break;
+		}
+
+		case ETelemetrySourceType::REST_API:
+		{
+			FTelemetryRestPoller::FEndpointSettings Settings;
+			Settings.EndpointId = Endpoint.EndpointId;
+			Settings.Url = Endpoint.EndpointURL;
+			Settings.PollInterval = Endpoint.PollInterval;
+			for (const TPair<FString, FName>& Mapping : Endpoint.KeyMappings)
+			{
+				Settings.FieldMappings.Emplace(Mapping.Key, Mapping.Value);
+			}
+
+			RestPoller->AddEndpoint(Settings);
+			break;
+		}
+
+		case ETelemetrySourceType::Replay:
+		{
+			if (ReplaySource.IsValid())
+			{
+				UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry endpoint %s: only one replay can run at a time"), *Endpoint.EndpointId.ToString());
+				break;
+			}
+
+			const FString Directory = Endpoint.EndpointURL.IsEmpty()
+				? FPaths::ProjectSavedDir() / TEXT("Telemetry")
+				: FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir(), Endpoint.EndpointURL);
+
+			ReplaySource = MakeShared<FTelemetryReplaySource>(KeyRegistry.ToSharedRef(), Directory, Endpoint.ReplaySpeed);
+			Worker.AddSource(ReplaySource.ToSharedRef());
+			break;
+		}
+
+		case ETelemetrySourceType::Database:
+		default:
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry endpoint %s: source type %s is not supported, skipping"), *Endpoint.EndpointId.ToString(), *UEnum::GetValueAsString(Endpoint.SourceType));
+			break;
+		}
+	}
+
+	if (RestPoller->NumEndpoints() > 0)
+	{
+		Worker.AddSource(RestPoller);
+	}
+}
+
+void UUS_TelemetryManager::DrainIngestQueue()
+{
+	HOMESTEAD_SCOPE(TelemetryDrain);
+
+	IngestQueue->Drain([this](TConstArrayView<FTelemetrySample> Batch)
+	{
+		// Keys resolved by ingest threads since the last batch need rings first
+		TimeSeriesStore.EnsureSlots(KeyRegistry->Num());
+		RollupPyramid.EnsureSlots(KeyRegistry->Num());
+		AlarmEngine.EnsureSlots(KeyRegistry->Num());
+		StalenessIndex.EnsureSlots(KeyRegistry->Num());
+		ChangedSlotFlags.SetNum(TimeSeriesStore.NumSlots(), false);
+
+		for (const FTelemetrySample& Sample : Batch)
+		{
+			// Confirmed unchanged: fresh again, but there is nothing to commit or notify
+			if (Sample.bKeepAlive)
+			{
+				if (StalenessIndex.Touch(Sample.Slot, Sample.TimestampTicks))
+				{
+					TouchedSlots.Add(Sample.Slot);
+				}
+				continue;
+			}
+
+			const FTelemetryValue Value = ResolveEnumLabel(Sample.Slot, Sample.Value);
+			if (!TimeSeriesStore.Append(Sample.Slot, Sample.TimestampTicks, Value))
+			{
+				continue;
+			}
+
+			// Status text has no numeric projection to aggregate or alarm on
+			if (Value.IsNumeric())
+			{
+				const float Number = Value.AsFloat();
+				RollupPyramid.AddSample(Sample.Slot, Sample.TimestampTicks, Number);
+				RollingStats.AddSample(Sample.Slot, Sample.TimestampTicks, Number);
+				AlarmEngine.SetValue(Sample.Slot, Number);
+			}
+			StalenessIndex.RecordSample(Sample.Slot, Sample.TimestampTicks);
+			++CommittedSampleCount;
+
+			// Replayed samples are already on disk and mock samples must never warm-start as real history
+			if (SegmentLog && !Sample.bReplayed && !Sample.bSimulated)
+			{
+				PersistBatch.Add({ Sample.Slot, false, false, false, Sample.TimestampTicks, Value });
+			}
+
+			if (!ChangedSlotFlags[Sample.Slot])
+			{
+				ChangedSlotFlags[Sample.Slot] = true;
+				ChangedSlots.Add(Sample.Slot);
+			}
+		}
+	});
+
+	// One clock read per frame for every time-based structure
+	const int64 NowTicks = FDateTime::UtcNow().GetTicks();
+
+	// Windows of quiet keys still age out
+	RollingStats.ExpireOlderThan(NowTicks);
+	UpdateStaleness(NowTicks);
+	UpdateOfflineState();
+
+	if (ChangedSlots.Num() > 0 || bAlarmThresholdsDirty)
+	{
+		EvaluateAlarms();
+	}
+
+	if (SegmentLog && PersistBatch.Num() > 0)
+	{
+		SegmentLog->Enqueue(MoveTemp(PersistBatch));
+		PersistBatch.Reset();
+	}
+
+	// One notification per changed key, carrying its latest value
+	for (const int32 Slot : ChangedSlots)
+	{
+		ChangedSlotFlags[Slot] = false;
+		PrimitiveBindings.MarkSlotDirty(Slot);
+		QueueSubscribers(Slot);
+
+		float Value = 0.0f;
+		int64 TimestampTicks = 0;
+		if (TimeSeriesStore.GetLatest(Slot, Value, TimestampTicks))
+		{
+			OnTelemetryDataUpdated(KeyRegistry->GetKey(Slot), Value);
+		}
+	}
+	ChangedSlots.Reset();
+
+	// All overlay writes of the frame in one pass
+	PrimitiveBindings.Flush(TimeSeriesStore, AlarmEngine);
+
+	// One callback per subscriber, however many of its keys changed
+	for (const int32 SubscriptionId : PendingSubscriptionIds)
+	{
+		PendingSubscriptionFlags[SubscriptionId] = false;
+
+		// Copy: the callback may subscribe again and reallocate Subscriptions
+		const FOnTelemetrySubscriptionUpdated Callback = Subscriptions[SubscriptionId].Callback;
+		Callback.ExecuteIfBound();
+	}
+	PendingSubscriptionIds.Reset();
+}
+
+void UUS_TelemetryManager::QueueSubscribers(int32 Slot)
+{
+	if (!SubscriptionsBySlot.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	for (const int32 SubscriptionId : SubscriptionsBySlot[Slot])
+	{
+		if (!PendingSubscriptionFlags[SubscriptionId])
+		{
+			PendingSubscriptionFlags[SubscriptionId] = true;
+			PendingSubscriptionIds.Add(SubscriptionId);
+		}
+	}
+}
+
+void UUS_TelemetryManager::UpdateStaleness(int64 NowTicks)
+{
+	StalenessIndexTransitions.Reset();
+	for (const int32 Slot : ChangedSlots)
+	{
+		StalenessIndex.Reschedule(Slot, NowTicks, StalenessIndexTransitions);
+	}
+	for (const int32 Slot : TouchedSlots)
+	{
+		StalenessIndex.Reschedule(Slot, NowTicks, StalenessIndexTransitions);
+	}
+	TouchedSlots.Reset();
+	StalenessIndex.Expire(NowTicks, StalenessIndexTransitions);
+
+	StalenessTransitions.Reset(StalenessIndexTransitions.Num());
+	for (const FTelemetryStalenessIndex::FTransition& IndexTransition : StalenessIndexTransitions)
+	{
+		FTelemetryStalenessTransition& Transition = StalenessTransitions.AddDefaulted_GetRef();
+		Transition.Handle = FTelemetryHandle(IndexTransition.Slot);
+		Transition.Key = KeyRegistry->GetKey(IndexTransition.Slot);
+		Transition.bStale = IndexTransition.bStale;
+
+		// Keys going stale have no new data, but their displays must still update
+		QueueSubscribers(IndexTransition.Slot);
+	}
+
+	if (StalenessTransitions.Num() > 0)
+	{
+		OnStalenessTransitions.Broadcast(StalenessTransitions);
+	}
+}
+
+void UUS_TelemetryManager::UpdateOfflineState()
+{
+	const uint32 Revision = EndpointHealth->GetRevision();
+	if (Revision != EndpointHealthRevision)
+	{
+		EndpointHealthRevision = Revision;
+
+		TArray<FTelemetryEndpointHealth::FSnapshot> Snapshots;
+		EndpointHealth->GetSnapshots(Snapshots);
+		NumEndpoints = Snapshots.Num();
+		NumFailingEndpoints = 0;
+		for (const FTelemetryEndpointHealth::FSnapshot& Snapshot : Snapshots)
+		{
+			NumFailingEndpoints += Snapshot.ConsecutiveFailures > 0 ? 1 : 0;
+		}
+	}
+
+	const bool bAllEndpointsFailing = NumEndpoints > 0 && NumFailingEndpoints == NumEndpoints;
+	const bool bAllKeysStale = StalenessIndex.NumTracked() > 0 && StalenessIndex.NumFresh() == 0;
+	const bool bOffline = bTelemetryActive && (bAllEndpointsFailing || bAllKeysStale);
+
+	if (bOffline != bTelemetryOffline)
+	{
+		bTelemetryOffline = bOffline;
+		UE_LOG(LogHomesteadTwin, Log, TEXT("Telemetry is %s"), bOffline ? TEXT("offline") : TEXT("back online"));
+		OnOfflineChanged.Broadcast(bOffline);
 	}
 }
 
-void UUS_TelemetryManager::GenerateMockData()
+void UUS_TelemetryManager::SetTelemetryStaleTimeout(FTelemetryHandle Handle, float Seconds)
 {
-	// Generate randomized mock telemetry data for testing
-	TArray<FName> MockKeys = {
-		FName("PowerUsage"),
-		FName("BatteryCharge"),
-		FName("SolarProduction"),
-		FName("Temperature"),
-		FName("Humidity")
-	};
+	StalenessIndex.EnsureSlots(KeyRegistry->Num());
+	StalenessIndex.SetStaleTimeout(Handle.Index, Seconds);
+}
 
-	FDateTime Now = FDateTime::UtcNow();
+void UUS_TelemetryManager::RegisterStaleTimeout(FTelemetryHandle Handle, float Seconds)
+{
+	if (!Handle.IsValid() || Seconds <= 0.0f)
+	{
+		return;
+	}
+
+	TArray<float>& Timeouts = StaleTimeoutRegistrations.FindOrAdd(Handle.Index);
+	Timeouts.Add(Seconds);
+	SetTelemetryStaleTimeout(Handle, FMath::Min(Timeouts));
+}
 
-	for (const FName& Key : MockKeys)
+void UUS_TelemetryManager::UnregisterStaleTimeout(FTelemetryHandle Handle, float Seconds)
+{
+	TArray<float>* Timeouts = StaleTimeoutRegistrations.Find(Handle.Index);
+	if (!Timeouts || Timeouts->RemoveSingleSwap(Seconds) == 0)
 	{
-		// Generate random values
-		float Value = FMath::FRandRange(0.0f, 100.0f);
+		return;
+	}
 
-		TelemetryDataCache.Add(Key, Value);
-		TelemetryTimestamps.Add(Key, Now);
+	if (Timeouts->Num() == 0)
+	{
+		StaleTimeoutRegistrations.Remove(Handle.Index);
+		SetTelemetryStaleTimeout(Handle, 0.0f);
+	}
+	else
+	{
+		SetTelemetryStaleTimeout(Handle, FMath::Min(*Timeouts));
+	}
+}
+
+void UUS_TelemetryManager::GetTelemetryEndpointStatus(TArray<FTelemetryEndpointStatus>& OutStatus) const
+{
+	TArray<FTelemetryEndpointHealth::FSnapshot> Snapshots;
+	EndpointHealth->GetSnapshots(Snapshots);
+
+	OutStatus.Reset(Snapshots.Num());
+	for (const FTelemetryEndpointHealth::FSnapshot& Snapshot : Snapshots)
+	{
+		FTelemetryEndpointStatus& Status = OutStatus.AddDefaulted_GetRef();
+		Status.EndpointId = Snapshot.EndpointId;
+		Status.bHealthy = Snapshot.bHealthy;
+		Status.ConsecutiveFailures = Snapshot.ConsecutiveFailures;
+		Status.BackoffSeconds = float(Snapshot.BackoffSeconds);
+		Status.LastSuccess = Snapshot.LastSuccessTicks > 0 ? FDateTime(Snapshot.LastSuccessTicks) : FDateTime::MinValue();
+		Status.LastFailure = Snapshot.LastFailureTicks > 0 ? FDateTime(Snapshot.LastFailureTicks) : FDateTime::MinValue();
+		Status.LastError = Snapshot.LastError;
+	}
+}
+
+void UUS_TelemetryManager::WarmStartFromLog()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 Capacity = TimeSeriesStore.GetCapacityPerKey();
+
+	// The log is read newest first, so each key collects its newest samples in reverse and
+	// reading stops once every key it holds has a full ring
+	TMap<FName, TArray<TPair<int64, FTelemetryValue>>> Recovered;
+	SegmentLog->Recover(
+		[&Recovered, Capacity](FName Key)
+		{
+			const TArray<TPair<int64, FTelemetryValue>>* Samples = Recovered.Find(Key);
+			return !Samples || Samples->Num() < Capacity;
+		},
+		[&Recovered, Capacity](FName Key, int64 TimestampTicks, const FTelemetryValue& Value)
+		{
+			TArray<TPair<int64, FTelemetryValue>>& Samples = Recovered.FindOrAdd(Key);
 
-		OnTelemetryDataUpdated(Key, Value);
+			// Anything newer than what is already kept is a duplicate left by an interrupted compaction
+			if (Samples.Num() < Capacity && (Samples.Num() == 0 || TimestampTicks <= Samples.Last().Key))
+			{
+				Samples.Emplace(TimestampTicks, Value);
+			}
+		});
+
+	int64 NumSamples = 0;
+	TArray<int32> RecoveredSlots;
+	RecoveredSlots.Reserve(Recovered.Num());
+	for (const TPair<FName, TArray<TPair<int64, FTelemetryValue>>>& Pair : Recovered)
+	{
+		const int32 Slot = RegisterTelemetryKey(Pair.Key).Index;
+		RecoveredSlots.Add(Slot);
+
+		for (int32 Index = Pair.Value.Num() - 1; Index >= 0; --Index)
+		{
+			const int64 TimestampTicks = Pair.Value[Index].Key;
+			const FTelemetryValue& Value = Pair.Value[Index].Value;
+			if (!TimeSeriesStore.Append(Slot, TimestampTicks, Value))
+			{
+				continue;
+			}
+
+			if (Value.IsNumeric())
+			{
+				const float Number = Value.AsFloat();
+				RollupPyramid.AddSample(Slot, TimestampTicks, Number);
+				RollingStats.AddSample(Slot, TimestampTicks, Number);
+				AlarmEngine.SetValue(Slot, Number);
+			}
+			StalenessIndex.RecordSample(Slot, TimestampTicks);
+			++NumSamples;
+		}
+	}
+
+	// Learned intervals and last-sample times carry over; keys whose data is already too old start stale
+	const int64 NowTicks = FDateTime::UtcNow().GetTicks();
+	StalenessIndexTransitions.Reset();
+	for (const int32 Slot : RecoveredSlots)
+	{
+		StalenessIndex.Reschedule(Slot, NowTicks, StalenessIndexTransitions);
+	}
+	StalenessIndexTransitions.Reset();
+
+	if (NumSamples > 0)
+	{
+		UE_LOG(LogHomesteadTwin, Log, TEXT("Telemetry: warm-started %lld samples for %d keys from disk in %.1f ms"),
+			NumSamples, KeyRegistry->Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
 	}
 }
@@ -4,8 +4,22 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "../Telemetry/TelemetryAlarmEngine.h"
+#include "../Telemetry/TelemetryEndpointHealth.h"
+#include "../Telemetry/TelemetryIngest.h"
+#include "../Telemetry/TelemetryKeyRegistry.h"
+#include "../Telemetry/TelemetryPrimitiveBindings.h"
+#include "../Telemetry/TelemetryRollingStats.h"
+#include "../Telemetry/TelemetryRollupPyramid.h"
+#include "../Telemetry/TelemetrySegmentLog.h"
+#include "../Telemetry/TelemetryStalenessIndex.h"
+#include "../Telemetry/TelemetryTimeSeriesStore.h"
 #include "US_TelemetryManager.generated.h"
 
+class FTelemetryReplaySource;
+class UPrimitiveComponent;
+
 /**
  * ETelemetrySourceType
  *
@@ -17,7 +31,8 @@ enum class ETelemetrySourceType : uint8
 	REST_API    UMETA(DisplayName = "REST API"),
 	MQTT        UMETA(DisplayName = "MQTT Topic"),
 	Database    UMETA(DisplayName = "Database Query"),
-	Mock        UMETA(DisplayName = "Mock/Dummy Data")
+	Mock        UMETA(DisplayName = "Mock/Dummy Data"),
+	Replay      UMETA(DisplayName = "Recorded Replay")
 };
 
 /**
@@ -38,7 +53,7 @@ struct FTelemetryEndpoint
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Telemetry")
 	ETelemetrySourceType SourceType;
 
-	/** URL or connection string */
+	/** URL or connection string (Replay: recording folder, relative to Saved/; empty = Saved/Telemetry) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Telemetry")
 	FString EndpointURL;
 
@@ -50,15 +65,269 @@ struct FTelemetryEndpoint
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Telemetry")
 	bool bEnabled;
 
+	/**
+	 * Source path -> telemetry key.
+	 * MQTT: topic filter (+ and # wildcards); a None key on a wildcard filter uses the topic itself as key.
+	 * REST_API: dotted JSON field path, array elements by index (e.g. "inverters.0.power").
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Telemetry")
+	TMap<FString, FName> KeyMappings;
+
+	/** MQTT subscription QoS (0 or 1) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Telemetry|MQTT", meta = (ClampMin = "0", ClampMax = "1"))
+	int32 MqttQoS;
+
+	/** Use MQTT 5 instead of 3.1.1 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Telemetry|MQTT")
+	bool bUseMqtt5;
+
+	/** Initial playback speed for Replay endpoints (1 = real time) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Telemetry|Replay", meta = (ClampMin = "0"))
+	float ReplaySpeed;
+
 	FTelemetryEndpoint()
 		: EndpointId(NAME_None)
 		, SourceType(ETelemetrySourceType::Mock)
 		, EndpointURL(TEXT(""))
 		, PollInterval(5.0f)
 		, bEnabled(true)
+		, MqttQoS(0)
+		, bUseMqtt5(false)
+		, ReplaySpeed(1.0f)
+	{}
+};
+
+/**
+ * FTelemetryHandle
+ *
+ * Stable handle to a registered telemetry key (dense slot index).
+ * Resolve once with RegisterTelemetryKey and read by handle every frame.
+ */
+USTRUCT(BlueprintType)
+struct FTelemetryHandle
+{
+	GENERATED_BODY()
+
+	/** Dense slot index in the telemetry store (INDEX_NONE = invalid) */
+	UPROPERTY()
+	int32 Index;
+
+	FTelemetryHandle()
+		: Index(INDEX_NONE)
+	{}
+
+	explicit FTelemetryHandle(int32 InIndex)
+		: Index(InIndex)
+	{}
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FTelemetryHandle& Other) const { return Index == Other.Index; }
+	bool operator!=(const FTelemetryHandle& Other) const { return Index != Other.Index; }
+
+	friend uint32 GetTypeHash(const FTelemetryHandle& Handle) { return ::GetTypeHash(Handle.Index); }
+};
+
+/**
+ * ETelemetryAlarmState
+ *
+ * Alarm state of a telemetry key (ordered by severity).
+ */
+UENUM(BlueprintType)
+enum class ETelemetryAlarmState : uint8
+{
+	Normal      UMETA(DisplayName = "Normal"),
+	Warning     UMETA(DisplayName = "Warning"),
+	Critical    UMETA(DisplayName = "Critical")
+};
+
+/**
+ * FTelemetryAlarmTransition
+ *
+ * A key whose alarm state changed during the last ingest batch.
+ */
+USTRUCT(BlueprintType)
+struct FTelemetryAlarmTransition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FTelemetryHandle Handle;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FName Key;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	ETelemetryAlarmState PreviousState;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	ETelemetryAlarmState NewState;
+
+	FTelemetryAlarmTransition()
+		: Key(NAME_None)
+		, PreviousState(ETelemetryAlarmState::Normal)
+		, NewState(ETelemetryAlarmState::Normal)
+	{}
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTelemetryAlarmTransitions, const TArray<FTelemetryAlarmTransition>&, Transitions);
+
+/**
+ * FTelemetryStalenessTransition
+ *
+ * A key that missed its expected update (stale) or received data again (fresh).
+ */
+USTRUCT(BlueprintType)
+struct FTelemetryStalenessTransition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FTelemetryHandle Handle;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FName Key;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	bool bStale;
+
+	FTelemetryStalenessTransition()
+		: Key(NAME_None)
+		, bStale(false)
+	{}
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTelemetryStalenessTransitions, const TArray<FTelemetryStalenessTransition>&, Transitions);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTelemetryOfflineChanged, bool, bOffline);
+
+/**
+ * FTelemetryEndpointStatus
+ *
+ * Health of a REST endpoint or MQTT broker.
+ */
+USTRUCT(BlueprintType)
+struct FTelemetryEndpointStatus
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FName EndpointId;
+
+	/** Last contact succeeded */
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	bool bHealthy;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	int32 ConsecutiveFailures;
+
+	/** Wait before the next attempt (0 = not backing off) */
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float BackoffSeconds;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FDateTime LastSuccess;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FDateTime LastFailure;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FString LastError;
+
+	FTelemetryEndpointStatus()
+		: EndpointId(NAME_None)
+		, bHealthy(false)
+		, ConsecutiveFailures(0)
+		, BackoffSeconds(0.0f)
+	{}
+};
+
+/**
+ * FTelemetryGraphPoint
+ *
+ * One aggregated point of a telemetry graph (min/max/mean over a rollup bucket).
+ */
+USTRUCT(BlueprintType)
+struct FTelemetryGraphPoint
+{
+	GENERATED_BODY()
+
+	/** Start of the bucket (UTC) */
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	FDateTime Timestamp;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Min;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Max;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Mean;
+
+	FTelemetryGraphPoint()
+		: Min(0.0f)
+		, Max(0.0f)
+		, Mean(0.0f)
+	{}
+};
+
+/**
+ * FTelemetryWindowStats
+ *
+ * Rolling-window aggregates of a key (see RegisterTelemetryWindow).
+ */
+USTRUCT(BlueprintType)
+struct FTelemetryWindowStats
+{
+	GENERATED_BODY()
+
+	/** Samples inside the window */
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	int32 Count;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Sum;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Mean;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Min;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Max;
+
+	/** Population variance */
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Variance;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float StandardDeviation;
+
+	/** Exponentially weighted moving average (time constant set at registration) */
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float Ewma;
+
+	/** Least-squares slope over the window (units per second) */
+	UPROPERTY(BlueprintReadOnly, Category = "Telemetry")
+	float RatePerSecond;
+
+	FTelemetryWindowStats()
+		: Count(0)
+		, Sum(0.0f)
+		, Mean(0.0f)
+		, Min(0.0f)
+		, Max(0.0f)
+		, Variance(0.0f)
+		, StandardDeviation(0.0f)
+		, Ewma(0.0f)
+		, RatePerSecond(0.0f)
 	{}
 };
 
+/** Native callback for a telemetry subscription (fires at most once per frame) */
+DECLARE_DELEGATE(FOnTelemetrySubscriptionUpdated);
+
 /**
  * UUS_TelemetryManager
  *
@@ -68,20 +337,40 @@ struct FTelemetryEndpoint
  * - Poll REST endpoints or subscribe to MQTT topics
  * - Cache telemetry data with timestamps
  * - Provide data to telemetry components
+ * - Notify subscribers once per frame when any of their keys changed
+ * - Evaluate alarm thresholds for every key and report state transitions
+ * - Flag keys that miss their expected update as stale and detect offline operation
+ * - Drive color overlays on bound primitives through Custom Primitive Data
  * - Support mock/dummy data mode for testing
  * - Handle connection failures gracefully (offline mode)
  *
  * Implementation Notes:
- * - Uses async HTTP requests or MQTT client library
- * - Data cached in memory with configurable retention
- * - Mock mode generates randomized test data
+ * - Sources (mock, REST, MQTT) run on FTelemetryIngestWorker, off the game thread
+ * - Decoded samples reach the game thread through a lock-free MPSC queue and are
+ *   committed in one batch per frame from Tick
+ * - Data cached in FTelemetryTimeSeriesStore: one fixed-size history ring per key,
+ *   sized by RetentionSamplesPerKey
+ * - Committed samples are persisted to an append-only segment log under Saved/Telemetry and
+ *   replayed into the store on Initialize, so history survives restarts
+ * - Long-range graphs read min/max/mean rollups from FTelemetryRollupPyramid instead of raw samples
+ * - Registered rolling windows (mean, min/max, variance, EWMA, slope) are updated at ingest, so
+ *   widgets read one precomputed number instead of scanning history
+ * - Mock mode generates seeded, deterministic waveforms (scales to 10k+ keys for load tests);
+ *   mock samples are never persisted, so they cannot warm-start as real history
+ * - Replay endpoints play a recorded log back at variable speed; replayed samples are not re-persisted
+ * - Staleness is a min-heap of per-key deadlines checked once per frame (one clock read for all
+ *   keys); stale/fresh changes notify the key's subscribers and are broadcast in bulk
+ * - Sources report endpoint health (failures, backoff) to a shared thread-safe table
  * - Designed for air-gap operation (no hard dependency on endpoints)
  */
 UCLASS()
-class HOMESTEADTWIN_API UUS_TelemetryManager : public UGameInstanceSubsystem
+class HOMESTEADTWIN_API UUS_TelemetryManager : public UGameInstanceSubsystem, public FTickableGameObject
 {
 	GENERATED_BODY()
 
+	/** Drives a private instance's ingest queue and drain directly */
+	friend class FTelemetryBenchmark;
+
 public:
 	UUS_TelemetryManager();
 
@@ -90,6 +379,14 @@ public:
 	virtual void Deinitialize() override;
 	// End USubsystem Interface
 
+	// Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return bTelemetryActive && !bDrainedByOwner; }
+	virtual bool IsTickableWhenPaused() const override { return true; }
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject Interface
+
 	/** Start telemetry polling */
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry")
 	void StartTelemetry();
@@ -102,18 +399,221 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
 	float GetTelemetryValue(FName Key, bool& bSuccess) const;
 
-	/** Get telemetry value as string */
+	/** Get telemetry value as display text (formatted from the typed value when called) */
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
 	FString GetTelemetryString(FName Key, bool& bSuccess) const;
 
+	/** Get a boolean telemetry value (numbers are true when non-zero) */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
+	bool GetTelemetryBool(FName Key, bool& bSuccess) const;
+
+	/** Get an integer telemetry value (exact for 64-bit counters) */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
+	int64 GetTelemetryInteger(FName Key, bool& bSuccess) const;
+
 	/** Get timestamp of last update for a key */
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
 	FDateTime GetTelemetryTimestamp(FName Key) const;
 
+	/** Resolve a key into a stable handle (registers the key if it has no data yet) */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry")
+	FTelemetryHandle RegisterTelemetryKey(FName Key);
+
+	/** Get telemetry value by handle */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
+	float GetTelemetryValueByHandle(FTelemetryHandle Handle, bool& bSuccess) const;
+
+	/** Get timestamp of last update by handle */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
+	FDateTime GetTelemetryTimestampByHandle(FTelemetryHandle Handle) const;
+
+	/**
+	 * Get telemetry value as display text by handle: floats with two decimals, integers,
+	 * true/false, enum labels or status text
+	 */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
+	FString GetTelemetryStringByHandle(FTelemetryHandle Handle, bool& bSuccess) const;
+
+	/** Get the latest value of a handle as stored (native, typed access) */
+	bool GetTypedTelemetryValue(FTelemetryHandle Handle, FTelemetryValue& OutValue) const;
+
+	/** Get the key a handle was registered for */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
+	FName GetTelemetryKeyForHandle(FTelemetryHandle Handle) const { return KeyRegistry->GetKey(Handle.Index); }
+
+	/**
+	 * Name the states of an enum key (e.g. a NetBotz sensor state or an inverter mode).
+	 * String samples matching a label (case-insensitive) are stored as its index, so the states
+	 * can drive thresholds, statistics and overlays; text displays show the label.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry")
+	void SetTelemetryEnumLabels(FName Key, const TArray<FString>& Labels);
+
+	/** Get the samples recorded for a key during the last WindowSeconds, oldest first */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry")
+	bool GetTelemetryHistory(FName Key, float WindowSeconds, TArray<float>& OutValues, TArray<FDateTime>& OutTimestamps) const;
+
+	/**
+	 * Get min/max/mean points covering the last WindowSeconds for a graph PixelWidth pixels wide.
+	 * Uses the coarsest rollup level that still yields about one point per pixel, so the cost is
+	 * independent of the window length.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry")
+	bool GetTelemetryGraph(FName Key, float WindowSeconds, int32 PixelWidth, TArray<FTelemetryGraphPoint>& OutPoints) const;
+
+	/** Get the rollup pyramid (native, multi-resolution history access) */
+	const FTelemetryRollupPyramid& GetRollupPyramid() const { return RollupPyramid; }
+
+	/**
+	 * Track rolling-window aggregates of a key over the last WindowSeconds, kept current at ingest.
+	 * The window is seeded from the retained history. EwmaTimeConstantSeconds <= 0 uses WindowSeconds.
+	 * Registering the same key/window/time constant again returns the same id.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Statistics")
+	int32 RegisterTelemetryWindow(FTelemetryHandle Handle, float WindowSeconds, float EwmaTimeConstantSeconds = 0.0f);
+
+	/** Get every aggregate of a registered window (O(1)) */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Statistics")
+	bool GetTelemetryWindowStats(int32 WindowId, FTelemetryWindowStats& OutStats) const;
+
+	/** Mean of a registered window, e.g. average PV production over the last 15 minutes */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Statistics")
+	float GetTelemetryWindowMean(int32 WindowId, bool& bSuccess) const;
+
+	/** Rate of change of a registered window (units per second), e.g. battery charge slope */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Statistics")
+	float GetTelemetryRateOfChange(int32 WindowId, bool& bSuccess) const;
+
+	/** Get the rolling-window aggregates (native access) */
+	const FTelemetryRollingStats& GetRollingStats() const { return RollingStats; }
+
+	/**
+	 * Subscribe to a set of handles. After each frame's drain, Callback fires once if any of
+	 * the handles received new data. Returns a subscription id for UnsubscribeFromTelemetry.
+	 */
+	int32 SubscribeToTelemetry(TConstArrayView<FTelemetryHandle> Handles, FOnTelemetrySubscriptionUpdated Callback);
+
+	/** Remove a subscription (safe to call from inside a subscription callback) */
+	void UnsubscribeFromTelemetry(int32 SubscriptionId);
+
+	/** Get the underlying time-series store (native, non-allocating history access) */
+	const FTelemetryTimeSeriesStore& GetTimeSeriesStore() const { return TimeSeriesStore; }
+
 	/** Check if telemetry system is running */
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
 	bool IsTelemetryActive() const { return bTelemetryActive; }
 
+	/**
+	 * Arm warning/critical thresholds for a key. With bLowerIsBetter the alarm rises as the value
+	 * climbs past the thresholds; otherwise as it falls below them. A raised state is held until
+	 * the value moves Hysteresis back past its threshold. One set of thresholds per key.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Alarms")
+	void SetAlarmThresholds(FTelemetryHandle Handle, float WarningThreshold, float CriticalThreshold, float Hysteresis, bool bLowerIsBetter);
+
+	/** Disarm the thresholds of a key */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Alarms")
+	void ClearAlarmThresholds(FTelemetryHandle Handle);
+
+	/**
+	 * Shared-key variant of SetAlarmThresholds for components: the first registrant's thresholds
+	 * arm the key and later ones are counted. A registrant asking for different thresholds gets a
+	 * warning and the existing ones (returns false). The key is disarmed when the last one unregisters.
+	 */
+	bool RegisterAlarmThresholds(FTelemetryHandle Handle, float WarningThreshold, float CriticalThreshold, float Hysteresis, bool bLowerIsBetter);
+
+	/** Drop one RegisterAlarmThresholds registration of a key */
+	void UnregisterAlarmThresholds(FTelemetryHandle Handle);
+
+	/** Current alarm state of a key */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Alarms")
+	ETelemetryAlarmState GetAlarmState(FTelemetryHandle Handle) const { return ETelemetryAlarmState(AlarmEngine.GetState(Handle.Index)); }
+
+	/**
+	 * Bind a key to a primitive's Custom Primitive Data. Every frame the key changes, the alarm
+	 * color (R, G, B) and the value normalized from [IntensityMin, IntensityMax] (A) are written
+	 * to CustomDataIndex..CustomDataIndex + 3 in one batched pass. Returns a binding id.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Alarms")
+	int32 BindTelemetryToPrimitive(FTelemetryHandle Handle, UPrimitiveComponent* Primitive, int32 CustomDataIndex, float IntensityMin, float IntensityMax);
+
+	/** Remove a primitive binding (its custom data keeps the last written values) */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Alarms")
+	void UnbindTelemetryFromPrimitive(int32 BindingId);
+
+	/** Transitions produced by the last evaluation (native, non-copying) */
+	const TArray<FTelemetryAlarmTransition>& GetLastAlarmTransitions() const { return AlarmTransitions; }
+
+	/** Fired once per ingest batch with only the keys whose alarm state changed */
+	UPROPERTY(BlueprintAssignable, Category = "Homestead Twin|Telemetry|Alarms")
+	FOnTelemetryAlarmTransitions OnAlarmTransitions;
+
+	/** Whether a key missed its expected update (keys without data are stale) */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Health")
+	bool IsTelemetryStale(FTelemetryHandle Handle) const { return StalenessIndex.IsStale(Handle.Index); }
+
+	/**
+	 * Seconds without data after which a key is stale. Keys without a timeout use
+	 * StaleUpdateMultiplier times their observed update interval. <= 0 restores that default.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Health")
+	void SetTelemetryStaleTimeout(FTelemetryHandle Handle, float Seconds);
+
+	/**
+	 * Shared-key variant of SetTelemetryStaleTimeout for components: the key uses the shortest
+	 * timeout of all its registrants, so no registrant sees it fresh for longer than it asked
+	 */
+	void RegisterStaleTimeout(FTelemetryHandle Handle, float Seconds);
+
+	/** Drop one RegisterStaleTimeout registration (the default applies again after the last one) */
+	void UnregisterStaleTimeout(FTelemetryHandle Handle, float Seconds);
+
+	/** Staleness changes of the last frame (native, non-copying) */
+	const TArray<FTelemetryStalenessTransition>& GetLastStalenessTransitions() const { return StalenessTransitions; }
+
+	/** Fired once per frame with every key that went stale or fresh */
+	UPROPERTY(BlueprintAssignable, Category = "Homestead Twin|Telemetry|Health")
+	FOnTelemetryStalenessTransitions OnStalenessTransitions;
+
+	/**
+	 * Telemetry is running but nothing is getting through: every endpoint is failing, or every
+	 * key that ever received data is stale
+	 */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Health")
+	bool IsTelemetryOffline() const { return bTelemetryOffline; }
+
+	/** Fired when IsTelemetryOffline changes */
+	UPROPERTY(BlueprintAssignable, Category = "Homestead Twin|Telemetry|Health")
+	FOnTelemetryOfflineChanged OnOfflineChanged;
+
+	/** Health of every REST endpoint and MQTT broker */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Health")
+	void GetTelemetryEndpointStatus(TArray<FTelemetryEndpointStatus>& OutStatus) const;
+
+	/** Set replay speed (1 = real time, 10, 100, ...) */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Replay")
+	void SetReplaySpeed(float Speed);
+
+	/** Pause or resume replay */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Replay")
+	void SetReplayPaused(bool bPaused);
+
+	/** Scrub replay to a recorded time */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry|Replay")
+	void SeekReplay(FDateTime Time);
+
+	/** Recorded time at the replay playhead */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Replay")
+	FDateTime GetReplayPosition() const;
+
+	/** Recorded time range of the replay */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Replay")
+	void GetReplayRange(FDateTime& OutStart, FDateTime& OutEnd) const;
+
+	/** Check if a replay endpoint is running */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry|Replay")
+	bool IsReplayActive() const { return ReplaySource.IsValid(); }
+
 	/** Enable/disable mock data mode */
 	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Telemetry")
 	void SetMockDataMode(bool bEnabled);
@@ -122,25 +622,177 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
 	bool IsMockDataMode() const { return bMockDataMode; }
 
+	/** Samples committed to the store since Initialize (sample twice to measure throughput) */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Telemetry")
+	int64 GetCommittedSampleCount() const { return CommittedSampleCount; }
+
+	/** Approximate heap memory held by the key registry, history, rollups, alarms and staleness index (bytes) */
+	SIZE_T GetTelemetryAllocatedSize() const;
+
 protected:
 	/** Called when telemetry data is updated */
 	UFUNCTION(BlueprintImplementableEvent, Category = "Homestead Twin|Telemetry")
 	void OnTelemetryDataUpdated(FName Key, float Value);
 
-	/** Poll telemetry endpoints (called on timer) */
-	void PollTelemetryEndpoints();
+	/** Drop every key, sample, binding and subscription and apply the retention settings */
+	void ResetTelemetryState();
+
+	/** Create ingest sources for the current mode and configured endpoints */
+	void CreateTelemetrySources(FTelemetryIngestWorker& Worker);
+
+	/** Commit every queued sample to the store and notify listeners once per changed key */
+	void DrainIngestQueue();
+
+	/** Load the newest persisted samples per key into the store, rollups, rolling stats and staleness index */
+	void WarmStartFromLog();
+
+	/** Run the alarm engine and broadcast any transitions */
+	void EvaluateAlarms();
 
-	/** Generate mock telemetry data */
-	void GenerateMockData();
+	/** Reschedule changed keys, expire overdue ones and broadcast staleness transitions */
+	void UpdateStaleness(int64 NowTicks);
+
+	/** Recompute IsTelemetryOffline from endpoint health and key staleness */
+	void UpdateOfflineState();
+
+	/** Queue a slot's subscribers for this frame's callbacks */
+	void QueueSubscribers(int32 Slot);
+
+	/** Turn a string sample of an enum key into its label index (other values pass through) */
+	FTelemetryValue ResolveEnumLabel(int32 Slot, const FTelemetryValue& Value) const;
+
+	/** Subscribed slots and the callback to fire when any of them changes */
+	struct FTelemetrySubscription
+	{
+		TArray<int32> Slots;
+		FOnTelemetrySubscriptionUpdated Callback;
+	};
 
 protected:
-	/** Telemetry data cache (key -> value) */
-	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|Telemetry")
-	TMap<FName, float> TelemetryDataCache;
+	/** Key -> slot mapping shared with ingest threads */
+	TSharedPtr<FTelemetryKeyRegistry> KeyRegistry;
 
-	/** Telemetry timestamp cache (key -> timestamp) */
-	UPROPERTY()
-	TMap<FName, FDateTime> TelemetryTimestamps;
+	/** Lock-free hand-off from ingest threads to the game thread */
+	TSharedPtr<FTelemetryIngestQueue> IngestQueue;
+
+	/** Replay source controlled through the Replay API (null unless a Replay endpoint is running) */
+	TSharedPtr<FTelemetryReplaySource> ReplaySource;
+
+	/** Worker thread running the telemetry sources (null when stopped) */
+	TUniquePtr<FTelemetryIngestWorker> IngestWorker;
+
+	/** Time-series history (slot -> ring of timestamped values) */
+	FTelemetryTimeSeriesStore TimeSeriesStore;
+
+	/** Min/max/mean rollups of the same history at coarser resolutions */
+	FTelemetryRollupPyramid RollupPyramid;
+
+	/** Rolling-window aggregates registered through RegisterTelemetryWindow */
+	FTelemetryRollingStats RollingStats;
+
+	/** Thresholds, latest values and alarm states of every slot */
+	FTelemetryAlarmEngine AlarmEngine;
+
+	/** Slot -> enum state labels (only keys given labels through SetTelemetryEnumLabels) */
+	TMap<int32, TArray<FString>> EnumLabelsBySlot;
+
+	/** Key -> primitive color overlay bindings, flushed once per drain */
+	FTelemetryPrimitiveBindings PrimitiveBindings;
+
+	/** Alarm engine output for the current evaluation (reused between frames) */
+	TArray<FTelemetryAlarmEngine::FTransition> AlarmEngineTransitions;
+	TArray<FTelemetryAlarmTransition> AlarmTransitions;
+
+	/** Thresholds changed since the last evaluation */
+	bool bAlarmThresholdsDirty;
+
+	/** Thresholds armed through RegisterAlarmThresholds and how many registrants share them */
+	struct FAlarmThresholdRegistration
+	{
+		float WarningThreshold;
+		float CriticalThreshold;
+		float Hysteresis;
+		bool bLowerIsBetter;
+		int32 NumRegistrants;
+	};
+
+	/** Slot -> shared threshold registration */
+	TMap<int32, FAlarmThresholdRegistration> AlarmThresholdRegistrations;
+
+	/** Per-key update deadlines */
+	FTelemetryStalenessIndex StalenessIndex;
+
+	/** Slots kept alive by sources this frame without a new sample (rescheduled, not notified) */
+	TArray<int32> TouchedSlots;
+
+	/** Slot -> timeouts requested through RegisterStaleTimeout (the minimum applies) */
+	TMap<int32, TArray<float>> StaleTimeoutRegistrations;
+
+	/** Staleness output for the current frame (reused between frames) */
+	TArray<FTelemetryStalenessIndex::FTransition> StalenessIndexTransitions;
+	TArray<FTelemetryStalenessTransition> StalenessTransitions;
+
+	/** Endpoint health reported by the sources (shared with ingest and HTTP threads) */
+	TSharedPtr<FTelemetryEndpointHealth> EndpointHealth;
+
+	/** EndpointHealth revision the cached counts below were taken at */
+	uint32 EndpointHealthRevision;
+	int32 NumEndpoints;
+	int32 NumFailingEndpoints;
+
+	/** Result of the last UpdateOfflineState */
+	bool bTelemetryOffline;
+
+	/** On-disk log of committed samples (null when persistence is off) */
+	TUniquePtr<FTelemetrySegmentLog> SegmentLog;
+
+	/** Samples committed during the current drain, handed to SegmentLog afterwards */
+	TArray<FTelemetrySample> PersistBatch;
+
+	/** Slots updated during the current drain (reused between frames) */
+	TArray<int32> ChangedSlots;
+
+	/** Per-slot flag backing ChangedSlots deduplication */
+	TBitArray<> ChangedSlotFlags;
+
+	/** Subscriptions by id (unbound callback = free id) */
+	TArray<FTelemetrySubscription> Subscriptions;
+
+	/** Ids of removed subscriptions, reused before growing Subscriptions */
+	TArray<int32> FreeSubscriptionIds;
+
+	/** Slot -> ids of the subscriptions that include it */
+	TArray<TArray<int32>> SubscriptionsBySlot;
+
+	/** Subscriptions to notify after the current drain (reused between frames) */
+	TArray<int32> PendingSubscriptionIds;
+
+	/** Per-subscription flag backing PendingSubscriptionIds deduplication */
+	TBitArray<> PendingSubscriptionFlags;
+
+	/** Number of samples retained per key (applied on Initialize) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "1"))
+	int32 RetentionSamplesPerKey;
+
+	/** Persist committed samples under Saved/Telemetry and warm-start from them (applied on Initialize) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry")
+	bool bPersistTelemetry;
+
+	/** Hours of persisted history kept when the log is compacted */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "1"))
+	float TelemetryLogRetentionHours;
+
+	/** A key without an explicit timeout is stale after this many of its update intervals (applied on Initialize) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "1"))
+	float StaleUpdateMultiplier;
+
+	/** Assumed update interval of a key until a second sample arrives (applied on Initialize) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "0"))
+	float DefaultUpdateIntervalSeconds;
+
+	/** Number of buckets per key at each rollup level (applied on Initialize) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "1"))
+	int32 RollupBucketsPerLevel;
 
 	/** Configured telemetry endpoints */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry")
@@ -154,6 +806,37 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category = "Homestead Twin|Telemetry")
 	bool bMockDataMode;
 
-	/** Telemetry polling timer handle */
-	FTimerHandle TelemetryPollTimerHandle;
+	/** Seconds between samples of each mock key */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "0.01"))
+	float MockUpdateInterval;
+
+	/** Seed for the mock generator (same seed = same value sequence) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry|Mock")
+	int32 MockSeed;
+
+	/** Number of mock keys (up to 5 use the homestead key names; raise to 10k+ for load tests) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry|Mock", meta = (ClampMin = "1"))
+	int32 MockKeyCount;
+
+	/** Total mock samples per second across all keys (0 = MockKeyCount / MockUpdateInterval) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry|Mock", meta = (ClampMin = "0"))
+	float MockTargetSamplesPerSecond;
+
+	/** Simulated seconds per real second for the mock waveforms */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry|Mock", meta = (ClampMin = "0"))
+	float MockTimeScale;
+
+	/** Expected step faults per mock key per simulated day */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry|Mock", meta = (ClampMin = "0"))
+	float MockFaultsPerKeyPerDay;
+
+	/** Samples committed to the store since Initialize (throughput measurement) */
+	int64 CommittedSampleCount;
+
+	/** Never ticked; whoever created this instance calls DrainIngestQueue itself (benchmark) */
+	bool bDrainedByOwner;
+
+	/** Cap on concurrent REST polls across all hosts (each host is polled one request at a time) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Telemetry", meta = (ClampMin = "1"))
+	int32 MaxConcurrentRestRequests;
 };
@@ -0,0 +1,446 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "US_WorldWidgetPool.h"
+#include "../HomesteadTwin.h"
+#include "Algo/Sort.h"
+#include "Blueprint/UserWidget.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/WidgetComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+namespace WorldWidgetPool
+{
+	/** Impostor custom data: RGB */
+	constexpr int32 ImpostorCustomDataFloats = 3;
+}
+
+using namespace WorldWidgetPool;
+
+HOMESTEAD_DECLARE_COUNTER(WorldWidgetSources);
+
+UUS_WorldWidgetPool::UUS_WorldWidgetPool()
+{
+	WidgetBudget = 24;
+	MaxWidgetDistance = 2500.0f;
+	MaxImpostorDistance = 20000.0f;
+	HysteresisFraction = 0.2f;
+	SelectionInterval = 0.1f;
+	WidgetDrawSize = FVector2D(256.0f, 96.0f);
+	DefaultWidgetClass = TSoftClassPtr<UUserWidget>(FSoftObjectPath(TEXT("/Game/UI/Widgets/WID_TelemetryText.WID_TelemetryText_C")));
+	ImpostorMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Sphere.Sphere")));
+	ImpostorScale = 0.1f;
+
+	PoolActor = nullptr;
+	Impostors = nullptr;
+	SelectionCountdown = 0.0f;
+}
+
+void UUS_WorldWidgetPool::Deinitialize()
+{
+	Sources.Reset();
+	FreeSourceIds.Reset();
+	WidgetComponents.Reset();
+	WidgetOwners.Reset();
+	FreeWidgets.Reset();
+	FreeImpostors.Reset();
+
+	if (PoolActor)
+	{
+		PoolActor->Destroy();
+	}
+	PoolActor = nullptr;
+	Impostors = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UUS_WorldWidgetPool::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UUS_WorldWidgetPool::Tick(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	if (!PlayerController)
+	{
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	SelectionCountdown -= DeltaTime;
+	if (SelectionCountdown <= 0.0f)
+	{
+		SelectionCountdown = SelectionInterval;
+		UpdateSelection(ViewLocation);
+	}
+
+	// Billboard only the budgeted widgets
+	for (int32 WidgetIndex = 0; WidgetIndex < WidgetComponents.Num(); ++WidgetIndex)
+	{
+		if (WidgetOwners[WidgetIndex] != INDEX_NONE)
+		{
+			UWidgetComponent* Widget = WidgetComponents[WidgetIndex];
+			const FVector ToViewer = ViewLocation - Widget->GetComponentLocation();
+			Widget->SetWorldRotation(ToViewer.Rotation());
+		}
+	}
+}
+
+TStatId UUS_WorldWidgetPool::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUS_WorldWidgetPool, STATGROUP_HomesteadTwin);
+}
+
+int32 UUS_WorldWidgetPool::RegisterWidgetSource(USceneComponent* Anchor, FVector Offset, TSubclassOf<UUserWidget> WidgetClass, float Relevance, bool bShowImpostor)
+{
+	if (!Anchor)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 SourceId = FreeSourceIds.Num() > 0 ? FreeSourceIds.Pop(EAllowShrinking::No) : Sources.AddDefaulted();
+	FWidgetSource& Source = Sources[SourceId];
+	Source = FWidgetSource();
+	Source.Anchor = Anchor;
+	Source.Offset = Offset;
+	Source.WidgetClass = WidgetClass;
+	Source.Relevance = FMath::Max(UE_KINDA_SMALL_NUMBER, Relevance);
+	Source.bShowImpostor = bShowImpostor;
+	Source.bRegistered = true;
+
+	// Picked up by the next selection pass
+	SelectionCountdown = 0.0f;
+	return SourceId;
+}
+
+void UUS_WorldWidgetPool::UnregisterWidgetSource(int32 SourceId)
+{
+	if (!Sources.IsValidIndex(SourceId) || !Sources[SourceId].bRegistered)
+	{
+		return;
+	}
+
+	FWidgetSource& Source = Sources[SourceId];
+	ReleaseWidget(Source);
+
+	if (Source.Impostor != INDEX_NONE)
+	{
+		if (UpdateImpostor(Source, false, FVector::ZeroVector))
+		{
+			Impostors->MarkRenderStateDirty();
+		}
+		FreeImpostors.Add(Source.Impostor);
+	}
+
+	Source = FWidgetSource();
+	FreeSourceIds.Add(SourceId);
+}
+
+void UUS_WorldWidgetPool::SetWidgetSourceContent(int32 SourceId, const FWorldWidgetContent& Content)
+{
+	if (!Sources.IsValidIndex(SourceId) || !Sources[SourceId].bRegistered)
+	{
+		return;
+	}
+
+	FWidgetSource& Source = Sources[SourceId];
+	const bool bColorChanged = !Source.Content.Color.Equals(Content.Color);
+	Source.Content = Content;
+
+	if (Source.Widget != INDEX_NONE)
+	{
+		PushContent(Source);
+	}
+	else if (Source.bImpostorVisible && bColorChanged)
+	{
+		const float Color[ImpostorCustomDataFloats] = { Content.Color.R, Content.Color.G, Content.Color.B };
+		Impostors->SetCustomData(Source.Impostor, MakeArrayView(Color, ImpostorCustomDataFloats), true);
+	}
+}
+
+void UUS_WorldWidgetPool::SetWidgetSourceRelevance(int32 SourceId, float Relevance)
+{
+	if (Sources.IsValidIndex(SourceId) && Sources[SourceId].bRegistered)
+	{
+		Sources[SourceId].Relevance = FMath::Max(UE_KINDA_SMALL_NUMBER, Relevance);
+	}
+}
+
+bool UUS_WorldWidgetPool::HasPooledWidget(int32 SourceId) const
+{
+	return Sources.IsValidIndex(SourceId) && Sources[SourceId].Widget != INDEX_NONE;
+}
+
+void UUS_WorldWidgetPool::UpdateSelection(const FVector& ViewLocation)
+{
+	HOMESTEAD_SCOPE(WorldWidgetSelection);
+	HOMESTEAD_SET_COUNTER(WorldWidgetSources, Sources.Num() - FreeSourceIds.Num());
+
+	const double MaxWidgetDistanceSq = FMath::Square(double(MaxWidgetDistance));
+	const double HeldWidgetDistanceSq = FMath::Square(double(MaxWidgetDistance) * (1.0 + HysteresisFraction));
+	const double MaxImpostorDistanceSq = FMath::Square(double(MaxImpostorDistance));
+	const double HeldScoreScale = FMath::Square(1.0 - HysteresisFraction);
+
+	// Score every source in range; lower is better
+	Candidates.Reset();
+	for (int32 SourceId = 0; SourceId < Sources.Num(); ++SourceId)
+	{
+		const FWidgetSource& Source = Sources[SourceId];
+		if (!Source.bRegistered || !Source.Anchor.IsValid())
+		{
+			continue;
+		}
+
+		const FVector Location = Source.Anchor->GetComponentTransform().TransformPosition(Source.Offset);
+		const double DistanceSq = FVector::DistSquared(ViewLocation, Location);
+		const bool bHeld = Source.Widget != INDEX_NONE;
+		if (DistanceSq <= (bHeld ? HeldWidgetDistanceSq : MaxWidgetDistanceSq))
+		{
+			const double Score = DistanceSq / FMath::Square(double(Source.Relevance)) * (bHeld ? HeldScoreScale : 1.0);
+			Candidates.Emplace(Score, SourceId);
+		}
+	}
+
+	// Keep the best WidgetBudget candidates
+	if (Candidates.Num() > WidgetBudget)
+	{
+		Algo::SortBy(Candidates, &TPair<double, int32>::Key);
+		Candidates.SetNum(WidgetBudget, EAllowShrinking::No);
+	}
+
+	Selected.Init(false, Sources.Num());
+	for (const TPair<double, int32>& Candidate : Candidates)
+	{
+		Selected[Candidate.Value] = true;
+	}
+
+	// Release before assigning so freed widgets can be reused this pass
+	for (int32 SourceId = 0; SourceId < Sources.Num(); ++SourceId)
+	{
+		if (!Selected[SourceId] && Sources[SourceId].Widget != INDEX_NONE)
+		{
+			ReleaseWidget(Sources[SourceId]);
+		}
+	}
+
+	for (const TPair<double, int32>& Candidate : Candidates)
+	{
+		if (Sources[Candidate.Value].Widget == INDEX_NONE)
+		{
+			AssignWidget(Candidate.Value);
+		}
+	}
+
+	// Everything else nearby is an impostor
+	bool bImpostorsChanged = false;
+	for (FWidgetSource& Source : Sources)
+	{
+		if (!Source.bRegistered || !Source.bShowImpostor)
+		{
+			continue;
+		}
+
+		bool bVisible = false;
+		FVector Location = FVector::ZeroVector;
+		if (Source.Widget == INDEX_NONE && Source.Anchor.IsValid())
+		{
+			Location = Source.Anchor->GetComponentTransform().TransformPosition(Source.Offset);
+			bVisible = FVector::DistSquared(ViewLocation, Location) <= MaxImpostorDistanceSq;
+		}
+
+		bImpostorsChanged |= UpdateImpostor(Source, bVisible, Location);
+	}
+
+	if (bImpostorsChanged && Impostors)
+	{
+		Impostors->MarkRenderStateDirty();
+	}
+}
+
+bool UUS_WorldWidgetPool::AssignWidget(int32 SourceId)
+{
+	FWidgetSource& Source = Sources[SourceId];
+	TSubclassOf<UUserWidget> WidgetClass = Source.WidgetClass ? Source.WidgetClass : TSubclassOf<UUserWidget>(DefaultWidgetClass.LoadSynchronous());
+
+	// Prefer a free widget of the same class (no widget recreation)
+	int32 FreeIndex = FreeWidgets.IndexOfByPredicate([this, &WidgetClass](int32 WidgetIndex)
+	{
+		return WidgetComponents[WidgetIndex]->GetWidgetClass() == WidgetClass;
+	});
+
+	int32 WidgetIndex = INDEX_NONE;
+	if (FreeIndex != INDEX_NONE)
+	{
+		WidgetIndex = FreeWidgets[FreeIndex];
+		FreeWidgets.RemoveAtSwap(FreeIndex, EAllowShrinking::No);
+	}
+	else if (WidgetComponents.Num() < WidgetBudget)
+	{
+		AActor* Owner = GetOrCreatePoolActor();
+		if (!Owner)
+		{
+			return false;
+		}
+
+		UWidgetComponent* Widget = NewObject<UWidgetComponent>(Owner);
+		Widget->SetWidgetSpace(EWidgetSpace::World);
+		Widget->SetDrawSize(WidgetDrawSize);
+		Widget->SetTwoSided(true);
+		Widget->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Widget->SetWidgetClass(WidgetClass);
+		Widget->RegisterComponent();
+		Widget->InitWidget();
+
+		WidgetIndex = WidgetComponents.Add(Widget);
+		WidgetOwners.Add(INDEX_NONE);
+	}
+	else if (FreeWidgets.Num() > 0)
+	{
+		// Budget reached: re-class a free widget of another class
+		WidgetIndex = FreeWidgets.Pop(EAllowShrinking::No);
+		WidgetComponents[WidgetIndex]->SetWidgetClass(WidgetClass);
+		WidgetComponents[WidgetIndex]->InitWidget();
+	}
+	else
+	{
+		return false;
+	}
+
+	UWidgetComponent* Widget = WidgetComponents[WidgetIndex];
+	Widget->AttachToComponent(Source.Anchor.Get(), FAttachmentTransformRules::KeepRelativeTransform);
+	Widget->SetRelativeLocation(Source.Offset);
+	Widget->SetVisibility(true);
+	Widget->SetComponentTickEnabled(true);
+
+	WidgetOwners[WidgetIndex] = SourceId;
+	Source.Widget = WidgetIndex;
+	PushContent(Source);
+	return true;
+}
+
+void UUS_WorldWidgetPool::ReleaseWidget(FWidgetSource& Source)
+{
+	if (Source.Widget == INDEX_NONE)
+	{
+		return;
+	}
+
+	UWidgetComponent* Widget = WidgetComponents[Source.Widget];
+	Widget->SetVisibility(false);
+	Widget->SetComponentTickEnabled(false);
+	Widget->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+
+	WidgetOwners[Source.Widget] = INDEX_NONE;
+	FreeWidgets.Add(Source.Widget);
+	Source.Widget = INDEX_NONE;
+}
+
+bool UUS_WorldWidgetPool::UpdateImpostor(FWidgetSource& Source, bool bVisible, const FVector& Location)
+{
+	if (!bVisible && !Source.bImpostorVisible)
+	{
+		return false;
+	}
+
+	if (bVisible && Source.bImpostorVisible && Location.Equals(Source.ImpostorLocation))
+	{
+		return false;
+	}
+
+	UInstancedStaticMeshComponent* Instances = GetOrCreateImpostors();
+	if (!Instances)
+	{
+		return false;
+	}
+
+	if (Source.Impostor == INDEX_NONE)
+	{
+		Source.Impostor = FreeImpostors.Num() > 0
+			? FreeImpostors.Pop(EAllowShrinking::No)
+			: Instances->AddInstance(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), true);
+	}
+
+	// Hidden impostors keep their slot at zero scale
+	const FTransform Transform(FQuat::Identity, Location, FVector(bVisible ? ImpostorScale : 0.0f));
+	Instances->UpdateInstanceTransform(Source.Impostor, Transform, true, false, true);
+
+	if (bVisible && !Source.bImpostorVisible)
+	{
+		const float Color[ImpostorCustomDataFloats] = { Source.Content.Color.R, Source.Content.Color.G, Source.Content.Color.B };
+		Instances->SetCustomData(Source.Impostor, MakeArrayView(Color, ImpostorCustomDataFloats), false);
+	}
+
+	Source.bImpostorVisible = bVisible;
+	Source.ImpostorLocation = Location;
+	return true;
+}
+
+void UUS_WorldWidgetPool::PushContent(const FWidgetSource& Source)
+{
+	UUserWidget* UserWidget = WidgetComponents[Source.Widget]->GetUserWidgetObject();
+	if (UserWidget && UserWidget->Implements<UWorldWidgetContentReceiver>())
+	{
+		IWorldWidgetContentReceiver::Execute_SetWorldWidgetContent(UserWidget, Source.Content);
+	}
+}
+
+AActor* UUS_WorldWidgetPool::GetOrCreatePoolActor()
+{
+	if (PoolActor)
+	{
+		return PoolActor;
+	}
+
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Name = TEXT("WorldWidgetPool");
+	SpawnParams.NameMode = FActorSpawnParameters::ESpawnActorNameMode::Requested;
+	SpawnParams.ObjectFlags = RF_Transient;
+	PoolActor = World->SpawnActor<AActor>(SpawnParams);
+	if (PoolActor)
+	{
+		USceneComponent* Root = NewObject<USceneComponent>(PoolActor, TEXT("Root"));
+		PoolActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	return PoolActor;
+}
+
+UInstancedStaticMeshComponent* UUS_WorldWidgetPool::GetOrCreateImpostors()
+{
+	if (Impostors)
+	{
+		return Impostors;
+	}
+
+	AActor* Owner = GetOrCreatePoolActor();
+	UStaticMesh* Mesh = ImpostorMesh.LoadSynchronous();
+	if (!Owner || !Mesh)
+	{
+		return nullptr;
+	}
+
+	Impostors = NewObject<UInstancedStaticMeshComponent>(Owner, TEXT("Impostors"));
+	Impostors->SetStaticMesh(Mesh);
+	Impostors->SetNumCustomDataFloats(ImpostorCustomDataFloats);
+	Impostors->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Impostors->SetCastShadow(false);
+	Impostors->SetMobility(EComponentMobility::Movable);
+	Impostors->SetupAttachment(Owner->GetRootComponent());
+	Impostors->RegisterComponent();
+
+	return Impostors;
+}
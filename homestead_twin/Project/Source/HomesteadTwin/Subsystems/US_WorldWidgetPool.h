@@ -0,0 +1,255 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "US_WorldWidgetPool.generated.h"
+
+class UWidgetComponent;
+class UUserWidget;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/**
+ * FWorldWidgetContent
+ *
+ * What a pooled world widget shows for its source (label, value, status color).
+ */
+USTRUCT(BlueprintType)
+struct FWorldWidgetContent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widget")
+	FText Label;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widget")
+	FText Value;
+
+	/** Status color (also used for the impostor) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widget")
+	FLinearColor Color;
+
+	/** Data is out of date (widgets fade out) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widget")
+	bool bStale;
+
+	FWorldWidgetContent()
+		: Color(FLinearColor::White)
+		, bStale(false)
+	{}
+};
+
+UINTERFACE(MinimalAPI, BlueprintType)
+class UWorldWidgetContentReceiver : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * IWorldWidgetContentReceiver
+ *
+ * Implemented by widgets used with UUS_WorldWidgetPool (e.g. WID_TelemetryText).
+ * A pooled widget is re-targeted between sources, so everything it shows must come from here.
+ */
+class HOMESTEADTWIN_API IWorldWidgetContentReceiver
+{
+	GENERATED_BODY()
+
+public:
+	/** Show the content of the source this widget is currently assigned to */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Homestead Twin|Widgets")
+	void SetWorldWidgetContent(const FWorldWidgetContent& Content);
+};
+
+/**
+ * UUS_WorldWidgetPool
+ *
+ * World Subsystem sharing a fixed budget of world-space widgets between many in-world sources
+ * (telemetry readouts, annotations).
+ *
+ * Responsibilities:
+ * - Keep a registry of widget sources (anchor component, offset, relevance, content)
+ * - Assign the pooled widgets to the most relevant sources near the viewer
+ * - Draw every other nearby source as a cheap impostor (one instanced mesh for all of them)
+ *
+ * Implementation Notes:
+ * - Selection runs every SelectionInterval: score = distance^2 / relevance^2, best WidgetBudget win
+ * - Hysteresis: a source holding a widget scores as if HysteresisFraction closer and may stay
+ *   HysteresisFraction beyond MaxWidgetDistance, so widgets don't thrash at the boundary
+ * - Pooled widget components are attached to their source's anchor, so they follow it without
+ *   per-frame updates; only the budgeted widgets are turned toward the viewer each frame
+ * - Content is pushed to a widget only while it is assigned (sources without one just store it)
+ * - Impostors are instances of one UInstancedStaticMeshComponent; instance slots are never
+ *   removed, hidden impostors are scaled to zero and reused. Color goes to per-instance custom
+ *   data 0..2, so the impostor material should read PerInstanceCustomData
+ * - Widgets are created on demand up to WidgetBudget and never destroyed before Deinitialize
+ */
+UCLASS()
+class HOMESTEADTWIN_API UUS_WorldWidgetPool : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UUS_WorldWidgetPool();
+
+	// Begin USubsystem Interface
+	virtual void Deinitialize() override;
+	// End USubsystem Interface
+
+	// Begin UWorldSubsystem Interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// End UWorldSubsystem Interface
+
+	// Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject Interface
+
+	/**
+	 * Register a source. Its widget (WidgetClass, or DefaultWidgetClass when null) is placed at
+	 * Offset relative to Anchor whenever the source wins a pooled widget. Relevance > 1 makes
+	 * the source win over closer ones. Returns a source id.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Widgets")
+	int32 RegisterWidgetSource(USceneComponent* Anchor, FVector Offset, TSubclassOf<UUserWidget> WidgetClass, float Relevance = 1.0f, bool bShowImpostor = true);
+
+	/** Remove a source and return its widget to the pool */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Widgets")
+	void UnregisterWidgetSource(int32 SourceId);
+
+	/** Update what a source shows (pushed to its widget only while it holds one) */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Widgets")
+	void SetWidgetSourceContent(int32 SourceId, const FWorldWidgetContent& Content);
+
+	/** Change how strongly a source competes for a widget */
+	UFUNCTION(BlueprintCallable, Category = "Homestead Twin|Widgets")
+	void SetWidgetSourceRelevance(int32 SourceId, float Relevance);
+
+	/** Check if a source currently holds a pooled widget */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Widgets")
+	bool HasPooledWidget(int32 SourceId) const;
+
+	/** Number of registered sources */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Widgets")
+	int32 GetNumWidgetSources() const { return Sources.Num() - FreeSourceIds.Num(); }
+
+	/** Number of pooled widgets currently assigned */
+	UFUNCTION(BlueprintPure, Category = "Homestead Twin|Widgets")
+	int32 GetNumAssignedWidgets() const { return WidgetComponents.Num() - FreeWidgets.Num(); }
+
+protected:
+	/** A registered source */
+	struct FWidgetSource
+	{
+		TWeakObjectPtr<USceneComponent> Anchor;
+		FVector Offset = FVector::ZeroVector;
+		TSubclassOf<UUserWidget> WidgetClass;
+		float Relevance = 1.0f;
+		bool bShowImpostor = true;
+		bool bRegistered = false;
+
+		FWorldWidgetContent Content;
+
+		/** Index into WidgetComponents (INDEX_NONE = none) */
+		int32 Widget = INDEX_NONE;
+
+		/** Impostor instance slot (INDEX_NONE = none) and whether it is shown */
+		int32 Impostor = INDEX_NONE;
+		bool bImpostorVisible = false;
+		FVector ImpostorLocation = FVector::ZeroVector;
+	};
+
+	/** Select the sources that get widgets and update impostors */
+	void UpdateSelection(const FVector& ViewLocation);
+
+	/** Give a source a pooled widget (creates one while under budget) */
+	bool AssignWidget(int32 SourceId);
+
+	/** Return a source's widget to the pool */
+	void ReleaseWidget(FWidgetSource& Source);
+
+	/** Show, move or hide a source's impostor; returns true if the instance changed */
+	bool UpdateImpostor(FWidgetSource& Source, bool bVisible, const FVector& Location);
+
+	/** Push a source's content into its widget */
+	void PushContent(const FWidgetSource& Source);
+
+	/** Pool owner actor and impostor component (created on first use) */
+	AActor* GetOrCreatePoolActor();
+	UInstancedStaticMeshComponent* GetOrCreateImpostors();
+
+protected:
+	/** Widgets shared by all sources (hard cap) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets", meta = (ClampMin = "0"))
+	int32 WidgetBudget;
+
+	/** Sources farther than this never get a widget (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets", meta = (ClampMin = "0"))
+	float MaxWidgetDistance;
+
+	/** Sources farther than this show no impostor either (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets", meta = (ClampMin = "0"))
+	float MaxImpostorDistance;
+
+	/** Advantage of a source that already holds a widget (fraction of its distance) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets", meta = (ClampMin = "0", ClampMax = "0.9"))
+	float HysteresisFraction;
+
+	/** Seconds between selection passes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets", meta = (ClampMin = "0"))
+	float SelectionInterval;
+
+	/** Draw size of pooled widgets */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets")
+	FVector2D WidgetDrawSize;
+
+	/** Widget class for sources registered without one */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets")
+	TSoftClassPtr<UUserWidget> DefaultWidgetClass;
+
+	/** Impostor mesh (its material should read PerInstanceCustomData 0..2 as color) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets")
+	TSoftObjectPtr<UStaticMesh> ImpostorMesh;
+
+	/** Uniform scale of impostor instances */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Homestead Twin|Widgets", meta = (ClampMin = "0"))
+	float ImpostorScale;
+
+private:
+	/** Sources by id (bRegistered = false = free id) */
+	TArray<FWidgetSource> Sources;
+
+	/** Ids of removed sources, reused before growing Sources */
+	TArray<int32> FreeSourceIds;
+
+	/** Every pooled widget component */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UWidgetComponent>> WidgetComponents;
+
+	/** Source id per widget component (INDEX_NONE = free) */
+	TArray<int32> WidgetOwners;
+
+	/** Indices of unassigned widget components */
+	TArray<int32> FreeWidgets;
+
+	/** Actor owning the pooled components */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> PoolActor;
+
+	/** One instanced mesh for every impostor */
+	UPROPERTY(Transient)
+	TObjectPtr<UInstancedStaticMeshComponent> Impostors;
+
+	/** Impostor instance slots released by unregistered sources */
+	TArray<int32> FreeImpostors;
+
+	/** Seconds until the next selection pass */
+	float SelectionCountdown;
+
+	/** Selection scratch (score, source id), reused between passes */
+	TArray<TPair<double, int32>> Candidates;
+	TBitArray<> Selected;
+};
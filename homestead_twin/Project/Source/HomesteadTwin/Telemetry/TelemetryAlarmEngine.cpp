@@ -0,0 +1,138 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryAlarmEngine.h"
+#include "Math/VectorRegister.h"
+#include <limits>
+
+FTelemetryAlarmEngine::FTelemetryAlarmEngine()
+	: SlotCount(0)
+{
+}
+
+void FTelemetryAlarmEngine::Reset()
+{
+	SlotCount = 0;
+	Values.Reset();
+	Signs.Reset();
+	WarningThresholds.Reset();
+	CriticalThresholds.Reset();
+	Hysteresis.Reset();
+	States.Reset();
+}
+
+void FTelemetryAlarmEngine::EnsureSlots(int32 InNumSlots)
+{
+	if (InNumSlots <= SlotCount)
+	{
+		return;
+	}
+
+	SlotCount = InNumSlots;
+
+	const int32 PaddedNum = Align(InNumSlots, 4);
+	const int32 NewEntries = PaddedNum - Values.Num();
+	if (NewEntries <= 0)
+	{
+		return;
+	}
+
+	// Unarmed defaults: no value, unreachable thresholds
+	const float NaN = std::numeric_limits<float>::quiet_NaN();
+	const float Infinity = std::numeric_limits<float>::infinity();
+	for (int32 Index = 0; Index < NewEntries; ++Index)
+	{
+		Values.Add(NaN);
+		Signs.Add(1.0f);
+		WarningThresholds.Add(Infinity);
+		CriticalThresholds.Add(Infinity);
+		Hysteresis.Add(0.0f);
+		States.Add(0.0f);
+	}
+}
+
+void FTelemetryAlarmEngine::SetThresholds(int32 Slot, float WarningThreshold, float CriticalThreshold, float InHysteresis, bool bLowIsBad)
+{
+	if (Slot < 0 || Slot >= SlotCount)
+	{
+		return;
+	}
+
+	const float Sign = bLowIsBad ? -1.0f : 1.0f;
+	const float NormalizedWarning = Sign * WarningThreshold;
+	const float NormalizedCritical = Sign * CriticalThreshold;
+
+	Signs[Slot] = Sign;
+	WarningThresholds[Slot] = NormalizedWarning;
+	CriticalThresholds[Slot] = FMath::Max(NormalizedWarning, NormalizedCritical);
+	Hysteresis[Slot] = FMath::Max(0.0f, InHysteresis);
+}
+
+void FTelemetryAlarmEngine::ClearThresholds(int32 Slot)
+{
+	if (Slot < 0 || Slot >= SlotCount)
+	{
+		return;
+	}
+
+	const float Infinity = std::numeric_limits<float>::infinity();
+	Signs[Slot] = 1.0f;
+	WarningThresholds[Slot] = Infinity;
+	CriticalThresholds[Slot] = Infinity;
+	Hysteresis[Slot] = 0.0f;
+}
+
+void FTelemetryAlarmEngine::Evaluate(TArray<FTransition>& OutTransitions)
+{
+	const VectorRegister4Float One = VectorOneFloat();
+
+	const int32 PaddedNum = Values.Num();
+	for (int32 Base = 0; Base < PaddedNum; Base += 4)
+	{
+		const VectorRegister4Float Value = VectorMultiply(VectorLoad(&Values[Base]), VectorLoad(&Signs[Base]));
+		const VectorRegister4Float Warning = VectorLoad(&WarningThresholds[Base]);
+		const VectorRegister4Float Critical = VectorLoad(&CriticalThresholds[Base]);
+		const VectorRegister4Float Band = VectorLoad(&Hysteresis[Base]);
+		const VectorRegister4Float OldState = VectorLoad(&States[Base]);
+
+		// Level the value reaches without hysteresis (NaN compares false = Normal)
+		const VectorRegister4Float Enter = VectorAdd(
+			VectorBitwiseAnd(VectorCompareGT(Value, Warning), One),
+			VectorBitwiseAnd(VectorCompareGT(Value, Critical), One));
+
+		// Level the value still holds if it was already there
+		const VectorRegister4Float Hold = VectorAdd(
+			VectorBitwiseAnd(VectorCompareGT(Value, VectorSubtract(Warning, Band)), One),
+			VectorBitwiseAnd(VectorCompareGT(Value, VectorSubtract(Critical, Band)), One));
+
+		const VectorRegister4Float NewState = VectorMax(Enter, VectorMin(OldState, Hold));
+
+		const uint32 ChangedMask = VectorMaskBits(VectorCompareNE(NewState, OldState));
+		if (ChangedMask == 0)
+		{
+			continue;
+		}
+
+		float NewStates[4];
+		VectorStore(NewState, NewStates);
+
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			if ((ChangedMask & (1u << Lane)) && Base + Lane < SlotCount)
+			{
+				OutTransitions.Add({ Base + Lane, EState(int32(States[Base + Lane])), EState(int32(NewStates[Lane])) });
+			}
+		}
+
+		VectorStore(NewState, &States[Base]);
+	}
+}
+
+SIZE_T FTelemetryAlarmEngine::GetAllocatedSize() const
+{
+	return Values.GetAllocatedSize()
+		+ Signs.GetAllocatedSize()
+		+ WarningThresholds.GetAllocatedSize()
+		+ CriticalThresholds.GetAllocatedSize()
+		+ Hysteresis.GetAllocatedSize()
+		+ States.GetAllocatedSize();
+}
@@ -0,0 +1,97 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FTelemetryAlarmEngine
+ *
+ * Central threshold evaluation for every telemetry key.
+ *
+ * Responsibilities:
+ * - Hold warning/critical thresholds, hysteresis and the latest value per slot
+ * - Evaluate all slots in one SIMD pass and report only the slots whose state changed
+ *
+ * Implementation Notes:
+ * - Structure-of-arrays columns, padded to a multiple of 4 so every pass is whole VectorRegisters
+ * - Thresholds are stored pre-multiplied by a direction sign, so "low is bad" and
+ *   "high is bad" alarms share one comparison: state rises when Sign * Value > threshold
+ * - A value exactly at a threshold keeps the better state, matching the component's original
+ *   GetColorForValue (Green while Value >= GreenThreshold, for high-is-good keys)
+ * - Hysteresis: a state is kept while the normalized value stays above its threshold minus Hysteresis
+ * - Slots without thresholds hold +inf thresholds; slots without a value hold NaN; both
+ *   evaluate to Normal without a mask
+ * - Game thread only
+ */
+class HOMESTEADTWIN_API FTelemetryAlarmEngine
+{
+public:
+	/** Alarm states (ordered by severity) */
+	enum EState : uint8
+	{
+		Normal = 0,
+		Warning = 1,
+		Critical = 2
+	};
+
+	/** One state change produced by Evaluate */
+	struct FTransition
+	{
+		int32 Slot;
+		EState OldState;
+		EState NewState;
+	};
+
+	FTelemetryAlarmEngine();
+
+	/** Drop all slots */
+	void Reset();
+
+	/** Allocate columns so that slots [0, InNumSlots) are valid */
+	void EnsureSlots(int32 InNumSlots);
+
+	/** Number of allocated slots */
+	int32 NumSlots() const { return SlotCount; }
+
+	/**
+	 * Arm a slot. With bLowIsBad the state rises as the value falls below the thresholds
+	 * (Warning >= Critical); otherwise as it rises above them (Warning <= Critical).
+	 */
+	void SetThresholds(int32 Slot, float WarningThreshold, float CriticalThreshold, float Hysteresis, bool bLowIsBad);
+
+	/** Disarm a slot (its state returns to Normal on the next Evaluate) */
+	void ClearThresholds(int32 Slot);
+
+	/** Record the latest value of a slot */
+	void SetValue(int32 Slot, float Value)
+	{
+		if (Slot >= 0 && Slot < SlotCount)
+		{
+			Values[Slot] = Value;
+		}
+	}
+
+	/** Current state of a slot */
+	EState GetState(int32 Slot) const { return (Slot >= 0 && Slot < SlotCount) ? EState(int32(States[Slot])) : Normal; }
+
+	/** Evaluate every slot; appends one entry per slot whose state changed */
+	void Evaluate(TArray<FTransition>& OutTransitions);
+
+	/** Approximate heap memory held by the engine (bytes) */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** Number of valid slots (columns are padded beyond it) */
+	int32 SlotCount;
+
+	/** SoA columns, padded to a multiple of 4 */
+	TArray<float> Values;
+	TArray<float> Signs;
+	TArray<float> WarningThresholds;
+	TArray<float> CriticalThresholds;
+	TArray<float> Hysteresis;
+
+	/** Alarm state per slot as a float (0, 1, 2) so it stays in vector registers */
+	TArray<float> States;
+};
@@ -0,0 +1,391 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryBenchmark.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "../HomesteadTwin.h"
+#include "../Subsystems/US_TelemetryManager.h"
+#include "Algo/AllOf.h"
+#include "Async/Async.h"
+#include "Engine/GameInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/StrongObjectPtr.h"
+#include <atomic>
+
+namespace TelemetryBenchmark
+{
+	/** Producers flush their batch every this many samples */
+	constexpr int32 FlushSamples = 1024;
+
+	/** Producer sleep between emission rounds in the steady-state phase (seconds) */
+	constexpr double ProducerInterval = 0.002;
+
+	/** Value at quantile Q of sorted values */
+	double Percentile(const TArray<double>& Sorted, double Q)
+	{
+		return Sorted.Num() > 0 ? Sorted[FMath::Min(Sorted.Num() - 1, int32(Q * (Sorted.Num() - 1) + 0.5))] : 0.0;
+	}
+
+	/** UTC ticks derived from the cycle counter, anchored once per case */
+	struct FClock
+	{
+		int64 StartTicks = FDateTime::UtcNow().GetTicks();
+		uint64 StartCycles = FPlatformTime::Cycles64();
+
+		int64 NowTicks() const
+		{
+			return StartTicks + int64(double(FPlatformTime::Cycles64() - StartCycles) * FPlatformTime::GetSecondsPerCycle64() * ETimespan::TicksPerSecond);
+		}
+	};
+
+	void RunBenchmarkCommand(const TArray<FString>& Args)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+
+		FTelemetryBenchmark::FSettings Settings;
+
+		FString KeyCounts;
+		if (FParse::Value(*Params, TEXT("Keys="), KeyCounts))
+		{
+			TArray<FString> Counts;
+			KeyCounts.ParseIntoArray(Counts, TEXT(","));
+
+			Settings.KeyCounts.Reset();
+			for (const FString& Count : Counts)
+			{
+				int32 NumKeys = 0;
+				if (LexTryParseString(NumKeys, *Count) && NumKeys > 0)
+				{
+					Settings.KeyCounts.Add(NumKeys);
+				}
+			}
+		}
+
+		FParse::Value(*Params, TEXT("Retention="), Settings.RetentionSamplesPerKey);
+		FParse::Value(*Params, TEXT("RollupBuckets="), Settings.RollupBucketsPerLevel);
+		FParse::Value(*Params, TEXT("Producers="), Settings.ProducerThreads);
+		FParse::Value(*Params, TEXT("SamplesPerKey="), Settings.ThroughputSamplesPerKey);
+		FParse::Value(*Params, TEXT("Frames="), Settings.Frames);
+		FParse::Value(*Params, TEXT("Hz="), Settings.KeyUpdateHz);
+
+		const TArray<FTelemetryBenchmark::FResult> Results = FTelemetryBenchmark::Run(Settings);
+
+		FString CsvPath;
+		FString JsonPath;
+		if (FTelemetryBenchmark::WriteResults(Settings, Results, FPaths::ProjectSavedDir() / TEXT("Benchmarks"), CsvPath, JsonPath))
+		{
+			UE_LOG(LogHomesteadTwin, Display, TEXT("Telemetry benchmark: results written to %s and %s"), *CsvPath, *JsonPath);
+		}
+		else
+		{
+			UE_LOG(LogHomesteadTwin, Error, TEXT("Telemetry benchmark: could not write results"));
+		}
+	}
+
+	FAutoConsoleCommand BenchmarkCommand(
+		TEXT("HomesteadTwin.Telemetry.Benchmark"),
+		TEXT("Benchmark telemetry ingest and write CSV/JSON to Saved/Benchmarks. ")
+		TEXT("Optional: Keys=1000,10000,100000 Retention=600 RollupBuckets=128 Producers=2 SamplesPerKey=20 Frames=300 Hz=1"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmarkCommand));
+}
+
+using namespace TelemetryBenchmark;
+
+TArray<FTelemetryBenchmark::FResult> FTelemetryBenchmark::Run(const FSettings& Settings)
+{
+	TArray<FResult> Results;
+	for (const int32 NumKeys : Settings.KeyCounts)
+	{
+		const FResult& Result = Results.Add_GetRef(RunCase(Settings, NumKeys));
+
+		UE_LOG(LogHomesteadTwin, Display, TEXT("Telemetry benchmark: %d keys: %.0f samples/s, latency p50 %.2f ms p99 %.2f ms, frame p50 %.3f ms p99 %.3f ms, %.0f bytes/key"),
+			Result.NumKeys, Result.SamplesPerSecond, Result.LatencyP50Ms, Result.LatencyP99Ms, Result.FrameCostP50Ms, Result.FrameCostP99Ms, Result.BytesPerKey);
+
+		// Release the case's history before the next, larger one allocates
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+	return Results;
+}
+
+FTelemetryBenchmark::FResult FTelemetryBenchmark::RunCase(const FSettings& Settings, int32 NumKeys)
+{
+	FResult Result;
+	Result.NumKeys = NumKeys;
+
+	// Game instance subsystems must be outered to a game instance; this one is never initialized
+	// into a subsystem collection, so the live manager and its sources are untouched
+	TStrongObjectPtr<UGameInstance> GameInstance(NewObject<UGameInstance>(GetTransientPackage()));
+	TStrongObjectPtr<UUS_TelemetryManager> Manager(NewObject<UUS_TelemetryManager>(GameInstance.Get()));
+	Manager->bDrainedByOwner = true;
+	Manager->RetentionSamplesPerKey = FMath::Max(1, Settings.RetentionSamplesPerKey);
+	Manager->RollupBucketsPerLevel = FMath::Max(1, Settings.RollupBucketsPerLevel);
+	Manager->ResetTelemetryState();
+
+	FTelemetryKeyRegistry& KeyRegistry = *Manager->KeyRegistry;
+	FTelemetryIngestQueue& Queue = *Manager->IngestQueue;
+	const FTelemetryTimeSeriesStore& Store = Manager->GetTimeSeriesStore();
+	const FClock Clock;
+
+	TArray<int32> Slots;
+	Slots.Reserve(NumKeys);
+	for (int32 Index = 0; Index < NumKeys; ++Index)
+	{
+		Slots.Add(Manager->RegisterTelemetryKey(FName(TEXT("Benchmark"), Index + 1)).Index);
+	}
+
+	// One subscriber per key, recording the age of the oldest sample each notification delivers
+	TArray<int64> LastSeenTicks;
+	LastSeenTicks.Init(0, FMath::Max(Store.NumSlots(), Slots.Num() > 0 ? Slots.Last() + 1 : 0));
+	TArray<double> Latencies;
+	bool bRecordLatency = false;
+
+	for (const int32 Slot : Slots)
+	{
+		const FTelemetryHandle Handle(Slot);
+		Manager->SubscribeToTelemetry(MakeArrayView(&Handle, 1), FOnTelemetrySubscriptionUpdated::CreateLambda([&, Slot]()
+		{
+			int64 OldestTicks = MAX_int64;
+			int64 NewestTicks = 0;
+			Store.ForEachSampleSince(Slot, LastSeenTicks[Slot] + 1, [&OldestTicks, &NewestTicks](int64 TimestampTicks, float Value)
+			{
+				OldestTicks = FMath::Min(OldestTicks, TimestampTicks);
+				NewestTicks = FMath::Max(NewestTicks, TimestampTicks);
+			});
+
+			if (NewestTicks > 0)
+			{
+				if (bRecordLatency)
+				{
+					Latencies.Add(double(Clock.NowTicks() - OldestTicks) / ETimespan::TicksPerMillisecond);
+				}
+				LastSeenTicks[Slot] = NewestTicks;
+			}
+		}));
+	}
+
+	const int32 NumProducers = FMath::Clamp(Settings.ProducerThreads, 1, NumKeys);
+	auto ProducerRange = [NumKeys, NumProducers](int32 Producer, int32& OutFirst, int32& OutLast)
+	{
+		OutFirst = int32(int64(NumKeys) * Producer / NumProducers);
+		OutLast = int32(int64(NumKeys) * (Producer + 1) / NumProducers);
+	};
+
+	// Throughput: a backlog of one-second-spaced history per key, pushed as fast as possible
+	{
+		const int32 SamplesPerKey = FMath::Max(1, Settings.ThroughputSamplesPerKey);
+		const int64 BaseTicks = Clock.NowTicks() - int64(SamplesPerKey) * ETimespan::TicksPerSecond;
+		Result.ThroughputSamples = int64(NumKeys) * SamplesPerKey;
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		TArray<TFuture<void>> Producers;
+		for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+		{
+			int32 First = 0;
+			int32 Last = 0;
+			ProducerRange(Producer, First, Last);
+
+			Producers.Add(Async(EAsyncExecution::Thread, [&KeyRegistry, &Queue, &Slots, First, Last, SamplesPerKey, BaseTicks]()
+			{
+				FTelemetrySampleWriter Writer(KeyRegistry);
+				for (int32 Sample = 0; Sample < SamplesPerKey; ++Sample)
+				{
+					const int64 TimestampTicks = BaseTicks + int64(Sample) * ETimespan::TicksPerSecond;
+					for (int32 Index = First; Index < Last; ++Index)
+					{
+						Writer.Add(Slots[Index], TimestampTicks, float(Sample));
+						if (Writer.NumPending() >= FlushSamples)
+						{
+							Writer.Flush(Queue);
+						}
+					}
+				}
+				Writer.Flush(Queue);
+			}));
+		}
+
+		const int64 TargetCount = Manager->CommittedSampleCount + Result.ThroughputSamples;
+		for (;;)
+		{
+			Manager->DrainIngestQueue();
+			if (Manager->CommittedSampleCount >= TargetCount)
+			{
+				break;
+			}
+
+			// Stop if samples were rejected instead of spinning forever
+			const bool bProducersDone = Algo::AllOf(Producers, [](const TFuture<void>& Producer) { return Producer.IsReady(); });
+			if (bProducersDone && Queue.GetPendingSampleCount() == 0)
+			{
+				Manager->DrainIngestQueue();
+				break;
+			}
+		}
+
+		const double Seconds = double(FPlatformTime::Cycles64() - StartCycles) * FPlatformTime::GetSecondsPerCycle64();
+		Result.SamplesPerSecond = Seconds > 0.0 ? double(Result.ThroughputSamples) / Seconds : 0.0;
+
+		for (TFuture<void>& Producer : Producers)
+		{
+			Producer.Wait();
+		}
+	}
+
+	// Steady state: every key at KeyUpdateHz, one drain per simulated frame
+	{
+		std::atomic<bool> bStop(false);
+		const double KeyUpdateHz = FMath::Max(0.001, Settings.KeyUpdateHz);
+
+		TArray<TFuture<void>> Producers;
+		for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+		{
+			int32 First = 0;
+			int32 Last = 0;
+			ProducerRange(Producer, First, Last);
+
+			Producers.Add(Async(EAsyncExecution::Thread, [&KeyRegistry, &Queue, &Slots, &Clock, &bStop, First, Last, KeyUpdateHz]()
+			{
+				FTelemetrySampleWriter Writer(KeyRegistry);
+				const double Rate = double(Last - First) * KeyUpdateHz;
+				const double StartSeconds = FPlatformTime::Seconds();
+				int64 Emitted = 0;
+				int32 Next = First;
+
+				while (!bStop.load(std::memory_order_relaxed))
+				{
+					const int64 Due = int64((FPlatformTime::Seconds() - StartSeconds) * Rate);
+					const int64 TimestampTicks = Clock.NowTicks();
+					for (; Emitted < Due; ++Emitted)
+					{
+						Writer.Add(Slots[Next], TimestampTicks, float(Emitted));
+						Next = Next + 1 < Last ? Next + 1 : First;
+						if (Writer.NumPending() >= FlushSamples)
+						{
+							Writer.Flush(Queue);
+						}
+					}
+					Writer.Flush(Queue);
+					FPlatformProcess::Sleep(ProducerInterval);
+				}
+			}));
+		}
+
+		bRecordLatency = true;
+
+		TArray<double> FrameCosts;
+		FrameCosts.Reserve(Settings.Frames);
+		for (int32 Frame = 0; Frame < Settings.Frames; ++Frame)
+		{
+			const double FrameStart = FPlatformTime::Seconds();
+
+			const uint64 DrainStart = FPlatformTime::Cycles64();
+			Manager->DrainIngestQueue();
+			FrameCosts.Add(double(FPlatformTime::Cycles64() - DrainStart) * FPlatformTime::GetSecondsPerCycle64() * 1000.0);
+
+			const double Remaining = Settings.FrameSeconds - (FPlatformTime::Seconds() - FrameStart);
+			if (Remaining > 0.0)
+			{
+				FPlatformProcess::Sleep(float(Remaining));
+			}
+		}
+
+		bStop = true;
+		for (TFuture<void>& Producer : Producers)
+		{
+			Producer.Wait();
+		}
+
+		// Samples still queued are not part of the measurement
+		bRecordLatency = false;
+		Manager->DrainIngestQueue();
+
+		FrameCosts.Sort();
+		Result.FrameCostP50Ms = Percentile(FrameCosts, 0.5);
+		Result.FrameCostP99Ms = Percentile(FrameCosts, 0.99);
+		Result.FrameCostMaxMs = FrameCosts.Num() > 0 ? FrameCosts.Last() : 0.0;
+
+		Latencies.Sort();
+		Result.Notifications = Latencies.Num();
+		Result.LatencyP50Ms = Percentile(Latencies, 0.5);
+		Result.LatencyP99Ms = Percentile(Latencies, 0.99);
+		Result.LatencyMaxMs = Latencies.Num() > 0 ? Latencies.Last() : 0.0;
+	}
+
+	Result.BytesPerKey = double(Manager->GetTelemetryAllocatedSize()) / NumKeys;
+	return Result;
+}
+
+bool FTelemetryBenchmark::WriteResults(const FSettings& Settings, TConstArrayView<FResult> Results, const FString& Directory, FString& OutCsvPath, FString& OutJsonPath)
+{
+	const FString BaseName = Directory / FString::Printf(TEXT("TelemetryBenchmark_%s"), *FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S")));
+	OutCsvPath = BaseName + TEXT(".csv");
+	OutJsonPath = BaseName + TEXT(".json");
+
+	const FString Build = FApp::GetBuildVersion();
+	const FString Configuration = LexToString(FApp::GetBuildConfiguration());
+	const FString Platform = FPlatformProperties::IniPlatformName();
+
+	FString Csv = TEXT("Build,Configuration,Platform,Keys,RetentionSamplesPerKey,RollupBucketsPerLevel,ProducerThreads,")
+		TEXT("ThroughputSamples,SamplesPerSecond,Notifications,LatencyP50Ms,LatencyP99Ms,LatencyMaxMs,")
+		TEXT("FrameCostP50Ms,FrameCostP99Ms,FrameCostMaxMs,BytesPerKey\n");
+	for (const FResult& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%s,%s,%s,%d,%d,%d,%d,%lld,%.1f,%lld,%.3f,%.3f,%.3f,%.4f,%.4f,%.4f,%.1f\n"),
+			*Build, *Configuration, *Platform, Result.NumKeys, Settings.RetentionSamplesPerKey, Settings.RollupBucketsPerLevel, Settings.ProducerThreads,
+			Result.ThroughputSamples, Result.SamplesPerSecond, Result.Notifications, Result.LatencyP50Ms, Result.LatencyP99Ms, Result.LatencyMaxMs,
+			Result.FrameCostP50Ms, Result.FrameCostP99Ms, Result.FrameCostMaxMs, Result.BytesPerKey);
+	}
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("benchmark"), TEXT("telemetry"));
+	Writer->WriteValue(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Writer->WriteValue(TEXT("build"), Build);
+	Writer->WriteValue(TEXT("configuration"), Configuration);
+	Writer->WriteValue(TEXT("platform"), Platform);
+	Writer->WriteValue(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	Writer->WriteValue(TEXT("engine"), FEngineVersion::Current().ToString());
+
+	Writer->WriteObjectStart(TEXT("settings"));
+	Writer->WriteValue(TEXT("retentionSamplesPerKey"), Settings.RetentionSamplesPerKey);
+	Writer->WriteValue(TEXT("rollupBucketsPerLevel"), Settings.RollupBucketsPerLevel);
+	Writer->WriteValue(TEXT("producerThreads"), Settings.ProducerThreads);
+	Writer->WriteValue(TEXT("throughputSamplesPerKey"), Settings.ThroughputSamplesPerKey);
+	Writer->WriteValue(TEXT("frames"), Settings.Frames);
+	Writer->WriteValue(TEXT("frameSeconds"), Settings.FrameSeconds);
+	Writer->WriteValue(TEXT("keyUpdateHz"), Settings.KeyUpdateHz);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteArrayStart(TEXT("results"));
+	for (const FResult& Result : Results)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("keys"), Result.NumKeys);
+		Writer->WriteValue(TEXT("throughputSamples"), Result.ThroughputSamples);
+		Writer->WriteValue(TEXT("samplesPerSecond"), Result.SamplesPerSecond);
+		Writer->WriteValue(TEXT("notifications"), Result.Notifications);
+		Writer->WriteValue(TEXT("latencyP50Ms"), Result.LatencyP50Ms);
+		Writer->WriteValue(TEXT("latencyP99Ms"), Result.LatencyP99Ms);
+		Writer->WriteValue(TEXT("latencyMaxMs"), Result.LatencyMaxMs);
+		Writer->WriteValue(TEXT("frameCostP50Ms"), Result.FrameCostP50Ms);
+		Writer->WriteValue(TEXT("frameCostP99Ms"), Result.FrameCostP99Ms);
+		Writer->WriteValue(TEXT("frameCostMaxMs"), Result.FrameCostMaxMs);
+		Writer->WriteValue(TEXT("bytesPerKey"), Result.BytesPerKey);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	return FFileHelper::SaveStringToFile(Csv, *OutCsvPath) && FFileHelper::SaveStringToFile(Json, *OutJsonPath);
+}
+
+#endif // !UE_BUILD_SHIPPING
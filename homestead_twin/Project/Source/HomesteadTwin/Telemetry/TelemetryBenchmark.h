@@ -0,0 +1,95 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UUS_TelemetryManager;
+
+/**
+ * FTelemetryBenchmark
+ *
+ * Ingest throughput and latency benchmark for UUS_TelemetryManager.
+ *
+ * Responsibilities:
+ * - Measure, per key count: saturated ingest rate, latency from sample hand-off to subscriber
+ *   notification, game-thread drain cost per frame, and memory per key
+ * - Write the results with build information as CSV and JSON under Saved/Benchmarks, so runs
+ *   of different builds can be compared
+ *
+ * Implementation Notes:
+ * - Each key count runs against a private, transient manager (no sources, no persistence), so
+ *   the live manager and its history are never touched; it is outered to its own transient game
+ *   instance, never initialized, and never ticked (the benchmark drives every drain)
+ * - Producer threads feed the real ingest queue through FTelemetrySampleWriter; every key has a
+ *   subscriber, standing in for one telemetry component per key
+ * - Throughput phase: producers push SamplesPerKey samples per key as fast as they can while the
+ *   game thread drains back to back
+ * - Steady-state phase: every key updates at KeyUpdateHz and the game thread drains once per
+ *   simulated frame; latency is measured from the oldest sample a notification delivers
+ * - Samples are stamped from the cycle counter, so stamping and measuring cost no clock syscalls
+ * - Runs on the game thread and blocks it; meant for headless runs
+ *   (-game -nullrhi -ExecCmds="HomesteadTwin.Telemetry.Benchmark; quit")
+ * - Not compiled into shipping builds
+ */
+class HOMESTEADTWIN_API FTelemetryBenchmark
+{
+public:
+	struct FSettings
+	{
+		/** Key counts to run, one case each */
+		TArray<int32> KeyCounts = { 1000, 10000, 100000 };
+
+		/** History and rollup sizes of the benchmark manager (memory per key depends on them) */
+		int32 RetentionSamplesPerKey = 600;
+		int32 RollupBucketsPerLevel = 128;
+
+		/** Threads producing samples */
+		int32 ProducerThreads = 2;
+
+		/** Samples per key in the throughput phase */
+		int32 ThroughputSamplesPerKey = 20;
+
+		/** Steady-state phase: frames simulated at FrameSeconds each, every key updating at KeyUpdateHz */
+		int32 Frames = 300;
+		double FrameSeconds = 1.0 / 60.0;
+		double KeyUpdateHz = 1.0;
+	};
+
+	/** Measurements of one key count */
+	struct FResult
+	{
+		int32 NumKeys = 0;
+
+		/** Throughput phase */
+		int64 ThroughputSamples = 0;
+		double SamplesPerSecond = 0.0;
+
+		/** Steady-state phase: hand-off to subscriber notification (ms) */
+		int64 Notifications = 0;
+		double LatencyP50Ms = 0.0;
+		double LatencyP99Ms = 0.0;
+		double LatencyMaxMs = 0.0;
+
+		/** Steady-state phase: game-thread drain time per frame, subscriber callbacks included (ms) */
+		double FrameCostP50Ms = 0.0;
+		double FrameCostP99Ms = 0.0;
+		double FrameCostMaxMs = 0.0;
+
+		/** Manager heap memory divided by the key count */
+		double BytesPerKey = 0.0;
+	};
+
+	/** Run every configured key count */
+	static TArray<FResult> Run(const FSettings& Settings);
+
+	/**
+	 * Write results to <Directory>/TelemetryBenchmark_<time>.csv and .json.
+	 * Returns false if either file could not be written.
+	 */
+	static bool WriteResults(const FSettings& Settings, TConstArrayView<FResult> Results, const FString& Directory, FString& OutCsvPath, FString& OutJsonPath);
+
+private:
+	/** Run one key count against a fresh manager */
+	static FResult RunCase(const FSettings& Settings, int32 NumKeys);
+};
@@ -0,0 +1,65 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryEndpointHealth.h"
+#include "Misc/ScopeLock.h"
+
+void FTelemetryEndpointHealth::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries.Reset();
+	Revision.fetch_add(1, std::memory_order_release);
+}
+
+int32 FTelemetryEndpointHealth::Register(FName EndpointId)
+{
+	FScopeLock ScopeLock(&Lock);
+	const int32 Index = Entries.AddDefaulted();
+	Entries[Index].EndpointId = EndpointId;
+	Revision.fetch_add(1, std::memory_order_release);
+	return Index;
+}
+
+void FTelemetryEndpointHealth::ReportSuccess(int32 Index)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (!Entries.IsValidIndex(Index))
+	{
+		return;
+	}
+
+	FSnapshot& Entry = Entries[Index];
+	const bool bChanged = !Entry.bHealthy || Entry.ConsecutiveFailures != 0;
+	Entry.bHealthy = true;
+	Entry.ConsecutiveFailures = 0;
+	Entry.BackoffSeconds = 0.0;
+	Entry.LastSuccessTicks = FDateTime::UtcNow().GetTicks();
+
+	// Routine successes only refresh the timestamp; readers poll it through snapshots
+	if (bChanged)
+	{
+		Revision.fetch_add(1, std::memory_order_release);
+	}
+}
+
+void FTelemetryEndpointHealth::ReportFailure(int32 Index, int32 ConsecutiveFailures, double BackoffSeconds, const FString& Error)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (!Entries.IsValidIndex(Index))
+	{
+		return;
+	}
+
+	FSnapshot& Entry = Entries[Index];
+	Entry.bHealthy = false;
+	Entry.ConsecutiveFailures = ConsecutiveFailures;
+	Entry.BackoffSeconds = BackoffSeconds;
+	Entry.LastFailureTicks = FDateTime::UtcNow().GetTicks();
+	Entry.LastError = Error;
+	Revision.fetch_add(1, std::memory_order_release);
+}
+
+void FTelemetryEndpointHealth::GetSnapshots(TArray<FSnapshot>& OutSnapshots) const
+{
+	FScopeLock ScopeLock(&Lock);
+	OutSnapshots = Entries;
+}
@@ -0,0 +1,68 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * FTelemetryEndpointHealth
+ *
+ * Thread-safe health table for telemetry endpoints (REST endpoints, MQTT brokers).
+ *
+ * Responsibilities:
+ * - Let sources report successes and failures (with their backoff) from any thread
+ * - Give the game thread a consistent snapshot for status displays and offline detection
+ *
+ * Implementation Notes:
+ * - Reports are rare (once per poll or connection change), so a critical section is enough
+ * - Revision increments on every state change; readers copy only when it moved
+ */
+class HOMESTEADTWIN_API FTelemetryEndpointHealth
+{
+public:
+	/** State of one endpoint */
+	struct FSnapshot
+	{
+		FName EndpointId;
+
+		/** Last contact succeeded (poll answered / broker session up) */
+		bool bHealthy = false;
+
+		int32 ConsecutiveFailures = 0;
+
+		/** Wait before the next attempt (0 = not backing off) */
+		double BackoffSeconds = 0.0;
+
+		/** UTC ticks of the last success / failure (0 = never) */
+		int64 LastSuccessTicks = 0;
+		int64 LastFailureTicks = 0;
+
+		FString LastError;
+	};
+
+	/** Drop every endpoint (before sources are created) */
+	void Reset();
+
+	/** Add an endpoint; returns the index used for reports */
+	int32 Register(FName EndpointId);
+
+	/** Report a successful contact (any thread) */
+	void ReportSuccess(int32 Index);
+
+	/** Report a failed contact and the backoff before the next attempt (any thread) */
+	void ReportFailure(int32 Index, int32 ConsecutiveFailures, double BackoffSeconds, const FString& Error);
+
+	/** Copy every endpoint's state */
+	void GetSnapshots(TArray<FSnapshot>& OutSnapshots) const;
+
+	/** Incremented on every change */
+	uint32 GetRevision() const { return Revision.load(std::memory_order_acquire); }
+
+private:
+	mutable FCriticalSection Lock;
+
+	TArray<FSnapshot> Entries;
+
+	std::atomic<uint32> Revision{0};
+};
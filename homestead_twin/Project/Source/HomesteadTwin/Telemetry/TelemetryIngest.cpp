@@ -0,0 +1,118 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryIngest.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+
+namespace TelemetryIngest
+{
+	/** Longest the worker sleeps when no source asks for an earlier tick (seconds) */
+	constexpr double MaxSleepSeconds = 1.0;
+}
+
+FTelemetryIngestWorker::FTelemetryIngestWorker(TSharedRef<FTelemetryKeyRegistry> InKeyRegistry, TSharedRef<FTelemetryIngestQueue> InQueue)
+	: KeyRegistry(InKeyRegistry)
+	, Queue(InQueue)
+	, Thread(nullptr)
+	, WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, bStopRequested(false)
+	, bWakeRequested(false)
+{
+}
+
+FTelemetryIngestWorker::~FTelemetryIngestWorker()
+{
+	StopThread();
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FTelemetryIngestWorker::AddSource(TSharedRef<ITelemetrySource> Source)
+{
+	check(Thread == nullptr);
+	Sources.Add(Source);
+}
+
+void FTelemetryIngestWorker::StartThread()
+{
+	if (Thread)
+	{
+		return;
+	}
+
+	bStopRequested = false;
+	Thread = FRunnableThread::Create(this, TEXT("TelemetryIngest"), 0, TPri_BelowNormal);
+}
+
+void FTelemetryIngestWorker::StopThread()
+{
+	if (!Thread)
+	{
+		return;
+	}
+
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+}
+
+void FTelemetryIngestWorker::Wake()
+{
+	bWakeRequested = true;
+	WakeEvent->Trigger();
+}
+
+uint32 FTelemetryIngestWorker::Run()
+{
+	FTelemetrySampleWriter Writer(*KeyRegistry);
+
+	for (const TSharedRef<ITelemetrySource>& Source : Sources)
+	{
+		Source->Start();
+	}
+
+	TArray<double> NextTickTimes;
+	NextTickTimes.Init(0.0, Sources.Num());
+
+	while (!bStopRequested)
+	{
+		const double Now = FPlatformTime::Seconds();
+		double NextWake = Now + TelemetryIngest::MaxSleepSeconds;
+		const bool bWoken = bWakeRequested.exchange(false);
+
+		for (int32 Index = 0; Index < Sources.Num(); ++Index)
+		{
+			if (bWoken || Now >= NextTickTimes[Index])
+			{
+				NextTickTimes[Index] = Now + FMath::Max(0.0, Sources[Index]->Tick(Now, Writer));
+			}
+			NextWake = FMath::Min(NextWake, NextTickTimes[Index]);
+		}
+
+		// One batch per pass keeps queue traffic proportional to passes, not samples
+		Writer.Flush(*Queue);
+
+		const double SleepSeconds = NextWake - FPlatformTime::Seconds();
+		if (SleepSeconds > 0.0)
+		{
+			WakeEvent->Wait(FTimespan::FromSeconds(SleepSeconds));
+		}
+	}
+
+	for (const TSharedRef<ITelemetrySource>& Source : Sources)
+	{
+		Source->Stop();
+	}
+
+	return 0;
+}
+
+void FTelemetryIngestWorker::Stop()
+{
+	bStopRequested = true;
+	WakeEvent->Trigger();
+}
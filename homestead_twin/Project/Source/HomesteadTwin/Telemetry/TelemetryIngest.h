@@ -0,0 +1,224 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "TelemetryKeyRegistry.h"
+#include "TelemetryValue.h"
+#include <atomic>
+
+class FRunnableThread;
+class FEvent;
+
+/**
+ * FTelemetrySample
+ *
+ * A single decoded telemetry value, addressed by dense slot.
+ * Fixed size (the value is a tagged 16-byte FTelemetryValue), so batches never allocate per sample.
+ */
+struct FTelemetrySample
+{
+	/** Slot from FTelemetryKeyRegistry */
+	int32 Slot;
+
+	/** Played back from the persisted log (already on disk; fits in Slot's padding) */
+	bool bReplayed;
+
+	/** No new value: the source confirmed Slot is unchanged (e.g. HTTP 304), which only keeps it fresh */
+	bool bKeepAlive;
+
+	/** Generated by a mock source: committed for display, but never persisted as history */
+	bool bSimulated;
+
+	/** Sample time (UTC ticks) */
+	int64 TimestampTicks;
+
+	/** Sample value */
+	FTelemetryValue Value;
+};
+
+/**
+ * FTelemetryIngestQueue
+ *
+ * Lock-free multi-producer / single-consumer hand-off from ingest threads to the
+ * game thread. Producers push whole batches so the per-node cost is amortized.
+ */
+class HOMESTEADTWIN_API FTelemetryIngestQueue
+{
+public:
+	/** Push a batch (any thread). Empty batches are ignored. */
+	void Enqueue(TArray<FTelemetrySample>&& Batch)
+	{
+		if (Batch.Num() == 0)
+		{
+			return;
+		}
+
+		PendingSamples.fetch_add(Batch.Num(), std::memory_order_relaxed);
+		Batches.Enqueue(MoveTemp(Batch));
+	}
+
+	/** Pop every queued batch (consumer thread only). Func(TConstArrayView<FTelemetrySample>). Returns samples drained. */
+	template <typename FuncType>
+	int32 Drain(FuncType&& Func)
+	{
+		int32 Drained = 0;
+		TArray<FTelemetrySample> Batch;
+		while (Batches.Dequeue(Batch))
+		{
+			Drained += Batch.Num();
+			Func(TConstArrayView<FTelemetrySample>(Batch));
+		}
+
+		PendingSamples.fetch_sub(Drained, std::memory_order_relaxed);
+		return Drained;
+	}
+
+	/** Number of samples waiting to be drained */
+	int32 GetPendingSampleCount() const { return PendingSamples.load(std::memory_order_relaxed); }
+
+private:
+	TQueue<TArray<FTelemetrySample>, EQueueMode::Mpsc> Batches;
+
+	std::atomic<int32> PendingSamples{0};
+};
+
+/**
+ * FTelemetrySampleWriter
+ *
+ * Per-producer batch builder. Resolves keys through the shared registry and
+ * collects samples until flushed into the ingest queue.
+ */
+class HOMESTEADTWIN_API FTelemetrySampleWriter
+{
+public:
+	explicit FTelemetrySampleWriter(FTelemetryKeyRegistry& InKeyRegistry)
+		: KeyRegistry(InKeyRegistry)
+	{}
+
+	/** Resolve a key into a slot (cache the result; this takes a registry lock) */
+	int32 ResolveKey(FName Key) { return KeyRegistry.FindOrAdd(Key); }
+
+	/** Add a float sample for a resolved slot */
+	void Add(int32 Slot, int64 TimestampTicks, float Value)
+	{
+		Pending.Add(FTelemetrySample{ Slot, false, false, false, TimestampTicks, FTelemetryValue::MakeFloat(Value) });
+	}
+
+	/** Add a typed sample for a resolved slot */
+	void Add(int32 Slot, int64 TimestampTicks, const FTelemetryValue& Value)
+	{
+		Pending.Add(FTelemetrySample{ Slot, false, false, false, TimestampTicks, Value });
+	}
+
+	/** Add a sample played back from the persisted log (committed like any other, but not logged again) */
+	void AddReplayed(int32 Slot, int64 TimestampTicks, const FTelemetryValue& Value)
+	{
+		Pending.Add(FTelemetrySample{ Slot, true, false, false, TimestampTicks, Value });
+	}
+
+	/** Add a generated sample (committed like any other, but never written to the persisted log) */
+	void AddSimulated(int32 Slot, int64 TimestampTicks, const FTelemetryValue& Value)
+	{
+		Pending.Add(FTelemetrySample{ Slot, false, false, true, TimestampTicks, Value });
+	}
+
+	/** Confirm a slot's value is still current without a new sample (keeps it fresh; nothing is committed) */
+	void AddKeepAlive(int32 Slot, int64 TimestampTicks)
+	{
+		Pending.Add(FTelemetrySample{ Slot, false, true, false, TimestampTicks, FTelemetryValue() });
+	}
+
+	/** Number of samples collected since the last flush */
+	int32 NumPending() const { return Pending.Num(); }
+
+	/** Hand the collected batch to the queue */
+	void Flush(FTelemetryIngestQueue& Queue)
+	{
+		if (Pending.Num() > 0)
+		{
+			Queue.Enqueue(MoveTemp(Pending));
+			Pending.Reset();
+		}
+	}
+
+private:
+	FTelemetryKeyRegistry& KeyRegistry;
+
+	TArray<FTelemetrySample> Pending;
+};
+
+/**
+ * ITelemetrySource
+ *
+ * A producer of telemetry samples driven by FTelemetryIngestWorker.
+ * All methods are called on the ingest thread.
+ */
+class HOMESTEADTWIN_API ITelemetrySource
+{
+public:
+	virtual ~ITelemetrySource() = default;
+
+	/** Called once when the worker starts running this source */
+	virtual void Start() {}
+
+	/**
+	 * Fetch, parse and decode any available data into Writer.
+	 * Returns the number of seconds until the source wants to be ticked again; sources may
+	 * be ticked earlier (see FTelemetryIngestWorker::Wake).
+	 */
+	virtual double Tick(double NowSeconds, FTelemetrySampleWriter& Writer) = 0;
+
+	/** Called once when the worker stops */
+	virtual void Stop() {}
+};
+
+/**
+ * FTelemetryIngestWorker
+ *
+ * Dedicated thread that runs every telemetry source and pushes decoded samples
+ * into the ingest queue, keeping network I/O and parsing off the game thread.
+ */
+class HOMESTEADTWIN_API FTelemetryIngestWorker : public FRunnable
+{
+public:
+	FTelemetryIngestWorker(TSharedRef<FTelemetryKeyRegistry> InKeyRegistry, TSharedRef<FTelemetryIngestQueue> InQueue);
+	virtual ~FTelemetryIngestWorker();
+
+	/** Add a source (must be called before StartThread) */
+	void AddSource(TSharedRef<ITelemetrySource> Source);
+
+	/** Spawn the ingest thread */
+	void StartThread();
+
+	/** Signal the thread to exit and wait for it */
+	void StopThread();
+
+	/** Wake the thread early and tick every source on its next pass (e.g. after a source rescheduled itself on another thread) */
+	void Wake();
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable Interface
+
+private:
+	TSharedRef<FTelemetryKeyRegistry> KeyRegistry;
+	TSharedRef<FTelemetryIngestQueue> Queue;
+
+	/** Sources run by this worker */
+	TArray<TSharedRef<ITelemetrySource>> Sources;
+
+	/** Ingest thread (null when not running) */
+	FRunnableThread* Thread;
+
+	/** Used to sleep between source ticks and to wake early on stop */
+	FEvent* WakeEvent;
+
+	std::atomic<bool> bStopRequested;
+
+	/** Set by Wake: tick every source regardless of its requested interval */
+	std::atomic<bool> bWakeRequested;
+};
@@ -0,0 +1,88 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+/**
+ * FTelemetryKeyRegistry
+ *
+ * Thread-safe mapping between telemetry keys and dense slot indices.
+ *
+ * Implementation Notes:
+ * - Shared between the game thread and ingest threads; sources resolve each key
+ *   once and then only pass slot indices around
+ * - Slots are never removed, so a resolved slot stays valid until Reset
+ */
+class HOMESTEADTWIN_API FTelemetryKeyRegistry
+{
+public:
+	/** Get the slot for a key, assigning the next dense slot if the key is unknown */
+	int32 FindOrAdd(FName Key)
+	{
+		{
+			FReadScopeLock ReadLock(Lock);
+			if (const int32* Slot = KeyToSlot.Find(Key))
+			{
+				return *Slot;
+			}
+		}
+
+		FWriteScopeLock WriteLock(Lock);
+		if (const int32* Slot = KeyToSlot.Find(Key))
+		{
+			return *Slot;
+		}
+
+		const int32 NewSlot = SlotKeys.Add(Key);
+		KeyToSlot.Add(Key, NewSlot);
+		return NewSlot;
+	}
+
+	/** Get the slot for a key (INDEX_NONE if unknown) */
+	int32 Find(FName Key) const
+	{
+		FReadScopeLock ReadLock(Lock);
+		const int32* Slot = KeyToSlot.Find(Key);
+		return Slot ? *Slot : INDEX_NONE;
+	}
+
+	/** Get the key owning a slot */
+	FName GetKey(int32 Slot) const
+	{
+		FReadScopeLock ReadLock(Lock);
+		return SlotKeys.IsValidIndex(Slot) ? SlotKeys[Slot] : NAME_None;
+	}
+
+	/** Number of registered keys */
+	int32 Num() const
+	{
+		FReadScopeLock ReadLock(Lock);
+		return SlotKeys.Num();
+	}
+
+	/** Forget every key (only safe while no ingest thread is running) */
+	void Reset()
+	{
+		FWriteScopeLock WriteLock(Lock);
+		KeyToSlot.Reset();
+		SlotKeys.Reset();
+	}
+
+	/** Approximate heap memory held by the registry (bytes) */
+	SIZE_T GetAllocatedSize() const
+	{
+		FReadScopeLock ReadLock(Lock);
+		return KeyToSlot.GetAllocatedSize() + SlotKeys.GetAllocatedSize();
+	}
+
+private:
+	mutable FRWLock Lock;
+
+	/** Key -> dense slot */
+	TMap<FName, int32> KeyToSlot;
+
+	/** Slot -> key */
+	TArray<FName> SlotKeys;
+};
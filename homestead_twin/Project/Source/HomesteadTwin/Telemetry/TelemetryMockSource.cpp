@@ -0,0 +1,227 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryMockSource.h"
+
+namespace TelemetryMock
+{
+	/** Tick interval while generating (seconds) */
+	constexpr double TickInterval = 0.01;
+
+	/** Upper bound on samples emitted per tick, so a stall does not turn into one huge batch */
+	constexpr int64 MaxSamplesPerTick = 1000000;
+
+	constexpr double SecondsPerDay = 86400.0;
+
+	/** Hash streams (keep noise, faults and parameters independent) */
+	constexpr uint32 ParamStream = 1;
+	constexpr uint32 NoiseStream = 2;
+	constexpr uint32 FaultStream = 3;
+
+	/** Classic mock key names, in waveform order */
+	const TCHAR* const NamedKeys[] = {
+		TEXT("SolarProduction"),
+		TEXT("BatteryCharge"),
+		TEXT("PowerUsage"),
+		TEXT("Temperature"),
+		TEXT("Humidity")
+	};
+
+	/** Generated key prefixes by waveform */
+	const TCHAR* const KeyPrefixes[] = {
+		TEXT("MockSolar"),
+		TEXT("MockBattery"),
+		TEXT("MockLoad"),
+		TEXT("MockSensor")
+	};
+
+	/** SplitMix64 finalizer */
+	uint64 Mix(uint64 Value)
+	{
+		Value += 0x9E3779B97F4A7C15ull;
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return Value ^ (Value >> 31);
+	}
+
+	/** Daylight factor [0, 1] for a simulated time (sunrise 06:00, sunset 18:00) */
+	float Daylight(double SimSeconds)
+	{
+		const double HourOfDay = FMath::Fmod(SimSeconds / 3600.0, 24.0);
+		const double Sun = FMath::Sin(PI * (HourOfDay - 6.0) / 12.0);
+		return Sun > 0.0 ? float(FMath::Pow(Sun, 1.5)) : 0.0f;
+	}
+}
+
+using namespace TelemetryMock;
+
+FTelemetryMockSource::FTelemetryMockSource(const FSettings& InSettings)
+	: Settings(InSettings)
+	, StartTime(0.0)
+	, EmittedSamples(0)
+{
+	Settings.NumKeys = FMath::Max(1, Settings.NumKeys);
+	Settings.TargetSamplesPerSecond = FMath::Max(0.01f, Settings.TargetSamplesPerSecond);
+
+	RatePerKey = double(Settings.TargetSamplesPerSecond) / Settings.NumKeys;
+	SimSecondsPerSample = Settings.TimeScale / RatePerKey;
+}
+
+void FTelemetryMockSource::Start()
+{
+	BuildModels();
+	StartTime = -1.0;
+	EmittedSamples = 0;
+}
+
+double FTelemetryMockSource::Tick(double NowSeconds, FTelemetrySampleWriter& Writer)
+{
+	if (Models.Num() > 0 && Models[0].Slot == INDEX_NONE)
+	{
+		for (FKeyModel& Model : Models)
+		{
+			Model.Slot = Writer.ResolveKey(Model.Key);
+		}
+	}
+
+	if (StartTime < 0.0)
+	{
+		StartTime = NowSeconds;
+	}
+
+	// Emit exactly the samples that are due at the target rate, round-robin over keys
+	const int64 Due = int64((NowSeconds - StartTime) * Settings.TargetSamplesPerSecond) + Models.Num();
+	int64 Emitted = EmittedSamples.load(std::memory_order_relaxed);
+	const int64 End = FMath::Min(Due, Emitted + MaxSamplesPerTick);
+
+	const int64 NowTicks = FDateTime::UtcNow().GetTicks();
+	const int32 NumModels = Models.Num();
+	for (; Emitted < End; ++Emitted)
+	{
+		const int32 KeyIndex = int32(Emitted % NumModels);
+		FKeyModel& Model = Models[KeyIndex];
+		Writer.AddSimulated(Model.Slot, NowTicks, FTelemetryValue::MakeFloat(GenerateValue(Model, KeyIndex, Emitted / NumModels)));
+	}
+
+	EmittedSamples.store(Emitted, std::memory_order_relaxed);
+
+	// Low rates sleep until the next sample is due; high rates batch at TickInterval
+	const double UntilNext = double(Emitted - Due + 1) / Settings.TargetSamplesPerSecond;
+	return FMath::Max(TickInterval, UntilNext);
+}
+
+void FTelemetryMockSource::BuildModels()
+{
+	Models.Reset(Settings.NumKeys);
+
+	const bool bNamedKeys = Settings.NumKeys <= UE_ARRAY_COUNT(NamedKeys);
+	for (int32 KeyIndex = 0; KeyIndex < Settings.NumKeys; ++KeyIndex)
+	{
+		FKeyModel& Model = Models.AddDefaulted_GetRef();
+		Model.Waveform = bNamedKeys ? EWaveform(FMath::Min(KeyIndex, 3)) : EWaveform(KeyIndex % 4);
+
+		Model.Key = bNamedKeys
+			? FName(NamedKeys[KeyIndex])
+			: FName(KeyPrefixes[KeyIndex % 4], KeyIndex / 4 + 1);
+
+		const float R0 = Hash01(KeyIndex, 0, ParamStream);
+		const float R1 = Hash01(KeyIndex, 1, ParamStream);
+		const float R2 = Hash01(KeyIndex, 2, ParamStream);
+
+		switch (Model.Waveform)
+		{
+		case EWaveform::Solar:
+			// Peak array output (kW)
+			Model.Amplitude = FMath::Lerp(3.0f, 12.0f, R0);
+			Model.NoiseAmplitude = 0.05f;
+			break;
+
+		case EWaveform::Battery:
+			// Capacity (kWh) and starting state of charge (%)
+			Model.Amplitude = FMath::Lerp(10.0f, 40.0f, R0);
+			Model.Charge = FMath::Lerp(30.0f, 90.0f, R1);
+			break;
+
+		case EWaveform::Load:
+			// Base load and evening peak (kW)
+			Model.Baseline = FMath::Lerp(0.3f, 1.2f, R0);
+			Model.Amplitude = FMath::Lerp(1.0f, 4.0f, R1);
+			Model.NoiseAmplitude = 0.2f;
+			break;
+
+		case EWaveform::Environment:
+			// Humidity-style sensors sit higher with a larger swing than temperature
+			Model.Baseline = (bNamedKeys && KeyIndex == 4) ? 55.0f : FMath::Lerp(15.0f, 25.0f, R0);
+			Model.Amplitude = (bNamedKeys && KeyIndex == 4) ? 15.0f : FMath::Lerp(3.0f, 8.0f, R1);
+			Model.NoiseAmplitude = 0.3f;
+			break;
+		}
+
+		Model.Phase = R2 * 2.0f * PI;
+	}
+}
+
+float FTelemetryMockSource::GenerateValue(FKeyModel& Model, int32 KeyIndex, int64 SampleIndex)
+{
+	const double SimSeconds = Settings.StartHour * 3600.0 + SampleIndex * SimSecondsPerSample;
+	const float Noise = (Hash01(KeyIndex, SampleIndex, NoiseStream) * 2.0f - 1.0f);
+
+	float Value = 0.0f;
+	switch (Model.Waveform)
+	{
+	case EWaveform::Solar:
+	{
+		// Slow cloud cover: one random attenuation per simulated 10 minutes
+		const float Cloud = 0.6f + 0.4f * Hash01(KeyIndex, uint64(SimSeconds / 600.0), NoiseStream + 16);
+		Value = Model.Amplitude * Daylight(SimSeconds) * Cloud + Model.NoiseAmplitude * Noise * Daylight(SimSeconds);
+		break;
+	}
+
+	case EWaveform::Battery:
+	{
+		// Charge from a nominal array by day, discharge into a nominal load by night
+		const double Hours = SimSecondsPerSample / 3600.0;
+		const float NetPower = 6.0f * Daylight(SimSeconds) - 1.5f;
+		Model.Charge = FMath::Clamp(Model.Charge + float(NetPower * Hours / Model.Amplitude * 100.0), 5.0f, 100.0f);
+		Value = Model.Charge;
+		break;
+	}
+
+	case EWaveform::Load:
+	{
+		// Morning and evening peaks on top of a base load
+		const double HourOfDay = FMath::Fmod(SimSeconds / 3600.0, 24.0);
+		const float Morning = FMath::Exp(-FMath::Square(float(HourOfDay) - 7.5f) / 2.0f);
+		const float Evening = FMath::Exp(-FMath::Square(float(HourOfDay) - 19.0f) / 4.0f);
+		Value = Model.Baseline + Model.Amplitude * (0.5f * Morning + Evening) + Model.NoiseAmplitude * Noise;
+		break;
+	}
+
+	case EWaveform::Environment:
+		Value = Model.Baseline + Model.Amplitude * float(FMath::Sin(2.0 * PI * SimSeconds / SecondsPerDay + Model.Phase)) + Model.NoiseAmplitude * Noise;
+		break;
+	}
+
+	// Step faults: each simulated hour may hold one fault window of 1-15 minutes
+	if (Settings.FaultsPerKeyPerDay > 0.0f)
+	{
+		const uint64 Hour = uint64(SimSeconds / 3600.0);
+		if (Hash01(KeyIndex, Hour, FaultStream) < Settings.FaultsPerKeyPerDay / 24.0f)
+		{
+			const double FaultStart = (Hour * 3600.0) + Hash01(KeyIndex, Hour, FaultStream + 1) * 2700.0;
+			const double FaultLength = 60.0 + Hash01(KeyIndex, Hour, FaultStream + 2) * 840.0;
+			if (SimSeconds >= FaultStart && SimSeconds < FaultStart + FaultLength)
+			{
+				// Half the faults drop out to zero, half stick at a spike
+				Value = Hash01(KeyIndex, Hour, FaultStream + 3) < 0.5f ? 0.0f : Value * 3.0f + 10.0f;
+			}
+		}
+	}
+
+	return Value;
+}
+
+float FTelemetryMockSource::Hash01(uint32 KeyIndex, uint64 Index, uint32 Stream) const
+{
+	const uint64 Hash = Mix(Mix(Mix(uint64(uint32(Settings.Seed)) ^ (uint64(Stream) << 32)) ^ KeyIndex) ^ Index);
+	return float(Hash >> 40) / float(1 << 24);
+}
@@ -0,0 +1,110 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TelemetryIngest.h"
+
+/**
+ * FTelemetryMockSource
+ *
+ * Deterministic, seeded telemetry generator for mock mode and load testing.
+ *
+ * Responsibilities:
+ * - Generate any number of keys (5 named homestead keys by default, 10k+ for stress runs)
+ * - Model plausible signals: diurnal solar curve, battery charge/discharge, household load,
+ *   environmental sensors with noise, plus injected step faults
+ * - Emit round-robin across keys at an exact target rate so ingest throughput can be measured
+ *
+ * Implementation Notes:
+ * - Sample N of key K depends only on (Seed, K, N) and key K's previous sample, so two runs
+ *   with the same settings produce the same value sequence regardless of tick timing
+ * - Noise and faults come from a stateless integer hash, not a shared random stream
+ * - Waveforms run on simulated time (sample index / per-key rate * TimeScale); timestamps
+ *   are the wall clock at emission
+ * - Samples are flagged simulated, so the telemetry manager never writes them to the segment log
+ */
+class HOMESTEADTWIN_API FTelemetryMockSource : public ITelemetrySource
+{
+public:
+	/** Generator configuration */
+	struct FSettings
+	{
+		/** Seed for every per-key parameter, noise and fault */
+		int32 Seed = 12345;
+
+		/** Number of keys; up to 5 use the classic homestead key names */
+		int32 NumKeys = 5;
+
+		/** Total samples per second across all keys (per-key rate = this / NumKeys) */
+		float TargetSamplesPerSecond = 5.0f;
+
+		/** Simulated seconds per real second (e.g. 3600 = one simulated hour per second) */
+		float TimeScale = 1.0f;
+
+		/** Simulated hour of day at the first sample */
+		float StartHour = 6.0f;
+
+		/** Expected step faults per key per simulated day */
+		float FaultsPerKeyPerDay = 0.5f;
+	};
+
+	explicit FTelemetryMockSource(const FSettings& InSettings);
+
+	/** Samples emitted since Start (any thread) */
+	int64 GetEmittedSamples() const { return EmittedSamples.load(std::memory_order_relaxed); }
+
+	// Begin ITelemetrySource Interface
+	virtual void Start() override;
+	virtual double Tick(double NowSeconds, FTelemetrySampleWriter& Writer) override;
+	// End ITelemetrySource Interface
+
+private:
+	/** Signal model of a key */
+	enum class EWaveform : uint8
+	{
+		Solar,
+		Battery,
+		Load,
+		Environment
+	};
+
+	/** Per-key parameters (derived from the seed) and model state */
+	struct FKeyModel
+	{
+		FName Key;
+		int32 Slot = INDEX_NONE;
+		EWaveform Waveform = EWaveform::Environment;
+
+		/** Waveform scale / offset / phase */
+		float Amplitude = 1.0f;
+		float Baseline = 0.0f;
+		float Phase = 0.0f;
+		float NoiseAmplitude = 0.0f;
+
+		/** Battery state of charge (%) */
+		float Charge = 50.0f;
+	};
+
+	/** Build the key models from the settings */
+	void BuildModels();
+
+	/** Generate sample SampleIndex of a key */
+	float GenerateValue(FKeyModel& Model, int32 KeyIndex, int64 SampleIndex);
+
+	/** Uniform [0, 1) from (Seed, Key, Index) */
+	float Hash01(uint32 KeyIndex, uint64 Index, uint32 Stream) const;
+
+private:
+	FSettings Settings;
+
+	/** Derived per-key rate (Hz) and simulated seconds per sample */
+	double RatePerKey;
+	double SimSecondsPerSample;
+
+	TArray<FKeyModel> Models;
+
+	/** Wall time of the first tick and samples emitted since */
+	double StartTime;
+	std::atomic<int64> EmittedSamples;
+};
@@ -0,0 +1,833 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryMqttClient.h"
+#include "TelemetryEndpointHealth.h"
+#include "../HomesteadTwin.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "AddressInfoTypes.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Crc.h"
+
+namespace TelemetryMqtt
+{
+	/** Seconds between socket polls while a connection is open */
+	constexpr double PollInterval = 0.005;
+
+	/** Seconds allowed for TCP connect + CONNACK */
+	constexpr double ConnectTimeout = 10.0;
+
+	/** Reconnect backoff range (seconds) */
+	constexpr double MinReconnectBackoff = 1.0;
+	constexpr double MaxReconnectBackoff = 30.0;
+
+	/** Seconds between keep-alives for the mapped keys while the session is connected */
+	constexpr double KeyKeepAliveInterval = 0.5;
+
+	/** Bytes requested per Recv call */
+	constexpr int32 ReadChunkSize = 16 * 1024;
+
+	/** MQTT 5 CONNECT property announcing the largest packet we accept */
+	constexpr uint8 MaximumPacketSizeProperty = 0x27;
+
+	/** Control packet types (high nibble of the fixed header) */
+	enum EPacketType : uint8
+	{
+		CONNECT = 1,
+		CONNACK = 2,
+		PUBLISH = 3,
+		PUBACK = 4,
+		SUBSCRIBE = 8,
+		SUBACK = 9,
+		PINGREQ = 12,
+		PINGRESP = 13,
+		DISCONNECT = 14
+	};
+
+	enum class EVarIntResult : uint8
+	{
+		Ok,
+		Incomplete,
+		Malformed
+	};
+
+	void WriteU16(TArray<uint8>& Out, uint16 Value)
+	{
+		Out.Add(uint8(Value >> 8));
+		Out.Add(uint8(Value & 0xFF));
+	}
+
+	void WriteVarInt(TArray<uint8>& Out, uint32 Value)
+	{
+		do
+		{
+			uint8 Byte = Value & 0x7F;
+			Value >>= 7;
+			if (Value > 0)
+			{
+				Byte |= 0x80;
+			}
+			Out.Add(Byte);
+		}
+		while (Value > 0);
+	}
+
+	void WriteU32(TArray<uint8>& Out, uint32 Value)
+	{
+		WriteU16(Out, uint16(Value >> 16));
+		WriteU16(Out, uint16(Value & 0xFFFF));
+	}
+
+	void WriteString(TArray<uint8>& Out, const FString& Value)
+	{
+		FTCHARToUTF8 Utf8(*Value);
+		WriteU16(Out, uint16(Utf8.Length()));
+		Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	EVarIntResult ReadVarInt(TArrayView<const uint8> Data, int32& InOutPos, uint32& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Shift = 0; Shift < 28; Shift += 7)
+		{
+			if (InOutPos >= Data.Num())
+			{
+				return EVarIntResult::Incomplete;
+			}
+
+			const uint8 Byte = Data[InOutPos++];
+			OutValue |= uint32(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				return EVarIntResult::Ok;
+			}
+		}
+		return EVarIntResult::Malformed;
+	}
+
+	bool IsNumberChar(uint8 C)
+	{
+		return (C >= '0' && C <= '9') || C == '-' || C == '+' || C == '.' || C == 'e' || C == 'E';
+	}
+
+	bool IsSpace(uint8 C)
+	{
+		return C == ' ' || C == '\t' || C == '\r' || C == '\n';
+	}
+
+	/** Case-insensitive match of the whole token [P, End) */
+	bool MatchToken(const uint8* P, const uint8* End, const ANSICHAR* Keyword)
+	{
+		for (; *Keyword; ++Keyword, ++P)
+		{
+			if (P >= End || FCharAnsi::ToLower(ANSICHAR(*P)) != *Keyword)
+			{
+				return false;
+			}
+		}
+		return P == End;
+	}
+
+	/**
+	 * Parse a scalar starting at P: a number, true/false/on/off, or text (status strings).
+	 * Inside a JSON object a bare token ends at ',' or '}'. A token that starts with a number
+	 * is that number ("12.5 V"); numbers are copied to a stack buffer only.
+	 */
+	bool ParseScalar(const uint8* P, const uint8* End, bool bInObject, FTelemetryValue& OutValue)
+	{
+		while (P < End && IsSpace(*P))
+		{
+			++P;
+		}
+
+		const bool bQuoted = P < End && *P == '"';
+		if (bQuoted)
+		{
+			++P;
+		}
+
+		const uint8* TokenEnd = P;
+		while (TokenEnd < End && (bQuoted ? *TokenEnd != '"' : !(bInObject && (*TokenEnd == ',' || *TokenEnd == '}'))))
+		{
+			++TokenEnd;
+		}
+		while (TokenEnd > P && IsSpace(TokenEnd[-1]))
+		{
+			--TokenEnd;
+		}
+
+		if (P == TokenEnd || (!bQuoted && MatchToken(P, TokenEnd, "null")))
+		{
+			return false;
+		}
+
+		if (MatchToken(P, TokenEnd, "true") || MatchToken(P, TokenEnd, "on"))
+		{
+			OutValue = FTelemetryValue::MakeBoolean(true);
+			return true;
+		}
+		if (MatchToken(P, TokenEnd, "false") || MatchToken(P, TokenEnd, "off"))
+		{
+			OutValue = FTelemetryValue::MakeBoolean(false);
+			return true;
+		}
+
+		ANSICHAR Buffer[64];
+		int32 Length = 0;
+		bool bHasDigit = false;
+		for (const uint8* C = P; C < TokenEnd && Length < UE_ARRAY_COUNT(Buffer) - 1 && IsNumberChar(*C); ++C)
+		{
+			bHasDigit |= (*C >= '0' && *C <= '9');
+			Buffer[Length++] = ANSICHAR(*C);
+		}
+		Buffer[Length] = '\0';
+
+		if (bHasDigit)
+		{
+			OutValue = FTelemetryValue::MakeNumber(FCStringAnsi::Atod(Buffer));
+		}
+		else
+		{
+			OutValue = FTelemetryValue::MakeString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(P), int32(TokenEnd - P)));
+		}
+		return true;
+	}
+}
+
+using namespace TelemetryMqtt;
+
+bool FTelemetryMqttClient::ParseBrokerUrl(const FString& Url, FSettings& InOutSettings)
+{
+	FString Rest = Url.TrimStartAndEnd();
+	if (!Rest.RemoveFromStart(TEXT("mqtt://")))
+	{
+		Rest.RemoveFromStart(TEXT("tcp://"));
+	}
+
+	int32 SlashIndex = INDEX_NONE;
+	if (Rest.FindChar(TEXT('/'), SlashIndex))
+	{
+		Rest.LeftInline(SlashIndex);
+	}
+
+	FString UserInfo;
+	FString HostPort = Rest;
+	if (Rest.Split(TEXT("@"), &UserInfo, &HostPort, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+	{
+		if (!UserInfo.Split(TEXT(":"), &InOutSettings.Username, &InOutSettings.Password))
+		{
+			InOutSettings.Username = UserInfo;
+		}
+	}
+
+	FString PortString;
+	if (HostPort.Split(TEXT(":"), &InOutSettings.Host, &PortString, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+	{
+		InOutSettings.Port = FCString::Atoi(*PortString);
+	}
+	else
+	{
+		InOutSettings.Host = HostPort;
+	}
+
+	return !InOutSettings.Host.IsEmpty() && InOutSettings.Port > 0 && InOutSettings.Port < 65536;
+}
+
+bool FTelemetryMqttClient::TopicMatchesFilter(FAnsiStringView Topic, FAnsiStringView Filter)
+{
+	// Wildcards never match system topics at the first level
+	if (Topic.Len() > 0 && Topic[0] == '$' && Filter.Len() > 0 && (Filter[0] == '+' || Filter[0] == '#'))
+	{
+		return false;
+	}
+
+	int32 T = 0;
+	for (int32 F = 0; F < Filter.Len();)
+	{
+		const ANSICHAR C = Filter[F];
+		if (C == '#')
+		{
+			return true;
+		}
+
+		if (C == '+')
+		{
+			while (T < Topic.Len() && Topic[T] != '/')
+			{
+				++T;
+			}
+			++F;
+			continue;
+		}
+
+		if (T < Topic.Len() && Topic[T] == C)
+		{
+			++T;
+			++F;
+			continue;
+		}
+
+		// "a/#" also matches the parent level "a"
+		return T == Topic.Len() && C == '/' && F + 2 == Filter.Len() && Filter[F + 1] == '#';
+	}
+
+	return T == Topic.Len();
+}
+
+bool FTelemetryMqttClient::DecodePayload(TArrayView<const uint8> Payload, FTelemetryValue& OutValue)
+{
+	const uint8* P = Payload.GetData();
+	const uint8* End = P + Payload.Num();
+
+	while (P < End && IsSpace(*P))
+	{
+		++P;
+	}
+
+	if (P < End && *P == '{')
+	{
+		// Scan for "value": without building a JSON DOM
+		static const uint8 Field[] = { '"', 'v', 'a', 'l', 'u', 'e', '"' };
+		for (; P + UE_ARRAY_COUNT(Field) <= End; ++P)
+		{
+			if (FMemory::Memcmp(P, Field, UE_ARRAY_COUNT(Field)) == 0)
+			{
+				P += UE_ARRAY_COUNT(Field);
+				while (P < End && (IsSpace(*P) || *P == ':'))
+				{
+					++P;
+				}
+				return ParseScalar(P, End, true, OutValue);
+			}
+		}
+		return false;
+	}
+
+	return ParseScalar(P, End, false, OutValue);
+}
+
+void FTelemetryMqttClient::EncodePacket(uint8 Header, TArrayView<const uint8> Body, TArray<uint8>& Out)
+{
+	Out.Add(Header);
+	WriteVarInt(Out, uint32(Body.Num()));
+	Out.Append(Body.GetData(), Body.Num());
+}
+
+int32 FTelemetryMqttClient::DecodePacket(TArrayView<const uint8> Data, uint8& OutHeader, TArrayView<const uint8>& OutBody)
+{
+	if (Data.Num() < 2)
+	{
+		return 0;
+	}
+
+	int32 BodyStart = 1;
+	uint32 RemainingLength = 0;
+	const EVarIntResult LengthResult = ReadVarInt(Data, BodyStart, RemainingLength);
+	if (LengthResult == EVarIntResult::Malformed || (LengthResult == EVarIntResult::Ok && RemainingLength > MaxPacketBytes))
+	{
+		return INDEX_NONE;
+	}
+	if (LengthResult == EVarIntResult::Incomplete || uint32(Data.Num() - BodyStart) < RemainingLength)
+	{
+		return 0;
+	}
+
+	OutHeader = Data[0];
+	OutBody = Data.Slice(BodyStart, RemainingLength);
+	return BodyStart + int32(RemainingLength);
+}
+
+FTelemetryMqttClient::FTelemetryMqttClient(const FSettings& InSettings)
+	: Settings(InSettings)
+	, SocketSubsystem(nullptr)
+	, Socket(nullptr)
+	, State(EState::Disconnected)
+	, NextPacketId(1)
+	, StateEnteredTime(0.0)
+	, LastSendTime(0.0)
+	, PingSentTime(0.0)
+	, LastKeyKeepAliveTime(0.0)
+	, ReconnectTime(0.0)
+	, ReconnectBackoff(MinReconnectBackoff)
+	, ConsecutiveFailures(0)
+	, HealthIndex(INDEX_NONE)
+{
+	if (Settings.ClientId.IsEmpty())
+	{
+		// 23 characters: the longest client id every 3.1.1 broker must accept
+		Settings.ClientId = TEXT("HT-") + FGuid::NewGuid().ToString(EGuidFormats::Digits).Left(20);
+	}
+
+	for (const TPair<FString, FName>& Mapping : Settings.TopicMappings)
+	{
+		FTCHARToUTF8 Utf8(*Mapping.Key);
+		FilterBytes.Emplace(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+FTelemetryMqttClient::~FTelemetryMqttClient()
+{
+	Stop();
+}
+
+void FTelemetryMqttClient::SetEndpointHealth(TSharedRef<FTelemetryEndpointHealth> InEndpointHealth)
+{
+	EndpointHealth = InEndpointHealth;
+	HealthIndex = InEndpointHealth->Register(Settings.EndpointId);
+}
+
+void FTelemetryMqttClient::Start()
+{
+	SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	ReconnectTime = 0.0;
+	ReconnectBackoff = MinReconnectBackoff;
+	ConsecutiveFailures = 0;
+}
+
+double FTelemetryMqttClient::Tick(double NowSeconds, FTelemetrySampleWriter& Writer)
+{
+	switch (State)
+	{
+	case EState::Disconnected:
+		if (NowSeconds >= ReconnectTime)
+		{
+			BeginConnect(NowSeconds);
+		}
+		return State == EState::Disconnected ? ReconnectTime - NowSeconds : PollInterval;
+
+	case EState::Connecting:
+	{
+		const ESocketConnectionState ConnectionState = Socket->GetConnectionState();
+		if (ConnectionState == SCS_Connected)
+		{
+			State = EState::AwaitingConnAck;
+			StateEnteredTime = NowSeconds;
+			QueueConnect();
+			if (!FlushOutbound(NowSeconds))
+			{
+				Disconnect(NowSeconds, TEXT("send failed"));
+			}
+		}
+		else if (ConnectionState == SCS_ConnectionError || NowSeconds - StateEnteredTime > ConnectTimeout)
+		{
+			Disconnect(NowSeconds, TEXT("connect failed"));
+		}
+		return PollInterval;
+	}
+
+	case EState::AwaitingConnAck:
+	case EState::Connected:
+		if (!FlushOutbound(NowSeconds) || !ReceivePackets(NowSeconds, Writer))
+		{
+			Disconnect(NowSeconds, TEXT("connection lost"));
+			return ReconnectTime - NowSeconds;
+		}
+
+		if (State == EState::AwaitingConnAck && NowSeconds - StateEnteredTime > ConnectTimeout)
+		{
+			Disconnect(NowSeconds, TEXT("no CONNACK"));
+			return ReconnectTime - NowSeconds;
+		}
+
+		if (PingSentTime > 0.0 && NowSeconds - PingSentTime > Settings.KeepAliveSeconds)
+		{
+			Disconnect(NowSeconds, TEXT("no PINGRESP"));
+			return ReconnectTime - NowSeconds;
+		}
+
+		if (State == EState::Connected && Settings.KeepAliveSeconds > 0 && PingSentTime == 0.0 && NowSeconds - LastSendTime >= Settings.KeepAliveSeconds * 0.5)
+		{
+			QueuePacket(PINGREQ << 4, TArrayView<const uint8>());
+			PingSentTime = NowSeconds;
+			FlushOutbound(NowSeconds);
+		}
+
+		// Change-only publishers send nothing while a value holds; a live session means it still holds
+		if (State == EState::Connected && NowSeconds - LastKeyKeepAliveTime >= KeyKeepAliveInterval)
+		{
+			LastKeyKeepAliveTime = NowSeconds;
+			const int64 NowTicks = FDateTime::UtcNow().GetTicks();
+			for (const FTopicRoute& Route : TopicRoutes)
+			{
+				if (Route.Slot != INDEX_NONE)
+				{
+					Writer.AddKeepAlive(Route.Slot, NowTicks);
+				}
+			}
+		}
+		return PollInterval;
+	}
+
+	return PollInterval;
+}
+
+void FTelemetryMqttClient::Stop()
+{
+	if (Socket && State == EState::Connected)
+	{
+		QueuePacket(DISCONNECT << 4, TArrayView<const uint8>());
+		FlushOutbound(FPlatformTime::Seconds());
+	}
+
+	if (Socket)
+	{
+		Socket->Close();
+		SocketSubsystem->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+	State = EState::Disconnected;
+}
+
+void FTelemetryMqttClient::BeginConnect(double NowSeconds)
+{
+	if (!SocketSubsystem)
+	{
+		Disconnect(NowSeconds, TEXT("no socket subsystem"));
+		return;
+	}
+
+	// Name resolution may block, but only the ingest thread
+	FAddressInfoResult AddressInfo = SocketSubsystem->GetAddressInfo(*Settings.Host, nullptr, EAddressInfoFlags::Default, NAME_None, SOCKTYPE_Streaming);
+	if (AddressInfo.ReturnCode != SE_NO_ERROR || AddressInfo.Results.Num() == 0)
+	{
+		Disconnect(NowSeconds, TEXT("could not resolve host"));
+		return;
+	}
+
+	TSharedRef<FInternetAddr> Address = AddressInfo.Results[0].Address;
+	Address->SetPort(Settings.Port);
+
+	Socket = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("TelemetryMqtt"), Address->GetProtocolType());
+	if (!Socket)
+	{
+		Disconnect(NowSeconds, TEXT("could not create socket"));
+		return;
+	}
+
+	Socket->SetNonBlocking(true);
+	Socket->SetNoDelay(true);
+
+	RecvBuffer.Reset();
+	SendBuffer.Reset();
+	PingSentTime = 0.0;
+
+	// Non-blocking connect; completion is polled through GetConnectionState
+	Socket->Connect(*Address);
+	State = EState::Connecting;
+	StateEnteredTime = NowSeconds;
+}
+
+void FTelemetryMqttClient::Disconnect(double NowSeconds, const TCHAR* Reason)
+{
+	UE_LOG(LogHomesteadTwin, Warning, TEXT("MQTT %s:%d: %s, retrying in %.0fs"), *Settings.Host, Settings.Port, Reason, ReconnectBackoff);
+
+	if (Socket)
+	{
+		Socket->Close();
+		SocketSubsystem->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+
+	State = EState::Disconnected;
+	ReconnectTime = NowSeconds + ReconnectBackoff;
+
+	++ConsecutiveFailures;
+	if (EndpointHealth)
+	{
+		EndpointHealth->ReportFailure(HealthIndex, ConsecutiveFailures, ReconnectBackoff, Reason);
+	}
+
+	ReconnectBackoff = FMath::Min(ReconnectBackoff * 2.0, MaxReconnectBackoff);
+}
+
+bool FTelemetryMqttClient::ReceivePackets(double NowSeconds, FTelemetrySampleWriter& Writer)
+{
+	// Stop reading once a maximal packet is buffered; the rest waits for the next tick
+	while (RecvBuffer.Num() <= int32(MaxPacketBytes))
+	{
+		const int32 Offset = RecvBuffer.Num();
+		RecvBuffer.AddUninitialized(ReadChunkSize);
+
+		int32 BytesRead = 0;
+		const bool bReadOk = Socket->Recv(RecvBuffer.GetData() + Offset, ReadChunkSize, BytesRead);
+		RecvBuffer.SetNum(Offset + FMath::Max(0, BytesRead), EAllowShrinking::No);
+
+		// Recv fails on error and when the broker closed the stream
+		if (!bReadOk)
+		{
+			return false;
+		}
+		if (BytesRead < ReadChunkSize)
+		{
+			break;
+		}
+	}
+
+	const TArrayView<const uint8> Data(RecvBuffer.GetData(), RecvBuffer.Num());
+	int32 Consumed = 0;
+	for (;;)
+	{
+		uint8 Header = 0;
+		TArrayView<const uint8> Body;
+		const int32 PacketBytes = DecodePacket(Data.Slice(Consumed, Data.Num() - Consumed), Header, Body);
+		if (PacketBytes == INDEX_NONE)
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("MQTT %s:%d: malformed or oversized packet"), *Settings.Host, Settings.Port);
+			return false;
+		}
+		if (PacketBytes == 0)
+		{
+			break;
+		}
+
+		if (!HandlePacket(Header, Body, NowSeconds, Writer))
+		{
+			return false;
+		}
+		Consumed += PacketBytes;
+	}
+
+	if (Consumed > 0)
+	{
+		RecvBuffer.RemoveAt(0, Consumed, EAllowShrinking::No);
+	}
+	return true;
+}
+
+bool FTelemetryMqttClient::HandlePacket(uint8 Header, TArrayView<const uint8> Body, double NowSeconds, FTelemetrySampleWriter& Writer)
+{
+	switch (Header >> 4)
+	{
+	case CONNACK:
+	{
+		// Byte 1 is the 3.1.1 return code / MQTT 5 reason code; both use 0 for success
+		if (Body.Num() < 2 || Body[1] != 0)
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("MQTT %s:%d: connection refused (code %d)"), *Settings.Host, Settings.Port, Body.Num() >= 2 ? Body[1] : -1);
+			return false;
+		}
+
+		UE_LOG(LogHomesteadTwin, Log, TEXT("MQTT %s:%d: connected, subscribing to %d filter(s)"), *Settings.Host, Settings.Port, FilterBytes.Num());
+		State = EState::Connected;
+		ReconnectBackoff = MinReconnectBackoff;
+		ConsecutiveFailures = 0;
+		if (EndpointHealth)
+		{
+			EndpointHealth->ReportSuccess(HealthIndex);
+		}
+		QueueSubscribe();
+		return FlushOutbound(NowSeconds);
+	}
+
+	case PUBLISH:
+		return HandlePublish(Header & 0x0F, Body, Writer);
+
+	case SUBACK:
+	{
+		int32 Pos = 2;
+		uint32 PropertiesLength = 0;
+		if (Settings.bUseMqtt5 && ReadVarInt(Body, Pos, PropertiesLength) == EVarIntResult::Ok)
+		{
+			Pos += PropertiesLength;
+		}
+		for (; Pos < Body.Num(); ++Pos)
+		{
+			if (Body[Pos] >= 0x80)
+			{
+				UE_LOG(LogHomesteadTwin, Warning, TEXT("MQTT %s:%d: subscription rejected (code %d)"), *Settings.Host, Settings.Port, Body[Pos]);
+			}
+		}
+		return true;
+	}
+
+	case PINGRESP:
+		PingSentTime = 0.0;
+		return true;
+
+	case DISCONNECT:
+		return false;
+
+	default:
+		// Anything a subscriber can ignore
+		return true;
+	}
+}
+
+bool FTelemetryMqttClient::HandlePublish(uint8 Flags, TArrayView<const uint8> Body, FTelemetrySampleWriter& Writer)
+{
+	const uint8 QoS = (Flags >> 1) & 0x03;
+	if (Body.Num() < 2)
+	{
+		return false;
+	}
+
+	const int32 TopicLength = (int32(Body[0]) << 8) | Body[1];
+	int32 Pos = 2 + TopicLength;
+	if (Pos > Body.Num())
+	{
+		return false;
+	}
+	const FAnsiStringView Topic(reinterpret_cast<const ANSICHAR*>(Body.GetData() + 2), TopicLength);
+
+	uint16 PacketId = 0;
+	if (QoS > 0)
+	{
+		if (Pos + 2 > Body.Num())
+		{
+			return false;
+		}
+		PacketId = uint16((Body[Pos] << 8) | Body[Pos + 1]);
+		Pos += 2;
+	}
+
+	if (Settings.bUseMqtt5)
+	{
+		uint32 PropertiesLength = 0;
+		if (ReadVarInt(Body, Pos, PropertiesLength) != EVarIntResult::Ok || Pos + int64(PropertiesLength) > Body.Num())
+		{
+			return false;
+		}
+		Pos += PropertiesLength;
+	}
+
+	const int32 Slot = ResolveTopic(Topic, Writer);
+	FTelemetryValue Value;
+	if (Slot != INDEX_NONE && DecodePayload(Body.Slice(Pos, Body.Num() - Pos), Value))
+	{
+		Writer.Add(Slot, FDateTime::UtcNow().GetTicks(), Value);
+	}
+
+	if (QoS == 1)
+	{
+		const uint8 Ack[2] = { uint8(PacketId >> 8), uint8(PacketId & 0xFF) };
+		QueuePacket(PUBACK << 4, Ack);
+	}
+	return true;
+}
+
+int32 FTelemetryMqttClient::ResolveTopic(FAnsiStringView Topic, FTelemetrySampleWriter& Writer)
+{
+	const uint32 Hash = FCrc::MemCrc32(Topic.GetData(), Topic.Len());
+	for (auto It = TopicRouteByHash.CreateConstKeyIterator(Hash); It; ++It)
+	{
+		const FTopicRoute& Route = TopicRoutes[It.Value()];
+		if (Route.Topic.Num() == Topic.Len() && FMemory::Memcmp(Route.Topic.GetData(), Topic.GetData(), Topic.Len()) == 0)
+		{
+			return Route.Slot;
+		}
+	}
+
+	// First delivery on this topic: match the filters once and cache the result
+	int32 Slot = INDEX_NONE;
+	for (int32 Index = 0; Index < FilterBytes.Num(); ++Index)
+	{
+		const FAnsiStringView Filter(reinterpret_cast<const ANSICHAR*>(FilterBytes[Index].GetData()), FilterBytes[Index].Num());
+		if (TopicMatchesFilter(Topic, Filter))
+		{
+			FName Key = Settings.TopicMappings[Index].Value;
+			if (Key.IsNone())
+			{
+				Key = FName(Topic.Len(), Topic.GetData());
+			}
+			Slot = Writer.ResolveKey(Key);
+			break;
+		}
+	}
+
+	FTopicRoute& Route = TopicRoutes.AddDefaulted_GetRef();
+	Route.Topic.Append(reinterpret_cast<const uint8*>(Topic.GetData()), Topic.Len());
+	Route.Slot = Slot;
+	TopicRouteByHash.Add(Hash, TopicRoutes.Num() - 1);
+
+	return Slot;
+}
+
+void FTelemetryMqttClient::QueueConnect()
+{
+	PacketScratch.Reset();
+	WriteString(PacketScratch, TEXT("MQTT"));
+	PacketScratch.Add(uint8(Settings.bUseMqtt5 ? 5 : 4)); // Protocol level
+
+	const bool bHasUsername = !Settings.Username.IsEmpty();
+	const bool bHasPassword = bHasUsername && !Settings.Password.IsEmpty();
+	uint8 ConnectFlags = 0x02; // Clean session / clean start
+	ConnectFlags |= bHasUsername ? 0x80 : 0;
+	ConnectFlags |= bHasPassword ? 0x40 : 0;
+	PacketScratch.Add(ConnectFlags);
+	WriteU16(PacketScratch, Settings.KeepAliveSeconds);
+
+	if (Settings.bUseMqtt5)
+	{
+		// Maximum Packet Size: the broker drops larger messages instead of sending them
+		WriteVarInt(PacketScratch, 5);
+		PacketScratch.Add(MaximumPacketSizeProperty);
+		WriteU32(PacketScratch, MaxPacketBytes);
+	}
+
+	WriteString(PacketScratch, Settings.ClientId);
+	if (bHasUsername)
+	{
+		WriteString(PacketScratch, Settings.Username);
+	}
+	if (bHasPassword)
+	{
+		WriteString(PacketScratch, Settings.Password);
+	}
+
+	QueuePacket(CONNECT << 4, PacketScratch);
+}
+
+void FTelemetryMqttClient::QueueSubscribe()
+{
+	if (FilterBytes.Num() == 0)
+	{
+		return;
+	}
+
+	PacketScratch.Reset();
+	WriteU16(PacketScratch, NextPacketId);
+	NextPacketId = NextPacketId == 0xFFFF ? 1 : NextPacketId + 1;
+
+	if (Settings.bUseMqtt5)
+	{
+		WriteVarInt(PacketScratch, 0); // No properties
+	}
+
+	for (const TArray<uint8>& Filter : FilterBytes)
+	{
+		WriteU16(PacketScratch, uint16(Filter.Num()));
+		PacketScratch.Append(Filter);
+		PacketScratch.Add(Settings.QoS);
+	}
+
+	// SUBSCRIBE carries mandatory flags 0b0010
+	QueuePacket((SUBSCRIBE << 4) | 0x02, PacketScratch);
+}
+
+void FTelemetryMqttClient::QueuePacket(uint8 Header, TArrayView<const uint8> Body)
+{
+	EncodePacket(Header, Body, SendBuffer);
+}
+
+bool FTelemetryMqttClient::FlushOutbound(double NowSeconds)
+{
+	if (SendBuffer.Num() == 0 || !Socket)
+	{
+		return true;
+	}
+
+	int32 BytesSent = 0;
+	if (!Socket->Send(SendBuffer.GetData(), SendBuffer.Num(), BytesSent))
+	{
+		// A full send buffer is not an error on a non-blocking socket
+		return SocketSubsystem->GetLastErrorCode() == SE_EWOULDBLOCK;
+	}
+
+	if (BytesSent > 0)
+	{
+		SendBuffer.RemoveAt(0, BytesSent, EAllowShrinking::No);
+		LastSendTime = NowSeconds;
+	}
+	return true;
+}
@@ -0,0 +1,170 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TelemetryIngest.h"
+
+class FSocket;
+class FTelemetryEndpointHealth;
+class ISocketSubsystem;
+
+/**
+ * FTelemetryMqttClient
+ *
+ * Minimal non-blocking MQTT 3.1.1 / 5 subscriber used as a telemetry source.
+ *
+ * Responsibilities:
+ * - Connect to a broker, subscribe to the mapped topic filters and keep the session alive
+ * - Map incoming topics to telemetry keys (with + and # wildcard filters)
+ * - Decode numeric payloads straight from the receive buffer
+ * - Reconnect automatically with exponential backoff
+ *
+ * Implementation Notes:
+ * - Runs on the ingest thread; all socket calls are non-blocking
+ * - Only the subscriber side of the protocol is implemented (no outbound PUBLISH)
+ * - QoS 1 deliveries are acknowledged with PUBACK; QoS 2 is downgraded by the broker
+ * - Topic -> slot routes are cached by topic hash so steady-state delivery does not allocate
+ * - Packets above MaxPacketBytes and a PINGREQ left unanswered for a keep-alive period drop the
+ *   connection, so a hostile or silent broker cannot grow the receive buffer or hang the session
+ * - While connected, every routed key gets a keep-alive each KeyKeepAliveInterval, so keys of
+ *   change-only publishers stay fresh between changes (a dead publisher needs its last will)
+ */
+class HOMESTEADTWIN_API FTelemetryMqttClient : public ITelemetrySource
+{
+public:
+	/** Broker connection and subscription settings */
+	struct FSettings
+	{
+		/** Endpoint id reported to the health table */
+		FName EndpointId;
+
+		FString Host;
+		int32 Port = 1883;
+		FString ClientId;
+		FString Username;
+		FString Password;
+		uint8 QoS = 0;
+		bool bUseMqtt5 = false;
+		uint16 KeepAliveSeconds = 30;
+
+		/** Topic filter -> key (NAME_None on a wildcard filter = use the topic as key) */
+		TArray<TPair<FString, FName>> TopicMappings;
+	};
+
+	/** Fill Host/Port/Username/Password from "mqtt://[user[:pass]@]host[:port]" */
+	static bool ParseBrokerUrl(const FString& Url, FSettings& InOutSettings);
+
+	/** MQTT topic filter matching ('+' = one level, '#' = remaining levels) */
+	static bool TopicMatchesFilter(FAnsiStringView Topic, FAnsiStringView Filter);
+
+	/** Decode a bare number, true/false/on/off or status text, or a JSON object with a "value" field */
+	static bool DecodePayload(TArrayView<const uint8> Payload, FTelemetryValue& OutValue);
+
+	/** Largest control packet accepted from the broker (bytes of remaining length) */
+	static constexpr uint32 MaxPacketBytes = 1024 * 1024;
+
+	/** Append one control packet: fixed header, remaining length, body */
+	static void EncodePacket(uint8 Header, TArrayView<const uint8> Body, TArray<uint8>& Out);
+
+	/**
+	 * Split the first control packet off Data. Returns the bytes it spans, 0 while it is
+	 * incomplete, or INDEX_NONE if its remaining length is malformed or above MaxPacketBytes.
+	 */
+	static int32 DecodePacket(TArrayView<const uint8> Data, uint8& OutHeader, TArrayView<const uint8>& OutBody);
+
+	explicit FTelemetryMqttClient(const FSettings& InSettings);
+	virtual ~FTelemetryMqttClient();
+
+	/** Report connection state to a health table (before the worker starts) */
+	void SetEndpointHealth(TSharedRef<FTelemetryEndpointHealth> InEndpointHealth);
+
+	// Begin ITelemetrySource Interface
+	virtual void Start() override;
+	virtual double Tick(double NowSeconds, FTelemetrySampleWriter& Writer) override;
+	virtual void Stop() override;
+	// End ITelemetrySource Interface
+
+private:
+	enum class EState : uint8
+	{
+		Disconnected,
+		Connecting,
+		AwaitingConnAck,
+		Connected
+	};
+
+	/** Cached mapping from a concrete topic to a slot */
+	struct FTopicRoute
+	{
+		TArray<uint8> Topic;
+		int32 Slot;
+	};
+
+	/** Open the socket and start a non-blocking connect */
+	void BeginConnect(double NowSeconds);
+
+	/** Close the socket and schedule a reconnect */
+	void Disconnect(double NowSeconds, const TCHAR* Reason);
+
+	/** Read everything available and dispatch complete packets */
+	bool ReceivePackets(double NowSeconds, FTelemetrySampleWriter& Writer);
+
+	/** Handle one complete control packet */
+	bool HandlePacket(uint8 Header, TArrayView<const uint8> Body, double NowSeconds, FTelemetrySampleWriter& Writer);
+
+	/** Handle a PUBLISH packet body */
+	bool HandlePublish(uint8 Flags, TArrayView<const uint8> Body, FTelemetrySampleWriter& Writer);
+
+	/** Resolve a concrete topic to a slot (INDEX_NONE = not mapped) */
+	int32 ResolveTopic(FAnsiStringView Topic, FTelemetrySampleWriter& Writer);
+
+	/** Queue packets and try to push pending outbound bytes */
+	void QueueConnect();
+	void QueueSubscribe();
+	void QueuePacket(uint8 Header, TArrayView<const uint8> Body);
+	bool FlushOutbound(double NowSeconds);
+
+private:
+	FSettings Settings;
+
+	/** Topic filters as UTF-8 bytes, parallel to Settings.TopicMappings */
+	TArray<TArray<uint8>> FilterBytes;
+
+	ISocketSubsystem* SocketSubsystem;
+	FSocket* Socket;
+	EState State;
+
+	/** Bytes received but not yet parsed */
+	TArray<uint8> RecvBuffer;
+
+	/** Bytes queued but not yet accepted by the socket */
+	TArray<uint8> SendBuffer;
+
+	/** Scratch for building packet bodies */
+	TArray<uint8> PacketScratch;
+
+	/** Topic hash -> index in TopicRoutes */
+	TMultiMap<uint32, int32> TopicRouteByHash;
+	TArray<FTopicRoute> TopicRoutes;
+
+	/** Next packet identifier for SUBSCRIBE */
+	uint16 NextPacketId;
+
+	/** Timing (the NowSeconds clock passed to Tick) */
+	double StateEnteredTime;
+	double LastSendTime;
+
+	/** When the outstanding PINGREQ was sent (0 = none outstanding) */
+	double PingSentTime;
+	double LastKeyKeepAliveTime;
+	double ReconnectTime;
+	double ReconnectBackoff;
+
+	/** Failed connection attempts since the last CONNACK */
+	int32 ConsecutiveFailures;
+
+	/** Health table and this broker's entry in it (optional) */
+	TSharedPtr<FTelemetryEndpointHealth> EndpointHealth;
+	int32 HealthIndex;
+};
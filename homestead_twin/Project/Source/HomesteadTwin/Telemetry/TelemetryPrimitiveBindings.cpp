@@ -0,0 +1,125 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryPrimitiveBindings.h"
+#include "TelemetryAlarmEngine.h"
+#include "TelemetryTimeSeriesStore.h"
+#include "Components/PrimitiveComponent.h"
+
+void FTelemetryPrimitiveBindings::Reset()
+{
+	Bindings.Reset();
+	FreeIds.Reset();
+	BindingsBySlot.Reset();
+	DirtyIds.Reset();
+}
+
+int32 FTelemetryPrimitiveBindings::Add(int32 Slot, const FBindingSettings& Settings)
+{
+	if (Slot < 0 || !Settings.Primitive.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 BindingId = FreeIds.Num() > 0 ? FreeIds.Pop(EAllowShrinking::No) : Bindings.AddDefaulted();
+	FBinding& Binding = Bindings[BindingId];
+	Binding = FBinding();
+	Binding.Settings = Settings;
+	Binding.Settings.DataIndex = FMath::Max(0, Settings.DataIndex);
+	Binding.Slot = Slot;
+
+	if (BindingsBySlot.Num() <= Slot)
+	{
+		BindingsBySlot.SetNum(Slot + 1);
+	}
+	BindingsBySlot[Slot].Add(BindingId);
+
+	// Show the current state right away
+	Binding.bDirty = true;
+	DirtyIds.Add(BindingId);
+
+	return BindingId;
+}
+
+void FTelemetryPrimitiveBindings::Remove(int32 BindingId)
+{
+	if (!Bindings.IsValidIndex(BindingId) || Bindings[BindingId].Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	FBinding& Binding = Bindings[BindingId];
+	BindingsBySlot[Binding.Slot].RemoveSingleSwap(BindingId, EAllowShrinking::No);
+
+	// A queued write is skipped by Flush once the slot is cleared
+	Binding.Slot = INDEX_NONE;
+	Binding.Settings.Primitive.Reset();
+	FreeIds.Add(BindingId);
+}
+
+void FTelemetryPrimitiveBindings::MarkSlotDirty(int32 Slot)
+{
+	if (!BindingsBySlot.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	for (const int32 BindingId : BindingsBySlot[Slot])
+	{
+		FBinding& Binding = Bindings[BindingId];
+		if (!Binding.bDirty)
+		{
+			Binding.bDirty = true;
+			DirtyIds.Add(BindingId);
+		}
+	}
+}
+
+void FTelemetryPrimitiveBindings::Flush(const FTelemetryTimeSeriesStore& Store, const FTelemetryAlarmEngine& AlarmEngine)
+{
+	for (const int32 BindingId : DirtyIds)
+	{
+		FBinding& Binding = Bindings[BindingId];
+		Binding.bDirty = false;
+
+		if (Binding.Slot == INDEX_NONE)
+		{
+			continue;
+		}
+
+		UPrimitiveComponent* Primitive = Binding.Settings.Primitive.Get();
+		if (!Primitive)
+		{
+			Remove(BindingId);
+			continue;
+		}
+
+		float Value = 0.0f;
+		int64 TimestampTicks = 0;
+		if (!Store.GetLatest(Binding.Slot, Value, TimestampTicks))
+		{
+			continue;
+		}
+
+		const FBindingSettings& Settings = Binding.Settings;
+		const FTelemetryAlarmEngine::EState State = AlarmEngine.GetState(Binding.Slot);
+		const FLinearColor& Color =
+			State == FTelemetryAlarmEngine::Critical ? Settings.CriticalColor :
+			State == FTelemetryAlarmEngine::Warning ? Settings.WarningColor :
+			Settings.NormalColor;
+
+		const float Range = Settings.IntensityMax - Settings.IntensityMin;
+		const float Intensity = FMath::IsNearlyZero(Range) ? 1.0f : FMath::Clamp((Value - Settings.IntensityMin) / Range, 0.0f, 1.0f);
+
+		const FVector4f Data(Color.R, Color.G, Color.B, Intensity);
+		if (Binding.bWritten && Data == Binding.Written)
+		{
+			continue;
+		}
+
+		Binding.Written = Data;
+		Binding.bWritten = true;
+		Primitive->SetCustomPrimitiveDataVector4(Settings.DataIndex, FVector4(Data));
+	}
+
+	DirtyIds.Reset();
+}
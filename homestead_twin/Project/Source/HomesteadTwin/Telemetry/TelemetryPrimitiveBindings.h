@@ -0,0 +1,95 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UPrimitiveComponent;
+class FTelemetryAlarmEngine;
+class FTelemetryTimeSeriesStore;
+
+/**
+ * FTelemetryPrimitiveBindings
+ *
+ * Binding table from telemetry slots to primitive components, driving color overlays
+ * through Custom Primitive Data instead of per-actor dynamic material instances.
+ *
+ * Responsibilities:
+ * - Map a slot to any number of (primitive, custom data index) targets
+ * - Collect the bindings touched during a frame and write them in one pass
+ *
+ * Implementation Notes:
+ * - Each binding writes 4 floats at its DataIndex: RGB of the alarm state color and an
+ *   intensity in [0, 1] normalized from the latest value; materials read them with
+ *   PrimitiveData / CustomPrimitiveData nodes, so every bound object shares its material
+ * - Custom Primitive Data updates go through the scene's lightweight primitive data path
+ *   (no render state recreation); unchanged values are not written at all
+ * - Ids are reused from a free list; bindings to destroyed primitives are dropped at flush
+ * - Game thread only
+ */
+class HOMESTEADTWIN_API FTelemetryPrimitiveBindings
+{
+public:
+	/** Target and appearance of one binding */
+	struct FBindingSettings
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Primitive;
+
+		/** First of the 4 custom data floats written (R, G, B, Intensity) */
+		int32 DataIndex = 0;
+
+		/** Value range mapped to intensity 0..1 (equal bounds = constant 1) */
+		float IntensityMin = 0.0f;
+		float IntensityMax = 100.0f;
+
+		/** Color per alarm state */
+		FLinearColor NormalColor = FLinearColor::Green;
+		FLinearColor WarningColor = FLinearColor::Yellow;
+		FLinearColor CriticalColor = FLinearColor::Red;
+	};
+
+	/** Drop all bindings */
+	void Reset();
+
+	/** Bind a slot to a primitive; returns the binding id (written on the next flush) */
+	int32 Add(int32 Slot, const FBindingSettings& Settings);
+
+	/** Remove a binding */
+	void Remove(int32 BindingId);
+
+	/** Number of live bindings */
+	int32 Num() const { return Bindings.Num() - FreeIds.Num(); }
+
+	/** Queue every binding of a slot for the next flush */
+	void MarkSlotDirty(int32 Slot);
+
+	/** Write every queued binding from the latest values and alarm states */
+	void Flush(const FTelemetryTimeSeriesStore& Store, const FTelemetryAlarmEngine& AlarmEngine);
+
+private:
+	struct FBinding
+	{
+		FBindingSettings Settings;
+		int32 Slot = INDEX_NONE;
+
+		/** Last written data */
+		FVector4f Written = FVector4f::Zero();
+		bool bWritten = false;
+
+		bool bDirty = false;
+	};
+
+private:
+	/** Bindings by id (Slot == INDEX_NONE = free id) */
+	TArray<FBinding> Bindings;
+
+	/** Ids of removed bindings, reused before growing Bindings */
+	TArray<int32> FreeIds;
+
+	/** Slot -> ids of the bindings over it */
+	TArray<TArray<int32>> BindingsBySlot;
+
+	/** Bindings to write on the next flush */
+	TArray<int32> DirtyIds;
+};
@@ -0,0 +1,379 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryReplaySource.h"
+#include "TelemetrySegmentLog.h"
+#include "../HomesteadTwin.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Serialization/MemoryReader.h"
+
+namespace TelemetryReplay
+{
+	/** Records between sparse index entries */
+	constexpr int32 IndexStride = 1024;
+
+	/** Upper bound on records emitted per tick (keeps 100x playback of dense logs bounded) */
+	constexpr int32 MaxRecordsPerTick = 250000;
+
+	/** Upper bound on records scanned backwards to rebuild state after a seek */
+	constexpr int32 MaxSeekBacktrackRecords = 1 << 20;
+
+	/** Playback tick interval (seconds) */
+	constexpr double TickInterval = 1.0 / 30.0;
+
+	/** RequestedSeekTicks value meaning "no seek pending" */
+	constexpr int64 NoSeek = MIN_int64;
+
+	uint32 ReadUInt32(const uint8* Data)
+	{
+		uint32 Value;
+		FMemory::Memcpy(&Value, Data, sizeof(Value));
+		return Value;
+	}
+}
+
+using namespace TelemetryReplay;
+using namespace TelemetryLogFormat;
+
+FTelemetryReplaySource::FTelemetryReplaySource(TSharedRef<FTelemetryKeyRegistry> InKeyRegistry, const FString& InDirectory, float InSpeed)
+	: KeyRegistry(InKeyRegistry)
+	, Directory(InDirectory)
+	, NumRecordedSlots(0)
+	, PlayheadTicks(0.0)
+	, LastTickTime(0.0)
+	, bAtEnd(true)
+	, RequestedSpeed(InSpeed)
+	, bRequestedPaused(false)
+	, RequestedSeekTicks(NoSeek)
+	, PublishedPlayheadTicks(0)
+	, PublishedStartTicks(0)
+	, PublishedEndTicks(0)
+{
+}
+
+FTelemetryReplaySource::~FTelemetryReplaySource()
+{
+	Stop();
+}
+
+void FTelemetryReplaySource::SetSpeed(float InSpeed)
+{
+	RequestedSpeed = FMath::Max(0.0f, InSpeed);
+}
+
+void FTelemetryReplaySource::SetPaused(bool bInPaused)
+{
+	bRequestedPaused = bInPaused;
+}
+
+void FTelemetryReplaySource::SeekTo(int64 TimestampTicks)
+{
+	RequestedSeekTicks = TimestampTicks;
+}
+
+void FTelemetryReplaySource::Start()
+{
+	TSet<int32> RecordedSlots;
+	for (const FString& Path : FTelemetrySegmentLog::FindSegmentFiles(Directory))
+	{
+		const int32 FirstBlock = Blocks.Num();
+		IndexSegment(Path);
+
+		for (int32 BlockIndex = FirstBlock; BlockIndex < Blocks.Num(); ++BlockIndex)
+		{
+			for (const int32 Slot : Segments[Blocks[BlockIndex].Segment].KeySlots)
+			{
+				RecordedSlots.Add(Slot);
+			}
+		}
+	}
+	NumRecordedSlots = RecordedSlots.Num();
+
+	if (Blocks.Num() == 0)
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry replay: no recorded segments in %s"), *Directory);
+		return;
+	}
+
+	int32 Slot = INDEX_NONE;
+	int64 FirstTicks = 0;
+	int64 LastTicks = 0;
+	FTelemetryValue Value;
+	ReadRecord(FCursor(), Slot, FirstTicks, Value);
+	ReadRecord(FCursor{ Blocks.Num() - 1, Blocks.Last().NumRecords - 1 }, Slot, LastTicks, Value);
+
+	PublishedStartTicks = FirstTicks;
+	PublishedEndTicks = FMath::Max(LastTicks, Index.Last().MaxTicks);
+
+	Cursor = FCursor();
+	bAtEnd = false;
+	PlayheadTicks = double(FirstTicks);
+	PublishedPlayheadTicks = FirstTicks;
+	LastTickTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogHomesteadTwin, Log, TEXT("Telemetry replay: %d segments, %d blocks, %d keys from %s"), Segments.Num(), Blocks.Num(), NumRecordedSlots, *Directory);
+}
+
+double FTelemetryReplaySource::Tick(double NowSeconds, FTelemetrySampleWriter& Writer)
+{
+	if (Blocks.Num() == 0)
+	{
+		return 1.0;
+	}
+
+	const int64 WallTicks = FDateTime::UtcNow().GetTicks();
+
+	const int64 SeekTicks = RequestedSeekTicks.exchange(NoSeek);
+	if (SeekTicks != NoSeek)
+	{
+		Seek(SeekTicks, WallTicks, Writer);
+	}
+
+	const double ElapsedSeconds = NowSeconds - LastTickTime;
+	LastTickTime = NowSeconds;
+
+	if (!bRequestedPaused)
+	{
+		PlayheadTicks = FMath::Min(PlayheadTicks + ElapsedSeconds * RequestedSpeed.load() * ETimespan::TicksPerSecond, double(PublishedEndTicks.load()));
+	}
+
+	int32 Slot = INDEX_NONE;
+	int64 RecordTicks = 0;
+	FTelemetryValue Value;
+	for (int32 Emitted = 0; !bAtEnd && Emitted < MaxRecordsPerTick; ++Emitted)
+	{
+		ReadRecord(Cursor, Slot, RecordTicks, Value);
+		if (double(RecordTicks) > PlayheadTicks)
+		{
+			break;
+		}
+
+		if (Slot != INDEX_NONE)
+		{
+			Writer.AddReplayed(Slot, WallTicks, Value);
+		}
+		bAtEnd = !Advance(Cursor);
+	}
+
+	PublishedPlayheadTicks = int64(PlayheadTicks);
+	return TickInterval;
+}
+
+void FTelemetryReplaySource::Stop()
+{
+	Index.Reset();
+	Blocks.Reset();
+
+	// Regions must be unmapped before their file handles close
+	for (FSegment& Segment : Segments)
+	{
+		Segment.Region.Reset();
+		Segment.Handle.Reset();
+	}
+	Segments.Reset();
+
+	bAtEnd = true;
+}
+
+void FTelemetryReplaySource::IndexSegment(const FString& Path)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FOpenMappedResult Result = PlatformFile.OpenMappedEx(*Path);
+	if (Result.HasError())
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry replay: cannot map %s"), *Path);
+		return;
+	}
+
+	FSegment Segment;
+	Segment.Handle = Result.StealValue();
+
+	const int64 Size = Segment.Handle->GetFileSize();
+	if (Size < SegmentHeaderBytes)
+	{
+		return;
+	}
+
+	Segment.Region.Reset(Segment.Handle->MapRegion(0, Size));
+	if (!Segment.Region)
+	{
+		return;
+	}
+
+	const uint8* Data = Segment.Region->GetMappedPtr();
+	if (ReadUInt32(Data) != SegmentMagic || ReadUInt32(Data + 4) != SegmentVersion)
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry replay: %s is not a telemetry segment"), *Path);
+		return;
+	}
+
+	const int32 SegmentIndex = Segments.Num();
+	int64 Offset = SegmentHeaderBytes;
+
+	// Structure checks only (the recovery path verifies CRCs); a torn tail ends the segment
+	while (Size - Offset >= BlockHeaderBytes)
+	{
+		const uint8* Header = Data + Offset;
+		const uint32 PayloadSize = ReadUInt32(Header + 4);
+		if (ReadUInt32(Header) != BlockMagic || PayloadSize > Size - Offset - BlockHeaderBytes)
+		{
+			break;
+		}
+
+		const uint8* Payload = Header + BlockHeaderBytes;
+		FMemoryReaderView Reader(MakeArrayView(Payload, int32(PayloadSize)));
+
+		int32 NumKeys = 0;
+		Reader << NumKeys;
+		for (int32 KeyIndex = 0; KeyIndex < NumKeys && !Reader.IsError(); ++KeyIndex)
+		{
+			uint32 KeyId = 0;
+			FString Key;
+			Reader << KeyId;
+			Reader << Key;
+
+			while (Segment.KeySlots.Num() <= int32(KeyId))
+			{
+				Segment.KeySlots.Add(INDEX_NONE);
+			}
+			Segment.KeySlots[KeyId] = KeyRegistry->FindOrAdd(FName(*Key));
+		}
+
+		int32 NumStrings = 0;
+		Reader << NumStrings;
+		for (int32 StringIndex = 0; StringIndex < NumStrings && !Reader.IsError(); ++StringIndex)
+		{
+			uint32 StringId = 0;
+			FString Text;
+			Reader << StringId;
+			Reader << Text;
+
+			// Ids are assigned densely, in order
+			if (StringId == uint32(Segment.Strings.Num()))
+			{
+				Segment.Strings.Add(FTelemetryValue::MakeString(Text));
+			}
+		}
+
+		int32 NumRecords = 0;
+		Reader << NumRecords;
+		if (Reader.IsError() || NumRecords < 0 || Reader.Tell() + NumRecords * RecordBytes != PayloadSize)
+		{
+			break;
+		}
+
+		if (NumRecords > 0)
+		{
+			const int32 BlockIndex = Blocks.Add({ SegmentIndex, Payload + Reader.Tell(), NumRecords });
+
+			// Sampling every IndexStride-th record touches one page per stride, not the whole block
+			for (int32 Record = 0; Record < NumRecords; Record += IndexStride)
+			{
+				int64 Ticks;
+				FMemory::Memcpy(&Ticks, Blocks[BlockIndex].Records + Record * RecordBytes + 4, sizeof(Ticks));
+				const int64 MaxTicks = Index.Num() > 0 ? FMath::Max(Index.Last().MaxTicks, Ticks) : Ticks;
+				Index.Add({ MaxTicks, FCursor{ BlockIndex, Record } });
+			}
+		}
+
+		Offset += BlockHeaderBytes + PayloadSize;
+	}
+
+	Segments.Add(MoveTemp(Segment));
+}
+
+void FTelemetryReplaySource::ReadRecord(const FCursor& InCursor, int32& OutSlot, int64& OutTicks, FTelemetryValue& OutValue) const
+{
+	const FBlock& Block = Blocks[InCursor.Block];
+	const FSegment& Segment = Segments[Block.Segment];
+
+	uint32 KeyId;
+	DecodeRecord(Block.Records + InCursor.Record * RecordBytes, Segment.Strings, KeyId, OutTicks, OutValue);
+
+	OutSlot = Segment.KeySlots.IsValidIndex(KeyId) ? Segment.KeySlots[KeyId] : INDEX_NONE;
+}
+
+bool FTelemetryReplaySource::Advance(FCursor& InOutCursor) const
+{
+	if (++InOutCursor.Record < Blocks[InOutCursor.Block].NumRecords)
+	{
+		return true;
+	}
+
+	if (InOutCursor.Block + 1 < Blocks.Num())
+	{
+		++InOutCursor.Block;
+		InOutCursor.Record = 0;
+		return true;
+	}
+
+	--InOutCursor.Record;
+	return false;
+}
+
+bool FTelemetryReplaySource::Retreat(FCursor& InOutCursor) const
+{
+	if (InOutCursor.Record > 0)
+	{
+		--InOutCursor.Record;
+		return true;
+	}
+
+	if (InOutCursor.Block > 0)
+	{
+		--InOutCursor.Block;
+		InOutCursor.Record = Blocks[InOutCursor.Block].NumRecords - 1;
+		return true;
+	}
+
+	return false;
+}
+
+void FTelemetryReplaySource::Seek(int64 TimestampTicks, int64 WallTicks, FTelemetrySampleWriter& Writer)
+{
+	const int64 Target = FMath::Clamp(TimestampTicks, PublishedStartTicks.load(), PublishedEndTicks.load());
+
+	// Last entry whose running max is still before the target; no record before it can be at or after it
+	const int32 EntryIndex = FMath::Max(0, Algo::LowerBoundBy(Index, Target, &FIndexEntry::MaxTicks) - 1);
+	FCursor SeekCursor = Index[EntryIndex].Cursor;
+
+	int32 Slot = INDEX_NONE;
+	int64 RecordTicks = 0;
+	FTelemetryValue Value;
+	bAtEnd = false;
+	for (;;)
+	{
+		ReadRecord(SeekCursor, Slot, RecordTicks, Value);
+		if (RecordTicks >= Target)
+		{
+			break;
+		}
+		if (!Advance(SeekCursor))
+		{
+			bAtEnd = true;
+			break;
+		}
+	}
+
+	// Re-emit the latest value of every key before the target, newest first
+	TBitArray<> SeenSlots(false, KeyRegistry->Num());
+	int32 NumSeen = 0;
+	FCursor BackCursor = SeekCursor;
+	bool bHasRecord = bAtEnd || Retreat(BackCursor);
+	for (int32 Scanned = 0; bHasRecord && NumSeen < NumRecordedSlots && Scanned < MaxSeekBacktrackRecords; ++Scanned)
+	{
+		ReadRecord(BackCursor, Slot, RecordTicks, Value);
+		if (SeenSlots.IsValidIndex(Slot) && !SeenSlots[Slot])
+		{
+			SeenSlots[Slot] = true;
+			++NumSeen;
+			Writer.AddReplayed(Slot, WallTicks, Value);
+		}
+		bHasRecord = Retreat(BackCursor);
+	}
+
+	Cursor = SeekCursor;
+	PlayheadTicks = double(Target);
+}
@@ -0,0 +1,137 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TelemetryIngest.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * FTelemetryReplaySource
+ *
+ * Plays a recorded telemetry log (FTelemetrySegmentLog format) back as a telemetry source.
+ *
+ * Responsibilities:
+ * - Memory-map every segment of a recording and index it without copying samples
+ * - Advance a playhead at a variable speed (1x, 10x, 100x, ...) and emit the samples it passes
+ * - Seek to any recorded timestamp in O(log n) through a sparse time index
+ *
+ * Implementation Notes:
+ * - Runs on the ingest thread; speed, pause and seek requests are posted through atomics
+ *   from the game thread and applied on the next tick
+ * - Records are fixed size per segment version, so a block is addressed as
+ *   (mapped base + index * record size) and pages are faulted in only as the playhead reaches them
+ * - String definitions are decoded once while indexing; string records then cost a table lookup
+ * - The sparse index holds one entry every IndexStride records, keyed by the running
+ *   maximum timestamp so it stays sorted even where keys interleave slightly out of order
+ * - Emitted samples are stamped with the wall clock, so the store's per-key time order holds
+ *   across seeks; the recorded time is exposed through GetPlayheadTicks
+ * - After a seek, the latest value of each key before the target is re-emitted so displays
+ *   reflect the state at the new position
+ */
+class HOMESTEADTWIN_API FTelemetryReplaySource : public ITelemetrySource
+{
+public:
+	FTelemetryReplaySource(TSharedRef<FTelemetryKeyRegistry> InKeyRegistry, const FString& InDirectory, float InSpeed);
+	virtual ~FTelemetryReplaySource();
+
+	/** Playback speed multiplier (thread-safe) */
+	void SetSpeed(float InSpeed);
+
+	/** Pause or resume playback (thread-safe) */
+	void SetPaused(bool bInPaused);
+
+	/** Jump to a recorded timestamp (thread-safe) */
+	void SeekTo(int64 TimestampTicks);
+
+	/** Recorded time of the playhead (thread-safe) */
+	int64 GetPlayheadTicks() const { return PublishedPlayheadTicks.load(); }
+
+	/** Recorded time range (valid once the source has started) */
+	int64 GetStartTicks() const { return PublishedStartTicks.load(); }
+	int64 GetEndTicks() const { return PublishedEndTicks.load(); }
+
+	// Begin ITelemetrySource Interface
+	virtual void Start() override;
+	virtual double Tick(double NowSeconds, FTelemetrySampleWriter& Writer) override;
+	virtual void Stop() override;
+	// End ITelemetrySource Interface
+
+private:
+	/** One mapped segment file */
+	struct FSegment
+	{
+		TUniquePtr<IMappedFileHandle> Handle;
+		TUniquePtr<IMappedFileRegion> Region;
+
+		/** Segment-local key id -> slot */
+		TArray<int32> KeySlots;
+
+		/** Segment-local string id -> value */
+		TArray<FTelemetryValue> Strings;
+	};
+
+	/** Records of one block inside a mapped segment */
+	struct FBlock
+	{
+		int32 Segment;
+		const uint8* Records;
+		int32 NumRecords;
+	};
+
+	/** Position of a record */
+	struct FCursor
+	{
+		int32 Block = 0;
+		int32 Record = 0;
+	};
+
+	/** Sparse index entry */
+	struct FIndexEntry
+	{
+		int64 MaxTicks;
+		FCursor Cursor;
+	};
+
+	/** Map a segment and append its blocks and index entries */
+	void IndexSegment(const FString& Path);
+
+	/** Decode the record at a cursor */
+	void ReadRecord(const FCursor& Cursor, int32& OutSlot, int64& OutTicks, FTelemetryValue& OutValue) const;
+
+	/** Step a cursor forward / backward; false at the end / start */
+	bool Advance(FCursor& Cursor) const;
+	bool Retreat(FCursor& Cursor) const;
+
+	/** Move the cursor to the first record at or after TimestampTicks and re-emit the state before it */
+	void Seek(int64 TimestampTicks, int64 WallTicks, FTelemetrySampleWriter& Writer);
+
+private:
+	TSharedRef<FTelemetryKeyRegistry> KeyRegistry;
+	FString Directory;
+
+	TArray<FSegment> Segments;
+	TArray<FBlock> Blocks;
+	TArray<FIndexEntry> Index;
+
+	/** Number of distinct slots in the recording */
+	int32 NumRecordedSlots;
+
+	/** Playback state (ingest thread) */
+	FCursor Cursor;
+	double PlayheadTicks;
+	double LastTickTime;
+	bool bAtEnd;
+
+	/** Requests from the game thread */
+	std::atomic<float> RequestedSpeed;
+	std::atomic<bool> bRequestedPaused;
+	std::atomic<int64> RequestedSeekTicks;
+
+	/** State published to the game thread */
+	std::atomic<int64> PublishedPlayheadTicks;
+	std::atomic<int64> PublishedStartTicks;
+	std::atomic<int64> PublishedEndTicks;
+};
@@ -0,0 +1,415 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryRestPoller.h"
+#include "TelemetryEndpointHealth.h"
+#include "../HomesteadTwin.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Serialization/JsonReader.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/Crc.h"
+
+namespace TelemetryRest
+{
+	/** Tick interval while an endpoint is due but held back by the in-flight caps (seconds) */
+	constexpr double CapRetryInterval = 0.05;
+
+	/** Upper bound for failure backoff (seconds) */
+	constexpr double MaxFailureBackoff = 60.0;
+
+	/** Request timeout for an endpoint (seconds) */
+	float GetRequestTimeout(float PollInterval)
+	{
+		return FMath::Max(2.0f, PollInterval);
+	}
+
+	/** One level of the JSON path while streaming */
+	struct FPathLevel
+	{
+		int32 PathLength;
+		bool bArray;
+		int32 NextIndex;
+	};
+
+	/** Append the segment for the next value in Parent to Path */
+	void AppendSegment(FString& Path, FPathLevel& Parent, const FString& Identifier)
+	{
+		if (Path.Len() > 0)
+		{
+			Path.AppendChar(TEXT('.'));
+		}
+
+		if (Parent.bArray)
+		{
+			Path.AppendInt(Parent.NextIndex++);
+		}
+		else
+		{
+			Path.Append(Identifier);
+		}
+	}
+}
+
+using namespace TelemetryRest;
+
+bool FTelemetryRestPoller::ExtractMappedFields(TArrayView<const uint8> Json, const FFieldMap& FieldMap, int64 TimestampTicks, FTelemetrySampleWriter& Writer)
+{
+	TSharedRef<TJsonReader<UTF8CHAR>> Reader = TJsonReaderFactory<UTF8CHAR>::CreateFromView(
+		FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Json.GetData()), Json.Num()));
+
+	TArray<FPathLevel, TInlineAllocator<16>> Levels;
+	FString Path;
+	Path.Reserve(128);
+
+	EJsonNotation Notation;
+	while (Reader->ReadNext(Notation))
+	{
+		switch (Notation)
+		{
+		case EJsonNotation::ObjectStart:
+		case EJsonNotation::ArrayStart:
+		{
+			const bool bArray = (Notation == EJsonNotation::ArrayStart);
+			if (Levels.Num() == 0)
+			{
+				Levels.Add({ 0, bArray, 0 });
+				break;
+			}
+
+			const int32 ParentLength = Path.Len();
+			AppendSegment(Path, Levels.Last(), Reader->GetIdentifier());
+
+			if (!FieldMap.ContainerPaths.Contains(Path))
+			{
+				// Nothing mapped below this container: skip it without decoding
+				Path.LeftInline(ParentLength, EAllowShrinking::No);
+				const bool bSkipped = bArray ? Reader->SkipArray() : Reader->SkipObject();
+				if (!bSkipped)
+				{
+					return false;
+				}
+				break;
+			}
+
+			Levels.Add({ ParentLength, bArray, 0 });
+			break;
+		}
+
+		case EJsonNotation::ObjectEnd:
+		case EJsonNotation::ArrayEnd:
+			if (Levels.Num() > 0)
+			{
+				Path.LeftInline(Levels.Pop(EAllowShrinking::No).PathLength, EAllowShrinking::No);
+			}
+			break;
+
+		case EJsonNotation::Number:
+		case EJsonNotation::Boolean:
+		case EJsonNotation::String:
+		case EJsonNotation::Null:
+		{
+			if (Levels.Num() == 0)
+			{
+				break;
+			}
+
+			const int32 ParentLength = Path.Len();
+			AppendSegment(Path, Levels.Last(), Reader->GetIdentifier());
+
+			if (const int32* Slot = FieldMap.FieldSlots.Find(Path))
+			{
+				FTelemetryValue Value;
+				bool bHasValue = true;
+				if (Notation == EJsonNotation::Number)
+				{
+					Value = FTelemetryValue::MakeNumber(Reader->GetValueAsNumber());
+				}
+				else if (Notation == EJsonNotation::Boolean)
+				{
+					Value = FTelemetryValue::MakeBoolean(Reader->GetValueAsBoolean());
+				}
+				else if (Notation == EJsonNotation::String)
+				{
+					// Quoted numbers stay numbers; anything else is status text
+					const FString& Text = Reader->GetValueAsString();
+					double Number = 0.0;
+					Value = LexTryParseString(Number, *Text) ? FTelemetryValue::MakeNumber(Number) : FTelemetryValue::MakeString(Text);
+				}
+				else
+				{
+					bHasValue = false;
+				}
+
+				if (bHasValue)
+				{
+					Writer.Add(*Slot, TimestampTicks, Value);
+				}
+			}
+
+			Path.LeftInline(ParentLength, EAllowShrinking::No);
+			break;
+		}
+
+		case EJsonNotation::Error:
+			return false;
+
+		default:
+			break;
+		}
+	}
+
+	return !Reader->GetErrorMessage().Len();
+}
+
+FTelemetryRestPoller::FTelemetryRestPoller(TSharedRef<FTelemetryKeyRegistry> InKeyRegistry, TSharedRef<FTelemetryIngestQueue> InQueue, int32 InMaxInFlightRequests)
+	: KeyRegistry(InKeyRegistry)
+	, Queue(InQueue)
+	, MaxInFlightRequests(FMath::Max(1, InMaxInFlightRequests))
+	, InFlightTotal(0)
+	, bStopping(false)
+{
+}
+
+void FTelemetryRestPoller::AddEndpoint(const FEndpointSettings& Settings)
+{
+	FEndpointState& State = Endpoints.AddDefaulted_GetRef();
+	State.Settings = Settings;
+	State.Settings.PollInterval = FMath::Max(0.1f, Settings.PollInterval);
+	State.Host = GetUrlHost(Settings.Url);
+	State.HealthIndex = EndpointHealth ? EndpointHealth->Register(Settings.EndpointId) : INDEX_NONE;
+
+	for (const TPair<FString, FName>& Mapping : Settings.FieldMappings)
+	{
+		State.FieldMap.FieldSlots.Add(Mapping.Key, KeyRegistry->FindOrAdd(Mapping.Value));
+
+		// Every ancestor of a mapped field must be descended into while streaming
+		int32 DotIndex = INDEX_NONE;
+		FString Prefix = Mapping.Key;
+		while (Prefix.FindLastChar(TEXT('.'), DotIndex))
+		{
+			Prefix.LeftInline(DotIndex);
+			State.FieldMap.ContainerPaths.Add(Prefix);
+		}
+	}
+}
+
+void FTelemetryRestPoller::Start()
+{
+	FScopeLock ScopeLock(&Lock);
+	bStopping = false;
+
+	// Spread the first polls so endpoints sharing a host do not all fire at once
+	const double Now = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < Endpoints.Num(); ++Index)
+	{
+		Endpoints[Index].NextPollTime = Now + 0.01 * Index;
+	}
+}
+
+double FTelemetryRestPoller::Tick(double NowSeconds, FTelemetrySampleWriter& Writer)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	double NextTick = MaxFailureBackoff;
+	for (int32 Index = 0; Index < Endpoints.Num(); ++Index)
+	{
+		FEndpointState& State = Endpoints[Index];
+		if (State.bInFlight)
+		{
+			// Completion wakes the worker; the timeout bounds how long that can take
+			NextTick = FMath::Min(NextTick, double(GetRequestTimeout(State.Settings.PollInterval)));
+			continue;
+		}
+
+		if (NowSeconds < State.NextPollTime)
+		{
+			NextTick = FMath::Min(NextTick, State.NextPollTime - NowSeconds);
+			continue;
+		}
+
+		const bool bHostBusy = InFlightPerHost.FindRef(State.Host) > 0;
+		if (bHostBusy || InFlightTotal >= MaxInFlightRequests)
+		{
+			// Due but waiting for a connection; check again shortly
+			NextTick = FMath::Min(NextTick, CapRetryInterval);
+			continue;
+		}
+
+		IssueRequest(Index, NowSeconds);
+		NextTick = FMath::Min(NextTick, double(State.Settings.PollInterval));
+	}
+
+	return NextTick;
+}
+
+void FTelemetryRestPoller::Stop()
+{
+	TArray<FHttpRequestPtr> RequestsToCancel;
+	{
+		FScopeLock ScopeLock(&Lock);
+		bStopping = true;
+		RequestsToCancel = MoveTemp(ActiveRequests);
+		ActiveRequests.Reset();
+	}
+
+	// Cancel outside the lock; completion delegates may run synchronously
+	for (const FHttpRequestPtr& Request : RequestsToCancel)
+	{
+		Request->CancelRequest();
+	}
+}
+
+void FTelemetryRestPoller::IssueRequest(int32 EndpointIndex, double NowSeconds)
+{
+	FEndpointState& State = Endpoints[EndpointIndex];
+	State.bInFlight = true;
+	State.NextPollTime = NowSeconds + State.Settings.PollInterval;
+	InFlightPerHost.FindOrAdd(State.Host)++;
+	++InFlightTotal;
+
+	SendRequest(EndpointIndex, State.Settings, State.ETag, State.LastModified);
+}
+
+void FTelemetryRestPoller::SendRequest(int32 EndpointIndex, const FEndpointSettings& Settings, const FString& ETag, const FString& LastModified)
+{
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Settings.Url);
+	Request->SetVerb(TEXT("GET"));
+	Request->SetHeader(TEXT("Accept"), TEXT("application/json"));
+	Request->SetHeader(TEXT("Connection"), TEXT("keep-alive"));
+	if (!ETag.IsEmpty())
+	{
+		Request->SetHeader(TEXT("If-None-Match"), ETag);
+	}
+	if (!LastModified.IsEmpty())
+	{
+		Request->SetHeader(TEXT("If-Modified-Since"), LastModified);
+	}
+	Request->SetTimeout(GetRequestTimeout(Settings.PollInterval));
+
+	// Parse on the HTTP thread instead of bouncing the body through the game thread
+	Request->SetDelegateThreadPolicy(EHttpRequestDelegateThreadPolicy::CompleteOnHttpThread);
+	Request->OnProcessRequestComplete().BindSP(this, &FTelemetryRestPoller::HandleResponse, EndpointIndex);
+
+	ActiveRequests.Add(Request);
+	Request->ProcessRequest();
+}
+
+void FTelemetryRestPoller::HandleResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully, int32 EndpointIndex)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		ActiveRequests.RemoveSingleSwap(Request, EAllowShrinking::No);
+	}
+
+	if (!bConnectedSuccessfully || !Response.IsValid())
+	{
+		CompleteRequest(EndpointIndex, 0, FString(), FString(), TArrayView<const uint8>());
+		return;
+	}
+
+	CompleteRequest(EndpointIndex, Response->GetResponseCode(), Response->GetHeader(TEXT("ETag")), Response->GetHeader(TEXT("Last-Modified")), Response->GetContent());
+}
+
+void FTelemetryRestPoller::CompleteRequest(int32 EndpointIndex, int32 ResponseCode, const FString& ETag, const FString& LastModified, TArrayView<const uint8> Content)
+{
+	const bool bNotModified = (ResponseCode == 304);
+	const bool bOk = (ResponseCode >= 200 && ResponseCode < 300);
+
+	bool bShouldParse = false;
+	const FFieldMap* FieldMap = nullptr;
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		FEndpointState& State = Endpoints[EndpointIndex];
+		State.bInFlight = false;
+		InFlightPerHost.FindOrAdd(State.Host)--;
+		--InFlightTotal;
+
+		if (bStopping)
+		{
+			return;
+		}
+
+		if (bOk || bNotModified)
+		{
+			FieldMap = &State.FieldMap;
+			State.ConsecutiveFailures = 0;
+			if (EndpointHealth)
+			{
+				EndpointHealth->ReportSuccess(State.HealthIndex);
+			}
+		}
+		else
+		{
+			++State.ConsecutiveFailures;
+			const double Backoff = FMath::Min(MaxFailureBackoff, State.Settings.PollInterval * FMath::Pow(2.0, FMath::Min(State.ConsecutiveFailures, 8)));
+			State.NextPollTime = FPlatformTime::Seconds() + Backoff;
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry endpoint %s: poll failed (HTTP %d), retrying in %.0fs"), *State.Settings.EndpointId.ToString(), ResponseCode, Backoff);
+
+			if (EndpointHealth)
+			{
+				const FString Error = ResponseCode == 0 ? FString(TEXT("Connection failed")) : FString::Printf(TEXT("HTTP %d"), ResponseCode);
+				EndpointHealth->ReportFailure(State.HealthIndex, State.ConsecutiveFailures, Backoff, Error);
+			}
+		}
+
+		// NextPollTime is final for this request; let the worker schedule it (still under Lock, so never after Stop)
+		if (WakeCallback)
+		{
+			WakeCallback();
+		}
+
+		if (bOk)
+		{
+			State.ETag = ETag;
+			State.LastModified = LastModified;
+
+			// Servers without validators still get unchanged bodies skipped
+			const uint32 BodyHash = FCrc::MemCrc32(Content.GetData(), Content.Num());
+			bShouldParse = (BodyHash != State.LastBodyHash);
+			State.LastBodyHash = BodyHash;
+		}
+	}
+
+	// FieldMap is immutable once the worker runs, so reading it needs no lock
+	FTelemetrySampleWriter Writer(*KeyRegistry);
+	if (!bShouldParse)
+	{
+		// 304 or an unchanged body: the endpoint is healthy and its values are still current
+		if (FieldMap)
+		{
+			const int64 NowTicks = FDateTime::UtcNow().GetTicks();
+			for (const TPair<FString, int32>& Field : FieldMap->FieldSlots)
+			{
+				Writer.AddKeepAlive(Field.Value, NowTicks);
+			}
+			Writer.Flush(*Queue);
+		}
+		return;
+	}
+
+	if (!ExtractMappedFields(Content, *FieldMap, FDateTime::UtcNow().GetTicks(), Writer))
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry endpoint %s: malformed JSON response"), *Endpoints[EndpointIndex].Settings.EndpointId.ToString());
+	}
+	Writer.Flush(*Queue);
+}
+
+FString FTelemetryRestPoller::GetUrlHost(const FString& Url)
+{
+	FString Host = Url;
+	const int32 SchemeEnd = Host.Find(TEXT("://"));
+	if (SchemeEnd != INDEX_NONE)
+	{
+		Host.RightChopInline(SchemeEnd + 3);
+	}
+
+	int32 PathStart = INDEX_NONE;
+	if (Host.FindChar(TEXT('/'), PathStart))
+	{
+		Host.LeftInline(PathStart);
+	}
+	return Host.ToLower();
+}
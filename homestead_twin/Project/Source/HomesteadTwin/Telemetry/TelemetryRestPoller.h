@@ -0,0 +1,145 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+#include "TelemetryIngest.h"
+
+class FTelemetryEndpointHealth;
+
+/**
+ * FTelemetryRestPoller
+ *
+ * Poll scheduler for every REST_API telemetry endpoint.
+ *
+ * Responsibilities:
+ * - Poll each endpoint at its own PollInterval
+ * - Serialize requests per host so they reuse one keep-alive connection, and cap total in-flight requests
+ * - Send If-None-Match / If-Modified-Since and skip unchanged payloads before parsing
+ * - Parse JSON responses on the HTTP thread, extracting only the mapped fields
+ *
+ * Implementation Notes:
+ * - Scheduling runs on the ingest thread; completions run on the HTTP thread, push their
+ *   samples straight into the ingest queue and wake the worker so the next poll is scheduled
+ *   from the endpoint's own PollInterval
+ * - Field paths are dotted JSON paths; array elements are addressed by index ("inverters.0.power")
+ * - Failed polls back off exponentially (up to MaxFailureBackoff) without affecting other endpoints
+ * - The HTTP transport is confined to SendRequest / HandleResponse; tests override SendRequest and
+ *   feed outcomes through CompleteRequest to stand in for the server
+ */
+class HOMESTEADTWIN_API FTelemetryRestPoller : public ITelemetrySource, public TSharedFromThis<FTelemetryRestPoller>
+{
+public:
+	/** Endpoint configuration */
+	struct FEndpointSettings
+	{
+		FName EndpointId;
+		FString Url;
+		float PollInterval = 5.0f;
+
+		/** JSON field path -> key */
+		TArray<TPair<FString, FName>> FieldMappings;
+	};
+
+	/** Field path -> slot lookup plus the container paths that lead to a mapped field */
+	struct FFieldMap
+	{
+		TMap<FString, int32> FieldSlots;
+		TSet<FString> ContainerPaths;
+	};
+
+	/**
+	 * Stream through a JSON document and emit a sample for every mapped field.
+	 * Objects and arrays that contain no mapped field are skipped without being parsed.
+	 */
+	static bool ExtractMappedFields(TArrayView<const uint8> Json, const FFieldMap& FieldMap, int64 TimestampTicks, FTelemetrySampleWriter& Writer);
+
+	FTelemetryRestPoller(TSharedRef<FTelemetryKeyRegistry> InKeyRegistry, TSharedRef<FTelemetryIngestQueue> InQueue, int32 InMaxInFlightRequests);
+
+	/** Report endpoint state to a health table (before AddEndpoint) */
+	void SetEndpointHealth(TSharedRef<FTelemetryEndpointHealth> InEndpointHealth) { EndpointHealth = InEndpointHealth; }
+
+	/** Called (HTTP thread) when a completed request reschedules its endpoint, to wake the ingest worker */
+	void SetWakeCallback(TFunction<void()> InWakeCallback) { WakeCallback = MoveTemp(InWakeCallback); }
+
+	/** Add an endpoint (before the worker starts) */
+	void AddEndpoint(const FEndpointSettings& Settings);
+
+	/** Number of configured endpoints */
+	int32 NumEndpoints() const { return Endpoints.Num(); }
+
+	// Begin ITelemetrySource Interface
+	virtual void Start() override;
+	virtual double Tick(double NowSeconds, FTelemetrySampleWriter& Writer) override;
+	virtual void Stop() override;
+	// End ITelemetrySource Interface
+
+protected:
+	/** Send the request for an endpoint (Lock held); completion must reach CompleteRequest */
+	virtual void SendRequest(int32 EndpointIndex, const FEndpointSettings& Settings, const FString& ETag, const FString& LastModified);
+
+	/**
+	 * Finish an endpoint's in-flight request (any thread). ResponseCode 0 = no connection;
+	 * ETag / LastModified are the response validators, Content its body.
+	 */
+	void CompleteRequest(int32 EndpointIndex, int32 ResponseCode, const FString& ETag, const FString& LastModified, TArrayView<const uint8> Content);
+
+private:
+	struct FEndpointState
+	{
+		FEndpointSettings Settings;
+		FString Host;
+		FFieldMap FieldMap;
+
+		double NextPollTime = 0.0;
+		bool bInFlight = false;
+		int32 ConsecutiveFailures = 0;
+
+		/** Entry in EndpointHealth (INDEX_NONE = not reported) */
+		int32 HealthIndex = INDEX_NONE;
+
+		/** Validators from the last 200 response */
+		FString ETag;
+		FString LastModified;
+
+		/** Body hash of the last parsed response (for servers without validators) */
+		uint32 LastBodyHash = 0;
+	};
+
+	/** Start a request for an endpoint (Lock held) */
+	void IssueRequest(int32 EndpointIndex, double NowSeconds);
+
+	/** HTTP completion (HTTP thread) */
+	void HandleResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully, int32 EndpointIndex);
+
+	/** Extract "host[:port]" from a URL */
+	static FString GetUrlHost(const FString& Url);
+
+private:
+	TSharedRef<FTelemetryKeyRegistry> KeyRegistry;
+	TSharedRef<FTelemetryIngestQueue> Queue;
+
+	/** Cap on concurrent requests across all hosts */
+	int32 MaxInFlightRequests;
+
+	/** Guards endpoint poll state, host counters and the active request list */
+	FCriticalSection Lock;
+
+	TArray<FEndpointState> Endpoints;
+
+	/** Host -> requests in flight (at most one, so requests share a keep-alive connection) */
+	TMap<FString, int32> InFlightPerHost;
+	int32 InFlightTotal;
+
+	/** Requests not yet completed (cancelled on Stop) */
+	TArray<FHttpRequestPtr> ActiveRequests;
+
+	bool bStopping;
+
+	/** Optional health table */
+	TSharedPtr<FTelemetryEndpointHealth> EndpointHealth;
+
+	/** Optional worker wake-up (see SetWakeCallback) */
+	TFunction<void()> WakeCallback;
+};
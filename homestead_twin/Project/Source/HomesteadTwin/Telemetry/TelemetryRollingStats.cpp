@@ -0,0 +1,270 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryRollingStats.h"
+
+namespace TelemetryRollingStats
+{
+	/** Initial ring capacity per window (power of two) */
+	constexpr int32 InitialCapacity = 16;
+
+	/** Minimum pushes between full rebuilds of the running sums */
+	constexpr int32 RebuildInterval = 4096;
+}
+
+using namespace TelemetryRollingStats;
+
+void FTelemetryRollingStats::Reset()
+{
+	Windows.Reset();
+	WindowsBySlot.Reset();
+}
+
+int32 FTelemetryRollingStats::AddWindow(int32 Slot, double WindowSeconds, double EwmaTimeConstantSeconds)
+{
+	if (Slot < 0 || WindowSeconds <= 0.0)
+	{
+		return INDEX_NONE;
+	}
+
+	const int64 WindowTicks = int64(WindowSeconds * ETimespan::TicksPerSecond);
+	const double EwmaTau = FMath::Max(0.0, EwmaTimeConstantSeconds);
+
+	if (WindowsBySlot.IsValidIndex(Slot))
+	{
+		for (int32 WindowId : WindowsBySlot[Slot])
+		{
+			if (Windows[WindowId].WindowTicks == WindowTicks && Windows[WindowId].EwmaTau == EwmaTau)
+			{
+				return WindowId;
+			}
+		}
+	}
+	else
+	{
+		WindowsBySlot.SetNum(Slot + 1);
+	}
+
+	const int32 WindowId = Windows.AddDefaulted();
+	FWindow& Window = Windows[WindowId];
+	Window.Slot = Slot;
+	Window.WindowTicks = WindowTicks;
+	Window.EwmaTau = EwmaTau;
+	Window.Times.SetNumUninitialized(InitialCapacity);
+	Window.Values.SetNumUninitialized(InitialCapacity);
+	Window.MinQueue.SetNumUninitialized(InitialCapacity);
+	Window.MaxQueue.SetNumUninitialized(InitialCapacity);
+	Window.Mask = InitialCapacity - 1;
+
+	WindowsBySlot[Slot].Add(WindowId);
+	return WindowId;
+}
+
+void FTelemetryRollingStats::AddSample(int32 Slot, int64 TimestampTicks, float Value)
+{
+	if (!WindowsBySlot.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	for (int32 WindowId : WindowsBySlot[Slot])
+	{
+		AddSampleToWindow(WindowId, TimestampTicks, Value);
+	}
+}
+
+void FTelemetryRollingStats::AddSampleToWindow(int32 WindowId, int64 TimestampTicks, float Value)
+{
+	if (Windows.IsValidIndex(WindowId))
+	{
+		FWindow& Window = Windows[WindowId];
+		EvictBefore(Window, TimestampTicks - Window.WindowTicks);
+		Push(Window, TimestampTicks, Value);
+	}
+}
+
+void FTelemetryRollingStats::ExpireOlderThan(int64 NowTicks)
+{
+	for (FWindow& Window : Windows)
+	{
+		EvictBefore(Window, NowTicks - Window.WindowTicks);
+	}
+}
+
+bool FTelemetryRollingStats::GetResult(int32 WindowId, FResult& OutResult) const
+{
+	if (!Windows.IsValidIndex(WindowId))
+	{
+		return false;
+	}
+
+	const FWindow& Window = Windows[WindowId];
+	OutResult = FResult();
+	OutResult.Count = Window.Num();
+	OutResult.Ewma = Window.Ewma;
+	if (OutResult.Count == 0)
+	{
+		return true;
+	}
+
+	const double N = OutResult.Count;
+	OutResult.Sum = Window.Sum;
+	OutResult.Mean = Window.Sum / N;
+	OutResult.Min = Window.Values[Window.MinQueue[Window.MinFront & Window.Mask] & Window.Mask];
+	OutResult.Max = Window.Values[Window.MaxQueue[Window.MaxFront & Window.Mask] & Window.Mask];
+	OutResult.Variance = FMath::Max(0.0, Window.SumSquares / N - OutResult.Mean * OutResult.Mean);
+
+	// Least-squares slope: (N Stv - St Sv) / (N Stt - St^2)
+	const double Denominator = N * Window.SumTT - Window.SumT * Window.SumT;
+	if (OutResult.Count >= 2 && Denominator > UE_DOUBLE_SMALL_NUMBER)
+	{
+		OutResult.SlopePerSecond = (N * Window.SumTV - Window.SumT * Window.Sum) / Denominator;
+	}
+
+	return true;
+}
+
+void FTelemetryRollingStats::Push(FWindow& Window, int64 TimestampTicks, float Value)
+{
+	if (Window.Num() > int32(Window.Mask))
+	{
+		Grow(Window);
+	}
+
+	if (Window.Num() == 0)
+	{
+		Window.OriginTicks = TimestampTicks;
+	}
+
+	const uint64 Seq = Window.Head++;
+	Window.Times[Seq & Window.Mask] = TimestampTicks;
+	Window.Values[Seq & Window.Mask] = Value;
+
+	// Monotonic deques: drop entries the new sample dominates
+	while (Window.MinBack != Window.MinFront && Window.Values[Window.MinQueue[(Window.MinBack - 1) & Window.Mask] & Window.Mask] >= Value)
+	{
+		--Window.MinBack;
+	}
+	Window.MinQueue[Window.MinBack++ & Window.Mask] = Seq;
+
+	while (Window.MaxBack != Window.MaxFront && Window.Values[Window.MaxQueue[(Window.MaxBack - 1) & Window.Mask] & Window.Mask] <= Value)
+	{
+		--Window.MaxBack;
+	}
+	Window.MaxQueue[Window.MaxBack++ & Window.Mask] = Seq;
+
+	const double T = double(TimestampTicks - Window.OriginTicks) / ETimespan::TicksPerSecond;
+	Window.Sum += Value;
+	Window.SumSquares += double(Value) * Value;
+	Window.SumT += T;
+	Window.SumTT += T * T;
+	Window.SumTV += T * Value;
+
+	// Time-based EWMA: alpha = 1 - exp(-dt / tau); tau = 0 tracks the latest value
+	if (!Window.bHasEwma || Window.EwmaTau <= 0.0)
+	{
+		Window.Ewma = Value;
+		Window.bHasEwma = true;
+	}
+	else
+	{
+		const double DeltaSeconds = FMath::Max(0.0, double(TimestampTicks - Window.EwmaTicks) / ETimespan::TicksPerSecond);
+		const double Alpha = 1.0 - FMath::Exp(-DeltaSeconds / Window.EwmaTau);
+		Window.Ewma += Alpha * (Value - Window.Ewma);
+	}
+	Window.EwmaTicks = TimestampTicks;
+
+	// Rebuild at most once per window length of pushes so the cost stays amortized O(1)
+	if (++Window.PushesSinceRebuild >= FMath::Max(RebuildInterval, Window.Num()))
+	{
+		Rebuild(Window);
+	}
+}
+
+void FTelemetryRollingStats::EvictBefore(FWindow& Window, int64 CutoffTicks)
+{
+	while (Window.Tail != Window.Head && Window.Times[Window.Tail & Window.Mask] < CutoffTicks)
+	{
+		const uint64 Seq = Window.Tail++;
+		const double Value = Window.Values[Seq & Window.Mask];
+		const double T = double(Window.Times[Seq & Window.Mask] - Window.OriginTicks) / ETimespan::TicksPerSecond;
+
+		Window.Sum -= Value;
+		Window.SumSquares -= Value * Value;
+		Window.SumT -= T;
+		Window.SumTT -= T * T;
+		Window.SumTV -= T * Value;
+
+		if (Window.MinFront != Window.MinBack && Window.MinQueue[Window.MinFront & Window.Mask] == Seq)
+		{
+			++Window.MinFront;
+		}
+		if (Window.MaxFront != Window.MaxBack && Window.MaxQueue[Window.MaxFront & Window.Mask] == Seq)
+		{
+			++Window.MaxFront;
+		}
+	}
+
+	// An emptied window restarts its sums from exact zero
+	if (Window.Tail == Window.Head)
+	{
+		Window.Sum = Window.SumSquares = Window.SumT = Window.SumTT = Window.SumTV = 0.0;
+		Window.PushesSinceRebuild = 0;
+	}
+}
+
+void FTelemetryRollingStats::Grow(FWindow& Window)
+{
+	const uint64 OldMask = Window.Mask;
+	const uint64 NewMask = (OldMask + 1) * 2 - 1;
+
+	// Sequence numbers are absolute, so every live entry is re-placed at seq & NewMask
+	TArray<int64> Times;
+	TArray<float> Values;
+	Times.SetNumUninitialized(int32(NewMask + 1));
+	Values.SetNumUninitialized(int32(NewMask + 1));
+	for (uint64 Seq = Window.Tail; Seq != Window.Head; ++Seq)
+	{
+		Times[Seq & NewMask] = Window.Times[Seq & OldMask];
+		Values[Seq & NewMask] = Window.Values[Seq & OldMask];
+	}
+
+	auto GrowQueue = [OldMask, NewMask](TArray<uint64>& Queue, uint64 Front, uint64 Back)
+	{
+		TArray<uint64> NewQueue;
+		NewQueue.SetNumUninitialized(int32(NewMask + 1));
+		for (uint64 Position = Front; Position != Back; ++Position)
+		{
+			NewQueue[Position & NewMask] = Queue[Position & OldMask];
+		}
+		Queue = MoveTemp(NewQueue);
+	};
+	GrowQueue(Window.MinQueue, Window.MinFront, Window.MinBack);
+	GrowQueue(Window.MaxQueue, Window.MaxFront, Window.MaxBack);
+
+	Window.Times = MoveTemp(Times);
+	Window.Values = MoveTemp(Values);
+	Window.Mask = NewMask;
+}
+
+void FTelemetryRollingStats::Rebuild(FWindow& Window)
+{
+	Window.PushesSinceRebuild = 0;
+	Window.Sum = Window.SumSquares = Window.SumT = Window.SumTT = Window.SumTV = 0.0;
+	if (Window.Tail == Window.Head)
+	{
+		return;
+	}
+
+	// Rebase the regression origin on the oldest sample to keep T small
+	Window.OriginTicks = Window.Times[Window.Tail & Window.Mask];
+	for (uint64 Seq = Window.Tail; Seq != Window.Head; ++Seq)
+	{
+		const double Value = Window.Values[Seq & Window.Mask];
+		const double T = double(Window.Times[Seq & Window.Mask] - Window.OriginTicks) / ETimespan::TicksPerSecond;
+		Window.Sum += Value;
+		Window.SumSquares += Value * Value;
+		Window.SumT += T;
+		Window.SumTT += T * T;
+		Window.SumTV += T * Value;
+	}
+}
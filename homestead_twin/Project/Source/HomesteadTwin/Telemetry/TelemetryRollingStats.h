@@ -0,0 +1,120 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FTelemetryRollingStats
+ *
+ * Incrementally maintained rolling-window aggregates for telemetry keys.
+ *
+ * Responsibilities:
+ * - Keep registered (slot, window length) pairs current as samples are committed
+ * - Answer sum, mean, min, max, variance, EWMA and least-squares slope in O(1)
+ *
+ * Implementation Notes:
+ * - Each window owns a ring of its in-window samples addressed by absolute sequence number
+ *   (seq & Mask), so eviction and the min/max monotonic deques never shift memory
+ * - Sum, sum of squares and the regression sums are doubles updated on push/evict; they are
+ *   rebuilt from the ring every RebuildInterval pushes (amortized O(1)) to cancel drift and to
+ *   rebase the regression time origin
+ * - EWMA uses a time-based decay (tau = EwmaTimeConstant) so irregular sample rates are handled
+ * - Game thread only
+ */
+class HOMESTEADTWIN_API FTelemetryRollingStats
+{
+public:
+	/** Aggregates of one window */
+	struct FResult
+	{
+		int32 Count = 0;
+		double Sum = 0.0;
+		double Mean = 0.0;
+		float Min = 0.0f;
+		float Max = 0.0f;
+		double Variance = 0.0;
+		double Ewma = 0.0;
+
+		/** Least-squares slope over the window (units per second) */
+		double SlopePerSecond = 0.0;
+	};
+
+	/** Drop all windows */
+	void Reset();
+
+	/**
+	 * Track a window over a slot; returns the window id. Registering the same
+	 * (slot, window, time constant) again returns the existing id.
+	 */
+	int32 AddWindow(int32 Slot, double WindowSeconds, double EwmaTimeConstantSeconds);
+
+	/** Number of registered windows */
+	int32 NumWindows() const { return Windows.Num(); }
+
+	/** Fold a committed sample into every window over its slot */
+	void AddSample(int32 Slot, int64 TimestampTicks, float Value);
+
+	/** Fold a sample into one window only (used to seed a new window from history) */
+	void AddSampleToWindow(int32 WindowId, int64 TimestampTicks, float Value);
+
+	/** Evict samples that have aged out of their window without a new sample arriving */
+	void ExpireOlderThan(int64 NowTicks);
+
+	/** Current aggregates of a window */
+	bool GetResult(int32 WindowId, FResult& OutResult) const;
+
+private:
+	struct FWindow
+	{
+		int32 Slot = INDEX_NONE;
+		int64 WindowTicks = 0;
+		double EwmaTau = 0.0;
+
+		/** Sample ring indexed by sequence & Mask */
+		TArray<int64> Times;
+		TArray<float> Values;
+		uint64 Mask = 0;
+
+		/** Sequence numbers: [Tail, Head) are in the window */
+		uint64 Tail = 0;
+		uint64 Head = 0;
+
+		/** Monotonic deques of sequence numbers, same ring size: [Front, Back) */
+		TArray<uint64> MinQueue;
+		TArray<uint64> MaxQueue;
+		uint64 MinFront = 0;
+		uint64 MinBack = 0;
+		uint64 MaxFront = 0;
+		uint64 MaxBack = 0;
+
+		/** Running sums (T in seconds relative to OriginTicks) */
+		int64 OriginTicks = 0;
+		double Sum = 0.0;
+		double SumSquares = 0.0;
+		double SumT = 0.0;
+		double SumTT = 0.0;
+		double SumTV = 0.0;
+
+		/** EWMA state */
+		double Ewma = 0.0;
+		int64 EwmaTicks = 0;
+		bool bHasEwma = false;
+
+		/** Pushes since the last rebuild */
+		int32 PushesSinceRebuild = 0;
+
+		int32 Num() const { return int32(Head - Tail); }
+	};
+
+	static void Push(FWindow& Window, int64 TimestampTicks, float Value);
+	static void EvictBefore(FWindow& Window, int64 CutoffTicks);
+	static void Grow(FWindow& Window);
+	static void Rebuild(FWindow& Window);
+
+private:
+	TArray<FWindow> Windows;
+
+	/** Slot -> ids of the windows over it */
+	TArray<TArray<int32>> WindowsBySlot;
+};
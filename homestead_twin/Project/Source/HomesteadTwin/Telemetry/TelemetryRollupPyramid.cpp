@@ -0,0 +1,189 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryRollupPyramid.h"
+#include "Misc/Timespan.h"
+
+namespace TelemetryRollup
+{
+	/** Bucket width of each level (seconds) */
+	constexpr int64 LevelSeconds[FTelemetryRollupPyramid::NumLevels] = { 1, 10, 60, 15 * 60, 60 * 60 };
+}
+
+int64 FTelemetryRollupPyramid::GetBucketTicks(int32 Level)
+{
+	check(Level >= 0 && Level < NumLevels);
+	return TelemetryRollup::LevelSeconds[Level] * ETimespan::TicksPerSecond;
+}
+
+FTelemetryRollupPyramid::FTelemetryRollupPyramid(int32 InBucketsPerLevel)
+{
+	Reset(InBucketsPerLevel);
+}
+
+void FTelemetryRollupPyramid::Reset(int32 InBucketsPerLevel)
+{
+	BucketsPerLevel = FMath::Max(1, InBucketsPerLevel);
+	SlotCount = 0;
+
+	for (FLevel& Level : Levels)
+	{
+		Level.MinColumn.Reset();
+		Level.MaxColumn.Reset();
+		Level.MeanColumn.Reset();
+		Level.CountColumn.Reset();
+		Level.LatestBucket.Reset();
+	}
+}
+
+void FTelemetryRollupPyramid::EnsureSlots(int32 InNumSlots)
+{
+	const int32 NewSlots = InNumSlots - SlotCount;
+	if (NewSlots <= 0)
+	{
+		return;
+	}
+
+	for (FLevel& Level : Levels)
+	{
+		Level.MinColumn.AddZeroed(NewSlots * BucketsPerLevel);
+		Level.MaxColumn.AddZeroed(NewSlots * BucketsPerLevel);
+		Level.MeanColumn.AddZeroed(NewSlots * BucketsPerLevel);
+		Level.CountColumn.AddZeroed(NewSlots * BucketsPerLevel);
+
+		for (int32 Index = 0; Index < NewSlots; ++Index)
+		{
+			Level.LatestBucket.Add(-1);
+		}
+	}
+
+	SlotCount = InNumSlots;
+}
+
+void FTelemetryRollupPyramid::AddSample(int32 Slot, int64 TimestampTicks, float Value)
+{
+	if (Slot < 0 || Slot >= SlotCount || TimestampTicks < 0)
+	{
+		return;
+	}
+
+	const int64 Base = (int64)Slot * BucketsPerLevel;
+
+	for (int32 LevelIndex = 0; LevelIndex < NumLevels; ++LevelIndex)
+	{
+		FLevel& Level = Levels[LevelIndex];
+		const int64 Bucket = TimestampTicks / GetBucketTicks(LevelIndex);
+		int64& Latest = Level.LatestBucket[Slot];
+
+		if (Bucket > Latest)
+		{
+			// Clear buckets skipped since the last sample (at most one full ring)
+			for (int64 Skipped = FMath::Max(Latest + 1, Bucket - BucketsPerLevel + 1); Skipped <= Bucket; ++Skipped)
+			{
+				Level.CountColumn[Base + Skipped % BucketsPerLevel] = 0;
+			}
+			Latest = Bucket;
+		}
+		else if (Bucket <= Latest - BucketsPerLevel)
+		{
+			continue;
+		}
+
+		const int64 Index = Base + Bucket % BucketsPerLevel;
+		int32& Count = Level.CountColumn[Index];
+		float& Mean = Level.MeanColumn[Index];
+
+		if (Count == 0)
+		{
+			Level.MinColumn[Index] = Value;
+			Level.MaxColumn[Index] = Value;
+			Mean = Value;
+			Count = 1;
+		}
+		else
+		{
+			Level.MinColumn[Index] = FMath::Min(Level.MinColumn[Index], Value);
+			Level.MaxColumn[Index] = FMath::Max(Level.MaxColumn[Index], Value);
+			++Count;
+			Mean += (Value - Mean) / Count;
+		}
+	}
+}
+
+int32 FTelemetryRollupPyramid::SelectLevel(int64 StartTicks, int64 EndTicks, int32 PixelWidth) const
+{
+	const int64 RangeTicks = EndTicks - StartTicks;
+
+	// A finer level whose ring is shorter than the range would only return its newest part
+	int32 FinestSpanning = NumLevels - 1;
+	while (FinestSpanning > 0 && int64(BucketsPerLevel) * GetBucketTicks(FinestSpanning - 1) >= RangeTicks)
+	{
+		--FinestSpanning;
+	}
+
+	for (int32 Level = NumLevels - 1; Level > FinestSpanning; --Level)
+	{
+		if (RangeTicks / GetBucketTicks(Level) >= PixelWidth)
+		{
+			return Level;
+		}
+	}
+	return FinestSpanning;
+}
+
+int32 FTelemetryRollupPyramid::CopyBuckets(int32 Slot, int32 Level, int64 StartTicks, int64 EndTicks, TArray<FBucket>& OutBuckets) const
+{
+	if (Slot < 0 || Slot >= SlotCount || Level < 0 || Level >= NumLevels || EndTicks < StartTicks)
+	{
+		return 0;
+	}
+
+	const FLevel& Data = Levels[Level];
+	const int64 Latest = Data.LatestBucket[Slot];
+	if (Latest < 0)
+	{
+		return 0;
+	}
+
+	const int64 BucketTicks = GetBucketTicks(Level);
+	const int64 First = FMath::Max(FMath::Max<int64>(StartTicks, 0) / BucketTicks, Latest - BucketsPerLevel + 1);
+	const int64 Last = FMath::Min(EndTicks / BucketTicks, Latest);
+	const int64 Base = (int64)Slot * BucketsPerLevel;
+
+	const int32 NumBefore = OutBuckets.Num();
+	if (Last >= First)
+	{
+		OutBuckets.Reserve(NumBefore + int32(Last - First + 1));
+	}
+
+	for (int64 Bucket = First; Bucket <= Last; ++Bucket)
+	{
+		const int64 Index = Base + Bucket % BucketsPerLevel;
+		if (Data.CountColumn[Index] > 0)
+		{
+			OutBuckets.Add({ Bucket * BucketTicks, Data.MinColumn[Index], Data.MaxColumn[Index], Data.MeanColumn[Index], Data.CountColumn[Index] });
+		}
+	}
+
+	return OutBuckets.Num() - NumBefore;
+}
+
+int32 FTelemetryRollupPyramid::QueryForWidth(int32 Slot, int64 StartTicks, int64 EndTicks, int32 PixelWidth, TArray<FBucket>& OutBuckets) const
+{
+	const int32 Level = SelectLevel(StartTicks, EndTicks, PixelWidth);
+	CopyBuckets(Slot, Level, StartTicks, EndTicks, OutBuckets);
+	return Level;
+}
+
+SIZE_T FTelemetryRollupPyramid::GetAllocatedSize() const
+{
+	SIZE_T Size = 0;
+	for (const FLevel& Level : Levels)
+	{
+		Size += Level.MinColumn.GetAllocatedSize()
+			+ Level.MaxColumn.GetAllocatedSize()
+			+ Level.MeanColumn.GetAllocatedSize()
+			+ Level.CountColumn.GetAllocatedSize()
+			+ Level.LatestBucket.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,102 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FTelemetryRollupPyramid
+ *
+ * Multi-resolution min/max/mean rollups of telemetry history for long-range graphs.
+ *
+ * Responsibilities:
+ * - Keep one bucket ring per slot at each level (1 s, 10 s, 1 min, 15 min, 1 h)
+ * - Fold every committed sample into all levels in O(1)
+ * - Pick the coarsest level that still fills a requested pixel width and whose ring spans the range
+ *
+ * Implementation Notes:
+ * - Buckets are aligned to multiples of the level width (UTC ticks), so bucket N of a
+ *   level always lives at ring index N % BucketsPerLevel and no timestamp column is needed
+ * - Columns use the same layout as FTelemetryTimeSeriesStore: slot N owns
+ *   [N * BucketsPerLevel, (N + 1) * BucketsPerLevel) of each level column
+ * - Buckets skipped by a gap in the data are cleared when the ring advances past them
+ * - Samples must arrive in time order per slot (the store already guarantees this)
+ * - Game thread only
+ */
+class HOMESTEADTWIN_API FTelemetryRollupPyramid
+{
+public:
+	/** One aggregated bucket */
+	struct FBucket
+	{
+		int64 StartTicks;
+		float Min;
+		float Max;
+		float Mean;
+		int32 Count;
+	};
+
+	/** Number of rollup levels */
+	static constexpr int32 NumLevels = 5;
+
+	/** Bucket width of a level (ticks) */
+	static int64 GetBucketTicks(int32 Level);
+
+	explicit FTelemetryRollupPyramid(int32 InBucketsPerLevel = 512);
+
+	/** Drop all slots and buckets and change the ring size of every level */
+	void Reset(int32 InBucketsPerLevel);
+
+	/** Allocate rings so that slots [0, InNumSlots) are valid */
+	void EnsureSlots(int32 InNumSlots);
+
+	/** Number of allocated slots */
+	int32 NumSlots() const { return SlotCount; }
+
+	/** Ring size of every level */
+	int32 GetBucketsPerLevel() const { return BucketsPerLevel; }
+
+	/** Fold a sample into every level */
+	void AddSample(int32 Slot, int64 TimestampTicks, float Value);
+
+	/**
+	 * Among the levels whose ring spans [StartTicks, EndTicks], the coarsest with at least
+	 * PixelWidth buckets in it (the finest spanning level if none has that many). The coarsest
+	 * level if no ring spans the range.
+	 */
+	int32 SelectLevel(int64 StartTicks, int64 EndTicks, int32 PixelWidth) const;
+
+	/**
+	 * Append the non-empty buckets of a level overlapping [StartTicks, EndTicks], oldest first.
+	 * Returns the number appended.
+	 */
+	int32 CopyBuckets(int32 Slot, int32 Level, int64 StartTicks, int64 EndTicks, TArray<FBucket>& OutBuckets) const;
+
+	/** SelectLevel + CopyBuckets; returns the level used */
+	int32 QueryForWidth(int32 Slot, int64 StartTicks, int64 EndTicks, int32 PixelWidth, TArray<FBucket>& OutBuckets) const;
+
+	/** Approximate heap memory held by the pyramid (bytes) */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FLevel
+	{
+		/** Aggregate columns, NumSlots * BucketsPerLevel entries */
+		TArray<float> MinColumn;
+		TArray<float> MaxColumn;
+		TArray<float> MeanColumn;
+		TArray<int32> CountColumn;
+
+		/** Newest bucket number written per slot (-1 = none) */
+		TArray<int64> LatestBucket;
+	};
+
+private:
+	/** Ring size of every level */
+	int32 BucketsPerLevel;
+
+	/** Number of allocated slots */
+	int32 SlotCount;
+
+	FLevel Levels[NumLevels];
+};
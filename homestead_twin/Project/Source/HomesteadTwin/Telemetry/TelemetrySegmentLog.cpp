@@ -0,0 +1,739 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetrySegmentLog.h"
+#include "../HomesteadTwin.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Crc.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace TelemetryLog
+{
+	/** Compaction writes a block every this many records */
+	constexpr int32 CompactBlockRecords = 65536;
+
+	const TCHAR* const CompactTempName = TEXT("Compact.tmp");
+
+	/** Bytes read first when looking for a block's definitions */
+	constexpr int64 DefinitionPrefixBytes = 64 * 1024;
+
+	uint32 ReadUInt32(const uint8* Data)
+	{
+		uint32 Value;
+		FMemory::Memcpy(&Value, Data, sizeof(Value));
+		return Value;
+	}
+}
+
+using namespace TelemetryLog;
+using namespace TelemetryLogFormat;
+
+void TelemetryLogFormat::DecodeRecord(const uint8* Record, TConstArrayView<FTelemetryValue> Strings,
+	uint32& OutKeyId, int64& OutTimestampTicks, FTelemetryValue& OutValue)
+{
+	const uint32 TypedKeyId = ReadUInt32(Record);
+	FMemory::Memcpy(&OutTimestampTicks, Record + 4, sizeof(OutTimestampTicks));
+
+	uint64 Payload;
+	FMemory::Memcpy(&Payload, Record + 12, sizeof(Payload));
+	OutKeyId = TypedKeyId & RecordKeyIdMask;
+
+	const ETelemetryValueType Type = ETelemetryValueType(TypedKeyId >> RecordTypeShift);
+	if (Type == ETelemetryValueType::String)
+	{
+		OutValue = Strings.IsValidIndex(int32(Payload)) ? Strings[int32(Payload)] : FTelemetryValue::MakeString(FStringView());
+	}
+	else
+	{
+		OutValue = FTelemetryValue::FromPayloadBits(Type, Payload);
+	}
+}
+
+/** Streams one segment block by block; opening reads only block headers and definitions */
+class FTelemetrySegmentLog::FSegmentReader
+{
+public:
+	/** Open Path and index its blocks, stopping at the first truncated or malformed block (false if not a segment) */
+	bool Open(const FString& Path);
+
+	int32 NumBlocks() const { return Blocks.Num(); }
+
+	/** Indexing stopped before the end of the file */
+	bool IsTorn() const { return bTorn; }
+
+	/** Keys defined in the indexed blocks */
+	const TMap<uint32, FName>& GetKeys() const { return KeysById; }
+
+	/**
+	 * Visit the records of a block, newest first if bNewestFirst.
+	 * Returns false (visiting nothing) if the block fails its checksum.
+	 */
+	bool ReadBlock(int32 BlockIndex, bool bNewestFirst, TFunctionRef<void(FName, int64, const FTelemetryValue&)> Func, int64& InOutSamples);
+
+private:
+	struct FBlock
+	{
+		int64 PayloadOffset;
+		uint32 PayloadSize;
+		uint32 PayloadCrc;
+
+		/** Records start, relative to the payload */
+		int64 RecordsOffset;
+		int32 NumRecords;
+	};
+
+	/** Read a block's key and string definitions and locate its records */
+	bool ReadDefinitions(FBlock& Block);
+
+	TUniquePtr<IFileHandle> File;
+	bool bTorn = false;
+
+	TMap<uint32, FName> KeysById;
+	TArray<FTelemetryValue> Strings;
+	TArray<FBlock> Blocks;
+	TArray<uint8> Buffer;
+};
+
+bool FTelemetrySegmentLog::FSegmentReader::Open(const FString& Path)
+{
+	File.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+	if (!File)
+	{
+		return false;
+	}
+
+	const int64 FileSize = File->Size();
+	uint8 SegmentHeader[SegmentHeaderBytes];
+	if (FileSize < SegmentHeaderBytes || !File->Read(SegmentHeader, SegmentHeaderBytes)
+		|| ReadUInt32(SegmentHeader) != SegmentMagic || ReadUInt32(SegmentHeader + 4) != SegmentVersion)
+	{
+		return false;
+	}
+
+	int64 Offset = SegmentHeaderBytes;
+	while (Offset < FileSize)
+	{
+		uint8 BlockHeader[BlockHeaderBytes];
+		if (FileSize - Offset < BlockHeaderBytes || !File->Seek(Offset) || !File->Read(BlockHeader, BlockHeaderBytes))
+		{
+			bTorn = true;
+			break;
+		}
+
+		FBlock Block;
+		Block.PayloadOffset = Offset + BlockHeaderBytes;
+		Block.PayloadSize = ReadUInt32(BlockHeader + 4);
+		Block.PayloadCrc = ReadUInt32(BlockHeader + 8);
+		if (ReadUInt32(BlockHeader) != BlockMagic || Block.PayloadSize > FileSize - Block.PayloadOffset || !ReadDefinitions(Block))
+		{
+			bTorn = true;
+			break;
+		}
+
+		Blocks.Add(Block);
+		Offset = Block.PayloadOffset + Block.PayloadSize;
+	}
+
+	return true;
+}
+
+bool FTelemetrySegmentLog::FSegmentReader::ReadDefinitions(FBlock& Block)
+{
+	// Definitions lead the payload and are usually small: try a prefix before reading it all
+	int64 PrefixBytes = FMath::Min<int64>(DefinitionPrefixBytes, Block.PayloadSize);
+	for (;;)
+	{
+		Buffer.SetNumUninitialized(int32(PrefixBytes), EAllowShrinking::No);
+		if (!File->Seek(Block.PayloadOffset) || !File->Read(Buffer.GetData(), PrefixBytes))
+		{
+			return false;
+		}
+
+		// Not checksummed yet, so cap what a corrupt length can allocate
+		FMemoryReaderView Reader(MakeArrayView(Buffer.GetData(), int32(PrefixBytes)));
+		Reader.ArMaxSerializeSize = PrefixBytes;
+
+		TArray<TPair<uint32, FName>, TInlineAllocator<16>> NewKeys;
+		TArray<FTelemetryValue, TInlineAllocator<16>> NewStrings;
+
+		int32 NumKeys = 0;
+		Reader << NumKeys;
+		for (int32 Index = 0; Index < NumKeys && !Reader.IsError(); ++Index)
+		{
+			uint32 KeyId = 0;
+			FString Key;
+			Reader << KeyId;
+			Reader << Key;
+			NewKeys.Emplace(KeyId, FName(*Key));
+		}
+
+		int32 NumStrings = 0;
+		Reader << NumStrings;
+		for (int32 Index = 0; Index < NumStrings && !Reader.IsError(); ++Index)
+		{
+			uint32 StringId = 0;
+			FString Text;
+			Reader << StringId;
+			Reader << Text;
+
+			// Ids are assigned densely, in order
+			if (StringId == uint32(Strings.Num() + NewStrings.Num()))
+			{
+				NewStrings.Add(FTelemetryValue::MakeString(Text));
+			}
+		}
+
+		int32 NumRecords = 0;
+		Reader << NumRecords;
+
+		if (Reader.IsError())
+		{
+			if (PrefixBytes == Block.PayloadSize)
+			{
+				return false;
+			}
+			PrefixBytes = Block.PayloadSize;
+			continue;
+		}
+
+		if (NumRecords < 0 || Reader.Tell() + NumRecords * RecordBytes != Block.PayloadSize)
+		{
+			return false;
+		}
+
+		for (const TPair<uint32, FName>& Key : NewKeys)
+		{
+			KeysById.Add(Key.Key, Key.Value);
+		}
+		Strings.Append(NewStrings);
+
+		Block.RecordsOffset = Reader.Tell();
+		Block.NumRecords = NumRecords;
+		return true;
+	}
+}
+
+bool FTelemetrySegmentLog::FSegmentReader::ReadBlock(int32 BlockIndex, bool bNewestFirst, TFunctionRef<void(FName, int64, const FTelemetryValue&)> Func, int64& InOutSamples)
+{
+	const FBlock& Block = Blocks[BlockIndex];
+	Buffer.SetNumUninitialized(int32(Block.PayloadSize), EAllowShrinking::No);
+	if (!File->Seek(Block.PayloadOffset) || !File->Read(Buffer.GetData(), Block.PayloadSize)
+		|| FCrc::MemCrc32(Buffer.GetData(), Block.PayloadSize) != Block.PayloadCrc)
+	{
+		return false;
+	}
+
+	// Fixed-size records: decode in place
+	const uint8* Records = Buffer.GetData() + Block.RecordsOffset;
+	for (int32 Step = 0; Step < Block.NumRecords; ++Step)
+	{
+		const int32 Index = bNewestFirst ? Block.NumRecords - 1 - Step : Step;
+
+		uint32 KeyId = 0;
+		int64 TimestampTicks = 0;
+		FTelemetryValue Value;
+		DecodeRecord(Records + Index * RecordBytes, Strings, KeyId, TimestampTicks, Value);
+
+		if (const FName* Key = KeysById.Find(KeyId))
+		{
+			Func(*Key, TimestampTicks, Value);
+			++InOutSamples;
+		}
+	}
+
+	return true;
+}
+
+void FTelemetrySegmentLog::FBlockBuilder::Reset()
+{
+	KeyDefinitions.Reset();
+	StringDefinitions.Reset();
+	Records.Reset();
+}
+
+void FTelemetrySegmentLog::FBlockBuilder::AddRecord(uint32 KeyId, int64 TimestampTicks, const FTelemetryValue& Value, TMap<FString, uint32>& StringIds)
+{
+	const ETelemetryValueType Type = Value.GetType();
+
+	uint64 Payload = 0;
+	if (Type == ETelemetryValueType::String)
+	{
+		FString Text = Value.ToString();
+		if (const uint32* StringId = StringIds.Find(Text))
+		{
+			Payload = *StringId;
+		}
+		else
+		{
+			const uint32 NewId = uint32(StringIds.Num());
+			StringDefinitions.Emplace(NewId, Text);
+			StringIds.Add(MoveTemp(Text), NewId);
+			Payload = NewId;
+		}
+	}
+	else
+	{
+		Payload = Value.GetPayloadBits();
+	}
+
+	Records.Add({ KeyId | (uint32(Type) << RecordTypeShift), TimestampTicks, Payload });
+}
+
+void FTelemetrySegmentLog::FBlockBuilder::Serialize(TArray<uint8>& OutBytes) const
+{
+	const int32 HeaderOffset = OutBytes.Num();
+	OutBytes.AddZeroed(BlockHeaderBytes);
+
+	FMemoryWriter Writer(OutBytes);
+	Writer.Seek(OutBytes.Num());
+
+	int32 NumKeys = KeyDefinitions.Num();
+	Writer << NumKeys;
+	for (const TPair<uint32, FString>& Definition : KeyDefinitions)
+	{
+		uint32 KeyId = Definition.Key;
+		FString Key = Definition.Value;
+		Writer << KeyId;
+		Writer << Key;
+	}
+
+	int32 NumStrings = StringDefinitions.Num();
+	Writer << NumStrings;
+	for (const TPair<uint32, FString>& Definition : StringDefinitions)
+	{
+		uint32 StringId = Definition.Key;
+		FString Text = Definition.Value;
+		Writer << StringId;
+		Writer << Text;
+	}
+
+	int32 NumRecords = Records.Num();
+	Writer << NumRecords;
+	for (const FRecord& Record : Records)
+	{
+		uint32 TypedKeyId = Record.TypedKeyId;
+		int64 TimestampTicks = Record.TimestampTicks;
+		uint64 Payload = Record.Payload;
+		Writer << TypedKeyId;
+		Writer << TimestampTicks;
+		Writer << Payload;
+	}
+
+	const uint8* Payload = OutBytes.GetData() + HeaderOffset + BlockHeaderBytes;
+	const uint32 PayloadSize = uint32(OutBytes.Num() - HeaderOffset - BlockHeaderBytes);
+	const uint32 PayloadCrc = FCrc::MemCrc32(Payload, PayloadSize);
+
+	uint8* Header = OutBytes.GetData() + HeaderOffset;
+	FMemory::Memcpy(Header, &BlockMagic, 4);
+	FMemory::Memcpy(Header + 4, &PayloadSize, 4);
+	FMemory::Memcpy(Header + 8, &PayloadCrc, 4);
+}
+
+FTelemetrySegmentLog::FTelemetrySegmentLog(const FSettings& InSettings, TSharedRef<FTelemetryKeyRegistry> InKeyRegistry)
+	: Settings(InSettings)
+	, KeyRegistry(InKeyRegistry)
+	, Thread(nullptr)
+	, WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	, bStopRequested(false)
+	, SegmentFile(nullptr)
+	, SegmentIndex(INDEX_NONE)
+	, NextSegmentIndex(INDEX_NONE)
+	, SegmentBytes(0)
+	, bSyncPending(false)
+	, LastSyncTime(0.0)
+	, NextKeyId(0)
+{
+	IFileManager::Get().MakeDirectory(*Settings.Directory, true);
+}
+
+FTelemetrySegmentLog::~FTelemetrySegmentLog()
+{
+	StopThread();
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+int64 FTelemetrySegmentLog::Recover(TFunctionRef<bool(FName)> NeedsKey, TFunctionRef<void(FName, int64, const FTelemetryValue&)> Func)
+{
+	check(Thread == nullptr);
+
+	// Leftover from a compaction interrupted before its rename; the inputs are still intact
+	IFileManager::Get().Delete(*(Settings.Directory / CompactTempName), false, false, true);
+
+	const TArray<int32> Indices = FindSegmentIndices(Settings.Directory);
+	NextSegmentIndex = Indices.Num() > 0 ? Indices.Last() + 1 : 0;
+
+	auto NeedsAnyKey = [&NeedsKey](const FSegmentReader& Reader)
+	{
+		for (const TPair<uint32, FName>& Key : Reader.GetKeys())
+		{
+			if (NeedsKey(Key.Value))
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	int64 TotalSamples = 0;
+	for (int32 Position = Indices.Num() - 1; Position >= 0; --Position)
+	{
+		FSegmentReader Reader;
+		if (!Reader.Open(GetSegmentPath(Indices[Position])))
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry log: segment %d is not readable"), Indices[Position]);
+			continue;
+		}
+		if (Reader.IsTorn())
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry log: segment %d ends in a torn block; recovering the %d blocks before it"), Indices[Position], Reader.NumBlocks());
+		}
+
+		for (int32 BlockIndex = Reader.NumBlocks() - 1; BlockIndex >= 0 && NeedsAnyKey(Reader); --BlockIndex)
+		{
+			if (!Reader.ReadBlock(BlockIndex, true, Func, TotalSamples))
+			{
+				UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry log: segment %d block %d fails its checksum; skipped"), Indices[Position], BlockIndex);
+			}
+		}
+	}
+
+	return TotalSamples;
+}
+
+void FTelemetrySegmentLog::StartThread()
+{
+	if (Thread)
+	{
+		return;
+	}
+
+	bStopRequested = false;
+	Thread = FRunnableThread::Create(this, TEXT("TelemetryLog"), 0, TPri_Lowest);
+}
+
+void FTelemetrySegmentLog::StopThread()
+{
+	if (!Thread)
+	{
+		return;
+	}
+
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+}
+
+void FTelemetrySegmentLog::Enqueue(TArray<FTelemetrySample>&& Samples)
+{
+	if (Samples.Num() > 0)
+	{
+		PendingBatches.Enqueue(MoveTemp(Samples));
+	}
+}
+
+uint32 FTelemetrySegmentLog::Run()
+{
+	OpenSegment();
+
+	while (!bStopRequested)
+	{
+		// Sleeping for the sync interval is what batches writes and fsyncs
+		WakeEvent->Wait(FTimespan::FromSeconds(Settings.SyncIntervalSeconds));
+		WritePending();
+	}
+
+	WritePending();
+	CloseSegment();
+
+	return 0;
+}
+
+void FTelemetrySegmentLog::Stop()
+{
+	bStopRequested = true;
+	WakeEvent->Trigger();
+}
+
+void FTelemetrySegmentLog::WritePending()
+{
+	TArray<FTelemetrySample> Batch;
+	while (PendingBatches.Dequeue(Batch))
+	{
+		for (const FTelemetrySample& Sample : Batch)
+		{
+			while (SlotKeyIds.Num() <= Sample.Slot)
+			{
+				SlotKeyIds.Add(INDEX_NONE);
+			}
+
+			int32& KeyId = SlotKeyIds[Sample.Slot];
+			if (KeyId == INDEX_NONE)
+			{
+				KeyId = int32(NextKeyId++);
+				Block.KeyDefinitions.Emplace(uint32(KeyId), KeyRegistry->GetKey(Sample.Slot).ToString());
+			}
+
+			Block.AddRecord(uint32(KeyId), Sample.TimestampTicks, Sample.Value, SegmentStringIds);
+		}
+	}
+
+	if (!SegmentFile || Block.IsEmpty())
+	{
+		Block.Reset();
+		return;
+	}
+
+	Scratch.Reset();
+	Block.Serialize(Scratch);
+	Block.Reset();
+
+	if (!SegmentFile->Write(Scratch.GetData(), Scratch.Num()))
+	{
+		// Cut off whatever part of the block landed, then move to a fresh segment: later blocks
+		// would refer to key and string ids only the lost block defined
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry log: write to segment %d failed; starting a new segment"), SegmentIndex);
+		SegmentFile->Truncate(SegmentBytes);
+		CloseSegment();
+		OpenSegment();
+		return;
+	}
+	SegmentBytes += Scratch.Num();
+	bSyncPending = true;
+
+	if (SegmentBytes >= Settings.MaxSegmentBytes)
+	{
+		CloseSegment();
+
+		if (FindSegmentIndices(Settings.Directory).Num() >= Settings.CompactSegmentCount)
+		{
+			CompactClosedSegments();
+		}
+
+		OpenSegment();
+	}
+	else if (FPlatformTime::Seconds() - LastSyncTime >= Settings.SyncIntervalSeconds)
+	{
+		SegmentFile->Flush(true);
+		bSyncPending = false;
+		LastSyncTime = FPlatformTime::Seconds();
+	}
+}
+
+bool FTelemetrySegmentLog::OpenSegment()
+{
+	if (NextSegmentIndex == INDEX_NONE)
+	{
+		const TArray<int32> Indices = FindSegmentIndices(Settings.Directory);
+		NextSegmentIndex = Indices.Num() > 0 ? Indices.Last() + 1 : 0;
+	}
+
+	SegmentIndex = NextSegmentIndex++;
+	SegmentFile = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*GetSegmentPath(SegmentIndex));
+	if (!SegmentFile)
+	{
+		UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry log: cannot open %s; samples will not be persisted"), *GetSegmentPath(SegmentIndex));
+		return false;
+	}
+
+	WriteSegmentHeader(*SegmentFile);
+	SegmentBytes = SegmentHeaderBytes;
+	bSyncPending = false;
+	LastSyncTime = FPlatformTime::Seconds();
+
+	// Key and string ids are local to a segment
+	SlotKeyIds.Reset();
+	NextKeyId = 0;
+	SegmentStringIds.Reset();
+	return true;
+}
+
+void FTelemetrySegmentLog::CloseSegment()
+{
+	if (!SegmentFile)
+	{
+		return;
+	}
+
+	if (bSyncPending)
+	{
+		SegmentFile->Flush(true);
+		bSyncPending = false;
+	}
+
+	delete SegmentFile;
+	SegmentFile = nullptr;
+}
+
+void FTelemetrySegmentLog::CompactClosedSegments()
+{
+	// Called between segments, so every existing segment is closed
+	const TArray<int32> Indices = FindSegmentIndices(Settings.Directory);
+	if (Indices.Num() < 2)
+	{
+		return;
+	}
+
+	const FString TempPath = Settings.Directory / CompactTempName;
+	TUniquePtr<IFileHandle> TempFile(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*TempPath));
+	if (!TempFile)
+	{
+		return;
+	}
+	WriteSegmentHeader(*TempFile);
+
+	const int64 CutoffTicks = (FDateTime::UtcNow() - FTimespan::FromSeconds(Settings.RetentionSeconds)).GetTicks();
+
+	TMap<FName, uint32> OutputKeyIds;
+	TMap<FString, uint32> OutputStringIds;
+
+	/** Newest timestamp kept per output key id */
+	TArray<int64> LastKeptTicks;
+	FBlockBuilder OutputBlock;
+	int64 KeptSamples = 0;
+
+	auto FlushBlock = [this, &OutputBlock, &TempFile]()
+	{
+		if (!OutputBlock.IsEmpty())
+		{
+			Scratch.Reset();
+			OutputBlock.Serialize(Scratch);
+			TempFile->Write(Scratch.GetData(), Scratch.Num());
+			OutputBlock.Reset();
+		}
+	};
+
+	for (const int32 Index : Indices)
+	{
+		int64 Samples = 0;
+		ReadSegment(GetSegmentPath(Index), [&](FName Key, int64 TimestampTicks, const FTelemetryValue& Value)
+		{
+			if (TimestampTicks < CutoffTicks)
+			{
+				return;
+			}
+
+			uint32* KeyId = OutputKeyIds.Find(Key);
+			if (!KeyId)
+			{
+				KeyId = &OutputKeyIds.Add(Key, uint32(OutputKeyIds.Num()));
+				OutputBlock.KeyDefinitions.Emplace(*KeyId, Key.ToString());
+				LastKeptTicks.Add(TimestampTicks);
+			}
+
+			// Committed samples are in order per key, so an older one is a duplicate left by an interrupted compaction
+			int64& LastTicks = LastKeptTicks[*KeyId];
+			if (TimestampTicks < LastTicks)
+			{
+				return;
+			}
+			LastTicks = TimestampTicks;
+
+			OutputBlock.AddRecord(*KeyId, TimestampTicks, Value, OutputStringIds);
+			++KeptSamples;
+
+			if (OutputBlock.Records.Num() >= CompactBlockRecords)
+			{
+				FlushBlock();
+				// Definitions already written stay valid for the rest of the file
+			}
+		}, Samples);
+	}
+
+	FlushBlock();
+	TempFile->Flush(true);
+	TempFile.Reset();
+
+	// Swap the output in over the oldest input before deleting the others: a crash in between
+	// leaves every sample on disk at least once (duplicates are dropped on recovery and by the
+	// next compaction), never zero times
+	if (KeptSamples > 0)
+	{
+		if (!IFileManager::Get().Move(*GetSegmentPath(Indices[0]), *TempPath, true, true))
+		{
+			UE_LOG(LogHomesteadTwin, Warning, TEXT("Telemetry log: cannot replace segment %d; compaction skipped"), Indices[0]);
+			IFileManager::Get().Delete(*TempPath, false, false, true);
+			return;
+		}
+	}
+	else
+	{
+		IFileManager::Get().Delete(*GetSegmentPath(Indices[0]), false, false, true);
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+	}
+
+	for (int32 Position = 1; Position < Indices.Num(); ++Position)
+	{
+		IFileManager::Get().Delete(*GetSegmentPath(Indices[Position]), false, false, true);
+	}
+
+	UE_LOG(LogHomesteadTwin, Log, TEXT("Telemetry log: compacted %d segments, kept %lld samples"), Indices.Num(), KeptSamples);
+}
+
+bool FTelemetrySegmentLog::ReadSegment(const FString& Path, TFunctionRef<void(FName, int64, const FTelemetryValue&)> Func, int64& OutSamples)
+{
+	OutSamples = 0;
+
+	FSegmentReader Reader;
+	if (!Reader.Open(Path))
+	{
+		return false;
+	}
+
+	bool bIntact = !Reader.IsTorn();
+	for (int32 BlockIndex = 0; BlockIndex < Reader.NumBlocks(); ++BlockIndex)
+	{
+		bIntact &= Reader.ReadBlock(BlockIndex, false, Func, OutSamples);
+	}
+	return bIntact;
+}
+
+void FTelemetrySegmentLog::WriteSegmentHeader(IFileHandle& File)
+{
+	uint8 Header[SegmentHeaderBytes];
+	FMemory::Memcpy(Header, &SegmentMagic, 4);
+	FMemory::Memcpy(Header + 4, &SegmentVersion, 4);
+	File.Write(Header, SegmentHeaderBytes);
+}
+
+TArray<FString> FTelemetrySegmentLog::FindSegmentFiles(const FString& Directory)
+{
+	TArray<FString> Paths;
+	for (const int32 Index : FindSegmentIndices(Directory))
+	{
+		Paths.Add(Directory / FString::Printf(TEXT("Segment_%08d.tlog"), Index));
+	}
+	return Paths;
+}
+
+TArray<int32> FTelemetrySegmentLog::FindSegmentIndices(const FString& Directory)
+{
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(Directory / TEXT("Segment_*.tlog")), true, false);
+
+	TArray<int32> Indices;
+	for (const FString& File : Files)
+	{
+		int32 Index = INDEX_NONE;
+		if (LexTryParseString(Index, *FPaths::GetBaseFilename(File).RightChop(8)) && Index >= 0)
+		{
+			Indices.Add(Index);
+		}
+	}
+
+	Indices.Sort();
+	return Indices;
+}
+
+FString FTelemetrySegmentLog::GetSegmentPath(int32 Index) const
+{
+	return Settings.Directory / FString::Printf(TEXT("Segment_%08d.tlog"), Index);
+}
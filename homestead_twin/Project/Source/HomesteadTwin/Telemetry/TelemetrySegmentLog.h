@@ -0,0 +1,202 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "TelemetryIngest.h"
+
+class FRunnableThread;
+class FEvent;
+class IFileHandle;
+
+/** On-disk segment format (shared by the log writer and the replay reader) */
+namespace TelemetryLogFormat
+{
+	constexpr uint32 SegmentMagic = 0x474C5448; // "HTLG"
+	constexpr uint32 SegmentVersion = 2;
+	constexpr uint32 BlockMagic = 0x314B4C42; // "BLK1"
+
+	/** Segment header: magic + version */
+	constexpr int64 SegmentHeaderBytes = 8;
+
+	/** Block header: magic + payload size + payload CRC */
+	constexpr int64 BlockHeaderBytes = 12;
+
+	/** Serialized record: key id with the value type in its top byte + timestamp ticks + 8-byte payload */
+	constexpr int64 RecordBytes = 20;
+
+	/** Key id bits of a record's first word (the top byte holds the ETelemetryValueType) */
+	constexpr uint32 RecordKeyIdMask = 0x00FFFFFF;
+	constexpr int32 RecordTypeShift = 24;
+
+	/**
+	 * Decode one serialized record. A string payload is an index into Strings, the string
+	 * definitions of the segment so far (unknown indices decode as an empty string).
+	 */
+	HOMESTEADTWIN_API void DecodeRecord(const uint8* Record, TConstArrayView<FTelemetryValue> Strings,
+		uint32& OutKeyId, int64& OutTimestampTicks, FTelemetryValue& OutValue);
+}
+
+/**
+ * FTelemetrySegmentLog
+ *
+ * Append-only on-disk log of committed telemetry samples.
+ *
+ * Responsibilities:
+ * - Write committed samples to segment files on a background thread
+ * - Batch fsyncs (at most one per SyncIntervalSeconds)
+ * - Rotate segments by size and compact closed segments, dropping expired samples
+ * - Replay every intact record on startup so history survives restarts and crashes
+ *
+ * Implementation Notes:
+ * - Segment = header + checksummed blocks; a block carries the key and string definitions it
+ *   introduces plus its samples. Key and string ids are local to a segment, so slots and
+ *   interned string ids never leak across runs
+ * - Records are fixed size whatever the value type: strings are written once per segment as
+ *   definitions and records refer to them by id
+ * - Every run starts a new segment; an old segment is never appended to after a restart
+ * - SegmentBytes counts only blocks that were written; a failed write is truncated away and the
+ *   log moves on to a new segment, so the samples of that one block are lost
+ * - Segments are read block by block (FSegmentReader): opening one reads only block headers
+ *   and definitions, and a block's records are read when it is visited, so memory does not
+ *   grow with segment size. Reading stops at the first truncated block, which discards only a
+ *   torn tail, and skips blocks that fail their checksum
+ * - Recovery reads newest first and stops once the caller has every key it needs
+ * - Compaction streams closed segments into a temp file, renames it over the oldest input and
+ *   only then deletes the other inputs; a crash in between leaves duplicates, which are older
+ *   than the samples before them and dropped like any out-of-order sample
+ * - The game thread only enqueues batches; all file I/O happens on the log thread
+ */
+class HOMESTEADTWIN_API FTelemetrySegmentLog : public FRunnable
+{
+public:
+	/** Log location and policies */
+	struct FSettings
+	{
+		FString Directory;
+
+		/** Rotate the open segment once it grows past this size */
+		int64 MaxSegmentBytes = 8 * 1024 * 1024;
+
+		/** Longest time a written block may wait for fsync */
+		double SyncIntervalSeconds = 2.0;
+
+		/** Compact once this many closed segments exist */
+		int32 CompactSegmentCount = 8;
+
+		/** Samples older than this are dropped during compaction */
+		double RetentionSeconds = 7.0 * 24.0 * 3600.0;
+	};
+
+	/** Segment files in a log directory, oldest first */
+	static TArray<FString> FindSegmentFiles(const FString& Directory);
+
+	FTelemetrySegmentLog(const FSettings& InSettings, TSharedRef<FTelemetryKeyRegistry> InKeyRegistry);
+	virtual ~FTelemetrySegmentLog();
+
+	/**
+	 * Visit intact samples newest first: segments, blocks and records in reverse (call before
+	 * StartThread). Reading stops once NeedsKey(Key) is false for every key of what is left, so
+	 * a caller keeping only the newest samples per key reads only what it keeps.
+	 * Func(FName Key, int64 TimestampTicks, const FTelemetryValue& Value). Returns the number of samples visited.
+	 */
+	int64 Recover(TFunctionRef<bool(FName)> NeedsKey, TFunctionRef<void(FName, int64, const FTelemetryValue&)> Func);
+
+	/** Start the log thread (opens a new segment) */
+	void StartThread();
+
+	/** Write everything still queued, fsync, close the segment and join the thread */
+	void StopThread();
+
+	/** Hand committed samples to the log thread (game thread) */
+	void Enqueue(TArray<FTelemetrySample>&& Samples);
+
+	// Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable Interface
+
+private:
+	class FSegmentReader;
+
+	/** One sample as stored in a block */
+	struct FRecord
+	{
+		/** Key id | value type << RecordTypeShift */
+		uint32 TypedKeyId;
+		int64 TimestampTicks;
+
+		/** Numeric payload bits, or the string id */
+		uint64 Payload;
+	};
+
+	/** Accumulates one block: new key and string definitions plus samples */
+	struct FBlockBuilder
+	{
+		TArray<TPair<uint32, FString>> KeyDefinitions;
+		TArray<TPair<uint32, FString>> StringDefinitions;
+		TArray<FRecord> Records;
+
+		/** Add a record, defining its string in this block if StringIds has not seen it yet */
+		void AddRecord(uint32 KeyId, int64 TimestampTicks, const FTelemetryValue& Value, TMap<FString, uint32>& StringIds);
+
+		bool IsEmpty() const { return Records.Num() == 0; }
+		void Reset();
+
+		/** Serialize as a checksummed block into OutBytes (appended) */
+		void Serialize(TArray<uint8>& OutBytes) const;
+	};
+
+	/** Read a segment; returns false if it ended in a torn or corrupt block */
+	static bool ReadSegment(const FString& Path, TFunctionRef<void(FName, int64, const FTelemetryValue&)> Func, int64& OutSamples);
+
+	/** Write the segment header */
+	static void WriteSegmentHeader(IFileHandle& File);
+
+	/** Existing segment indices in Directory, ascending */
+	static TArray<int32> FindSegmentIndices(const FString& Directory);
+	FString GetSegmentPath(int32 Index) const;
+
+	/** Open the next segment for writing */
+	bool OpenSegment();
+
+	/** fsync and close the open segment */
+	void CloseSegment();
+
+	/** Write everything queued so far as one block */
+	void WritePending();
+
+	/** Merge all closed segments into one, dropping samples past retention */
+	void CompactClosedSegments();
+
+private:
+	FSettings Settings;
+	TSharedRef<FTelemetryKeyRegistry> KeyRegistry;
+
+	/** Batches handed over by the game thread */
+	TQueue<TArray<FTelemetrySample>, EQueueMode::Spsc> PendingBatches;
+
+	FRunnableThread* Thread;
+	FEvent* WakeEvent;
+	std::atomic<bool> bStopRequested;
+
+	/** Log thread state */
+	IFileHandle* SegmentFile;
+	int32 SegmentIndex;
+	int32 NextSegmentIndex;
+	int64 SegmentBytes;
+	bool bSyncPending;
+	double LastSyncTime;
+
+	/** Slot -> key id in the open segment (INDEX_NONE = not yet defined) */
+	TArray<int32> SlotKeyIds;
+	uint32 NextKeyId;
+
+	/** String -> string id in the open segment */
+	TMap<FString, uint32> SegmentStringIds;
+
+	FBlockBuilder Block;
+	TArray<uint8> Scratch;
+};
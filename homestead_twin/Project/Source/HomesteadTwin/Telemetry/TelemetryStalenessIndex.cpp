@@ -0,0 +1,251 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryStalenessIndex.h"
+
+namespace TelemetryStaleness
+{
+	/** Weight of the newest gap in the learned update interval */
+	constexpr double IntervalSmoothing = 0.2;
+}
+
+using namespace TelemetryStaleness;
+
+FTelemetryStalenessIndex::FTelemetryStalenessIndex()
+	: DefaultIntervalTicks(ETimespan::TicksPerSecond * 10)
+	, StaleMultiplier(3.0)
+	, MinStaleTicks(ETimespan::TicksPerSecond)
+	, TrackedCount(0)
+{
+}
+
+void FTelemetryStalenessIndex::Reset(double InDefaultIntervalSeconds, double InStaleMultiplier, double InMinStaleSeconds)
+{
+	DefaultIntervalTicks = int64(FMath::Max(0.0, InDefaultIntervalSeconds) * ETimespan::TicksPerSecond);
+	StaleMultiplier = FMath::Max(1.0, InStaleMultiplier);
+	MinStaleTicks = int64(FMath::Max(0.0, InMinStaleSeconds) * ETimespan::TicksPerSecond);
+
+	LastSampleTicks.Reset();
+	ExplicitTimeoutTicks.Reset();
+	LearnedIntervalTicks.Reset();
+	Deadlines.Reset();
+	HeapPositions.Reset();
+	Stale.Reset();
+	Heap.Reset();
+	TrackedCount = 0;
+}
+
+void FTelemetryStalenessIndex::EnsureSlots(int32 InNumSlots)
+{
+	const int32 NewEntries = InNumSlots - LastSampleTicks.Num();
+	if (NewEntries <= 0)
+	{
+		return;
+	}
+
+	LastSampleTicks.AddZeroed(NewEntries);
+	ExplicitTimeoutTicks.AddZeroed(NewEntries);
+	LearnedIntervalTicks.AddZeroed(NewEntries);
+	Deadlines.AddZeroed(NewEntries);
+	HeapPositions.Reserve(InNumSlots);
+	for (int32 Index = 0; Index < NewEntries; ++Index)
+	{
+		HeapPositions.Add(INDEX_NONE);
+	}
+	Stale.Add(true, NewEntries);
+}
+
+void FTelemetryStalenessIndex::SetStaleTimeout(int32 Slot, double Seconds)
+{
+	if (!ExplicitTimeoutTicks.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	ExplicitTimeoutTicks[Slot] = Seconds > 0.0 ? int64(Seconds * ETimespan::TicksPerSecond) : 0;
+
+	// Apply to the pending deadline; Expire picks up a deadline that is now in the past
+	if (HeapPositions[Slot] != INDEX_NONE)
+	{
+		HeapSet(Slot, LastSampleTicks[Slot] + GetTimeoutTicks(Slot));
+	}
+}
+
+void FTelemetryStalenessIndex::RecordSample(int32 Slot, int64 TimestampTicks)
+{
+	if (!LastSampleTicks.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	const int64 PreviousTicks = LastSampleTicks[Slot];
+	if (PreviousTicks == 0)
+	{
+		++TrackedCount;
+	}
+	else if (TimestampTicks > PreviousTicks)
+	{
+		const double Gap = double(TimestampTicks - PreviousTicks);
+		double& Learned = LearnedIntervalTicks[Slot];
+		Learned = Learned > 0.0 ? Learned + IntervalSmoothing * (Gap - Learned) : Gap;
+	}
+
+	LastSampleTicks[Slot] = FMath::Max(PreviousTicks, TimestampTicks);
+}
+
+bool FTelemetryStalenessIndex::Touch(int32 Slot, int64 TimestampTicks)
+{
+	// A key that never had data has no value to confirm
+	if (!LastSampleTicks.IsValidIndex(Slot) || LastSampleTicks[Slot] == 0)
+	{
+		return false;
+	}
+
+	LastSampleTicks[Slot] = FMath::Max(LastSampleTicks[Slot], TimestampTicks);
+	return true;
+}
+
+void FTelemetryStalenessIndex::Reschedule(int32 Slot, int64 NowTicks, TArray<FTransition>& OutTransitions)
+{
+	if (!LastSampleTicks.IsValidIndex(Slot) || LastSampleTicks[Slot] == 0)
+	{
+		return;
+	}
+
+	// A late-arriving old sample does not make the key fresh; a key whose only samples are
+	// already past their deadline (e.g. warm-started from disk) goes stale right away
+	const int64 Deadline = LastSampleTicks[Slot] + GetTimeoutTicks(Slot);
+	if (Deadline <= NowTicks)
+	{
+		if (!Stale[Slot] && HeapPositions[Slot] == INDEX_NONE)
+		{
+			Stale[Slot] = true;
+			OutTransitions.Add({ Slot, true });
+		}
+		return;
+	}
+
+	HeapSet(Slot, Deadline);
+
+	if (Stale[Slot])
+	{
+		Stale[Slot] = false;
+		OutTransitions.Add({ Slot, false });
+	}
+}
+
+void FTelemetryStalenessIndex::Expire(int64 NowTicks, TArray<FTransition>& OutTransitions)
+{
+	while (Heap.Num() > 0 && Deadlines[Heap[0]] <= NowTicks)
+	{
+		const int32 Slot = Heap[0];
+		HeapRemoveTop();
+
+		Stale[Slot] = true;
+		OutTransitions.Add({ Slot, true });
+	}
+}
+
+SIZE_T FTelemetryStalenessIndex::GetAllocatedSize() const
+{
+	return LastSampleTicks.GetAllocatedSize()
+		+ ExplicitTimeoutTicks.GetAllocatedSize()
+		+ LearnedIntervalTicks.GetAllocatedSize()
+		+ Deadlines.GetAllocatedSize()
+		+ HeapPositions.GetAllocatedSize()
+		+ Stale.GetAllocatedSize()
+		+ Heap.GetAllocatedSize();
+}
+
+int64 FTelemetryStalenessIndex::GetTimeoutTicks(int32 Slot) const
+{
+	if (ExplicitTimeoutTicks[Slot] > 0)
+	{
+		return ExplicitTimeoutTicks[Slot];
+	}
+
+	const double Interval = LearnedIntervalTicks[Slot] > 0.0 ? LearnedIntervalTicks[Slot] : double(DefaultIntervalTicks);
+	return FMath::Max(MinStaleTicks, int64(Interval * StaleMultiplier));
+}
+
+void FTelemetryStalenessIndex::HeapSet(int32 Slot, int64 Deadline)
+{
+	const int64 OldDeadline = Deadlines[Slot];
+	Deadlines[Slot] = Deadline;
+
+	int32 Position = HeapPositions[Slot];
+	if (Position == INDEX_NONE)
+	{
+		Position = Heap.Add(Slot);
+		HeapPositions[Slot] = Position;
+		SiftUp(Position);
+	}
+	else if (Deadline < OldDeadline)
+	{
+		SiftUp(Position);
+	}
+	else
+	{
+		SiftDown(Position);
+	}
+}
+
+void FTelemetryStalenessIndex::HeapRemoveTop()
+{
+	const int32 Last = Heap.Num() - 1;
+	HeapSwap(0, Last);
+	HeapPositions[Heap[Last]] = INDEX_NONE;
+	Heap.Pop(EAllowShrinking::No);
+
+	if (Heap.Num() > 0)
+	{
+		SiftDown(0);
+	}
+}
+
+void FTelemetryStalenessIndex::SiftUp(int32 HeapPosition)
+{
+	while (HeapPosition > 0)
+	{
+		const int32 Parent = (HeapPosition - 1) / 2;
+		if (Deadlines[Heap[Parent]] <= Deadlines[Heap[HeapPosition]])
+		{
+			break;
+		}
+		HeapSwap(Parent, HeapPosition);
+		HeapPosition = Parent;
+	}
+}
+
+void FTelemetryStalenessIndex::SiftDown(int32 HeapPosition)
+{
+	const int32 Count = Heap.Num();
+	for (;;)
+	{
+		const int32 Left = HeapPosition * 2 + 1;
+		const int32 Right = Left + 1;
+		int32 Smallest = HeapPosition;
+
+		if (Left < Count && Deadlines[Heap[Left]] < Deadlines[Heap[Smallest]])
+		{
+			Smallest = Left;
+		}
+		if (Right < Count && Deadlines[Heap[Right]] < Deadlines[Heap[Smallest]])
+		{
+			Smallest = Right;
+		}
+		if (Smallest == HeapPosition)
+		{
+			break;
+		}
+
+		HeapSwap(HeapPosition, Smallest);
+		HeapPosition = Smallest;
+	}
+}
+
+void FTelemetryStalenessIndex::HeapSwap(int32 A, int32 B)
+{
+	Swap(Heap[A], Heap[B]);
+	HeapPositions[Heap[A]] = A;
+	HeapPositions[Heap[B]] = B;
+}
@@ -0,0 +1,98 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FTelemetryStalenessIndex
+ *
+ * Deadline index that flags telemetry keys stale when they miss their expected next update.
+ *
+ * Responsibilities:
+ * - Track, per slot, the time of the latest sample and the deadline for the next one
+ * - Report stale / fresh transitions in bulk, touching only the slots whose deadline passed
+ *
+ * Implementation Notes:
+ * - Indexed binary min-heap of slots keyed by deadline: reschedule and expiry are O(log n),
+ *   and a frame with nothing overdue costs one comparison against the heap top
+ * - A slot's timeout is either explicit (SetStaleTimeout) or StaleMultiplier times its learned
+ *   update interval (EWMA of the gaps between samples), never below MinStaleSeconds
+ * - Stale slots leave the heap; the next sample puts them back and reports them fresh
+ * - Sources that confirm a value is unchanged without resending it (HTTP 304, change-only
+ *   publishers on a live connection) Touch the slot, which moves its deadline like a sample
+ * - Game thread only
+ */
+class HOMESTEADTWIN_API FTelemetryStalenessIndex
+{
+public:
+	/** One change of a slot's staleness */
+	struct FTransition
+	{
+		int32 Slot;
+		bool bStale;
+	};
+
+	FTelemetryStalenessIndex();
+
+	/** Drop all slots and change the timeout rules */
+	void Reset(double InDefaultIntervalSeconds, double InStaleMultiplier, double InMinStaleSeconds);
+
+	/** Allocate state so that slots [0, InNumSlots) are valid */
+	void EnsureSlots(int32 InNumSlots);
+
+	/** Explicit timeout for a slot (<= 0 = learn from the update rate) */
+	void SetStaleTimeout(int32 Slot, double Seconds);
+
+	/** Note a committed sample (O(1); call Reschedule once per slot afterwards) */
+	void RecordSample(int32 Slot, int64 TimestampTicks);
+
+	/** Note that a slot's latest value is still current without a new sample (O(1); no interval learning). False if it never had a sample */
+	bool Touch(int32 Slot, int64 TimestampTicks);
+
+	/** Move a slot's deadline after new samples; reports it fresh if it was stale, or stale if its first samples are already past the deadline */
+	void Reschedule(int32 Slot, int64 NowTicks, TArray<FTransition>& OutTransitions);
+
+	/** Flag every slot whose deadline has passed */
+	void Expire(int64 NowTicks, TArray<FTransition>& OutTransitions);
+
+	/** Whether a slot missed its deadline (slots without samples are stale) */
+	bool IsStale(int32 Slot) const { return !Stale.IsValidIndex(Slot) || Stale[Slot]; }
+
+	/** Number of slots that have received samples, and how many of them are fresh */
+	int32 NumTracked() const { return TrackedCount; }
+	int32 NumFresh() const { return Heap.Num(); }
+
+	/** Approximate heap memory held by the index (bytes) */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** Timeout of a slot (ticks) */
+	int64 GetTimeoutTicks(int32 Slot) const;
+
+	/** Heap maintenance */
+	void HeapSet(int32 Slot, int64 Deadline);
+	void HeapRemoveTop();
+	void SiftUp(int32 HeapPosition);
+	void SiftDown(int32 HeapPosition);
+	void HeapSwap(int32 A, int32 B);
+
+private:
+	/** Timeout rules (ticks) */
+	int64 DefaultIntervalTicks;
+	double StaleMultiplier;
+	int64 MinStaleTicks;
+
+	/** Per-slot columns */
+	TArray<int64> LastSampleTicks;
+	TArray<int64> ExplicitTimeoutTicks;
+	TArray<double> LearnedIntervalTicks;
+	TArray<int64> Deadlines;
+	TArray<int32> HeapPositions;
+	TBitArray<> Stale;
+
+	/** Min-heap of slots by deadline */
+	TArray<int32> Heap;
+
+	int32 TrackedCount;
+};
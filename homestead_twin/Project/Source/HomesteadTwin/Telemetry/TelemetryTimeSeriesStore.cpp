@@ -0,0 +1,174 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryTimeSeriesStore.h"
+
+FTelemetryTimeSeriesStore::FTelemetryTimeSeriesStore(int32 InCapacityPerKey)
+{
+	Reset(InCapacityPerKey);
+}
+
+void FTelemetryTimeSeriesStore::Reset(int32 InCapacityPerKey)
+{
+	CapacityPerKey = FMath::Max(1, InCapacityPerKey);
+
+	TimestampColumn.Reset();
+	ValueColumn.Reset();
+	TypedColumn.Reset();
+	TypedRings.Reset();
+	Heads.Reset();
+	Counts.Reset();
+}
+
+void FTelemetryTimeSeriesStore::EnsureSlots(int32 InNumSlots)
+{
+	const int32 NewSlots = InNumSlots - NumSlots();
+	if (NewSlots <= 0)
+	{
+		return;
+	}
+
+	// Grow both columns by whole rings; existing slots keep their offsets
+	TimestampColumn.AddZeroed(NewSlots * CapacityPerKey);
+	ValueColumn.AddZeroed(NewSlots * CapacityPerKey);
+	Heads.AddZeroed(NewSlots);
+	Counts.AddZeroed(NewSlots);
+	for (int32 Index = 0; Index < NewSlots; ++Index)
+	{
+		TypedRings.Add(INDEX_NONE);
+	}
+}
+
+bool FTelemetryTimeSeriesStore::Append(int32 Slot, int64 TimestampTicks, const FTelemetryValue& Value)
+{
+	if (!Heads.IsValidIndex(Slot))
+	{
+		return false;
+	}
+
+	const int64 Base = (int64)Slot * CapacityPerKey;
+	int32& Head = Heads[Slot];
+	int32& Count = Counts[Slot];
+
+	if (Count > 0)
+	{
+		const int32 LatestRing = (Head - 1 + CapacityPerKey) % CapacityPerKey;
+		if (TimestampTicks < TimestampColumn[Base + LatestRing])
+		{
+			return false;
+		}
+	}
+
+	TimestampColumn[Base + Head] = TimestampTicks;
+	ValueColumn[Base + Head] = Value.AsFloat();
+
+	if (TypedRings[Slot] == INDEX_NONE && Value.GetType() != ETelemetryValueType::Float)
+	{
+		AllocateTypedRing(Slot);
+	}
+	if (TypedRings[Slot] != INDEX_NONE)
+	{
+		TypedColumn[(int64)TypedRings[Slot] * CapacityPerKey + Head] = Value;
+	}
+
+	Head = (Head + 1) % CapacityPerKey;
+	Count = FMath::Min(Count + 1, CapacityPerKey);
+
+	return true;
+}
+
+bool FTelemetryTimeSeriesStore::GetLatest(int32 Slot, float& OutValue, int64& OutTimestampTicks) const
+{
+	if (!Counts.IsValidIndex(Slot) || Counts[Slot] == 0)
+	{
+		return false;
+	}
+
+	const int64 Physical = (int64)Slot * CapacityPerKey + (Heads[Slot] - 1 + CapacityPerKey) % CapacityPerKey;
+	OutValue = ValueColumn[Physical];
+	OutTimestampTicks = TimestampColumn[Physical];
+	return true;
+}
+
+bool FTelemetryTimeSeriesStore::GetLatestValue(int32 Slot, FTelemetryValue& OutValue, int64& OutTimestampTicks) const
+{
+	if (!Counts.IsValidIndex(Slot) || Counts[Slot] == 0)
+	{
+		return false;
+	}
+
+	const int32 LatestRing = (Heads[Slot] - 1 + CapacityPerKey) % CapacityPerKey;
+	const int64 Physical = (int64)Slot * CapacityPerKey + LatestRing;
+	OutValue = TypedRings[Slot] != INDEX_NONE
+		? TypedColumn[(int64)TypedRings[Slot] * CapacityPerKey + LatestRing]
+		: FTelemetryValue::MakeFloat(ValueColumn[Physical]);
+	OutTimestampTicks = TimestampColumn[Physical];
+	return true;
+}
+
+int32 FTelemetryTimeSeriesStore::CopySamplesSince(int32 Slot, int64 SinceTicks, TArrayView<int64> OutTimestamps, TArrayView<float> OutValues) const
+{
+	if (!Counts.IsValidIndex(Slot))
+	{
+		return 0;
+	}
+
+	const int32 Count = Counts[Slot];
+	const int32 MaxOut = FMath::Min(OutTimestamps.Num(), OutValues.Num());
+	const int32 First = FMath::Max(LowerBoundLogical(Slot, SinceTicks), Count - MaxOut);
+	const int64 Base = (int64)Slot * CapacityPerKey;
+
+	int32 Written = 0;
+	for (int32 Logical = First; Logical < Count; ++Logical, ++Written)
+	{
+		const int64 Physical = Base + LogicalToRing(Slot, Logical);
+		OutTimestamps[Written] = TimestampColumn[Physical];
+		OutValues[Written] = ValueColumn[Physical];
+	}
+
+	return Written;
+}
+
+SIZE_T FTelemetryTimeSeriesStore::GetAllocatedSize() const
+{
+	return TimestampColumn.GetAllocatedSize()
+		+ ValueColumn.GetAllocatedSize()
+		+ TypedColumn.GetAllocatedSize()
+		+ TypedRings.GetAllocatedSize()
+		+ Heads.GetAllocatedSize()
+		+ Counts.GetAllocatedSize();
+}
+
+int32 FTelemetryTimeSeriesStore::LowerBoundLogical(int32 Slot, int64 Ticks) const
+{
+	const int64 Base = (int64)Slot * CapacityPerKey;
+
+	int32 Low = 0;
+	int32 High = Counts[Slot];
+	while (Low < High)
+	{
+		const int32 Mid = Low + (High - Low) / 2;
+		if (TimestampColumn[Base + LogicalToRing(Slot, Mid)] < Ticks)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+	return Low;
+}
+
+void FTelemetryTimeSeriesStore::AllocateTypedRing(int32 Slot)
+{
+	const int32 Ring = TypedColumn.Num() / CapacityPerKey;
+	const int64 Base = (int64)Slot * CapacityPerKey;
+
+	// Add grows geometrically; an exact Reserve here would reallocate the column for every new ring
+	for (int32 Index = 0; Index < CapacityPerKey; ++Index)
+	{
+		TypedColumn.Add(FTelemetryValue::MakeFloat(ValueColumn[Base + Index]));
+	}
+
+	TypedRings[Slot] = Ring;
+}
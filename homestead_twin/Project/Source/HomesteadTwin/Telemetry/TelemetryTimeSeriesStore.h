@@ -0,0 +1,122 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TelemetryValue.h"
+
+/**
+ * FTelemetryTimeSeriesStore
+ *
+ * Columnar ring-buffer storage for telemetry history.
+ *
+ * Responsibilities:
+ * - Keep a fixed-capacity history ring per dense key slot
+ * - Answer latest-value and time-window queries without allocating
+ *
+ * Implementation Notes:
+ * - Timestamps (UTC ticks) and values live in two separate contiguous columns;
+ *   slot N owns the range [N * Capacity, (N + 1) * Capacity) of each column
+ * - Slot indices come from FTelemetryKeyRegistry; the store only owns samples
+ * - Slots are never removed, so a slot index stays valid for the store lifetime
+ * - Game thread only; ingest threads hand samples over through FTelemetryIngestQueue
+ * - Samples older than the latest sample of a slot are rejected, which keeps
+ *   every ring sorted by time and lets window queries binary search
+ * - The value column holds the float projection of every sample. A slot that receives a
+ *   non-float value (integer, boolean, enum, string) also gets a ring in the typed column,
+ *   allocated on first use, so float-only keys pay nothing for typed samples
+ */
+class HOMESTEADTWIN_API FTelemetryTimeSeriesStore
+{
+public:
+	explicit FTelemetryTimeSeriesStore(int32 InCapacityPerKey = 3600);
+
+	/** Drop all slots and samples and change the per-key capacity */
+	void Reset(int32 InCapacityPerKey);
+
+	/** Allocate rings so that slots [0, InNumSlots) are valid */
+	void EnsureSlots(int32 InNumSlots);
+
+	/** Number of allocated slots */
+	int32 NumSlots() const { return Heads.Num(); }
+
+	/** Ring capacity of every slot */
+	int32 GetCapacityPerKey() const { return CapacityPerKey; }
+
+	/** Number of samples currently held for a slot */
+	int32 NumSamples(int32 Slot) const { return Counts.IsValidIndex(Slot) ? Counts[Slot] : 0; }
+
+	/** Append a sample; returns false if it is older than the latest sample of the slot */
+	bool Append(int32 Slot, int64 TimestampTicks, const FTelemetryValue& Value);
+
+	/** Get the most recent sample of a slot (float projection) */
+	bool GetLatest(int32 Slot, float& OutValue, int64& OutTimestampTicks) const;
+
+	/** Get the most recent sample of a slot as stored */
+	bool GetLatestValue(int32 Slot, FTelemetryValue& OutValue, int64& OutTimestampTicks) const;
+
+	/** Whether a slot has received non-float values */
+	bool HasTypedValues(int32 Slot) const { return TypedRings.IsValidIndex(Slot) && TypedRings[Slot] != INDEX_NONE; }
+
+	/**
+	 * Copy samples with a timestamp >= SinceTicks into caller-owned views, oldest first.
+	 * If more samples match than fit, the newest ones are kept. Returns the number written.
+	 */
+	int32 CopySamplesSince(int32 Slot, int64 SinceTicks, TArrayView<int64> OutTimestamps, TArrayView<float> OutValues) const;
+
+	/** Visit samples with a timestamp >= SinceTicks, oldest first. Func(int64 TimestampTicks, float Value) */
+	template <typename FuncType>
+	void ForEachSampleSince(int32 Slot, int64 SinceTicks, FuncType&& Func) const
+	{
+		if (!Counts.IsValidIndex(Slot))
+		{
+			return;
+		}
+
+		const int32 Count = Counts[Slot];
+		const int64 Base = (int64)Slot * CapacityPerKey;
+		for (int32 Logical = LowerBoundLogical(Slot, SinceTicks); Logical < Count; ++Logical)
+		{
+			const int64 Physical = Base + LogicalToRing(Slot, Logical);
+			Func(TimestampColumn[Physical], ValueColumn[Physical]);
+		}
+	}
+
+	/** Approximate heap memory held by the store (bytes) */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** Convert a logical index (0 = oldest) into a ring index for a slot */
+	int32 LogicalToRing(int32 Slot, int32 Logical) const
+	{
+		return (Heads[Slot] - Counts[Slot] + Logical + CapacityPerKey) % CapacityPerKey;
+	}
+
+	/** First logical index whose timestamp is >= Ticks */
+	int32 LowerBoundLogical(int32 Slot, int64 Ticks) const;
+
+	/** Give a slot a typed ring, filled from its float history */
+	void AllocateTypedRing(int32 Slot);
+
+private:
+	/** Ring capacity per slot */
+	int32 CapacityPerKey;
+
+	/** Timestamp column (UTC ticks), NumSlots * CapacityPerKey entries */
+	TArray<int64> TimestampColumn;
+
+	/** Value column (float projection), NumSlots * CapacityPerKey entries */
+	TArray<float> ValueColumn;
+
+	/** Typed column, CapacityPerKey entries per typed ring */
+	TArray<FTelemetryValue> TypedColumn;
+
+	/** Typed ring index per slot (INDEX_NONE = float-only slot) */
+	TArray<int32> TypedRings;
+
+	/** Next ring write position per slot */
+	TArray<int32> Heads;
+
+	/** Number of valid samples per slot */
+	TArray<int32> Counts;
+};
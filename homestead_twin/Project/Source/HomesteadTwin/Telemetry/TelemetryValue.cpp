@@ -0,0 +1,236 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "TelemetryValue.h"
+
+namespace TelemetryValue
+{
+	/** Largest integer a float holds exactly */
+	constexpr double MaxExactFloatInteger = 16777216.0;
+
+	/** Magnitude beyond which a double no longer converts safely to int64 */
+	constexpr double MaxInteger = 9.0e18;
+}
+
+using namespace TelemetryValue;
+
+FTelemetryStringTable& FTelemetryStringTable::Get()
+{
+	static FTelemetryStringTable Table;
+	return Table;
+}
+
+int32 FTelemetryStringTable::Intern(FStringView Text)
+{
+	// Hashed once; the key is copied into an FString only when it is added
+	const uint32 Hash = FStringIdKeyFuncs::GetKeyHash(Text);
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const int32* Id = StringIds.FindByHash(Hash, Text))
+		{
+			return *Id;
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	if (const int32* Id = StringIds.FindByHash(Hash, Text))
+	{
+		return *Id;
+	}
+
+	if (Strings.Num() >= MaxStrings)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 NewId = Strings.Emplace(Text);
+	StringIds.AddByHash(Hash, Strings[NewId], NewId);
+	return NewId;
+}
+
+FString FTelemetryStringTable::GetString(int32 Id) const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Strings.IsValidIndex(Id) ? Strings[Id] : FString();
+}
+
+void FTelemetryStringTable::VisitString(int32 Id, TFunctionRef<void(FStringView)> Visitor) const
+{
+	FReadScopeLock ReadLock(Lock);
+	Visitor(Strings.IsValidIndex(Id) ? FStringView(Strings[Id]) : FStringView());
+}
+
+int32 FTelemetryStringTable::Num() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Strings.Num();
+}
+
+FTelemetryValue FTelemetryValue::MakeFloat(float Value)
+{
+	FTelemetryValue Result;
+	Result.WritePayload(Value);
+	return Result;
+}
+
+FTelemetryValue FTelemetryValue::MakeInteger(int64 Value)
+{
+	FTelemetryValue Result;
+	Result.MakeEmpty(ETelemetryValueType::Integer);
+	Result.WritePayload(Value);
+	return Result;
+}
+
+FTelemetryValue FTelemetryValue::MakeBoolean(bool bValue)
+{
+	FTelemetryValue Result;
+	Result.MakeEmpty(ETelemetryValueType::Boolean);
+	Result.WritePayload(uint8(bValue ? 1 : 0));
+	return Result;
+}
+
+FTelemetryValue FTelemetryValue::MakeEnum(int32 Ordinal)
+{
+	FTelemetryValue Result;
+	Result.MakeEmpty(ETelemetryValueType::Enum);
+	Result.WritePayload(Ordinal);
+	return Result;
+}
+
+FTelemetryValue FTelemetryValue::MakeString(FStringView Text)
+{
+	const auto Utf8 = StringCast<UTF8CHAR>(Text.GetData(), Text.Len());
+	return MakeString(FUtf8StringView(Utf8.Get(), Utf8.Length()));
+}
+
+FTelemetryValue FTelemetryValue::MakeString(FUtf8StringView Text)
+{
+	FTelemetryValue Result;
+	Result.MakeEmpty(ETelemetryValueType::String);
+
+	int32 Length = Text.Len();
+	if (Length > InlineStringBytes)
+	{
+		// Converted on the stack; the table copies the text only for a string it has not seen
+		const auto Wide = StringCast<TCHAR>(Text.GetData(), Text.Len());
+		const int32 Id = FTelemetryStringTable::Get().Intern(FStringView(Wide.Get(), Wide.Length()));
+		if (Id != INDEX_NONE)
+		{
+			Result.Data[1] = InternedLength;
+			Result.WritePayload(Id);
+			return Result;
+		}
+
+		// Table full: keep the inline prefix, cut at a code point boundary
+		Length = InlineStringBytes;
+		while (Length > 0 && (uint8(Text[Length]) & 0xC0) == 0x80)
+		{
+			--Length;
+		}
+	}
+
+	Result.Data[1] = uint8(Length);
+	FMemory::Memcpy(Result.Data + 2, Text.GetData(), Length);
+	return Result;
+}
+
+FTelemetryValue FTelemetryValue::MakeNumber(double Value)
+{
+	if (FMath::Abs(Value) > MaxExactFloatInteger && FMath::Abs(Value) < MaxInteger && Value == FMath::RoundToDouble(Value))
+	{
+		return MakeInteger(int64(Value));
+	}
+	return MakeFloat(float(Value));
+}
+
+FTelemetryValue FTelemetryValue::FromPayloadBits(ETelemetryValueType Type, uint64 Bits)
+{
+	FTelemetryValue Result;
+	Result.MakeEmpty(Type == ETelemetryValueType::String ? ETelemetryValueType::Float : Type);
+	Result.WritePayload(Bits);
+	return Result;
+}
+
+float FTelemetryValue::AsFloat() const
+{
+	switch (GetType())
+	{
+	case ETelemetryValueType::Float:
+		return ReadPayload<float>();
+	case ETelemetryValueType::Integer:
+		return float(ReadPayload<int64>());
+	case ETelemetryValueType::Boolean:
+		return ReadPayload<uint8>() != 0 ? 1.0f : 0.0f;
+	case ETelemetryValueType::Enum:
+		return float(ReadPayload<int32>());
+	default:
+		return 0.0f;
+	}
+}
+
+int64 FTelemetryValue::AsInteger() const
+{
+	switch (GetType())
+	{
+	case ETelemetryValueType::Integer:
+		return ReadPayload<int64>();
+	case ETelemetryValueType::Enum:
+		return ReadPayload<int32>();
+	case ETelemetryValueType::String:
+		return 0;
+	default:
+		return int64(AsFloat());
+	}
+}
+
+uint64 FTelemetryValue::GetPayloadBits() const
+{
+	return ReadPayload<uint64>();
+}
+
+FString FTelemetryValue::ToString(TConstArrayView<FString> EnumLabels) const
+{
+	switch (GetType())
+	{
+	case ETelemetryValueType::Float:
+		return FString::Printf(TEXT("%.2f"), ReadPayload<float>());
+
+	case ETelemetryValueType::Integer:
+		return FString::Printf(TEXT("%lld"), ReadPayload<int64>());
+
+	case ETelemetryValueType::Boolean:
+		return ReadPayload<uint8>() != 0 ? TEXT("true") : TEXT("false");
+
+	case ETelemetryValueType::Enum:
+	{
+		const int32 Ordinal = ReadPayload<int32>();
+		return EnumLabels.IsValidIndex(Ordinal) ? EnumLabels[Ordinal] : FString::FromInt(Ordinal);
+	}
+
+	case ETelemetryValueType::String:
+		if (Data[1] == InternedLength)
+		{
+			return FTelemetryStringTable::Get().GetString(ReadPayload<int32>());
+		}
+		return FString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Data + 2), Data[1]));
+
+	default:
+		return FString();
+	}
+}
+
+void FTelemetryValue::VisitString(TFunctionRef<void(FStringView)> Visitor) const
+{
+	if (GetType() != ETelemetryValueType::String)
+	{
+		return;
+	}
+
+	if (Data[1] == InternedLength)
+	{
+		FTelemetryStringTable::Get().VisitString(ReadPayload<int32>(), Visitor);
+		return;
+	}
+
+	const auto Wide = StringCast<TCHAR>(reinterpret_cast<const UTF8CHAR*>(Data + 2), Data[1]);
+	Visitor(FStringView(Wide.Get(), Wide.Length()));
+}
@@ -0,0 +1,162 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+/** Kind of value carried by a telemetry sample */
+enum class ETelemetryValueType : uint8
+{
+	Float,
+	Integer,
+	Boolean,
+	Enum,
+	String
+};
+
+/**
+ * FTelemetryStringTable
+ *
+ * Process-wide intern table for telemetry strings too long to store inline.
+ *
+ * Implementation Notes:
+ * - Status strings repeat (ONLINE, ON BATTERY, ...), so each distinct string is allocated once
+ *   and samples carry only its id
+ * - Append-only; ids stay valid for the process lifetime
+ * - Bounded at MaxStrings so a feed of unique strings cannot grow it without limit
+ * - Thread-safe; ingest threads intern while decoding
+ * - Looked up by string view (view-compatible key funcs), so interning a known string allocates nothing
+ */
+class HOMESTEADTWIN_API FTelemetryStringTable
+{
+public:
+	/** Most strings the table will hold */
+	static constexpr int32 MaxStrings = 65536;
+
+	static FTelemetryStringTable& Get();
+
+	/** Get the id of Text, adding it on first use (INDEX_NONE once the table is full) */
+	int32 Intern(FStringView Text);
+
+	/** Get the text of an id (empty if unknown) */
+	FString GetString(int32 Id) const;
+
+	/** Call Visitor with a view of an id's text (empty if unknown), without copying it */
+	void VisitString(int32 Id, TFunctionRef<void(FStringView)> Visitor) const;
+
+	/** Number of interned strings */
+	int32 Num() const;
+
+private:
+	/** Case-sensitive FString keys that can also be found by FStringView */
+	struct FStringIdKeyFuncs : BaseKeyFuncs<TPair<FString, int32>, FString, false>
+	{
+		static const FString& GetSetKey(const TPair<FString, int32>& Element) { return Element.Key; }
+		static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+		static bool Matches(const FString& A, FStringView B) { return FStringView(A).Equals(B, ESearchCase::CaseSensitive); }
+		static uint32 GetKeyHash(const FString& Key) { return GetTypeHash(FStringView(Key)); }
+		static uint32 GetKeyHash(FStringView Key) { return GetTypeHash(Key); }
+	};
+
+	mutable FRWLock Lock;
+
+	TArray<FString> Strings;
+	TMap<FString, int32, FDefaultSetAllocator, FStringIdKeyFuncs> StringIds;
+};
+
+/**
+ * FTelemetryValue
+ *
+ * Compact tagged telemetry value: float, 64-bit integer, boolean, enum ordinal or short string.
+ *
+ * Responsibilities:
+ * - Carry any decoded value in a fixed 16 bytes, so samples and rings never allocate per value
+ * - Project every non-string value onto a float for history, rollups, statistics and alarms
+ * - Format itself only when a display asks for text
+ *
+ * Implementation Notes:
+ * - Byte 0 holds the type; numeric payloads live in bytes 8-15
+ * - Strings up to InlineStringBytes UTF-8 bytes are stored inline (byte 1 = length, bytes 2-15
+ *   = text); longer strings are interned in FTelemetryStringTable and bytes 8-11 hold the id
+ * - If the intern table is full, a long string is truncated to its inline prefix
+ */
+struct HOMESTEADTWIN_API FTelemetryValue
+{
+	/** Longest string stored without interning (UTF-8 bytes) */
+	static constexpr int32 InlineStringBytes = 14;
+
+	/** Float value 0 */
+	FTelemetryValue() { MakeEmpty(ETelemetryValueType::Float); }
+
+	static FTelemetryValue MakeFloat(float Value);
+	static FTelemetryValue MakeInteger(int64 Value);
+	static FTelemetryValue MakeBoolean(bool bValue);
+	static FTelemetryValue MakeEnum(int32 Ordinal);
+	static FTelemetryValue MakeString(FStringView Text);
+	static FTelemetryValue MakeString(FUtf8StringView Text);
+
+	/** A float, or an integer if Value is integral and too large for a float to hold exactly (counters) */
+	static FTelemetryValue MakeNumber(double Value);
+
+	/** Rebuild a non-string value from its type and GetPayloadBits */
+	static FTelemetryValue FromPayloadBits(ETelemetryValueType Type, uint64 Bits);
+
+	ETelemetryValueType GetType() const { return ETelemetryValueType(Data[0]); }
+
+	/** Whether the value has a meaningful float projection (every type except String) */
+	bool IsNumeric() const { return GetType() != ETelemetryValueType::String; }
+
+	/** Float projection: booleans are 0 / 1, enums their ordinal, strings 0 */
+	float AsFloat() const;
+
+	/** Integer projection (floats truncate, strings 0) */
+	int64 AsInteger() const;
+
+	/** Boolean projection (non-zero numbers are true, strings false) */
+	bool AsBoolean() const { return AsFloat() != 0.0f; }
+
+	/** Numeric payload as stored in bytes 8-15 (not meaningful for strings) */
+	uint64 GetPayloadBits() const;
+
+	/** Format for display. Enums use EnumLabels[Ordinal] when one exists. */
+	FString ToString(TConstArrayView<FString> EnumLabels = TConstArrayView<FString>()) const;
+
+	/** Call Visitor with the text of a string value without building an FString (not called for other types) */
+	void VisitString(TFunctionRef<void(FStringView)> Visitor) const;
+
+	bool operator==(const FTelemetryValue& Other) const { return FMemory::Memcmp(Data, Other.Data, sizeof(Data)) == 0; }
+	bool operator!=(const FTelemetryValue& Other) const { return !(*this == Other); }
+
+private:
+	/** String length byte marking an interned string */
+	static constexpr uint8 InternedLength = 0xFF;
+
+	/** Offset of the numeric payload */
+	static constexpr int32 PayloadOffset = 8;
+
+	void MakeEmpty(ETelemetryValueType Type)
+	{
+		FMemory::Memzero(Data, sizeof(Data));
+		Data[0] = uint8(Type);
+	}
+
+	template <typename T>
+	T ReadPayload() const
+	{
+		T Value;
+		FMemory::Memcpy(&Value, Data + PayloadOffset, sizeof(T));
+		return Value;
+	}
+
+	template <typename T>
+	void WritePayload(T Value)
+	{
+		FMemory::Memcpy(Data + PayloadOffset, &Value, sizeof(T));
+	}
+
+private:
+	alignas(8) uint8 Data[16];
+};
+
+static_assert(sizeof(FTelemetryValue) == 16, "FTelemetryValue must stay 16 bytes");
@@ -0,0 +1,70 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "../Annotations/AnnotationJournal.h"
+#include "../Subsystems/US_AnnotationManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAnnotationJournalTornTailTest, "HomesteadTwin.Annotations.Journal.TornTail",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAnnotationJournalTornTailTest::RunTest(const FString& Parameters)
+{
+	const FString Path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("AnnotationJournalTornTail.journal"));
+	IFileManager::Get().Delete(*Path, false, false, true);
+
+	FAnnotation First;
+	First.Text = TEXT("First");
+	FAnnotation Second;
+	Second.Text = TEXT("Second");
+
+	TArray<uint8> Records;
+	FAnnotationJournal::EncodeUpsert(FAnnotationJournal::EOp::Create, First, Records);
+	FAnnotationJournal::EncodeUpsert(FAnnotationJournal::EOp::Create, Second, Records);
+
+	FAnnotationJournal Journal(Path);
+	TestTrue(TEXT("Records appended"), Journal.Append(Records));
+	Journal.Close();
+
+	// Simulate a crash part way through a record: half of a third one reaches the file
+	TArray<uint8> Bytes;
+	FFileHelper::LoadFileToArray(Bytes, *Path);
+	const int64 ValidSize = Bytes.Num();
+	TArray<uint8> Partial;
+	FAnnotationJournal::EncodeDelete(First.AnnotationId, Partial);
+	Bytes.Append(Partial.GetData(), Partial.Num() / 2);
+	FFileHelper::SaveArrayToFile(Bytes, *Path);
+
+	TArray<FGuid> Upserted;
+	TArray<FGuid> Deleted;
+	auto OnUpsert = [&Upserted](FAnnotation&& Annotation) { Upserted.Add(Annotation.AnnotationId); };
+	auto OnDelete = [&Deleted](const FGuid& AnnotationId) { Deleted.Add(AnnotationId); };
+
+	bool bTorn = false;
+	TestEqual(TEXT("Records before the torn tail"), Journal.Replay(OnUpsert, OnDelete, bTorn), 2);
+	TestTrue(TEXT("Torn tail reported"), bTorn);
+
+	// The next append cuts the tail off first, so the new record is readable
+	FAnnotation Third;
+	Third.Text = TEXT("Third");
+	Records.Reset();
+	FAnnotationJournal::EncodeUpsert(FAnnotationJournal::EOp::Create, Third, Records);
+	TestTrue(TEXT("Record appended after the torn tail"), Journal.Append(Records));
+	Journal.Close();
+	TestEqual(TEXT("File holds only valid records"), IFileManager::Get().FileSize(*Path), ValidSize + Records.Num());
+
+	Upserted.Reset();
+	TestEqual(TEXT("All records replay"), Journal.Replay(OnUpsert, OnDelete, bTorn), 3);
+	TestFalse(TEXT("No torn tail left"), bTorn);
+	TestTrue(TEXT("Appended record replays last"), Upserted.Num() == 3 && Upserted.Last() == Third.AnnotationId);
+	TestEqual(TEXT("Partial delete discarded"), Deleted.Num(), 0);
+
+	Journal.Delete();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,49 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "../Annotations/AnnotationJson.h"
+#include "../Subsystems/US_AnnotationManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAnnotationJsonLeftoverTempTest, "HomesteadTwin.Annotations.Json.LeftoverTemp",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAnnotationJsonLeftoverTempTest::RunTest(const FString& Parameters)
+{
+	IFileManager& FileManager = IFileManager::Get();
+	const FString Path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("AnnotationJsonLeftoverTemp.json"));
+	const FString TempPath = Path + TEXT(".tmp");
+	FileManager.Delete(*Path, false, false, true);
+
+	FAnnotation Annotation;
+	Annotation.Text = TEXT("Kept");
+	FString Error;
+	TestTrue(TEXT("Saved"), FAnnotationJson::SaveFile(MakeArrayView(&Annotation, 1), Path, Error));
+
+	TArray<uint8> Bytes;
+	FFileHelper::LoadFileToArray(Bytes, *Path);
+	FileManager.Delete(*Path, false, false, true);
+
+	// A crash part way through the first save: the truncated temp file is ignored
+	FFileHelper::SaveArrayToFile(MakeArrayView(Bytes.GetData(), Bytes.Num() / 2), *TempPath);
+	TArray<FAnnotation> Loaded;
+	TestFalse(TEXT("Truncated temp file not loaded"), FAnnotationJson::LoadFile(Path, Loaded, Error));
+	TestTrue(TEXT("Reported as no file"), Error.IsEmpty());
+	TestEqual(TEXT("Nothing loaded"), Loaded.Num(), 0);
+	TestFalse(TEXT("Not moved into place"), FileManager.FileExists(*Path));
+
+	// A crash between the sync and the move: the complete temp file is loaded and promoted
+	FFileHelper::SaveArrayToFile(Bytes, *TempPath);
+	TestTrue(TEXT("Complete temp file loaded"), FAnnotationJson::LoadFile(Path, Loaded, Error));
+	TestTrue(TEXT("Annotation read back"), Loaded.Num() == 1 && Loaded[0].AnnotationId == Annotation.AnnotationId);
+	TestTrue(TEXT("Moved into place"), FileManager.FileExists(*Path) && !FileManager.FileExists(*TempPath));
+
+	FileManager.Delete(*Path, false, false, true);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,59 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "../Telemetry/TelemetryAlarmEngine.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryAlarmEngineBoundaryTest, "HomesteadTwin.Telemetry.AlarmEngine.Boundaries",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryAlarmEngineBoundaryTest::RunTest(const FString& Parameters)
+{
+	FTelemetryAlarmEngine Engine;
+	Engine.EnsureSlots(5);
+
+	TArray<FTelemetryAlarmEngine::FTransition> Transitions;
+	auto Step = [&Engine, &Transitions](int32 Slot, float Value)
+	{
+		Engine.SetValue(Slot, Value);
+		Transitions.Reset();
+		Engine.Evaluate(Transitions);
+		return int32(Engine.GetState(Slot));
+	};
+
+	// High is good (component defaults: Green 80, Yellow 60): a value at a threshold keeps the better state
+	Engine.SetThresholds(0, 80.0f, 60.0f, 0.0f, true);
+	TestEqual(TEXT("At green threshold"), Step(0, 80.0f), FTelemetryAlarmEngine::Normal);
+	TestEqual(TEXT("Just below green"), Step(0, 79.9f), FTelemetryAlarmEngine::Warning);
+	TestEqual(TEXT("Transition reported"), Transitions.Num(), 1);
+	TestEqual(TEXT("At yellow threshold"), Step(0, 60.0f), FTelemetryAlarmEngine::Warning);
+	TestEqual(TEXT("Just below yellow"), Step(0, 59.9f), FTelemetryAlarmEngine::Critical);
+	TestEqual(TEXT("Back at yellow without hysteresis"), Step(0, 60.0f), FTelemetryAlarmEngine::Warning);
+	TestEqual(TEXT("Back at green without hysteresis"), Step(0, 80.0f), FTelemetryAlarmEngine::Normal);
+
+	// High is bad: the mirror image
+	Engine.SetThresholds(1, 30.0f, 50.0f, 0.0f, false);
+	TestEqual(TEXT("At warning threshold"), Step(1, 30.0f), FTelemetryAlarmEngine::Normal);
+	TestEqual(TEXT("Just above warning"), Step(1, 30.5f), FTelemetryAlarmEngine::Warning);
+	TestEqual(TEXT("At critical threshold"), Step(1, 50.0f), FTelemetryAlarmEngine::Warning);
+	TestEqual(TEXT("Just above critical"), Step(1, 50.5f), FTelemetryAlarmEngine::Critical);
+
+	// Hysteresis: a raised state holds until the value is a full band past the threshold
+	Engine.SetThresholds(2, 80.0f, 60.0f, 5.0f, true);
+	TestEqual(TEXT("Enter warning"), Step(2, 79.0f), FTelemetryAlarmEngine::Warning);
+	TestEqual(TEXT("Held inside the band"), Step(2, 84.0f), FTelemetryAlarmEngine::Warning);
+	TestEqual(TEXT("Released at threshold plus band"), Step(2, 85.0f), FTelemetryAlarmEngine::Normal);
+
+	// Unarmed slots stay Normal whatever their value, and a slot without a value stays Normal
+	TestEqual(TEXT("Unarmed slot"), Step(3, -1.0e6f), FTelemetryAlarmEngine::Normal);
+	TestEqual(TEXT("Nothing reported for it"), Transitions.Num(), 0);
+	Engine.SetThresholds(4, 80.0f, 60.0f, 0.0f, true);
+	Transitions.Reset();
+	Engine.Evaluate(Transitions);
+	TestEqual(TEXT("Armed slot without a value"), int32(Engine.GetState(4)), int32(FTelemetryAlarmEngine::Normal));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,452 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "../Telemetry/TelemetryMqttClient.h"
+#include "../Telemetry/TelemetryEndpointHealth.h"
+#include "../Telemetry/TelemetryKeyRegistry.h"
+#include "Misc/AutomationTest.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TelemetryMqttClientTests
+{
+	/** Ticks allowed for a loopback round trip before a step counts as failed */
+	constexpr int32 MaxPumpTicks = 2000;
+
+	FAnsiStringView Ansi(const ANSICHAR* Text)
+	{
+		return FAnsiStringView(Text);
+	}
+
+	TArray<uint8> Bytes(std::initializer_list<uint8> Values)
+	{
+		return TArray<uint8>(Values);
+	}
+
+	/**
+	 * Loopback listener standing in for a broker. The test drives both ends on one thread:
+	 * every pump ticks the client, then lets the broker accept and read.
+	 */
+	class FFakeBroker
+	{
+	public:
+		FFakeBroker()
+			: SocketSubsystem(ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM))
+			, Listener(nullptr)
+			, Peer(nullptr)
+			, Port(0)
+			, AcceptedCount(0)
+		{
+			TSharedRef<FInternetAddr> Address = SocketSubsystem->CreateInternetAddr();
+			Address->SetLoopbackAddress();
+			Address->SetPort(0);
+
+			Listener = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("FakeMqttBroker"), Address->GetProtocolType());
+			if (Listener && Listener->Bind(*Address) && Listener->Listen(4))
+			{
+				Listener->SetNonBlocking(true);
+				Listener->GetAddress(*Address);
+				Port = Address->GetPort();
+			}
+		}
+
+		~FFakeBroker()
+		{
+			DropPeer();
+			if (Listener)
+			{
+				Listener->Close();
+				SocketSubsystem->DestroySocket(Listener);
+			}
+		}
+
+		bool IsListening() const { return Port != 0; }
+		int32 GetPort() const { return Port; }
+		int32 GetAcceptedCount() const { return AcceptedCount; }
+
+		/** Accept a pending client, read what it sent and pop the next complete packet */
+		bool Poll(uint8& OutHeader, TArray<uint8>& OutBody)
+		{
+			bool bPending = false;
+			if (!Peer && Listener->HasPendingConnection(bPending) && bPending)
+			{
+				Peer = Listener->Accept(TEXT("FakeMqttPeer"));
+				if (Peer)
+				{
+					Peer->SetNonBlocking(true);
+					++AcceptedCount;
+				}
+			}
+
+			if (Peer)
+			{
+				uint8 Chunk[1024];
+				int32 BytesRead = 0;
+				while (Peer->Recv(Chunk, sizeof(Chunk), BytesRead) && BytesRead > 0)
+				{
+					Received.Append(Chunk, BytesRead);
+				}
+			}
+
+			TArrayView<const uint8> Body;
+			const int32 PacketBytes = FTelemetryMqttClient::DecodePacket(Received, OutHeader, Body);
+			if (PacketBytes <= 0)
+			{
+				return false;
+			}
+
+			OutBody = TArray<uint8>(Body.GetData(), Body.Num());
+			Received.RemoveAt(0, PacketBytes);
+			return true;
+		}
+
+		void Send(uint8 Header, TArrayView<const uint8> Body)
+		{
+			TArray<uint8> Packet;
+			FTelemetryMqttClient::EncodePacket(Header, Body, Packet);
+
+			int32 BytesSent = 0;
+			if (Peer)
+			{
+				Peer->Send(Packet.GetData(), Packet.Num(), BytesSent);
+			}
+		}
+
+		/** Close the client's connection (it should reconnect after its backoff) */
+		void DropPeer()
+		{
+			if (Peer)
+			{
+				Peer->Close();
+				SocketSubsystem->DestroySocket(Peer);
+				Peer = nullptr;
+			}
+			Received.Reset();
+		}
+
+	private:
+		ISocketSubsystem* SocketSubsystem;
+		FSocket* Listener;
+		FSocket* Peer;
+		int32 Port;
+		int32 AcceptedCount;
+		TArray<uint8> Received;
+	};
+
+	/** A client subscribed to "home/+/soc" talking to a fake broker, with a controllable clock */
+	struct FFakeSession
+	{
+		FTelemetryKeyRegistry Registry;
+		FTelemetryIngestQueue Queue;
+		FTelemetrySampleWriter Writer;
+		TSharedRef<FTelemetryEndpointHealth> Health;
+		FFakeBroker Broker;
+		TUniquePtr<FTelemetryMqttClient> Client;
+
+		/** Added to FPlatformTime::Seconds to move the client's clock forward */
+		double TimeOffset = 0.0;
+
+		explicit FFakeSession(uint16 KeepAliveSeconds)
+			: Writer(Registry)
+			, Health(MakeShared<FTelemetryEndpointHealth>())
+		{
+			FTelemetryMqttClient::FSettings Settings;
+			Settings.EndpointId = TEXT("FakeBroker");
+			Settings.Host = TEXT("127.0.0.1");
+			Settings.Port = Broker.GetPort();
+			Settings.QoS = 1;
+			Settings.KeepAliveSeconds = KeepAliveSeconds;
+			Settings.TopicMappings.Emplace(TEXT("home/+/soc"), TEXT("battery_soc"));
+
+			Client = MakeUnique<FTelemetryMqttClient>(Settings);
+			Client->SetEndpointHealth(Health);
+			Client->Start();
+		}
+
+		double Now() const { return FPlatformTime::Seconds() + TimeOffset; }
+
+		/** Tick until the broker receives a packet of Type (high nibble of the header) */
+		bool PumpUntilPacket(uint8 Type, TArray<uint8>& OutBody)
+		{
+			for (int32 Attempt = 0; Attempt < MaxPumpTicks; ++Attempt)
+			{
+				Client->Tick(Now(), Writer);
+
+				uint8 Header = 0;
+				while (Broker.Poll(Header, OutBody))
+				{
+					if ((Header >> 4) == Type)
+					{
+						return true;
+					}
+				}
+				FPlatformProcess::Sleep(0.001f);
+			}
+			return false;
+		}
+
+		/** Tick a few times so loopback traffic is delivered */
+		void Pump(int32 Ticks)
+		{
+			TArray<uint8> Ignored;
+			uint8 Header = 0;
+			for (int32 Attempt = 0; Attempt < Ticks; ++Attempt)
+			{
+				Client->Tick(Now(), Writer);
+				Broker.Poll(Header, Ignored);
+				FPlatformProcess::Sleep(0.001f);
+			}
+		}
+
+		/** Accept CONNECT and SUBSCRIBE and acknowledge both */
+		bool Handshake()
+		{
+			TArray<uint8> Body;
+			if (!PumpUntilPacket(1, Body))
+			{
+				return false;
+			}
+			Broker.Send(0x20, Bytes({ 0x00, 0x00 }));
+
+			if (!PumpUntilPacket(8, Body) || Body.Num() < 2)
+			{
+				return false;
+			}
+			Broker.Send(0x90, Bytes({ Body[0], Body[1], 0x01 }));
+			Pump(5);
+			return true;
+		}
+
+		FTelemetryEndpointHealth::FSnapshot GetHealth() const
+		{
+			TArray<FTelemetryEndpointHealth::FSnapshot> Snapshots;
+			Health->GetSnapshots(Snapshots);
+			return Snapshots.Num() > 0 ? Snapshots[0] : FTelemetryEndpointHealth::FSnapshot();
+		}
+	};
+}
+
+using namespace TelemetryMqttClientTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryMqttTopicFilterTest, "HomesteadTwin.Telemetry.Mqtt.TopicFilter",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryMqttTopicFilterTest::RunTest(const FString& Parameters)
+{
+	TestTrue(TEXT("Exact topic"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b/c"), Ansi("a/b/c")));
+	TestFalse(TEXT("Different topic"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b/d"), Ansi("a/b/c")));
+	TestFalse(TEXT("Prefix is not a match"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b"), Ansi("a/b/c")));
+
+	// '+' is exactly one level, which may be empty
+	TestTrue(TEXT("+ matches one level"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b/c"), Ansi("a/+/c")));
+	TestTrue(TEXT("+ matches an empty level"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a//c"), Ansi("a/+/c")));
+	TestTrue(TEXT("Trailing + matches an empty last level"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/"), Ansi("a/+")));
+	TestFalse(TEXT("+ does not match two levels"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b/x/c"), Ansi("a/+/c")));
+	TestFalse(TEXT("Trailing + needs the level"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a"), Ansi("a/+")));
+	TestTrue(TEXT("+/+ matches /"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("/"), Ansi("+/+")));
+	TestFalse(TEXT("Single + does not match two levels"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b"), Ansi("+")));
+
+	// '#' is every remaining level, including the parent
+	TestTrue(TEXT("# matches everything"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b/c"), Ansi("#")));
+	TestTrue(TEXT("a/# matches deeper levels"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b/c"), Ansi("a/#")));
+	TestTrue(TEXT("a/# matches the parent"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a"), Ansi("a/#")));
+	TestFalse(TEXT("a/# does not match a sibling"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("ab"), Ansi("a/#")));
+	TestTrue(TEXT("a/+/# matches a/b"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("a/b"), Ansi("a/+/#")));
+
+	// Wildcards at the first level never match $ topics
+	TestFalse(TEXT("# skips $SYS"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("$SYS/broker/uptime"), Ansi("#")));
+	TestFalse(TEXT("+ skips $SYS"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("$SYS/x"), Ansi("+/x")));
+	TestTrue(TEXT("Explicit $SYS filter"), FTelemetryMqttClient::TopicMatchesFilter(Ansi("$SYS/broker/uptime"), Ansi("$SYS/#")));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryMqttDecodePayloadTest, "HomesteadTwin.Telemetry.Mqtt.DecodePayload",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryMqttDecodePayloadTest::RunTest(const FString& Parameters)
+{
+	auto Decode = [](const ANSICHAR* Payload, FTelemetryValue& OutValue)
+	{
+		return FTelemetryMqttClient::DecodePayload(TArrayView<const uint8>(reinterpret_cast<const uint8*>(Payload), FCStringAnsi::Strlen(Payload)), OutValue);
+	};
+
+	FTelemetryValue Value;
+	TestTrue(TEXT("Bare number"), Decode(" 42.5\n", Value) && Value.AsFloat() == 42.5f);
+	TestTrue(TEXT("Number with a unit"), Decode("12.5 V", Value) && Value.AsFloat() == 12.5f);
+	TestTrue(TEXT("On is a boolean"), Decode("ON", Value) && Value.GetType() == ETelemetryValueType::Boolean && Value.AsBoolean());
+	TestTrue(TEXT("Status text"), Decode("charging", Value) && !Value.IsNumeric() && Value.ToString() == TEXT("charging"));
+	TestFalse(TEXT("Bare null"), Decode("null", Value));
+	TestFalse(TEXT("Empty payload"), Decode("", Value));
+
+	// JSON objects: the "value" field wherever it is nested, quoted numbers stay numbers
+	TestTrue(TEXT("Object value"), Decode("{\"value\": 230.1, \"unit\": \"V\"}", Value) && Value.AsFloat() == 230.1f);
+	TestTrue(TEXT("Nested value"), Decode("{\"sensor\": {\"value\": \"17\"}}", Value) && Value.IsNumeric() && Value.AsFloat() == 17.0f);
+	TestTrue(TEXT("Object status text"), Decode("{\"value\": \"fault\"}", Value) && Value.ToString() == TEXT("fault"));
+	TestFalse(TEXT("Object without value"), Decode("{\"unit\": \"V\"}", Value));
+	TestFalse(TEXT("Object with null value"), Decode("{\"value\": null}", Value));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryMqttPacketFramingTest, "HomesteadTwin.Telemetry.Mqtt.PacketFraming",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryMqttPacketFramingTest::RunTest(const FString& Parameters)
+{
+	// Remaining length is a 7-bit varint; check the byte boundaries
+	const TPair<int32, TArray<uint8>> LengthCases[] = {
+		{ 0, Bytes({ 0x00 }) },
+		{ 127, Bytes({ 0x7F }) },
+		{ 128, Bytes({ 0x80, 0x01 }) },
+		{ 16383, Bytes({ 0xFF, 0x7F }) },
+		{ 16384, Bytes({ 0x80, 0x80, 0x01 }) }
+	};
+	for (const TPair<int32, TArray<uint8>>& Case : LengthCases)
+	{
+		TArray<uint8> Body;
+		Body.SetNumZeroed(Case.Key);
+
+		TArray<uint8> Packet;
+		FTelemetryMqttClient::EncodePacket(0x30, Body, Packet);
+		TestEqual(*FString::Printf(TEXT("Packet size for %d"), Case.Key), Packet.Num(), 1 + Case.Value.Num() + Case.Key);
+		TestTrue(*FString::Printf(TEXT("Length bytes for %d"), Case.Key), FMemory::Memcmp(Packet.GetData() + 1, Case.Value.GetData(), Case.Value.Num()) == 0);
+
+		uint8 Header = 0;
+		TArrayView<const uint8> Decoded;
+		TestEqual(*FString::Printf(TEXT("Round trip for %d"), Case.Key), FTelemetryMqttClient::DecodePacket(Packet, Header, Decoded), Packet.Num());
+		TestEqual(*FString::Printf(TEXT("Body size for %d"), Case.Key), Decoded.Num(), Case.Key);
+		TestEqual(*FString::Printf(TEXT("Header for %d"), Case.Key), Header, uint8(0x30));
+	}
+
+	// Two packets back to back: the first is split off, the rest left for the next call
+	TArray<uint8> Stream;
+	FTelemetryMqttClient::EncodePacket(0xD0, TArrayView<const uint8>(), Stream);
+	FTelemetryMqttClient::EncodePacket(0x40, Bytes({ 0x00, 0x07 }), Stream);
+
+	uint8 Header = 0;
+	TArrayView<const uint8> Body;
+	TestEqual(TEXT("PINGRESP spans two bytes"), FTelemetryMqttClient::DecodePacket(Stream, Header, Body), 2);
+	TestEqual(TEXT("PINGRESP header"), Header, uint8(0xD0));
+	TestEqual(TEXT("PUBACK follows"), FTelemetryMqttClient::DecodePacket(TArrayView<const uint8>(Stream).Slice(2, 4), Header, Body), 4);
+	TestTrue(TEXT("PUBACK packet id"), Body.Num() == 2 && Body[1] == 0x07);
+
+	// Incomplete input waits for more bytes
+	TestEqual(TEXT("Header only"), FTelemetryMqttClient::DecodePacket(Bytes({ 0x30 }), Header, Body), 0);
+	TestEqual(TEXT("Length continues"), FTelemetryMqttClient::DecodePacket(Bytes({ 0x30, 0x80 }), Header, Body), 0);
+	TestEqual(TEXT("Body short"), FTelemetryMqttClient::DecodePacket(Bytes({ 0x30, 0x03, 0x00, 0x01 }), Header, Body), 0);
+
+	// A fifth length byte is malformed; a length above the cap is refused before buffering it
+	TestEqual(TEXT("Five length bytes"), FTelemetryMqttClient::DecodePacket(Bytes({ 0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F }), Header, Body), int32(INDEX_NONE));
+
+	TArray<uint8> Oversized;
+	Oversized.Add(0x30);
+	for (uint32 Length = FTelemetryMqttClient::MaxPacketBytes + 1; Length > 0; Length >>= 7)
+	{
+		Oversized.Add(uint8(Length & 0x7F) | (Length >= 0x80 ? 0x80 : 0x00));
+	}
+	TestEqual(TEXT("Oversized packet"), FTelemetryMqttClient::DecodePacket(Oversized, Header, Body), int32(INDEX_NONE));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryMqttFakeBrokerTest, "HomesteadTwin.Telemetry.Mqtt.FakeBroker",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryMqttFakeBrokerTest::RunTest(const FString& Parameters)
+{
+	FFakeSession Session(30);
+	if (!TestTrue(TEXT("Fake broker listening"), Session.Broker.IsListening()) || !TestTrue(TEXT("Handshake"), Session.Handshake()))
+	{
+		return false;
+	}
+	TestTrue(TEXT("Healthy after CONNACK"), Session.GetHealth().bHealthy);
+
+	// QoS 1 PUBLISH on a wildcard-mapped topic, packet id 7
+	const ANSICHAR Topic[] = "home/battery/soc";
+	const ANSICHAR Payload[] = "87.5";
+	TArray<uint8> Publish;
+	Publish.Add(0x00);
+	Publish.Add(uint8(UE_ARRAY_COUNT(Topic) - 1));
+	Publish.Append(reinterpret_cast<const uint8*>(Topic), UE_ARRAY_COUNT(Topic) - 1);
+	Publish.Append(Bytes({ 0x00, 0x07 }));
+	Publish.Append(reinterpret_cast<const uint8*>(Payload), UE_ARRAY_COUNT(Payload) - 1);
+	Session.Broker.Send(0x32, Publish);
+
+	TArray<uint8> Ack;
+	if (!TestTrue(TEXT("PUBACK received"), Session.PumpUntilPacket(4, Ack)))
+	{
+		return false;
+	}
+	TestTrue(TEXT("PUBACK echoes the packet id"), Ack.Num() == 2 && Ack[0] == 0x00 && Ack[1] == 0x07);
+
+	const int32 Slot = Session.Registry.Find(TEXT("battery_soc"));
+	bool bFoundSample = false;
+	Session.Writer.Flush(Session.Queue);
+	Session.Queue.Drain([&](TConstArrayView<FTelemetrySample> Batch)
+	{
+		for (const FTelemetrySample& Sample : Batch)
+		{
+			bFoundSample |= Sample.Slot == Slot && !Sample.bKeepAlive && Sample.Value.AsFloat() == 87.5f;
+		}
+	});
+	TestTrue(TEXT("Delivered value written to the mapped key"), bFoundSample);
+
+	// Broker goes away: the client reports the failure and reconnects after its backoff
+	Session.Broker.DropPeer();
+	Session.Pump(20);
+	TestFalse(TEXT("Unhealthy after the drop"), Session.GetHealth().bHealthy);
+
+	Session.TimeOffset += 2.0;
+	TArray<uint8> Connect;
+	TestTrue(TEXT("CONNECT after reconnect"), Session.PumpUntilPacket(1, Connect));
+	TestEqual(TEXT("Second connection accepted"), Session.Broker.GetAcceptedCount(), 2);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryMqttPingTimeoutTest, "HomesteadTwin.Telemetry.Mqtt.PingTimeout",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryMqttPingTimeoutTest::RunTest(const FString& Parameters)
+{
+	FFakeSession Session(2);
+	if (!TestTrue(TEXT("Fake broker listening"), Session.Broker.IsListening()) || !TestTrue(TEXT("Handshake"), Session.Handshake()))
+	{
+		return false;
+	}
+
+	// Idle for half the keep-alive: PINGREQ goes out and an answered ping keeps the session
+	TArray<uint8> Body;
+	Session.TimeOffset += 1.5;
+	if (!TestTrue(TEXT("First PINGREQ"), Session.PumpUntilPacket(12, Body)))
+	{
+		return false;
+	}
+	Session.Broker.Send(0xD0, TArrayView<const uint8>());
+	Session.Pump(5);
+
+	// Past the first ping's deadline: answered, so the client pings again instead of dropping
+	Session.TimeOffset += 2.5;
+	if (!TestTrue(TEXT("Second PINGREQ"), Session.PumpUntilPacket(12, Body)))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Answered ping keeps the session"), Session.GetHealth().ConsecutiveFailures, 0);
+
+	// A broker that stops answering is dropped one keep-alive period after the ping
+	Session.TimeOffset += 2.5;
+	Session.Pump(5);
+
+	const FTelemetryEndpointHealth::FSnapshot Health = Session.GetHealth();
+	TestFalse(TEXT("Unanswered ping drops the session"), Health.bHealthy);
+	TestEqual(TEXT("Reported reason"), Health.LastError, FString(TEXT("no PINGRESP")));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
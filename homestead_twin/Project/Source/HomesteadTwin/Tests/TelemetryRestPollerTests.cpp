@@ -0,0 +1,247 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "../Telemetry/TelemetryRestPoller.h"
+#include "../Telemetry/TelemetryEndpointHealth.h"
+#include "../Telemetry/TelemetryKeyRegistry.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TelemetryRestPollerTests
+{
+	TArray<uint8> Utf8Bytes(const ANSICHAR* Text)
+	{
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Text), FCStringAnsi::Strlen(Text));
+	}
+
+	/** Pop every queued sample */
+	TArray<FTelemetrySample> DrainSamples(FTelemetryIngestQueue& Queue)
+	{
+		TArray<FTelemetrySample> Samples;
+		Queue.Drain([&Samples](TConstArrayView<FTelemetrySample> Batch)
+		{
+			Samples.Append(Batch.GetData(), Batch.Num());
+		});
+		return Samples;
+	}
+
+	/** Poller whose requests go nowhere; the test completes them in place of a server */
+	class FFakeServerPoller : public FTelemetryRestPoller
+	{
+	public:
+		struct FSentRequest
+		{
+			int32 EndpointIndex;
+			FString ETag;
+		};
+
+		using FTelemetryRestPoller::FTelemetryRestPoller;
+		using FTelemetryRestPoller::CompleteRequest;
+
+		TArray<FSentRequest> SentRequests;
+
+	protected:
+		virtual void SendRequest(int32 EndpointIndex, const FEndpointSettings& Settings, const FString& ETag, const FString& LastModified) override
+		{
+			SentRequests.Add({ EndpointIndex, ETag });
+		}
+	};
+
+	TSharedRef<FFakeServerPoller> MakePoller(TSharedRef<FTelemetryKeyRegistry> Registry, TSharedRef<FTelemetryIngestQueue> Queue, int32 MaxInFlightRequests, TConstArrayView<const TCHAR*> Urls)
+	{
+		TSharedRef<FFakeServerPoller> Poller = MakeShared<FFakeServerPoller>(Registry, Queue, MaxInFlightRequests);
+		for (int32 Index = 0; Index < Urls.Num(); ++Index)
+		{
+			FTelemetryRestPoller::FEndpointSettings Settings;
+			Settings.EndpointId = FName(TEXT("Endpoint"), Index);
+			Settings.Url = Urls[Index];
+			Settings.PollInterval = 5.0f;
+			Settings.FieldMappings.Emplace(TEXT("battery.soc"), FName(TEXT("soc"), Index));
+			Poller->AddEndpoint(Settings);
+		}
+		Poller->Start();
+		return Poller;
+	}
+}
+
+using namespace TelemetryRestPollerTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryRestExtractFieldsTest, "HomesteadTwin.Telemetry.RestPoller.ExtractMappedFields",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryRestExtractFieldsTest::RunTest(const FString& Parameters)
+{
+	FTelemetryRestPoller::FFieldMap FieldMap;
+	FieldMap.FieldSlots.Add(TEXT("site.battery.soc"), 0);
+	FieldMap.FieldSlots.Add(TEXT("site.battery.mode"), 1);
+	FieldMap.FieldSlots.Add(TEXT("site.battery.missing"), 2);
+	FieldMap.FieldSlots.Add(TEXT("inverters.1.power"), 3);
+	FieldMap.FieldSlots.Add(TEXT("inverters.1.fault"), 4);
+	FieldMap.FieldSlots.Add(TEXT("grid"), 5);
+	FieldMap.ContainerPaths.Add(TEXT("site"));
+	FieldMap.ContainerPaths.Add(TEXT("site.battery"));
+	FieldMap.ContainerPaths.Add(TEXT("inverters"));
+	FieldMap.ContainerPaths.Add(TEXT("inverters.1"));
+
+	const TArray<uint8> Json = Utf8Bytes(
+		"{\"site\":{\"battery\":{\"soc\":\"87.5\",\"mode\":\"charging\",\"temp\":21.5}},"
+		"\"inverters\":[{\"power\":1200},{\"power\":800,\"fault\":true}],"
+		"\"grid\":null,"
+		"\"unmapped\":{\"soc\":1,\"deep\":[1,2,3]}}");
+
+	FTelemetryKeyRegistry Registry;
+	FTelemetryIngestQueue Queue;
+	FTelemetrySampleWriter Writer(Registry);
+	TestTrue(TEXT("Document parses"), FTelemetryRestPoller::ExtractMappedFields(Json, FieldMap, 42, Writer));
+	Writer.Flush(Queue);
+
+	TMap<int32, FTelemetryValue> Values;
+	for (const FTelemetrySample& Sample : DrainSamples(Queue))
+	{
+		TestEqual(TEXT("Timestamp passed through"), Sample.TimestampTicks, int64(42));
+		Values.Add(Sample.Slot, Sample.Value);
+	}
+
+	TestEqual(TEXT("Only present, non-null mapped fields"), Values.Num(), 4);
+	TestTrue(TEXT("Quoted number stays numeric"), Values.Contains(0) && Values[0].IsNumeric() && Values[0].AsFloat() == 87.5f);
+	TestTrue(TEXT("Status text is a string"), Values.Contains(1) && !Values[1].IsNumeric() && Values[1].ToString() == TEXT("charging"));
+	TestFalse(TEXT("Missing field emits nothing"), Values.Contains(2));
+	TestTrue(TEXT("Array element by index"), Values.Contains(3) && Values[3].AsFloat() == 800.0f);
+	TestTrue(TEXT("Boolean field"), Values.Contains(4) && Values[4].GetType() == ETelemetryValueType::Boolean && Values[4].AsBoolean());
+	TestFalse(TEXT("Null emits nothing"), Values.Contains(5));
+
+	// A truncated document reports failure (fields read before the cut may still be emitted)
+	FTelemetrySampleWriter TruncatedWriter(Registry);
+	TestFalse(TEXT("Truncated document fails"), FTelemetryRestPoller::ExtractMappedFields(Utf8Bytes("{\"site\":{\"battery\":{\"soc\":"), FieldMap, 42, TruncatedWriter));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryRestConditionalTest, "HomesteadTwin.Telemetry.RestPoller.ConditionalRequests",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryRestConditionalTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FTelemetryKeyRegistry> Registry = MakeShared<FTelemetryKeyRegistry>();
+	TSharedRef<FTelemetryIngestQueue> Queue = MakeShared<FTelemetryIngestQueue>();
+	TSharedRef<FTelemetryEndpointHealth> Health = MakeShared<FTelemetryEndpointHealth>();
+
+	TSharedRef<FFakeServerPoller> Poller = MakeShared<FFakeServerPoller>(Registry, Queue, 4);
+	Poller->SetEndpointHealth(Health);
+	{
+		FTelemetryRestPoller::FEndpointSettings Settings;
+		Settings.EndpointId = TEXT("Battery");
+		Settings.Url = TEXT("http://battery.local/status");
+		Settings.PollInterval = 5.0f;
+		Settings.FieldMappings.Emplace(TEXT("soc"), TEXT("battery_soc"));
+		Poller->AddEndpoint(Settings);
+	}
+	Poller->Start();
+
+	const int32 Slot = Registry->Find(TEXT("battery_soc"));
+	FTelemetrySampleWriter Writer(*Registry);
+	double Now = FPlatformTime::Seconds() + 1.0;
+
+	// First poll: no validators yet; the 200 body is parsed and its ETag kept
+	Poller->Tick(Now, Writer);
+	if (!TestEqual(TEXT("First request sent"), Poller->SentRequests.Num(), 1))
+	{
+		return false;
+	}
+	TestTrue(TEXT("No If-None-Match on the first request"), Poller->SentRequests[0].ETag.IsEmpty());
+	Poller->CompleteRequest(0, 200, TEXT("\"v1\""), FString(), Utf8Bytes("{\"soc\":50}"));
+
+	TArray<FTelemetrySample> Samples = DrainSamples(*Queue);
+	TestTrue(TEXT("200 commits the value"), Samples.Num() == 1 && Samples[0].Slot == Slot && !Samples[0].bKeepAlive && Samples[0].Value.AsFloat() == 50.0f);
+
+	// Not due again until the poll interval has passed
+	Poller->Tick(Now + 1.0, Writer);
+	TestEqual(TEXT("Poll interval honored"), Poller->SentRequests.Num(), 1);
+
+	// Second poll carries the validator; 304 only confirms the key is still current
+	Now += 5.0;
+	Poller->Tick(Now, Writer);
+	if (!TestEqual(TEXT("Second request sent"), Poller->SentRequests.Num(), 2))
+	{
+		return false;
+	}
+	TestEqual(TEXT("If-None-Match carries the ETag"), Poller->SentRequests[1].ETag, FString(TEXT("\"v1\"")));
+	Poller->CompleteRequest(0, 304, FString(), FString(), TArrayView<const uint8>());
+
+	Samples = DrainSamples(*Queue);
+	TestTrue(TEXT("304 keeps the key alive without a value"), Samples.Num() == 1 && Samples[0].Slot == Slot && Samples[0].bKeepAlive);
+
+	// A server without validators returning the same body is skipped the same way
+	Now += 5.0;
+	Poller->Tick(Now, Writer);
+	Poller->CompleteRequest(0, 200, FString(), FString(), Utf8Bytes("{\"soc\":50}"));
+	Samples = DrainSamples(*Queue);
+	TestTrue(TEXT("Unchanged body is not parsed"), Samples.Num() == 1 && Samples[0].bKeepAlive);
+
+	// A failed poll emits nothing and is reported
+	Now += 5.0;
+	Poller->Tick(Now, Writer);
+	Poller->CompleteRequest(0, 0, FString(), FString(), TArrayView<const uint8>());
+	TestEqual(TEXT("Failure emits nothing"), DrainSamples(*Queue).Num(), 0);
+
+	TArray<FTelemetryEndpointHealth::FSnapshot> Snapshots;
+	Health->GetSnapshots(Snapshots);
+	TestTrue(TEXT("Failure reported"), Snapshots.Num() == 1 && !Snapshots[0].bHealthy && Snapshots[0].ConsecutiveFailures == 1);
+
+	Poller->Stop();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryRestInFlightCapTest, "HomesteadTwin.Telemetry.RestPoller.InFlightCap",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryRestInFlightCapTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FTelemetryKeyRegistry> Registry = MakeShared<FTelemetryKeyRegistry>();
+	TSharedRef<FTelemetryIngestQueue> Queue = MakeShared<FTelemetryIngestQueue>();
+
+	// Endpoints 0 and 1 share a host; at most two requests in flight overall
+	const TCHAR* Urls[] = {
+		TEXT("http://inverter.local/a"),
+		TEXT("http://INVERTER.local/b"),
+		TEXT("http://battery.local/status"),
+		TEXT("http://meter.local/status")
+	};
+	TSharedRef<FFakeServerPoller> Poller = MakePoller(Registry, Queue, 2, Urls);
+
+	FTelemetrySampleWriter Writer(*Registry);
+	const double Now = FPlatformTime::Seconds() + 1.0;
+	const TArray<uint8> Body = Utf8Bytes("{\"battery\":{\"soc\":1}}");
+
+	auto SentOrder = [&Poller]()
+	{
+		TArray<int32> Order;
+		for (const FFakeServerPoller::FSentRequest& Sent : Poller->SentRequests)
+		{
+			Order.Add(Sent.EndpointIndex);
+		}
+		return Order;
+	};
+
+	// Endpoint 1 waits for its host, endpoint 3 for the global cap
+	Poller->Tick(Now, Writer);
+	TestTrue(TEXT("One request per host, two in total"), SentOrder() == TArray<int32>({ 0, 2 }));
+
+	Poller->Tick(Now, Writer);
+	TestEqual(TEXT("Nothing more while both are in flight"), SentOrder().Num(), 2);
+
+	// Finishing the shared host's request frees both its connection and a global slot
+	Poller->CompleteRequest(0, 200, FString(), FString(), Body);
+	Poller->Tick(Now, Writer);
+	TestTrue(TEXT("Same-host endpoint follows"), SentOrder() == TArray<int32>({ 0, 2, 1 }));
+
+	Poller->CompleteRequest(2, 200, FString(), FString(), Body);
+	Poller->Tick(Now, Writer);
+	TestTrue(TEXT("Capped endpoint follows"), SentOrder() == TArray<int32>({ 0, 2, 1, 3 }));
+
+	Poller->Stop();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,48 @@
+// Copyright Fluxology. All Rights Reserved.
+
+#include "../Telemetry/TelemetryRollupPyramid.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTelemetryRollupPyramidLongRangeTest, "HomesteadTwin.Telemetry.RollupPyramid.LongRange",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTelemetryRollupPyramidLongRangeTest::RunTest(const FString& Parameters)
+{
+	// Two days of one-minute samples; the 1 min ring (512 buckets) holds only ~8.5 h of them
+	FTelemetryRollupPyramid Pyramid(512);
+	Pyramid.EnsureSlots(1);
+
+	const int64 EndTicks = FDateTime(2026, 1, 3).GetTicks();
+	const int64 MinuteTicks = ETimespan::TicksPerMinute;
+	for (int64 TimestampTicks = EndTicks - 2 * ETimespan::TicksPerDay; TimestampTicks <= EndTicks; TimestampTicks += MinuteTicks)
+	{
+		Pyramid.AddSample(0, TimestampTicks, 1.0f);
+	}
+
+	const int64 StartTicks = EndTicks - ETimespan::TicksPerDay;
+	TArray<FTelemetryRollupPyramid::FBucket> Buckets;
+	const int32 Level = Pyramid.QueryForWidth(0, StartTicks, EndTicks, 500, Buckets);
+
+	TestTrue(TEXT("Selected level spans one day"), int64(Pyramid.GetBucketsPerLevel()) * FTelemetryRollupPyramid::GetBucketTicks(Level) >= EndTicks - StartTicks);
+	if (!TestTrue(TEXT("Buckets returned"), Buckets.Num() > 0))
+	{
+		return false;
+	}
+
+	const int64 BucketTicks = FTelemetryRollupPyramid::GetBucketTicks(Level);
+	TestEqual(TEXT("First bucket starts at the range start"), Buckets[0].StartTicks, StartTicks / BucketTicks * BucketTicks);
+	TestEqual(TEXT("Last bucket holds the range end"), Buckets.Last().StartTicks, EndTicks / BucketTicks * BucketTicks);
+
+	// A range the 1 s ring spans still gets 1 s detail; one it does not span moves up to 10 s
+	TestEqual(TEXT("Five minutes at 300 px use the 1 s level"), Pyramid.SelectLevel(EndTicks - 5 * MinuteTicks, EndTicks, 300), 0);
+	TestEqual(TEXT("Ten minutes at 300 px use the 10 s level"), Pyramid.SelectLevel(EndTicks - 10 * MinuteTicks, EndTicks, 300), 1);
+
+	// Ranges no ring spans fall back to the coarsest level
+	TestEqual(TEXT("A year uses the coarsest level"), Pyramid.SelectLevel(EndTicks - 365 * ETimespan::TicksPerDay, EndTicks, 100), FTelemetryRollupPyramid::NumLevels - 1);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS